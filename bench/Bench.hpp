@@ -0,0 +1,106 @@
+/*
+ * Copyright (C) 2025 aeml
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Minimal benchmark harness: each benchmark registers a function that times
+// its variants through Run and records one row per variant. atlascore_bench
+// runs every benchmark whose name contains the filter argument.
+namespace bench
+{
+    struct Row
+    {
+        std::string benchmark;
+        std::string variant;
+        double      msPerRun{0.0};
+        std::string note;
+    };
+
+    class Context
+    {
+    public:
+        explicit Context(std::string benchmark) : m_benchmark(std::move(benchmark)) {}
+
+        // Calls fn `runs` times after one warm-up call; returns mean ms per run.
+        template <typename Fn>
+        double Run(const std::string& variant, int runs, Fn&& fn, std::string note = {})
+        {
+            fn();
+            const auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < runs; ++i)
+            {
+                fn();
+            }
+            const auto end = std::chrono::steady_clock::now();
+            const double ms = std::chrono::duration<double, std::milli>(end - start).count() / runs;
+            m_rows.push_back({m_benchmark, variant, ms, std::move(note)});
+            return ms;
+        }
+
+        // Records a row measured by the benchmark itself.
+        void Record(const std::string& variant, double msPerRun, std::string note = {})
+        {
+            m_rows.push_back({m_benchmark, variant, msPerRun, std::move(note)});
+        }
+
+        // Attaches a note (e.g. an accuracy figure) to the last recorded row.
+        void Note(std::string note)
+        {
+            if (!m_rows.empty())
+            {
+                m_rows.back().note = std::move(note);
+            }
+        }
+
+        const std::vector<Row>& Rows() const noexcept { return m_rows; }
+
+    private:
+        std::string      m_benchmark;
+        std::vector<Row> m_rows;
+    };
+
+    using BenchmarkFn = void (*)(Context&);
+
+    struct Benchmark
+    {
+        const char* name;
+        BenchmarkFn fn;
+    };
+
+    inline std::vector<Benchmark>& Registry()
+    {
+        static std::vector<Benchmark> benchmarks;
+        return benchmarks;
+    }
+
+    struct Registrar
+    {
+        Registrar(const char* name, BenchmarkFn fn) { Registry().push_back({name, fn}); }
+    };
+}
+
+#define ATLASCORE_BENCHMARK(name)                                        \
+    static void name(bench::Context&);                                   \
+    static const bench::Registrar name##_registrar{#name, &name};        \
+    static void name(bench::Context& ctx)
@@ -0,0 +1,57 @@
+/*
+ * Copyright (C) 2025 aeml
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "Bench.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+
+int main(int argc, char** argv)
+{
+    const std::string filter = argc > 1 ? argv[1] : "";
+
+    auto benchmarks = bench::Registry();
+    std::sort(benchmarks.begin(), benchmarks.end(), [](const bench::Benchmark& a, const bench::Benchmark& b) {
+        return std::string(a.name) < std::string(b.name);
+    });
+
+    std::printf("%-28s %-24s %12s  %s\n", "benchmark", "variant", "ms/run", "note");
+    int ran = 0;
+    for (const auto& benchmark : benchmarks)
+    {
+        if (!filter.empty() && std::string(benchmark.name).find(filter) == std::string::npos)
+        {
+            continue;
+        }
+        bench::Context ctx(benchmark.name);
+        benchmark.fn(ctx);
+        for (const auto& row : ctx.Rows())
+        {
+            std::printf("%-28s %-24s %12.4f  %s\n", row.benchmark.c_str(), row.variant.c_str(), row.msPerRun, row.note.c_str());
+        }
+        ++ran;
+    }
+
+    if (ran == 0)
+    {
+        std::fprintf(stderr, "No benchmark matches '%s'\n", filter.c_str());
+        return 1;
+    }
+    return 0;
+}
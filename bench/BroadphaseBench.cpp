@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2025 aeml
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "Bench.hpp"
+
+#include "jobs/JobSystem.hpp"
+#include "physics/CollisionSystem.hpp"
+
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+    // `count` proxies in a square of side 2 * `halfWidth` cycling through
+    // `sizes`, plus a floor.
+    std::vector<physics::AABBComponent> Scene(std::size_t count, const std::vector<float>& sizes, float halfWidth = 40.0f)
+    {
+        std::mt19937 rng(42u);
+        std::uniform_real_distribution<float> pos(-halfWidth, halfWidth);
+        std::vector<physics::AABBComponent> boxes;
+        boxes.reserve(count + 1);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            const float size = sizes[i % sizes.size()];
+            const float x = pos(rng);
+            const float y = pos(rng);
+            boxes.push_back({x, y, x + size, y + size});
+        }
+        boxes.push_back({-100.0f, -41.0f, 100.0f, -39.0f});
+        return boxes;
+    }
+
+    void RunScene(bench::Context& ctx, const std::string& scene, const std::vector<physics::AABBComponent>& boxes,
+                  jobs::JobSystem& jobSystem)
+    {
+        constexpr int kRuns = 20;
+        std::vector<std::uint32_t> ids(boxes.size());
+        for (std::size_t i = 0; i < ids.size(); ++i) ids[i] = static_cast<std::uint32_t>(i);
+
+        std::vector<physics::CollisionEvent> events;
+        const physics::Broadphase kinds[] = {
+            physics::Broadphase::BruteForce, physics::Broadphase::UniformGrid,
+            physics::Broadphase::HierarchicalGrid, physics::Broadphase::SweepAndPrune,
+            physics::Broadphase::Auto};
+        for (const auto kind : kinds)
+        {
+            // Each system keeps its state between runs, as between substeps.
+            physics::CollisionSystem system;
+            system.SetBroadphase(kind);
+            system.Detect(boxes, ids, events);
+            const std::string name = system.ActiveBroadphase().Name();
+            const std::string label = kind == physics::Broadphase::Auto ? "auto (" + name + ")" : name;
+            ctx.Run(scene + ": " + label, kRuns, [&] { system.Detect(boxes, ids, events); },
+                    std::to_string(events.size()) + " pairs");
+            if (kind != physics::Broadphase::BruteForce)
+            {
+                const std::string base = kind == physics::Broadphase::Auto ? "auto" : name;
+                ctx.Run(scene + ": " + base + ", jobs", kRuns, [&] { system.Detect(boxes, ids, events, &jobSystem); });
+            }
+        }
+    }
+}
+
+ATLASCORE_BENCHMARK(BroadphaseMixedSizes)
+{
+    jobs::JobSystem jobSystem;
+    RunScene(ctx, "links 0.44", Scene(4000, {0.44f}), jobSystem);
+    RunScene(ctx, "links/crates/balls", Scene(4000, {0.44f, 1.0f, 1.0f, 4.0f}), jobSystem);
+    RunScene(ctx, "crates/balls", Scene(4000, {1.0f, 4.0f}), jobSystem);
+    RunScene(ctx, "packed particles 0.1", Scene(4000, {0.1f}, 10.0f), jobSystem);
+}
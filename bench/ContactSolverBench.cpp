@@ -0,0 +1,112 @@
+/*
+ * Copyright (C) 2025 aeml
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "Bench.hpp"
+
+#include "ecs/World.hpp"
+#include "jobs/JobSystem.hpp"
+#include "physics/CollisionSystem.hpp"
+#include "physics/Components.hpp"
+#include "physics/Systems.hpp"
+
+#include <string>
+#include <vector>
+
+namespace
+{
+    // A `side` x `side` block of overlapping balls resting on a floor, with
+    // one event per touching neighbour and per bottom ball.
+    void BallBlock(ecs::World& world, int side, std::vector<physics::CollisionEvent>& events)
+    {
+        auto floor = world.CreateEntity();
+        world.AddComponent<physics::TransformComponent>(floor, 0.0f, -1.0f, 0.0f);
+        auto& floorBody = world.AddComponent<physics::RigidBodyComponent>(floor);
+        floorBody.mass = 0.0f;
+        floorBody.invMass = 0.0f;
+        world.AddComponent<physics::AABBComponent>(floor, -1.0f, -1.0f, 0.95f * static_cast<float>(side), -0.45f);
+
+        std::vector<ecs::EntityId> balls;
+        for (int row = 0; row < side; ++row)
+        {
+            for (int col = 0; col < side; ++col)
+            {
+                auto e = world.CreateEntity();
+                world.AddComponent<physics::TransformComponent>(e, 0.95f * static_cast<float>(col),
+                                                                0.95f * static_cast<float>(row), 0.0f);
+                auto& rb = world.AddComponent<physics::RigidBodyComponent>(e);
+                rb.vy = -2.0f;
+                rb.vx = col % 2 == 0 ? 0.5f : -0.5f;
+                world.AddComponent<physics::CircleColliderComponent>(e, 0.5f);
+                balls.push_back(e);
+            }
+        }
+        auto add = [&](ecs::EntityId a, ecs::EntityId b)
+        {
+            physics::CollisionEvent event{};
+            event.entityA = a;
+            event.entityB = b;
+            events.push_back(event);
+        };
+        for (int row = 0; row < side; ++row)
+        {
+            for (int col = 0; col < side; ++col)
+            {
+                const auto e = balls[static_cast<std::size_t>(row * side + col)];
+                if (row == 0) add(floor, e);
+                if (col + 1 < side) add(e, balls[static_cast<std::size_t>(row * side + col + 1)]);
+                if (row + 1 < side) add(e, balls[static_cast<std::size_t>((row + 1) * side + col)]);
+            }
+        }
+    }
+}
+
+ATLASCORE_BENCHMARK(ContactVelocitySolve)
+{
+    jobs::JobSystem jobSystem;
+    for (const int side : {70, 224})
+    {
+        ecs::World world;
+        std::vector<physics::CollisionEvent> events;
+        BallBlock(world, side, events);
+        const std::string size = std::to_string(events.size() / 1000) + "k contacts";
+
+        physics::CollisionResolutionSystem resolution;
+        physics::ContactBuffer contacts;
+        resolution.PrepareContacts(events, world, contacts);
+        std::vector<physics::RigidBodyComponent> start;
+        for (const auto* body : contacts.bodyRigid) start.push_back(*body);
+        // Every run starts from the same velocities.
+        auto reset = [&]
+        {
+            for (std::size_t i = 0; i < start.size(); ++i) *contacts.bodyRigid[i] = start[i];
+        };
+        const int runs = side > 100 ? 5 : 20;
+        ctx.Run(size, runs, [&] { reset(); resolution.ResolveVelocity(contacts); },
+                std::to_string(contacts.BatchCount()) + " batches");
+        ctx.Run(size + ", jobs", runs, [&] { reset(); resolution.ResolveVelocity(contacts, &jobSystem); });
+
+        // The same passes with the Jacobi solver, which spreads the single
+        // island over every worker.
+        physics::CollisionResolutionSystem jacobi;
+        physics::CollisionResolutionSystem::SolverSettings settings;
+        settings.solver = physics::ContactSolver::Jacobi;
+        jacobi.SetSolverSettings(settings);
+        ctx.Run(size + ", Jacobi", runs, [&] { reset(); jacobi.ResolveVelocity(contacts); });
+        ctx.Run(size + ", Jacobi, jobs", runs, [&] { reset(); jacobi.ResolveVelocity(contacts, &jobSystem); });
+    }
+}
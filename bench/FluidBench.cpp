@@ -0,0 +1,80 @@
+/*
+ * Copyright (C) 2025 aeml
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "Bench.hpp"
+
+#include "ecs/World.hpp"
+#include "jobs/JobSystem.hpp"
+#include "physics/Components.hpp"
+#include "physics/Fluid.hpp"
+
+#include <cmath>
+#include <memory>
+#include <string>
+
+namespace
+{
+    // A square block of `count` particles at rest spacing, in a box twice
+    // as wide so the block collapses and spreads while it is timed.
+    physics::FluidSystem* DamBreak(ecs::World& world, std::size_t count, jobs::JobSystem* jobSystem)
+    {
+        physics::FluidSettings settings;
+        const float spacing = settings.restSpacing;
+        const auto side = static_cast<std::size_t>(std::sqrt(static_cast<float>(count)));
+        const float width = 2.0f * spacing * static_cast<float>(side);
+        auto wall = [&](float minX, float minY, float maxX, float maxY)
+        {
+            auto e = world.CreateEntity();
+            world.AddComponent<physics::TransformComponent>(e, 0.5f * (minX + maxX), 0.5f * (minY + maxY), 0.0f);
+            world.AddComponent<physics::AABBComponent>(e, minX, minY, maxX, maxY);
+        };
+        wall(-10.0f, -10.0f, 0.0f, 2.0f * width);
+        wall(width, -10.0f, width + 10.0f, 2.0f * width);
+        wall(-10.0f, -10.0f, width + 10.0f, 0.0f);
+        for (std::size_t i = 0; i < side * side; ++i)
+        {
+            auto p = world.CreateEntity();
+            world.AddComponent<physics::TransformComponent>(p, (static_cast<float>(i % side) + 0.5f) * spacing,
+                                                            (static_cast<float>(i / side) + 0.5f) * spacing, 0.0f);
+            world.AddComponent<physics::FluidParticleComponent>(p);
+        }
+        auto system = std::make_unique<physics::FluidSystem>();
+        system->SetSettings(settings);
+        system->SetJobSystem(jobSystem);
+        auto* out = system.get();
+        world.AddSystem(std::move(system));
+        return out;
+    }
+}
+
+ATLASCORE_BENCHMARK(FluidStep)
+{
+    jobs::JobSystem jobSystem;
+    for (const std::size_t count : {std::size_t{10000}, std::size_t{100000}})
+    {
+        const std::string size = std::to_string(count / 1000) + "k particles";
+        const int runs = count > 10000 ? 5 : 30;
+        for (jobs::JobSystem* js : {static_cast<jobs::JobSystem*>(nullptr), &jobSystem})
+        {
+            ecs::World world;
+            auto* fluid = DamBreak(world, count, js);
+            ctx.Run(size + (js ? ", jobs" : ""), runs, [&] { world.Update(1.0f / 60.0f); });
+            ctx.Note(std::to_string(fluid->NeighbourCount() / fluid->ParticleCount()) + " neighbours per particle");
+        }
+    }
+}
@@ -0,0 +1,90 @@
+/*
+ * Copyright (C) 2025 aeml
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "Bench.hpp"
+
+#include "jobs/JobSystem.hpp"
+#include "physics/Gravity.hpp"
+
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+    // `count` bodies in a disc, denser towards the centre.
+    physics::GravityBodies Disc(std::size_t count)
+    {
+        std::mt19937 rng(42u);
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+        physics::GravityBodies bodies;
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            const float r = 100.0f * unit(rng) * unit(rng);
+            const float angle = 6.2831853f * unit(rng);
+            bodies.Push(r * std::cos(angle), r * std::sin(angle), 0.5f + unit(rng));
+        }
+        return bodies;
+    }
+
+    std::string ErrorNote(const std::vector<float>& ax, const std::vector<float>& ay,
+                          const std::vector<float>& rx, const std::vector<float>& ry)
+    {
+        double error = 0.0;
+        double norm = 0.0;
+        for (std::size_t i = 0; i < ax.size(); ++i)
+        {
+            error += (ax[i] - rx[i]) * (ax[i] - rx[i]) + (ay[i] - ry[i]) * (ay[i] - ry[i]);
+            norm += rx[i] * rx[i] + ry[i] * ry[i];
+        }
+        return "rms error " + std::to_string(std::sqrt(error / norm));
+    }
+}
+
+ATLASCORE_BENCHMARK(GravityNBody)
+{
+    jobs::JobSystem jobSystem;
+    physics::GravitySolver solver;
+    std::vector<float> directX, directY, ax, ay;
+    for (const std::size_t count : {std::size_t{10000}, std::size_t{100000}})
+    {
+        const auto bodies = Disc(count);
+        const std::string size = std::to_string(count / 1000) + "k bodies";
+        physics::GravitySettings settings;
+
+        // Brute force only at the smaller size; 100k is 10^10 pairs.
+        const bool direct = count <= 10000;
+        if (direct)
+        {
+            settings.method = physics::GravityMethod::Direct;
+            ctx.Run(size + ": direct", 1, [&] { solver.Accelerations(bodies, settings, &jobSystem, directX, directY); });
+            settings.method = physics::GravityMethod::BarnesHut;
+        }
+        for (const float angle : {0.5f, 0.8f})
+        {
+            settings.openingAngle = angle;
+            const std::string variant = size + ": Barnes-Hut, angle " + std::to_string(angle).substr(0, 3);
+            ctx.Run(variant, count > 10000 ? 3 : 10, [&] { solver.Accelerations(bodies, settings, nullptr, ax, ay); });
+            ctx.Note(std::to_string(solver.NodeCount()) + " cells"
+                     + (direct ? ", " + ErrorNote(ax, ay, directX, directY) : std::string()));
+            ctx.Run(variant + ", jobs", count > 10000 ? 3 : 10,
+                    [&] { solver.Accelerations(bodies, settings, &jobSystem, ax, ay); });
+        }
+    }
+}
@@ -0,0 +1,98 @@
+/*
+ * Copyright (C) 2025 aeml
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "Bench.hpp"
+
+#include "ecs/World.hpp"
+#include "physics/Components.hpp"
+#include "physics/Systems.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+
+namespace
+{
+    // Hangs `chains` rigid chains of `links` bodies from static anchors, laid
+    // out stretched so every joint starts violated.
+    void BuildChains(ecs::World& world, int chains, int links)
+    {
+        for (int c = 0; c < chains; ++c)
+        {
+            const float y = static_cast<float>(c) * 3.0f;
+            auto prev = world.CreateEntity();
+            world.AddComponent<physics::TransformComponent>(prev, 0.0f, y, 0.0f);
+            auto& anchor = world.AddComponent<physics::RigidBodyComponent>(prev);
+            anchor.mass = 0.0f;
+            anchor.invMass = 0.0f;
+
+            for (int l = 1; l <= links; ++l)
+            {
+                auto link = world.CreateEntity();
+                world.AddComponent<physics::TransformComponent>(link, static_cast<float>(l) * 1.2f, y - 0.2f * l, 0.0f);
+                auto& rb = world.AddComponent<physics::RigidBodyComponent>(link);
+                rb.mass = 1.0f;
+                rb.invMass = 1.0f;
+                world.AddComponent<physics::DistanceJointComponent>(link, physics::DistanceJointComponent{prev, link, 1.0f, 0.0f});
+                prev = link;
+            }
+        }
+    }
+
+    float MaxStretch(const ecs::World& world)
+    {
+        float worst = 0.0f;
+        world.ForEach<physics::DistanceJointComponent>([&](ecs::EntityId, const physics::DistanceJointComponent& joint) {
+            const auto* tA = world.GetComponent<physics::TransformComponent>(joint.entityA);
+            const auto* tB = world.GetComponent<physics::TransformComponent>(joint.entityB);
+            worst = std::max(worst, std::fabs(std::hypot(tB->x - tA->x, tB->y - tA->y) - joint.targetDistance));
+        });
+        return worst;
+    }
+
+    // One Resolve from the stretched layout, repeated on fresh copies.
+    void RunSolver(bench::Context& ctx, physics::JointSolver solver, int iterations, const std::string& variant)
+    {
+        constexpr int kChains = 16;
+        constexpr int kLinks = 32;
+        constexpr int kRuns = 50;
+        constexpr float kDt = 1.0f / 960.0f; // wrecking scenario substep
+
+        ecs::World world;
+        BuildChains(world, kChains, kLinks);
+        auto* transforms = world.GetStorage<physics::TransformComponent>();
+        const auto initial = transforms->GetData();
+
+        physics::ConstraintResolutionSystem system;
+        system.SetSolver(solver);
+        system.SetIterationCount(iterations);
+        ctx.Run(variant, kRuns, [&] {
+            auto& data = transforms->GetData();
+            std::copy(initial.begin(), initial.end(), data.begin());
+            system.Resolve(world, kDt);
+        });
+        ctx.Note("max stretch " + std::to_string(MaxStretch(world)));
+    }
+}
+
+ATLASCORE_BENCHMARK(JointChainSolve)
+{
+    RunSolver(ctx, physics::JointSolver::Iterative, 16, "gauss-seidel x16");
+    RunSolver(ctx, physics::JointSolver::Iterative, 64, "gauss-seidel x64");
+    RunSolver(ctx, physics::JointSolver::Auto, 16, "direct tree");
+}
@@ -0,0 +1,151 @@
+/*
+ * Copyright (C) 2025 aeml
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "Bench.hpp"
+
+#include "ecs/World.hpp"
+#include "jobs/JobSystem.hpp"
+#include "physics/CollisionSystem.hpp"
+#include "physics/Components.hpp"
+#include "physics/Narrowphase.hpp"
+#include "physics/Systems.hpp"
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+    // `count` circle pairs, about two thirds of them touching.
+    physics::CircleCircleBatch CirclePairs(std::size_t count)
+    {
+        std::mt19937 rng(42u);
+        std::uniform_real_distribution<float> pos(-100.0f, 100.0f);
+        std::uniform_real_distribution<float> gap(-0.5f, 0.5f);
+        physics::CircleCircleBatch pairs;
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            const float x = pos(rng);
+            const float y = pos(rng);
+            pairs.Push(x, y, 0.5f, x + 0.8f + gap(rng), y + gap(rng), 0.5f, static_cast<std::uint32_t>(i));
+        }
+        return pairs;
+    }
+
+    physics::CircleAabbBatch CircleBoxPairs(std::size_t count)
+    {
+        std::mt19937 rng(43u);
+        std::uniform_real_distribution<float> pos(-1.6f, 1.6f);
+        const physics::AABBComponent box{-1.0f, -1.0f, 1.0f, 1.0f};
+        physics::CircleAabbBatch pairs;
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            pairs.Push(pos(rng), pos(rng), 0.5f, box, static_cast<std::uint32_t>(i));
+        }
+        return pairs;
+    }
+
+    std::string Hits(const std::vector<std::uint8_t>& hit)
+    {
+        std::size_t count = 0;
+        for (const auto h : hit) count += h;
+        return std::to_string(count) + " contacts";
+    }
+
+    // A row of `count` + 1 overlapping balls, one event per neighbour pair,
+    // so PrepareContacts has `count` circle contacts to build.
+    void RowOfBalls(ecs::World& world, std::size_t count, std::vector<physics::CollisionEvent>& events)
+    {
+        std::vector<ecs::EntityId> balls;
+        for (std::size_t i = 0; i <= count; ++i)
+        {
+            auto e = world.CreateEntity();
+            world.AddComponent<physics::TransformComponent>(e, 0.9f * static_cast<float>(i), 0.0f, 0.0f);
+            world.AddComponent<physics::RigidBodyComponent>(e);
+            world.AddComponent<physics::CircleColliderComponent>(e, 0.5f);
+            balls.push_back(e);
+        }
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            physics::CollisionEvent event{};
+            event.entityA = balls[i];
+            event.entityB = balls[i + 1];
+            event.bodyA = static_cast<std::uint32_t>(i);
+            event.bodyB = static_cast<std::uint32_t>(i + 1);
+            events.push_back(event);
+        }
+    }
+}
+
+ATLASCORE_BENCHMARK(NarrowphaseCircles)
+{
+    jobs::JobSystem jobSystem;
+    for (const std::size_t count : {std::size_t{10000}, std::size_t{100000}})
+    {
+        const int runs = count > 10000 ? 20 : 200;
+        const std::string size = std::to_string(count / 1000) + "k";
+        physics::ManifoldBatch out;
+
+        // The same pairs one call at a time, as PrepareContacts used to.
+        const auto circles = CirclePairs(count);
+        ctx.Run("circle/circle " + size + ": per pair", runs, [&] {
+            out.hit.resize(count);
+            out.nx.resize(count);
+            out.ny.resize(count);
+            out.penetration.resize(count);
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                out.hit[i] = physics::CircleCircleManifold(circles.ax[i], circles.ay[i], circles.radiusA[i],
+                                                           circles.bx[i], circles.by[i], circles.radiusB[i],
+                                                           out.nx[i], out.ny[i], out.penetration[i]);
+            }
+        });
+        ctx.Run("circle/circle " + size + ": batched", runs, [&] { physics::CircleCircleManifolds(circles, out); });
+        ctx.Note(Hits(out.hit));
+
+        const auto boxes = CircleBoxPairs(count);
+        ctx.Run("circle/box " + size + ": per pair", runs, [&] {
+            out.hit.resize(count);
+            out.nx.resize(count);
+            out.ny.resize(count);
+            out.penetration.resize(count);
+            const physics::AABBComponent box{boxes.minX[0], boxes.minY[0], boxes.maxX[0], boxes.maxY[0]};
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                out.hit[i] = physics::CircleAabbManifold(boxes.cx[i], boxes.cy[i], boxes.radius[i], box,
+                                                         out.nx[i], out.ny[i], out.penetration[i]);
+            }
+        });
+        ctx.Run("circle/box " + size + ": batched", runs, [&] { physics::CircleAabbManifolds(boxes, out); });
+        ctx.Note(Hits(out.hit));
+
+        // End to end: record lookups, buckets, kernels, materials, islands.
+        ecs::World world;
+        std::vector<physics::CollisionEvent> events;
+        RowOfBalls(world, count, events);
+        physics::CollisionResolutionSystem resolution;
+        physics::ContactBuffer contacts;
+        ctx.Run("PrepareContacts " + size, count > 10000 ? 10 : 50,
+                [&] { resolution.PrepareContacts(events, world, contacts); });
+        ctx.Note(std::to_string(contacts.Size()) + " rows");
+        // Island building on the job system.
+        ctx.Run("PrepareContacts " + size + ", jobs", count > 10000 ? 10 : 50,
+                [&] { resolution.PrepareContacts(events, world, contacts, &jobSystem); });
+    }
+}
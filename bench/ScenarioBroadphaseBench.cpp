@@ -0,0 +1,137 @@
+/*
+ * Copyright (C) 2025 aeml
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "Bench.hpp"
+
+#include "ecs/World.hpp"
+#include "physics/Broadphase.hpp"
+#include "physics/Systems.hpp"
+#include "simlab/Scenario.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <utility>
+
+namespace
+{
+    // Forwards to a built-in strategy and times its calls.
+    class TimedBroadphase final : public physics::IBroadphase
+    {
+    public:
+        explicit TimedBroadphase(physics::Broadphase kind) : m_inner(physics::CreateBroadphase(kind)) {}
+
+        void FindPairs(const std::vector<physics::AABBComponent>& aabbs, const physics::ProxyFilter& filter,
+                       jobs::JobSystem* jobSystem, std::vector<physics::ProxyPair>& pairs) override
+        {
+            const auto start = std::chrono::steady_clock::now();
+            m_inner->FindPairs(aabbs, filter, jobSystem, pairs);
+            m_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            m_proxies = aabbs.size();
+            if (const auto* chooser = dynamic_cast<const physics::AutoBroadphase*>(m_inner.get()))
+            {
+                m_choice = chooser->LastChoice()->Name();
+            }
+        }
+
+        const char* Name() const noexcept override { return m_inner->Name(); }
+
+        double      Seconds() const noexcept { return m_seconds; }
+        std::size_t Proxies() const noexcept { return m_proxies; }
+        const char* Choice() const noexcept { return m_choice; }
+        void        Reset() noexcept { m_seconds = 0.0; }
+
+    private:
+        std::unique_ptr<physics::IBroadphase> m_inner;
+        double                                m_seconds{0.0};
+        std::size_t                           m_proxies{0};
+        const char*                           m_choice{nullptr};
+    };
+
+    // Runs `frames` frames of a fresh scenario after a warm-up and returns the
+    // broadphase milliseconds per frame, or a negative value when the
+    // scenario has no PhysicsSystem or fails.
+    double TimeScenario(const simlab::ScenarioDesc& desc, physics::Broadphase kind, int frames, std::string& note)
+    {
+        constexpr float kDt = 1.0f / 60.0f;
+        constexpr int kWarmup = 30;
+        try
+        {
+            ecs::World world;
+            auto scenario = desc.factory();
+            scenario->Setup(world);
+            auto* physicsSystem = world.FindSystem<physics::PhysicsSystem>();
+            if (!physicsSystem) return -1.0;
+
+            auto timed = std::make_unique<TimedBroadphase>(kind);
+            auto* timer = timed.get();
+            physicsSystem->SetBroadphase(std::move(timed));
+
+            for (int i = 0; i < kWarmup; ++i)
+            {
+                scenario->Update(world, kDt);
+                world.Update(kDt);
+            }
+            timer->Reset();
+            const auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < frames; ++i)
+            {
+                scenario->Update(world, kDt);
+                world.Update(kDt);
+            }
+            const double frameMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / frames;
+
+            char buffer[128];
+            std::snprintf(buffer, sizeof(buffer), "%zu proxies, frame %.3f ms", timer->Proxies(), frameMs);
+            note = buffer;
+            if (timer->Choice())
+            {
+                note += std::string(", picked ") + timer->Choice();
+            }
+            return timer->Seconds() * 1000.0 / frames;
+        }
+        catch (...)
+        {
+            return -1.0;
+        }
+    }
+}
+
+// Broadphase time per frame for every registered scenario with physics,
+// under each strategy. The strategies report identical contacts, so the
+// simulations match and only the cost differs.
+ATLASCORE_BENCHMARK(BroadphaseScenarios)
+{
+    constexpr int kFrames = 60;
+    const physics::Broadphase kinds[] = {
+        physics::Broadphase::BruteForce, physics::Broadphase::UniformGrid,
+        physics::Broadphase::HierarchicalGrid, physics::Broadphase::SweepAndPrune,
+        physics::Broadphase::Auto};
+    for (const auto& desc : simlab::ScenarioRegistry::All())
+    {
+        for (const auto kind : kinds)
+        {
+            std::string note;
+            const double ms = TimeScenario(desc, kind, kFrames, note);
+            if (ms < 0.0) break;
+            const auto name = physics::CreateBroadphase(kind)->Name();
+            ctx.Record(std::string(desc.key) + ": " + name, ms, std::move(note));
+        }
+    }
+}
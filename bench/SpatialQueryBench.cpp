@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 2025 aeml
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "Bench.hpp"
+
+#include "jobs/JobSystem.hpp"
+#include "physics/Components.hpp"
+#include "physics/SpatialQuery.hpp"
+
+#include <random>
+#include <string>
+#include <vector>
+
+ATLASCORE_BENCHMARK(SpatialQueries)
+{
+    jobs::JobSystem jobSystem;
+    for (const std::size_t count : {std::size_t{10000}, std::size_t{100000}})
+    {
+        // Unit-sized colliders at a density of about one per 4 square units.
+        std::mt19937 rng(42u);
+        const float side = 2.0f * std::sqrt(static_cast<float>(count));
+        std::uniform_real_distribution<float> pos(0.0f, side);
+        std::vector<physics::AABBComponent> bounds;
+        std::vector<std::uint32_t> entities;
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            const float x = pos(rng);
+            const float y = pos(rng);
+            bounds.push_back({x, y, x + 1.0f, y + 1.0f});
+            entities.push_back(static_cast<std::uint32_t>(i));
+        }
+        const std::string size = std::to_string(count / 1000) + "k colliders";
+
+        physics::SpatialQueryIndex index;
+        ctx.Run(size + ": build", 20, [&] { index.Build(bounds, entities, {}, count); });
+
+        std::vector<physics::AABBComponent> boxes;
+        std::vector<physics::Ray> rays;
+        for (int q = 0; q < 1000; ++q)
+        {
+            const float x = pos(rng);
+            const float y = pos(rng);
+            boxes.push_back({x, y, x + 4.0f, y + 4.0f});
+            rays.push_back({x, y, pos(rng) - x, pos(rng) - y, 20.0f});
+        }
+
+        // What a caller without the index does: test every collider.
+        std::vector<std::uint32_t> found;
+        std::size_t results = 0;
+        ctx.Run(size + ": 1000 box queries, full scan", 5, [&] {
+            results = 0;
+            for (const auto& box : boxes)
+            {
+                found.clear();
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    const auto& b = bounds[i];
+                    if (b.maxX >= box.minX && box.maxX >= b.minX && b.maxY >= box.minY && box.maxY >= b.minY)
+                    {
+                        found.push_back(entities[i]);
+                    }
+                }
+                results += found.size();
+            }
+        });
+        ctx.Note(std::to_string(results) + " results");
+        ctx.Run(size + ": 1000 box queries", 50, [&] {
+            for (const auto& box : boxes) index.QueryAabb(box, found);
+        });
+        std::vector<std::uint32_t> offsets;
+        ctx.Run(size + ": 1000 box queries, batched, jobs", 50,
+                [&] { index.QueryAabbs(boxes, offsets, found, &jobSystem); });
+        ctx.Note(std::to_string(found.size()) + " results");
+
+        std::vector<physics::RayHit> hits;
+        ctx.Run(size + ": 1000 raycasts, batched", 50, [&] { index.Raycasts(rays, hits, nullptr); });
+        std::size_t hitCount = 0;
+        for (const auto& hit : hits) hitCount += hit.entity != 0xFFFFFFFFu ? 1 : 0;
+        ctx.Note(std::to_string(hitCount) + " hits");
+    }
+}
@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 2025 aeml
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "Bench.hpp"
+
+#include "ecs/World.hpp"
+#include "jobs/JobSystem.hpp"
+#include "physics/Components.hpp"
+#include "physics/Systems.hpp"
+
+#include <memory>
+#include <string>
+
+namespace
+{
+    // A `columns` x `rows` wall of crates and balls on a floor, settled for
+    // a second before timing starts.
+    physics::PhysicsSystem* BuildWall(ecs::World& world, int columns, int rows, physics::PhysicsExecution execution,
+                                      jobs::JobSystem* jobSystem)
+    {
+        auto system = std::make_unique<physics::PhysicsSystem>();
+        physics::PhysicsSettings settings;
+        settings.substeps = 8;
+        settings.execution = execution;
+        // Both modes re-measure penetration (Tiled always does).
+        settings.positionTolerance = 1e-6f;
+        system->SetSettings(settings);
+        system->SetJobSystem(jobSystem);
+        auto* physicsSystem = system.get();
+        world.AddSystem(std::move(system));
+
+        const float width = static_cast<float>(columns);
+        auto floor = world.CreateEntity();
+        world.AddComponent<physics::TransformComponent>(floor, 0.0f, -1.0f, 0.0f);
+        auto& floorBody = world.AddComponent<physics::RigidBodyComponent>(floor);
+        floorBody.mass = 0.0f;
+        floorBody.invMass = 0.0f;
+        world.AddComponent<physics::AABBComponent>(floor, -width, -2.0f, width, 0.0f);
+        for (int row = 0; row < rows; ++row)
+        {
+            for (int col = 0; col < columns; ++col)
+            {
+                const float x = static_cast<float>(col) - 0.5f * width + (row % 2 == 0 ? 0.0f : 0.5f);
+                const float y = 0.5f + static_cast<float>(row);
+                auto e = world.CreateEntity();
+                world.AddComponent<physics::TransformComponent>(e, x, y, 0.0f);
+                auto& rb = world.AddComponent<physics::RigidBodyComponent>(e);
+                rb.friction = 0.6f;
+                rb.lastX = x;
+                rb.lastY = y;
+                physics::ConfigureBoxInertia(rb, 1.0f, 1.0f);
+                if ((row + col) % 2 == 0)
+                {
+                    world.AddComponent<physics::AABBComponent>(e, x - 0.5f, y - 0.5f, x + 0.5f, y + 0.5f);
+                }
+                else
+                {
+                    world.AddComponent<physics::CircleColliderComponent>(e, 0.5f);
+                }
+            }
+        }
+        for (int frame = 0; frame < 60; ++frame) world.Update(1.0f / 60.0f);
+        return physicsSystem;
+    }
+}
+
+// One frame of a resting wall, staged against tiled execution. The tiled
+// rows differ from the staged ones in solve order only, not in work.
+ATLASCORE_BENCHMARK(TiledStep)
+{
+    jobs::JobSystem jobSystem;
+    for (const int columns : {80, 400})
+    {
+        const int rows = 25;
+        const std::string size = std::to_string(columns * rows / 1000) + "k bodies";
+        const int runs = columns > 100 ? 5 : 20;
+        for (const auto execution : {physics::PhysicsExecution::Staged, physics::PhysicsExecution::Tiled})
+        {
+            const std::string mode = execution == physics::PhysicsExecution::Tiled ? "tiled" : "staged";
+            for (jobs::JobSystem* js : {static_cast<jobs::JobSystem*>(nullptr), &jobSystem})
+            {
+                ecs::World world;
+                auto* physicsSystem = BuildWall(world, columns, rows, execution, js);
+                ctx.Run(size + ", " + mode + (js ? ", jobs" : ""), runs, [&] { world.Update(1.0f / 60.0f); });
+                ctx.Note(std::to_string(physicsSystem->GetCollisionEvents().size()) + " contacts");
+            }
+        }
+    }
+}
@@ -0,0 +1,171 @@
+/*
+ * Copyright (C) 2025 aeml
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace ecs
+{
+    // Sequence container built from fixed-size blocks that are never moved
+    // once allocated. push_back never invalidates references to existing
+    // elements, unlike std::vector. Indexing costs one shift and one mask.
+    template <typename T, std::size_t ChunkBytes = 16384>
+    class ChunkedArray
+    {
+    public:
+        static constexpr std::size_t kChunkSize = ChunkBytes / sizeof(T) > 0 ? ChunkBytes / sizeof(T) : 1;
+
+        template <bool Const>
+        class Iterator
+        {
+        public:
+            using iterator_category = std::random_access_iterator_tag;
+            using value_type = T;
+            using difference_type = std::ptrdiff_t;
+            using pointer = std::conditional_t<Const, const T*, T*>;
+            using reference = std::conditional_t<Const, const T&, T&>;
+            using Owner = std::conditional_t<Const, const ChunkedArray, ChunkedArray>;
+
+            Iterator() = default;
+            Iterator(Owner* owner, std::size_t index) : m_owner(owner), m_index(index) {}
+            operator Iterator<true>() const { return Iterator<true>(m_owner, m_index); }
+
+            reference operator*() const { return (*m_owner)[m_index]; }
+            pointer operator->() const { return &(*m_owner)[m_index]; }
+            reference operator[](difference_type n) const { return (*m_owner)[m_index + n]; }
+
+            Iterator& operator++() { ++m_index; return *this; }
+            Iterator operator++(int) { Iterator tmp = *this; ++m_index; return tmp; }
+            Iterator& operator--() { --m_index; return *this; }
+            Iterator operator--(int) { Iterator tmp = *this; --m_index; return tmp; }
+            Iterator& operator+=(difference_type n) { m_index += n; return *this; }
+            Iterator& operator-=(difference_type n) { m_index -= n; return *this; }
+            Iterator operator+(difference_type n) const { return Iterator(m_owner, m_index + n); }
+            Iterator operator-(difference_type n) const { return Iterator(m_owner, m_index - n); }
+            friend Iterator operator+(difference_type n, const Iterator& it) { return it + n; }
+            difference_type operator-(const Iterator& other) const
+            {
+                return static_cast<difference_type>(m_index) - static_cast<difference_type>(other.m_index);
+            }
+
+            bool operator==(const Iterator& other) const { return m_index == other.m_index; }
+            bool operator!=(const Iterator& other) const { return m_index != other.m_index; }
+            bool operator<(const Iterator& other) const { return m_index < other.m_index; }
+            bool operator>(const Iterator& other) const { return m_index > other.m_index; }
+            bool operator<=(const Iterator& other) const { return m_index <= other.m_index; }
+            bool operator>=(const Iterator& other) const { return m_index >= other.m_index; }
+
+        private:
+            Owner*      m_owner{nullptr};
+            std::size_t m_index{0};
+        };
+
+        using value_type = T;
+        using size_type = std::size_t;
+        using iterator = Iterator<false>;
+        using const_iterator = Iterator<true>;
+
+        ChunkedArray() = default;
+        ChunkedArray(ChunkedArray&&) noexcept = default;
+        ChunkedArray& operator=(ChunkedArray&&) noexcept = default;
+        ChunkedArray(const ChunkedArray& other) { for (const auto& v : other) push_back(v); }
+        ChunkedArray& operator=(const ChunkedArray& other)
+        {
+            if (this != &other)
+            {
+                clear();
+                for (const auto& v : other) push_back(v);
+            }
+            return *this;
+        }
+
+        T& operator[](std::size_t i) { return (*m_chunks[i / kChunkSize])[i % kChunkSize]; }
+        const T& operator[](std::size_t i) const { return (*m_chunks[i / kChunkSize])[i % kChunkSize]; }
+
+        T& back() { return (*this)[m_size - 1]; }
+        const T& back() const { return (*this)[m_size - 1]; }
+
+        void push_back(const T& value)
+        {
+            if (m_size == capacity())
+            {
+                m_chunks.push_back(std::make_unique<Chunk>());
+            }
+            (*this)[m_size] = value;
+            ++m_size;
+        }
+
+        void push_back(T&& value)
+        {
+            if (m_size == capacity())
+            {
+                m_chunks.push_back(std::make_unique<Chunk>());
+            }
+            (*this)[m_size] = std::move(value);
+            ++m_size;
+        }
+
+        void pop_back()
+        {
+            --m_size;
+            (*this)[m_size] = T{};
+        }
+
+        void clear()
+        {
+            m_chunks.clear();
+            m_size = 0;
+        }
+
+        // Allocates whole chunks up front; existing elements stay in place.
+        void reserve(std::size_t count)
+        {
+            while (capacity() < count)
+            {
+                m_chunks.push_back(std::make_unique<Chunk>());
+            }
+        }
+
+        // Frees trailing chunks that hold no live element.
+        void shrink_to_fit()
+        {
+            const std::size_t needed = (m_size + kChunkSize - 1) / kChunkSize;
+            m_chunks.resize(needed);
+        }
+
+        std::size_t size() const noexcept { return m_size; }
+        bool empty() const noexcept { return m_size == 0; }
+        std::size_t capacity() const noexcept { return m_chunks.size() * kChunkSize; }
+
+        iterator begin() { return iterator(this, 0); }
+        iterator end() { return iterator(this, m_size); }
+        const_iterator begin() const { return const_iterator(this, 0); }
+        const_iterator end() const { return const_iterator(this, m_size); }
+
+    private:
+        using Chunk = std::array<T, kChunkSize>;
+
+        std::vector<std::unique_ptr<Chunk>> m_chunks;
+        std::size_t                         m_size{0};
+    };
+}
@@ -17,20 +17,39 @@
 
 #pragma once
 
+#include <cstddef>
+#include <type_traits>
 #include <vector>
 #include <unordered_map>
 #include <utility>
 
+#include "ecs/ChunkedArray.hpp"
+
 // Forward declaration of EntityId to avoid circular include with World.hpp.
 #include <cstdint>
 namespace ecs { using EntityId = std::uint32_t; }
 
 namespace ecs
 {
+    // Specialize with kStableAddresses = true for components whose addresses
+    // are cached across frames. Such storages keep their data in a
+    // ChunkedArray, so adding components never moves existing ones. The
+    // specialization must be visible wherever the storage is instantiated,
+    // i.e. next to the component definition.
+    template <typename TComponent>
+    struct ComponentStorageTraits
+    {
+        static constexpr bool kStableAddresses = false;
+    };
+
     template <typename TComponent>
     class ComponentStorage
     {
     public:
+        static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+        static constexpr bool kStableAddresses = ComponentStorageTraits<TComponent>::kStableAddresses;
+        using Container = std::conditional_t<kStableAddresses, ChunkedArray<TComponent>, std::vector<TComponent>>;
+
         TComponent& Add(EntityId id, const TComponent& component)
         {
             if (m_entityToDense.find(id) != m_entityToDense.end())
@@ -38,20 +57,35 @@ namespace ecs
                 // Update existing
                 size_t index = m_entityToDense[id];
                 m_data[index] = component;
+                m_changed[index] = CurrentTick();
                 return m_data[index];
             }
 
             size_t index = m_data.size();
+            if (m_data.size() == m_data.capacity())
+            {
+                // A vector grows by reallocating; chunked storage only appends a block.
+                m_layoutVersion += kStableAddresses ? 0 : 1;
+            }
             m_data.push_back(component);
             m_denseToEntity.push_back(id);
+            m_changed.push_back(CurrentTick());
             m_entityToDense[id] = index;
+            ++m_structureVersion;
             return m_data.back();
         }
 
+        // Mutable lookup counts as a write and stamps the slot; use the const
+        // overload for reads that should not show up in change queries.
         TComponent* Get(EntityId id)
         {
             auto it = m_entityToDense.find(id);
-            return it != m_entityToDense.end() ? &m_data[it->second] : nullptr;
+            if (it == m_entityToDense.end())
+            {
+                return nullptr;
+            }
+            m_changed[it->second] = CurrentTick();
+            return &m_data[it->second];
         }
 
         const TComponent* Get(EntityId id) const
@@ -74,6 +108,7 @@ namespace ecs
             if (index != lastIndex)
             {
                 m_data[index] = std::move(m_data[lastIndex]);
+                m_changed[index] = m_changed[lastIndex];
                 const EntityId movedId = m_denseToEntity[lastIndex];
                 m_denseToEntity[index] = movedId;
                 m_entityToDense[movedId] = index;
@@ -81,15 +116,111 @@ namespace ecs
 
             m_data.pop_back();
             m_denseToEntity.pop_back();
+            m_changed.pop_back();
             m_entityToDense.erase(it);
+            ++m_structureVersion;
+            ++m_layoutVersion;
             return true;
         }
 
+        // Dense slot currently holding the entity's component, or npos.
+        std::size_t IndexOf(EntityId id) const
+        {
+            auto it = m_entityToDense.find(id);
+            return it != m_entityToDense.end() ? it->second : npos;
+        }
+
+        // Rearranges the dense arrays so that slot k holds the component that
+        // previously lived in slot order[k]. order must be a permutation of
+        // [0, Size()); entity ids are untouched, only their dense slots move.
+        void Reorder(const std::vector<std::size_t>& order)
+        {
+            if (order.size() != m_data.size())
+            {
+                return;
+            }
+
+            Container data;
+            std::vector<EntityId> entities;
+            std::vector<std::uint32_t> changed;
+            data.reserve(order.size());
+            entities.reserve(order.size());
+            changed.reserve(order.size());
+            for (std::size_t k = 0; k < order.size(); ++k)
+            {
+                data.push_back(std::move(m_data[order[k]]));
+                entities.push_back(m_denseToEntity[order[k]]);
+                changed.push_back(m_changed[order[k]]);
+                m_entityToDense[entities.back()] = k;
+            }
+            m_data = std::move(data);
+            m_denseToEntity = std::move(entities);
+            m_changed = std::move(changed);
+            ++m_structureVersion;
+            ++m_layoutVersion;
+        }
+
+        // Releases capacity left behind by removals.
+        void ShrinkToFit()
+        {
+            if constexpr (!kStableAddresses)
+            {
+                if (m_data.capacity() != m_data.size())
+                {
+                    ++m_layoutVersion;
+                }
+            }
+            m_data.shrink_to_fit();
+            m_denseToEntity.shrink_to_fit();
+            m_changed.shrink_to_fit();
+        }
+
+        // Change tracking. Every slot carries the tick at which it was last
+        // written; a consumer remembers the tick it last looked at and asks for
+        // slots stamped after it. Inside a World the tick is the world's shared
+        // clock (see World::AdvanceChangeTick), so stamps compare across storages.
+        void SetTickSource(const std::uint32_t* tick) noexcept { m_tickSource = tick; }
+        std::uint32_t CurrentTick() const noexcept { return m_tickSource ? *m_tickSource : m_localTick; }
+        void AdvanceLocalTick() noexcept { ++m_localTick; }
+
+        // Stamps a slot written through GetData(), which is not tracked.
+        void MarkChanged(std::size_t index) { m_changed[index] = CurrentTick(); }
+        std::uint32_t ChangedTick(std::size_t index) const { return m_changed[index]; }
+
+        bool ChangedSince(EntityId id, std::uint32_t since) const
+        {
+            auto it = m_entityToDense.find(id);
+            return it != m_entityToDense.end() && m_changed[it->second] > since;
+        }
+
+        // Bumped whenever slots are added, removed or permuted.
+        std::uint64_t StructureVersion() const noexcept { return m_structureVersion; }
+
+        // Bumped whenever a live component may have changed address: removals
+        // (swap-and-pop), reorders, and for vector-backed storages any add that
+        // reallocated. Pointers fetched from this storage stay valid for as long
+        // as LayoutVersion() is unchanged and their entity is alive.
+        std::uint64_t LayoutVersion() const noexcept { return m_layoutVersion; }
+
+        template <typename Fn>
+        void ForEachChanged(std::uint32_t since, Fn&& fn) const
+        {
+            for (size_t i = 0; i < m_data.size(); ++i)
+            {
+                if (m_changed[i] > since)
+                {
+                    fn(m_denseToEntity[i], m_data[i]);
+                }
+            }
+        }
+
         template <typename Fn>
         void ForEach(Fn&& fn)
         {
+            const std::uint32_t tick = CurrentTick();
             for (size_t i = 0; i < m_data.size(); ++i)
             {
+                m_changed[i] = tick;
                 fn(m_denseToEntity[i], m_data[i]);
             }
         }
@@ -103,15 +234,21 @@ namespace ecs
             }
         }
 
-        // Direct access for systems (e.g. JobSystem)
-        std::vector<TComponent>& GetData() { return m_data; }
-        const std::vector<TComponent>& GetData() const { return m_data; }
+        // Direct access for systems (e.g. JobSystem). Writes through the
+        // mutable overload are not tracked; pair them with MarkChanged.
+        Container& GetData() { return m_data; }
+        const Container& GetData() const { return m_data; }
         const std::vector<EntityId>& GetEntities() const { return m_denseToEntity; }
         size_t Size() const { return m_data.size(); }
 
     private:
-        std::vector<TComponent> m_data;
+        Container               m_data;
         std::vector<EntityId>   m_denseToEntity;
         std::unordered_map<EntityId, size_t> m_entityToDense;
+        std::vector<std::uint32_t> m_changed;
+        const std::uint32_t* m_tickSource{nullptr};
+        std::uint32_t m_localTick{1};
+        std::uint64_t m_structureVersion{0};
+        std::uint64_t m_layoutVersion{0};
     };
 }
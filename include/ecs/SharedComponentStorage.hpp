@@ -0,0 +1,224 @@
+/*
+ * Copyright (C) 2025 aeml
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace ecs
+{
+    using EntityId = std::uint32_t;
+
+    // Flyweight storage: each entity refers to one interned, immutable value
+    // and entities with equal values share it. Writes go through Set/Modify,
+    // which re-intern the result (copy-on-write), so a shared value never
+    // changes under the other entities that reference it. T must be
+    // copyable and equality comparable.
+    template <typename T>
+    class SharedComponentStorage
+    {
+    public:
+        using Handle = std::uint32_t;
+        static constexpr Handle kInvalidHandle = static_cast<Handle>(-1);
+
+        Handle Set(EntityId id, const T& value)
+        {
+            const Handle handle = Intern(value);
+            auto it = m_entityToDense.find(id);
+            if (it != m_entityToDense.end())
+            {
+                Release(m_handles[it->second]);
+                m_handles[it->second] = handle;
+            }
+            else
+            {
+                m_entityToDense.emplace(id, m_denseToEntity.size());
+                m_denseToEntity.push_back(id);
+                m_handles.push_back(handle);
+            }
+            ++m_version;
+            return handle;
+        }
+
+        // Copy-on-write edit: fn receives a private copy of the entity's value,
+        // which is then interned again. Returns false if the entity has none.
+        template <typename Fn>
+        bool Modify(EntityId id, Fn&& fn)
+        {
+            const T* current = Get(id);
+            if (!current)
+            {
+                return false;
+            }
+            T copy = *current;
+            fn(copy);
+            Set(id, copy);
+            return true;
+        }
+
+        const T* Get(EntityId id) const
+        {
+            const Handle handle = HandleOf(id);
+            return handle != kInvalidHandle ? &m_slots[handle].value : nullptr;
+        }
+
+        Handle HandleOf(EntityId id) const
+        {
+            auto it = m_entityToDense.find(id);
+            return it != m_entityToDense.end() ? m_handles[it->second] : kInvalidHandle;
+        }
+
+        bool Remove(EntityId id)
+        {
+            auto it = m_entityToDense.find(id);
+            if (it == m_entityToDense.end())
+            {
+                return false;
+            }
+
+            const std::size_t index = it->second;
+            const std::size_t lastIndex = m_denseToEntity.size() - 1;
+            Release(m_handles[index]);
+            if (index != lastIndex)
+            {
+                const EntityId movedId = m_denseToEntity[lastIndex];
+                m_denseToEntity[index] = movedId;
+                m_handles[index] = m_handles[lastIndex];
+                m_entityToDense[movedId] = index;
+            }
+            m_denseToEntity.pop_back();
+            m_handles.pop_back();
+            m_entityToDense.erase(it);
+            ++m_version;
+            return true;
+        }
+
+        // Value behind a handle; only valid while ReferenceCount(handle) > 0.
+        const T& Value(Handle handle) const { return m_slots[handle].value; }
+        std::uint32_t ReferenceCount(Handle handle) const
+        {
+            return handle < m_slots.size() ? m_slots[handle].refCount : 0u;
+        }
+
+        // Upper bound on handle values, for tables indexed by handle.
+        std::size_t HandleCapacity() const noexcept { return m_slots.size(); }
+        std::size_t DistinctCount() const noexcept { return m_slots.size() - m_freeSlots.size(); }
+        std::size_t Size() const noexcept { return m_denseToEntity.size(); }
+
+        // Bumped on every Set/Modify/Remove.
+        std::uint64_t Version() const noexcept { return m_version; }
+
+        template <typename Fn>
+        void ForEach(Fn&& fn) const
+        {
+            for (std::size_t i = 0; i < m_denseToEntity.size(); ++i)
+            {
+                fn(m_denseToEntity[i], m_slots[m_handles[i]].value);
+            }
+        }
+
+        // Calls fn(handle, value, entities) once per distinct live value, in
+        // handle order; entities are listed in storage order.
+        template <typename Fn>
+        void ForEachSharedGroup(Fn&& fn) const
+        {
+            std::vector<std::size_t> offsets(m_slots.size() + 1, 0);
+            for (Handle handle : m_handles)
+            {
+                ++offsets[handle + 1];
+            }
+            for (std::size_t h = 0; h < m_slots.size(); ++h)
+            {
+                offsets[h + 1] += offsets[h];
+            }
+
+            std::vector<EntityId> grouped(m_denseToEntity.size());
+            std::vector<std::size_t> cursor(offsets.begin(), offsets.end() - 1);
+            for (std::size_t i = 0; i < m_denseToEntity.size(); ++i)
+            {
+                grouped[cursor[m_handles[i]]++] = m_denseToEntity[i];
+            }
+
+            std::vector<EntityId> members;
+            for (std::size_t h = 0; h < m_slots.size(); ++h)
+            {
+                if (m_slots[h].refCount == 0)
+                {
+                    continue;
+                }
+                members.assign(grouped.begin() + static_cast<std::ptrdiff_t>(offsets[h]),
+                               grouped.begin() + static_cast<std::ptrdiff_t>(offsets[h + 1]));
+                fn(static_cast<Handle>(h), m_slots[h].value, members);
+            }
+        }
+
+    private:
+        struct Slot
+        {
+            T             value{};
+            std::uint32_t refCount{0};
+        };
+
+        // Distinct values are expected to be few (materials, shapes), so a
+        // linear scan beats hashing arbitrary component types.
+        Handle Intern(const T& value)
+        {
+            for (std::size_t h = 0; h < m_slots.size(); ++h)
+            {
+                if (m_slots[h].refCount > 0 && m_slots[h].value == value)
+                {
+                    ++m_slots[h].refCount;
+                    return static_cast<Handle>(h);
+                }
+            }
+
+            Handle handle;
+            if (!m_freeSlots.empty())
+            {
+                handle = m_freeSlots.back();
+                m_freeSlots.pop_back();
+            }
+            else
+            {
+                handle = static_cast<Handle>(m_slots.size());
+                m_slots.emplace_back();
+            }
+            m_slots[handle].value = value;
+            m_slots[handle].refCount = 1;
+            return handle;
+        }
+
+        void Release(Handle handle)
+        {
+            if (--m_slots[handle].refCount == 0)
+            {
+                m_freeSlots.push_back(handle);
+            }
+        }
+
+        std::vector<Slot>                         m_slots;
+        std::vector<Handle>                       m_freeSlots;
+        std::vector<EntityId>                     m_denseToEntity;
+        std::vector<Handle>                       m_handles;
+        std::unordered_map<EntityId, std::size_t> m_entityToDense;
+        std::uint64_t                             m_version{0};
+    };
+}
@@ -27,6 +27,7 @@
 #include <optional>
 
 #include "ecs/ComponentStorage.hpp"
+#include "ecs/SharedComponentStorage.hpp"
 
 #include <cstdint>
 
@@ -40,6 +41,9 @@ namespace ecs
     {
     public:
         World() = default;
+        // Storages point at m_changeTick, so the world stays put.
+        World(const World&) = delete;
+        World& operator=(const World&) = delete;
 
         EntityId CreateEntity();
         void     DestroyEntity(EntityId id);
@@ -52,6 +56,7 @@ namespace ecs
             if (it == m_componentStores.end())
             {
                 auto wrapper = std::make_unique<StorageWrapper<TComponent>>();
+                wrapper->storage.SetTickSource(&m_changeTick);
                 it = m_componentStores.emplace(key, std::move(wrapper)).first;
             }
             auto* storage = static_cast<StorageWrapper<TComponent>*>(it->second.get());
@@ -111,6 +116,78 @@ namespace ecs
             return &storage->storage;
         }
 
+        // The storage's StructureVersion() plus one, or 0 while the world has
+        // no TComponent storage, so caches keyed on it also see the storage
+        // being created.
+        template <typename TComponent>
+        std::uint64_t StructureVersionOf() const
+        {
+            const auto* storage = GetStorage<TComponent>();
+            return storage ? storage->StructureVersion() + 1 : 0;
+        }
+
+        // Shared (flyweight) components live in their own storages, separate
+        // from any regular storage of the same type.
+        template <typename TComponent>
+        typename SharedComponentStorage<TComponent>::Handle AddSharedComponent(EntityId id, const TComponent& value)
+        {
+            const std::type_index key{typeid(SharedComponentStorage<TComponent>)};
+            auto it = m_componentStores.find(key);
+            if (it == m_componentStores.end())
+            {
+                it = m_componentStores.emplace(key, std::make_unique<SharedStorageWrapper<TComponent>>()).first;
+            }
+            auto* storage = static_cast<SharedStorageWrapper<TComponent>*>(it->second.get());
+            return storage->storage.Set(id, value);
+        }
+
+        template <typename TComponent>
+        const TComponent* GetSharedComponent(EntityId id) const
+        {
+            const auto* storage = GetSharedStorage<TComponent>();
+            return storage ? storage->Get(id) : nullptr;
+        }
+
+        template <typename TComponent>
+        SharedComponentStorage<TComponent>* GetSharedStorage()
+        {
+            auto it = m_componentStores.find(std::type_index{typeid(SharedComponentStorage<TComponent>)});
+            if (it == m_componentStores.end())
+            {
+                return nullptr;
+            }
+            return &static_cast<SharedStorageWrapper<TComponent>*>(it->second.get())->storage;
+        }
+
+        template <typename TComponent>
+        const SharedComponentStorage<TComponent>* GetSharedStorage() const
+        {
+            auto it = m_componentStores.find(std::type_index{typeid(SharedComponentStorage<TComponent>)});
+            if (it == m_componentStores.end())
+            {
+                return nullptr;
+            }
+            return &static_cast<const SharedStorageWrapper<TComponent>*>(it->second.get())->storage;
+        }
+
+        // Visits each distinct shared value once with the entities using it.
+        template <typename TComponent, typename Fn>
+        void ForEachSharedGroup(Fn&& fn) const
+        {
+            if (const auto* storage = GetSharedStorage<TComponent>())
+            {
+                storage->ForEachSharedGroup(std::forward<Fn>(fn));
+            }
+        }
+
+        // Shared clock for component change stamps. A consumer keeps the value
+        // returned by AdvanceChangeTick() and later passes it as `since`; every
+        // write after that call carries a larger stamp. Only mutable access
+        // stamps, so code that merely reads (rendering, hashing, metrics)
+        // should go through a const World& to keep the stamps meaningful.
+        std::uint32_t ChangeTick() const noexcept { return m_changeTick; }
+        std::uint32_t AdvanceChangeTick() noexcept { return m_changeTick++; }
+
         void AddSystem(std::unique_ptr<ISystem> system);
         void Update(float dt);
 
@@ -153,6 +230,84 @@ namespace ecs
             storage->storage.ForEach(std::forward<Fn>(fn));
         }
 
+        template <typename TComponent, typename Fn>
+        void ForEach(Fn&& fn) const
+        {
+            if (const auto* storage = GetStorage<TComponent>())
+            {
+                storage->ForEach(std::forward<Fn>(fn));
+            }
+        }
+
+        // Read-only View: visits the same entities without stamping them.
+        template <typename T1, typename T2, typename... TRest, typename Fn>
+        void View(Fn&& fn) const
+        {
+            const ComponentStorage<T1>* s1 = GetStorage<T1>();
+            const ComponentStorage<T2>* s2 = GetStorage<T2>();
+            std::tuple<const ComponentStorage<TRest>*...> restStores = std::make_tuple(GetStorage<TRest>()...);
+            if (!s1 || !s2 || ((!std::get<const ComponentStorage<TRest>*>(restStores)) || ...)) return;
+
+            auto process = [&](EntityId id) {
+                const T1* c1 = s1->Get(id);
+                const T2* c2 = s2->Get(id);
+                const auto rest = std::make_tuple(std::get<const ComponentStorage<TRest>*>(restStores)->Get(id)...);
+                const bool present = c1 && c2 && std::apply([](auto*... r) { return ((r != nullptr) && ...); }, rest);
+                if (present)
+                {
+                    std::apply([&](auto*... r) { fn(id, *c1, *c2, *r...); }, rest);
+                }
+            };
+            if (s2->Size() < s1->Size()) s2->ForEach([&](EntityId id, const T2&) { process(id); });
+            else s1->ForEach([&](EntityId id, const T1&) { process(id); });
+        }
+
+        // Visits components written after tick `since` (read-only).
+        template <typename TComponent, typename Fn>
+        void ForEachChanged(std::uint32_t since, Fn&& fn) const
+        {
+            if (const auto* storage = GetStorage<TComponent>())
+            {
+                storage->ForEachChanged(since, std::forward<Fn>(fn));
+            }
+        }
+
+        // Visits entities holding all listed components where at least one of
+        // them was written after tick `since` (read-only).
+        template <typename T1, typename T2, typename... TRest, typename Fn>
+        void ViewChanged(std::uint32_t since, Fn&& fn) const
+        {
+            const ComponentStorage<T1>* s1 = GetStorage<T1>();
+            const ComponentStorage<T2>* s2 = GetStorage<T2>();
+            std::tuple<const ComponentStorage<TRest>*...> restStores = std::make_tuple(GetStorage<TRest>()...);
+            if (!s1 || !s2 || ((!std::get<const ComponentStorage<TRest>*>(restStores)) || ...)) return;
+
+            const auto& entities = s1->GetEntities();
+            const auto& data = s1->GetData();
+            for (size_t i = 0; i < entities.size(); ++i)
+            {
+                const EntityId id = entities[i];
+                const size_t slot2 = s2->IndexOf(id);
+                if (slot2 == ComponentStorage<T2>::npos) continue;
+                const auto restSlots = std::make_tuple(std::get<const ComponentStorage<TRest>*>(restStores)->IndexOf(id)...);
+                const bool present = std::apply([](auto... slots) {
+                    return ((slots != ComponentStorage<T1>::npos) && ...);
+                }, restSlots);
+                if (!present) continue;
+
+                bool changed = s1->ChangedTick(i) > since || s2->ChangedTick(slot2) > since;
+                std::apply([&](auto... slots) {
+                    changed = changed || ((std::get<const ComponentStorage<TRest>*>(restStores)->ChangedTick(slots) > since) || ...);
+                }, restSlots);
+                if (!changed) continue;
+
+                std::apply([&](auto... slots) {
+                    fn(id, data[i], s2->GetData()[slot2],
+                       std::get<const ComponentStorage<TRest>*>(restStores)->GetData()[slots]...);
+                }, restSlots);
+            }
+        }
+
         // Multi-component View
         // Usage: world.View<Transform, Velocity>([&](EntityId id, Transform& t, Velocity& v) { ... });
         template <typename T1, typename T2, typename... TRest, typename Fn>
@@ -234,6 +389,7 @@ namespace ecs
         }
 
         EntityId                                      m_nextEntity{1};
+        std::uint32_t                                 m_changeTick{1};
         std::vector<EntityId>                         m_entities;
         std::vector<std::unique_ptr<ISystem>>         m_systems;
         struct IStorage
@@ -251,6 +407,16 @@ namespace ecs
                 storage.Remove(id);
             }
         };
+        template <typename T>
+        struct SharedStorageWrapper : IStorage
+        {
+            SharedComponentStorage<T> storage;
+
+            void RemoveEntity(EntityId id) override
+            {
+                storage.Remove(id);
+            }
+        };
         std::unordered_map<std::type_index, std::unique_ptr<IStorage>> m_componentStores;
     };
 
@@ -0,0 +1,152 @@
+/*
+ * Copyright (C) 2025 aeml
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "jobs/JobSystem.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace jobs
+{
+    // How a loop over `count` items is cut into batches: about four per
+    // worker, none smaller than the given minimum. Without a job system the
+    // whole range is one batch.
+    struct BatchPlan
+    {
+        std::size_t count{0}; // items
+        std::size_t size{0};  // items per batch
+        std::size_t batches{0};
+
+        std::size_t Begin(std::size_t batch) const noexcept { return batch * size; }
+        std::size_t End(std::size_t batch) const noexcept { return std::min(count, (batch + 1) * size); }
+    };
+
+    inline BatchPlan PlanBatches(std::size_t count, std::size_t minBatch, const JobSystem* jobSystem) noexcept
+    {
+        BatchPlan plan;
+        plan.count = count;
+        if (count == 0)
+        {
+            return plan;
+        }
+        plan.size = count;
+        if (jobSystem && count > minBatch)
+        {
+            const std::size_t workers = std::max<std::size_t>(1, jobSystem->WorkerCount());
+            plan.size = std::max(std::max<std::size_t>(1, minBatch), count / (workers * 4 + 1));
+        }
+        plan.batches = (count + plan.size - 1) / plan.size;
+        return plan;
+    }
+
+    // Runs fn(batch, begin, end) for every batch of `plan`, on the job system
+    // when there is more than one batch.
+    template <typename Fn>
+    void ForEachBatch(const BatchPlan& plan, JobSystem* jobSystem, const Fn& fn)
+    {
+        if (!jobSystem || plan.batches < 2)
+        {
+            for (std::size_t b = 0; b < plan.batches; ++b)
+            {
+                fn(b, plan.Begin(b), plan.End(b));
+            }
+            return;
+        }
+        auto handles = jobSystem->Dispatch(plan.batches, 1, [&](std::size_t start, std::size_t end)
+        {
+            for (std::size_t b = start; b < end; ++b)
+            {
+                fn(b, plan.Begin(b), plan.End(b));
+            }
+        });
+        jobSystem->Wait(handles);
+    }
+
+    // Replaces values[i] with the sum of values[0, i) and returns the total.
+    // Batches sum their ranges in parallel, the batch totals are scanned in
+    // order, then each batch adds its offset, so the result does not depend
+    // on the batching. `batchSums` is scratch kept by the caller.
+    template <typename T>
+    T ExclusiveScan(std::vector<T>& values, JobSystem* jobSystem, std::vector<T>& batchSums)
+    {
+        const BatchPlan plan = PlanBatches(values.size(), 4096, jobSystem);
+        batchSums.assign(plan.batches, T{});
+        ForEachBatch(plan, jobSystem, [&](std::size_t batch, std::size_t begin, std::size_t end)
+        {
+            T sum{};
+            for (std::size_t i = begin; i < end; ++i)
+            {
+                sum += values[i];
+            }
+            batchSums[batch] = sum;
+        });
+        T total{};
+        for (auto& sum : batchSums)
+        {
+            const T value = sum;
+            sum = total;
+            total += value;
+        }
+        ForEachBatch(plan, jobSystem, [&](std::size_t batch, std::size_t begin, std::size_t end)
+        {
+            T running = batchSums[batch];
+            for (std::size_t i = begin; i < end; ++i)
+            {
+                const T value = values[i];
+                values[i] = running;
+                running += value;
+            }
+        });
+        return total;
+    }
+
+    // Appends parts[0, used) to `out` in order. Each part's offset is the
+    // sum of the sizes before it, so the parts are copied in parallel and the
+    // result is the serial concatenation. Parts are cleared but keep their
+    // capacity for the next round.
+    template <typename T>
+    void AppendBatches(std::vector<std::vector<T>>& parts, std::size_t used, JobSystem* jobSystem,
+                       std::vector<T>& out)
+    {
+        const std::size_t base = out.size();
+        std::size_t total = base;
+        for (std::size_t p = 0; p < used; ++p)
+        {
+            total += parts[p].size();
+        }
+        out.resize(total);
+        const bool parallel = jobSystem && used > 1 && total - base >= 4096;
+        const BatchPlan plan{used, 1, used};
+        ForEachBatch(plan, parallel ? jobSystem : nullptr, [&](std::size_t p, std::size_t, std::size_t)
+        {
+            std::size_t offset = base;
+            for (std::size_t q = 0; q < p; ++q)
+            {
+                offset += parts[q].size();
+            }
+            std::copy(parts[p].begin(), parts[p].end(), out.begin() + static_cast<std::ptrdiff_t>(offset));
+        });
+        for (std::size_t p = 0; p < used; ++p)
+        {
+            parts[p].clear();
+        }
+    }
+}
@@ -0,0 +1,234 @@
+/*
+ * Copyright (C) 2025 aeml
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "physics/Components.hpp"
+
+namespace jobs { class JobSystem; }
+
+namespace physics {
+
+// Per-proxy motion state. Pairs of two static bodies, and pairs with no
+// awake proxy and at least one sleeping proxy, are not reported, so static
+// geometry and settled islands cost no narrowphase.
+enum class ProxyMotion : std::uint8_t {
+    Static,   // rigid body with zero inverse mass
+    Awake,
+    Asleep,
+    Unbodied  // no rigid body: detection only, never pruned as static
+};
+
+// Rejects pairs that can never interact, inside the broadphase pair loops.
+// Either vector may be null; when set it is parallel to the proxies.
+struct ProxyFilter {
+    const std::vector<ProxyMotion>*              motion{nullptr};
+    const std::vector<CollisionFilterComponent>* layers{nullptr};
+
+    bool Rejects(std::size_t a, std::size_t b) const noexcept {
+        if (motion) {
+            const ProxyMotion ma = (*motion)[a];
+            const ProxyMotion mb = (*motion)[b];
+            if (ma == ProxyMotion::Static && mb == ProxyMotion::Static) return true;
+            if (ma != ProxyMotion::Awake && mb != ProxyMotion::Awake
+                && (ma == ProxyMotion::Asleep || mb == ProxyMotion::Asleep)) return true;
+        }
+        if (layers) {
+            const auto& fa = (*layers)[a];
+            const auto& fb = (*layers)[b];
+            if ((fa.layer & fb.mask) == 0u || (fb.layer & fa.mask) == 0u) return true;
+        }
+        return false;
+    }
+};
+
+// Broadphase strategies. All of them report the same pairs, and
+// CollisionSystem::Detect puts the pairs in one order, so switching
+// strategies changes cost only, never results.
+enum class Broadphase : std::uint8_t {
+    // Picks one of the strategies below on every call (see AutoBroadphase).
+    Auto,
+    // Tests every pair; cheapest for a few dozen proxies.
+    BruteForce,
+    // Fixed-size cells. Large proxies span many cells, so a pair is only
+    // reported from the cell holding the corner of the pair's overlap.
+    UniformGrid,
+    // Loose grid levels: level 0 cells fit the smallest proxy and each level
+    // doubles. Every proxy sits in one cell of the level that fits it, so no
+    // pair is found twice.
+    HierarchicalGrid,
+    // Min-x endpoints sorted once and kept between calls; each call repairs
+    // the order with insertion sort, which is near O(n) while proxies move
+    // little (stacks, piles).
+    SweepAndPrune,
+    // A broadphase handed to CollisionSystem::SetBroadphase directly.
+    Custom
+};
+
+// Proxy indices of an overlapping pair, lower index first.
+using ProxyPair = std::pair<std::uint32_t, std::uint32_t>;
+
+class IBroadphase {
+public:
+    virtual ~IBroadphase() = default;
+
+    // Appends every pair of overlapping (or touching) `aabbs` that `filter`
+    // does not reject, in any order, each pair once.
+    virtual void FindPairs(const std::vector<AABBComponent>& aabbs,
+                           const ProxyFilter& filter,
+                           jobs::JobSystem* jobSystem,
+                           std::vector<ProxyPair>& pairs) = 0;
+
+    virtual const char* Name() const noexcept = 0;
+};
+
+class BruteForceBroadphase final : public IBroadphase {
+public:
+    void FindPairs(const std::vector<AABBComponent>& aabbs, const ProxyFilter& filter,
+                   jobs::JobSystem* jobSystem, std::vector<ProxyPair>& pairs) override;
+    const char* Name() const noexcept override { return "brute force"; }
+};
+
+class UniformGridBroadphase final : public IBroadphase {
+public:
+    explicit UniformGridBroadphase(float cellSize = 2.0f) noexcept : m_cellSize(cellSize) {}
+
+    void SetCellSize(float cellSize) noexcept { m_cellSize = cellSize; }
+    float CellSize() const noexcept { return m_cellSize; }
+
+    void FindPairs(const std::vector<AABBComponent>& aabbs, const ProxyFilter& filter,
+                   jobs::JobSystem* jobSystem, std::vector<ProxyPair>& pairs) override;
+    const char* Name() const noexcept override { return "uniform grid"; }
+
+private:
+    struct CellEntry {
+        std::uint64_t key;
+        std::uint32_t index;
+        bool operator<(const CellEntry& rhs) const {
+            if (key != rhs.key) return key < rhs.key;
+            return index < rhs.index;
+        }
+    };
+
+    float m_cellSize;
+    // Build buffers, kept between calls so a build allocates only when the
+    // scene grows: (cell, proxy) entries counting-sorted into hash buckets.
+    std::vector<std::size_t>            m_batchCounts;
+    std::vector<std::uint32_t>          m_bucketStart;
+    std::vector<std::uint32_t>          m_bucketCursor;
+    std::vector<std::uint32_t>          m_scanScratch;
+    std::vector<CellEntry>              m_entries;
+    std::vector<std::vector<ProxyPair>> m_batchPairs;
+};
+
+class HierarchicalGridBroadphase final : public IBroadphase {
+public:
+    void FindPairs(const std::vector<AABBComponent>& aabbs, const ProxyFilter& filter,
+                   jobs::JobSystem* jobSystem, std::vector<ProxyPair>& pairs) override;
+    const char* Name() const noexcept override { return "hierarchical grid"; }
+
+private:
+    // Open-addressing table from (level, cell) to the head of its list of
+    // proxies (linked through m_next).
+    struct GridCell {
+        std::uint64_t key;
+        std::uint32_t head;
+        int           level; // -1 marks an empty slot
+    };
+
+    // Build buffers, kept between calls so a build allocates only when the
+    // scene grows.
+    std::vector<GridCell>               m_table;
+    std::vector<std::uint32_t>          m_next;
+    std::vector<std::uint8_t>           m_levelOf;
+    std::vector<std::vector<ProxyPair>> m_batchPairs;
+};
+
+class SweepAndPruneBroadphase final : public IBroadphase {
+public:
+    void FindPairs(const std::vector<AABBComponent>& aabbs, const ProxyFilter& filter,
+                   jobs::JobSystem* jobSystem, std::vector<ProxyPair>& pairs) override;
+    const char* Name() const noexcept override { return "sweep and prune"; }
+
+    // Endpoint moves made by the last repair (n on a rebuild).
+    std::size_t LastSortMoves() const noexcept { return m_sortMoves; }
+    // Proxies whose x interval overlapped another's in the last sweep; far
+    // above the pair count when many proxies share x ranges (tall stacks).
+    std::size_t LastCandidates() const noexcept { return m_candidates; }
+
+private:
+    struct Endpoint {
+        float         minX;
+        std::uint32_t index;
+        bool operator<(const Endpoint& rhs) const {
+            if (minX != rhs.minX) return minX < rhs.minX;
+            return index < rhs.index;
+        }
+    };
+
+    std::vector<Endpoint> m_endpoints;
+    std::vector<std::vector<ProxyPair>> m_batchPairs;
+    std::size_t           m_sortMoves{0};
+    std::size_t           m_candidates{0};
+};
+
+// Chooses per call from the proxy count, the spread of proxy sizes, the
+// workers available and how crowded the last sweep was:
+//   * up to kBruteForceLimit proxies: brute force;
+//   * more than kParallelGridLimit proxies of similar size (largest at most
+//     kSizeSpreadLimit times the smallest) and more than one worker: the
+//     uniform grid, with cells as large as the largest proxy;
+//   * otherwise sweep and prune, unless its last sweep tested more than
+//     kCrowdFactor candidates per proxy (a candidate costs a compare, a
+//     grid lookup far more); then the hierarchical grid, with sweep and
+//     prune probed again every kProbeInterval calls.
+class AutoBroadphase final : public IBroadphase {
+public:
+    static constexpr std::size_t kBruteForceLimit = 16;
+    static constexpr float       kSizeSpreadLimit = 8.0f;
+    static constexpr std::size_t kParallelGridLimit = 2000;
+    static constexpr std::size_t kCrowdFactor = 64;
+    static constexpr int         kProbeInterval = 60;
+
+    void FindPairs(const std::vector<AABBComponent>& aabbs, const ProxyFilter& filter,
+                   jobs::JobSystem* jobSystem, std::vector<ProxyPair>& pairs) override;
+    const char* Name() const noexcept override { return "auto"; }
+
+    // The strategy used by the last call (nullptr before the first).
+    const IBroadphase* LastChoice() const noexcept { return m_last; }
+
+private:
+    BruteForceBroadphase       m_bruteForce;
+    UniformGridBroadphase      m_uniformGrid;
+    HierarchicalGridBroadphase m_hierarchical;
+    SweepAndPruneBroadphase    m_sweepAndPrune;
+    IBroadphase*               m_last{nullptr};
+    bool                       m_crowded{false};
+    int                        m_callsSinceProbe{0};
+};
+
+// Creates the strategy for `kind` (nullptr for Broadphase::Custom).
+std::unique_ptr<IBroadphase> CreateBroadphase(Broadphase kind);
+
+} // namespace physics
@@ -18,36 +18,74 @@
 #pragma once
 
 #include <vector>
-#include <utility>
+#include <memory>
 #include <cstdint>
 
+#include "physics/Broadphase.hpp"
 #include "physics/Components.hpp"
 
-namespace jobs { class JobSystem; }
-
 namespace physics {
 
 struct CollisionEvent {
+    static constexpr std::uint32_t kNoBody = 0xFFFFFFFFu;
+
     std::uint32_t entityA; // EntityId
     std::uint32_t entityB; // EntityId
     float normalX{0.0f};
     float normalY{0.0f};
     float penetration{0.0f};
+    // Dense RigidBodyComponent slots of the two entities when the producer
+    // knows them (kNoBody otherwise). They go stale once the rigid body
+    // storage is re-ordered; consumers check them against entityA/entityB.
+    std::uint32_t bodyA{kNoBody};
+    std::uint32_t bodyB{kNoBody};
 };
 
+// The manifold Detect reports for two overlapping boxes: the axis of least
+// overlap, with the normal pointing from a to b. Touching boxes overlap.
+bool AabbManifold(const AABBComponent& a, const AABBComponent& b, CollisionEvent& event) noexcept;
+
 class CollisionSystem {
 public:
+    CollisionSystem();
+
+    // Selects a built-in strategy (Broadphase::Custom is ignored).
+    void SetBroadphase(Broadphase kind);
+    // Installs a caller-provided strategy; GetBroadphase() then reports Custom.
+    void SetBroadphase(std::unique_ptr<IBroadphase> broadphase);
+    Broadphase GetBroadphase() const noexcept { return m_kind; }
+
+    // The strategy that served the last Detect: for Broadphase::Auto, the
+    // one it picked.
+    const IBroadphase& ActiveBroadphase() const noexcept;
+
     // Detect collisions between AABBs; returns events (clears previous contents).
     // Requires a parallel vector of EntityIds to populate the events correctly.
+    // `motion` and `layers`, when given, are parallel to `aabbs` as well and
+    // prune pairs inside the broadphase (see ProxyFilter). `bodies`, when
+    // given, holds each proxy's rigid body slot and is copied into the
+    // events' bodyA/bodyB. Events come out
+    // ordered by (lower, higher) proxy index whatever the strategy or thread
+    // count, with entityA the lower index.
     void Detect(const std::vector<AABBComponent>& aabbs, 
                 const std::vector<std::uint32_t>& entityIds,
                 std::vector<CollisionEvent>& outEvents, 
-                jobs::JobSystem* jobSystem = nullptr) const;
+                jobs::JobSystem* jobSystem = nullptr,
+                const std::vector<ProxyMotion>* motion = nullptr,
+                const std::vector<CollisionFilterComponent>* layers = nullptr,
+                const std::vector<std::uint32_t>* bodies = nullptr);
 
 private:
-    static bool Overlaps(const AABBComponent& a, const AABBComponent& b) {
-        return !(a.maxX < b.minX || b.maxX < a.minX || a.maxY < b.minY || b.maxY < a.minY);
-    }
+    Broadphase                   m_kind{Broadphase::Auto};
+    std::unique_ptr<IBroadphase> m_broadphase;
+    std::vector<ProxyPair>       m_pairs;
+    // Kept between calls: pairs counting-sorted by lower index, and one
+    // event buffer per batch of proxies.
+    std::vector<std::uint32_t>   m_bucketStart;
+    std::vector<std::uint32_t>   m_bucketCursor;
+    std::vector<std::uint32_t>   m_scanScratch;
+    std::vector<std::uint32_t>   m_partners;
+    std::vector<std::vector<CollisionEvent>> m_batchEvents;
 };
 
 } // namespace physics
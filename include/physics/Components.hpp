@@ -17,7 +17,10 @@
 
 #pragma once
 
+#include "ecs/ComponentStorage.hpp"
+
 #include <algorithm>
+#include <cmath>
 #include <cstdint>
 
 namespace physics
@@ -28,7 +31,18 @@ namespace physics
         float y{0.0f};
         float rotation{0.0f};
     };
+}
+
+// Solver caches hold raw pointers to transforms and rigid bodies across
+// substeps and frames, so their storages use stable chunked blocks.
+template <>
+struct ecs::ComponentStorageTraits<physics::TransformComponent>
+{
+    static constexpr bool kStableAddresses = true;
+};
 
+namespace physics
+{
     struct RigidBodyComponent
     {
         float vx{0.0f};
@@ -46,7 +60,29 @@ namespace physics
         float torque{0.0f};
         float angularFriction{0.5f};
         float angularDrag{0.0f};
+        // Island sleeping (PhysicsSettings::enableSleeping): seconds spent
+        // below the sleep thresholds, and whether the body is parked.
+        float sleepTimer{0.0f};
+        bool  asleep{false};
     };
+}
+
+template <>
+struct ecs::ComponentStorageTraits<physics::RigidBodyComponent>
+{
+    static constexpr bool kStableAddresses = true;
+};
+
+namespace physics
+{
+    // Wakes a body so the next step simulates it again. PhysicsSystem also
+    // wakes bodies that are touched, jointed to an awake body, or given a
+    // velocity or torque while asleep.
+    inline void WakeBody(RigidBodyComponent& body)
+    {
+        body.asleep = false;
+        body.sleepTimer = 0.0f;
+    }
 
     // Simple environment-wide forces for weather-like simulations.
     struct EnvironmentForces
@@ -81,6 +117,49 @@ namespace physics
         float offsetY{0.0f};
     };
 
+    // Collision layer bits. Two proxies can touch only when each one's layer
+    // shares a bit with the other's mask. Proxies without this component are
+    // on layer 1 and collide with every layer.
+    struct CollisionFilterComponent
+    {
+        std::uint32_t layer{1u};
+        std::uint32_t mask{0xFFFFFFFFu};
+    };
+
+    // A particle of the fluid simulated by FluidSystem, which keeps its
+    // position in the entity's TransformComponent. Fluid particles have no
+    // rigid body and are invisible to PhysicsSystem.
+    struct FluidParticleComponent
+    {
+        float vx{0.0f};
+        float vy{0.0f};
+    };
+
+    // Contact material shared by many bodies through
+    // World::AddSharedComponent. When present it takes precedence over the
+    // restitution/friction fields of the body's RigidBodyComponent.
+    struct PhysicsMaterial
+    {
+        float restitution{0.5f};
+        float friction{0.5f};
+
+        bool operator==(const PhysicsMaterial&) const = default;
+    };
+
+    // The coefficients a body collides with: `shared` when it has a
+    // PhysicsMaterial, else its own RigidBodyComponent fields.
+    inline PhysicsMaterial MaterialOf(const RigidBodyComponent& body, const PhysicsMaterial* shared) noexcept
+    {
+        return shared ? *shared : PhysicsMaterial{body.restitution, body.friction};
+    }
+
+    // The coefficients of a contact: the lower restitution and the root of
+    // the summed squared frictions.
+    inline PhysicsMaterial CombineMaterials(const PhysicsMaterial& a, const PhysicsMaterial& b) noexcept
+    {
+        return {std::min(a.restitution, b.restitution), std::sqrt(a.friction * a.friction + b.friction * b.friction)};
+    }
+
     inline void ConfigureCircleInertia(RigidBodyComponent& body, float radius)
     {
         if (body.mass <= 0.0f || radius <= 0.0f)
@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2025 aeml
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include "physics/Broadphase.hpp"
+#include "physics/Components.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ecs { class World; }
+
+namespace physics
+{
+    struct SweepHit
+    {
+        float t{1.0f};       // fraction of the motion at first contact
+        float normalX{0.0f}; // surface normal at contact, pointing at the mover
+        float normalY{0.0f};
+    };
+
+    // Time of impact of a circle moving from (x0, y0) to (x1, y1) against a
+    // box. Misses, and motions that start overlapping the box, return false.
+    bool SweepCircleAabb(float x0, float y0, float x1, float y1, float radius,
+                         const AABBComponent& box, SweepHit& hit) noexcept;
+
+    // Same for a box of the given half extents.
+    bool SweepAabbAabb(float x0, float y0, float x1, float y1, float halfW, float halfH,
+                       const AABBComponent& box, SweepHit& hit) noexcept;
+
+    struct ContinuousCollisionStats
+    {
+        std::size_t sweptBodies{0};
+        std::size_t clampedBodies{0};
+    };
+
+    // The broadphase proxy table the sweeps run over, as PhysicsSystem keeps
+    // it: per proxy its bounds after integration, its motion state, entity,
+    // rigid body and transform slots (CollisionEvent::kNoBody when it has
+    // none), shape slot and, when the world has any, collision layers.
+    // Proxies before `boxProxies` are AABBs, the rest circles.
+    struct SweepProxies
+    {
+        std::vector<AABBComponent>*                  bounds{nullptr};
+        const std::vector<ProxyMotion>*              motion{nullptr};
+        const std::vector<std::uint32_t>*            ids{nullptr};
+        const std::vector<std::uint32_t>*            bodies{nullptr};
+        const std::vector<std::uint32_t>*            transforms{nullptr};
+        const std::vector<std::uint32_t>*            shapes{nullptr};
+        const std::vector<CollisionFilterComponent>* layers{nullptr};
+        std::size_t                                  boxProxies{0};
+    };
+
+    // Sweeps the substep motion (lastX/lastY to the transform) of every awake
+    // proxy that moved more than `motionThreshold` times its half-size
+    // against the static AABB proxies its layers collide with. A body that would pass into one is
+    // stopped at the time of impact, its velocity reflected off the surface
+    // with the pair's restitution and its bounds moved with it, so
+    // thin walls hold at any substep count.
+    ContinuousCollisionStats ClampFastBodiesToStatic(ecs::World& world, const SweepProxies& proxies, float dt,
+                                                     float motionThreshold);
+}
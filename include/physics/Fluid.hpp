@@ -0,0 +1,130 @@
+/*
+ * Copyright (C) 2025 aeml
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "ecs/World.hpp"
+#include "physics/Components.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace jobs { class JobSystem; }
+
+namespace physics
+{
+    // Position-based fluid (Macklin and Mueller, "Position Based Fluids").
+    //
+    // Each substep predicts particle positions under gravity, finds every
+    // particle's neighbours within smoothingRadius, then runs Jacobi
+    // iterations that move particles apart wherever the SPH density is
+    // above the rest density. Velocities follow from the corrected
+    // positions, smoothed by XSPH viscosity. Static AABBs (no rigid body,
+    // or a static one) are walls. Rigid circles are obstacles, and dynamic
+    // ones take back the momentum they give the fluid.
+    struct FluidSettings
+    {
+        // Particle spacing at rest density; particles collide with walls
+        // at half of it.
+        float restSpacing{0.5f};
+        // Kernel support, about twice restSpacing.
+        float smoothingRadius{1.0f};
+        int   substeps{2};
+        int   iterations{4};
+        // Constraint softening; larger values give springier, more
+        // compressible fluid.
+        float relaxation{10.0f};
+        float viscosity{0.1f};
+        float gravityY{-9.81f};
+        // Mass of a particle in the momentum exchange with rigid bodies.
+        float particleMass{0.1f};
+    };
+
+    // Simulates every entity with a FluidParticleComponent and a
+    // TransformComponent. Particle state is copied into structure-of-arrays
+    // buffers for the step and written back at the end of Update. Every
+    // pass is a parallel loop in which a particle only writes its own
+    // values, and neighbour lists are in a fixed order, so the result does
+    // not depend on the number of workers.
+    class FluidSystem : public ecs::ISystem
+    {
+    public:
+        // Neighbours kept per particle; rest density gives about a dozen.
+        static constexpr std::size_t kMaxNeighbours = 32;
+
+        void Update(ecs::World& world, float dt) override;
+
+        void SetSettings(const FluidSettings& settings) { m_settings = settings; }
+        const FluidSettings& Settings() const noexcept { return m_settings; }
+        void SetJobSystem(jobs::JobSystem* jobSystem) { m_jobSystem = jobSystem; }
+
+        std::size_t ParticleCount() const noexcept { return m_x.size(); }
+        // Neighbour pairs (counted from both sides) in the last substep.
+        std::size_t NeighbourCount() const noexcept { return m_neighbourTotal; }
+        // Density of a particle inside a square lattice of restSpacing.
+        float RestDensity() const noexcept { return m_restDensity; }
+
+    private:
+        struct Circle
+        {
+            float         x, y, radius;
+            float         invMass;
+            std::uint32_t body; // rigid body slot
+        };
+
+        void Join(const ecs::World& world);
+        void GatherObstacles(const ecs::World& world);
+        void Step(ecs::World& world, float dt);
+        void BuildNeighbours();
+        void PushOutOfCircles(ecs::World& world, float dt);
+
+        FluidSettings    m_settings{};
+        jobs::JobSystem* m_jobSystem{nullptr};
+        float            m_restDensity{0.0f};
+        std::size_t      m_neighbourTotal{0};
+
+        // Particle state: position, velocity, predicted position.
+        std::vector<float> m_x, m_y, m_vx, m_vy, m_px, m_py;
+        // Per-iteration scratch.
+        std::vector<float> m_lambda, m_dx, m_dy;
+
+        // Cell-linked neighbour search: particles counting-sorted into
+        // hashed cells of smoothingRadius, then up to kMaxNeighbours per
+        // particle, in cell order and by index within a cell.
+        std::vector<std::uint32_t> m_cellOf;
+        std::vector<std::uint32_t> m_bucketStart;
+        std::vector<std::uint32_t> m_bucketCursor;
+        std::vector<std::uint32_t> m_scanScratch;
+        std::vector<std::uint32_t> m_bucketParticles;
+        std::vector<std::uint32_t> m_neighbourCount;
+        std::vector<std::uint32_t> m_neighbours;
+        std::vector<std::uint32_t> m_batchNeighbours;
+
+        // Fluid and transform slot of each particle, rebuilt when either
+        // storage gains, loses or reorders slots; likewise the circle and
+        // wall slots.
+        std::vector<std::uint32_t> m_fluidSlot;
+        std::vector<std::uint32_t> m_transformSlot;
+        std::vector<std::uint32_t> m_wallSlots[2];   // AABB, rigid body (kNone without one)
+        std::vector<std::uint32_t> m_circleSlots[3]; // circle, transform, rigid body
+        const ecs::World*          m_joinWorld{nullptr};
+        std::uint64_t              m_joinVersions[5]{};
+        std::vector<AABBComponent> m_walls;
+        std::vector<Circle>        m_circles;
+    };
+}
@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2025 aeml
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "physics/Components.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace physics
+{
+    // Circle manifolds, one pair at a time or a batch at a time.
+    //
+    // Normals point from the first shape to the second (the box, for circle
+    // vs box), which is the direction the contact solver expects. The batch
+    // kernels give bit-identical results to the single-pair functions.
+
+    bool CircleCircleManifold(float ax, float ay, float radiusA, float bx, float by, float radiusB,
+                              float& nx, float& ny, float& penetration) noexcept;
+
+    bool CircleAabbManifold(float cx, float cy, float radius, const AABBComponent& box,
+                            float& nx, float& ny, float& penetration) noexcept;
+
+    // Pairs per kernel step. The kernels work on this many lanes at once
+    // with selects instead of branches, so the compiler can keep them in
+    // vector registers; the tail of a batch runs through the same lanes.
+    constexpr std::size_t kNarrowphaseLanes = 8;
+
+    // Circle centres (offsets applied) and radii, one pair per row. `tag` is
+    // passed through for the caller.
+    struct CircleCircleBatch
+    {
+        std::vector<float>         ax, ay, radiusA;
+        std::vector<float>         bx, by, radiusB;
+        std::vector<std::uint32_t> tag;
+
+        std::size_t Size() const noexcept { return tag.size(); }
+        void Clear() noexcept;
+        void Push(float pax, float pay, float pra, float pbx, float pby, float prb, std::uint32_t ptag);
+    };
+
+    struct CircleAabbBatch
+    {
+        std::vector<float>         cx, cy, radius;
+        std::vector<float>         minX, minY, maxX, maxY;
+        std::vector<std::uint32_t> tag;
+
+        std::size_t Size() const noexcept { return tag.size(); }
+        void Clear() noexcept;
+        void Push(float pcx, float pcy, float pradius, const AABBComponent& box, std::uint32_t ptag);
+    };
+
+    // Kernel output, row for row with the input batch. Rows that do not
+    // touch have hit == 0 and unspecified normal and penetration.
+    struct ManifoldBatch
+    {
+        std::vector<float>        nx, ny, penetration;
+        std::vector<std::uint8_t> hit;
+    };
+
+    void CircleCircleManifolds(const CircleCircleBatch& pairs, ManifoldBatch& out);
+    void CircleAabbManifolds(const CircleAabbBatch& pairs, ManifoldBatch& out);
+}
@@ -0,0 +1,120 @@
+/*
+ * Copyright (C) 2025 aeml
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "physics/Components.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace jobs { class JobSystem; }
+
+namespace physics
+{
+    // A segment or ray crossing a collider. `fraction` runs from 0 at the
+    // start of the segment to 1 at its end; a segment that starts inside
+    // the collider hits at 0 with a zero normal.
+    struct RayHit
+    {
+        std::uint32_t entity{0xFFFFFFFFu};
+        float         fraction{1.0f};
+        float         x{0.0f}, y{0.0f};
+        float         normalX{0.0f}, normalY{0.0f};
+    };
+
+    struct Ray
+    {
+        float x{0.0f}, y{0.0f};
+        float dirX{1.0f}, dirY{0.0f};
+        float maxDistance{1.0f};
+    };
+
+    // Spatial queries over the colliders of the last physics step: the
+    // broadphase proxies of PhysicsSystem (boxes, and circles without a
+    // box), tested against their exact shapes.
+    //
+    // Build puts proxies no larger than a cell into a loose hashed grid,
+    // keyed by the cell of their min corner, and keeps the few larger ones
+    // (walls, floors) in a list every query scans. Cells are twice the
+    // median proxy size. A query visits only the cells it overlaps (a
+    // segment walks the cells it crosses), so it costs about its result
+    // count. `mask` selects proxies whose collision layer shares a bit with
+    // it. Overlap results are entity ids in ascending order; segment hits
+    // are ordered by fraction, then entity.
+    class SpatialQueryIndex
+    {
+    public:
+        // `bounds`, `entities` and `layers` (which may be empty) are parallel;
+        // the first `boxCount` proxies are boxes and the rest are circles
+        // filling their bounds.
+        void Build(const std::vector<AABBComponent>& bounds, const std::vector<std::uint32_t>& entities,
+                   const std::vector<CollisionFilterComponent>& layers, std::size_t boxCount);
+
+        std::size_t Size() const noexcept { return m_bounds.size(); }
+        float CellSize() const noexcept { return m_cellSize; }
+
+        // Colliders overlapping or touching the box / the circle.
+        void QueryAabb(const AABBComponent& box, std::vector<std::uint32_t>& out,
+                       std::uint32_t mask = 0xFFFFFFFFu) const;
+        void QueryRadius(float x, float y, float radius, std::vector<std::uint32_t>& out,
+                         std::uint32_t mask = 0xFFFFFFFFu) const;
+
+        // Every collider the segment from (x0, y0) to (x1, y1) crosses.
+        void CastSegment(float x0, float y0, float x1, float y1, std::vector<RayHit>& out,
+                         std::uint32_t mask = 0xFFFFFFFFu) const;
+        // The first collider along the ray within maxDistance, if any. The
+        // walk stops at the first cell that cannot hold a nearer hit.
+        bool Raycast(const Ray& ray, RayHit& hit, std::uint32_t mask = 0xFFFFFFFFu) const;
+
+        // Batched forms, one query per item, spread over the job system.
+        // AABB results are concatenated, query q's entities in
+        // out[offsets[q], offsets[q + 1]). A ray that misses gets an
+        // entity of 0xFFFFFFFF.
+        void QueryAabbs(const std::vector<AABBComponent>& boxes, std::vector<std::uint32_t>& offsets,
+                        std::vector<std::uint32_t>& out, jobs::JobSystem* jobSystem,
+                        std::uint32_t mask = 0xFFFFFFFFu) const;
+        void Raycasts(const std::vector<Ray>& rays, std::vector<RayHit>& hits, jobs::JobSystem* jobSystem,
+                      std::uint32_t mask = 0xFFFFFFFFu) const;
+
+    private:
+        // Appends the matching entities to `out` and sorts what it appended.
+        void AppendAabb(const AABBComponent& box, std::uint32_t mask, std::vector<std::uint32_t>& out) const;
+
+        template <typename Fn>
+        void ForEachCandidate(const AABBComponent& box, std::uint32_t mask, const Fn& fn) const;
+        template <typename Fn>
+        void WalkSegment(float x0, float y0, float x1, float y1, std::uint32_t mask, const Fn& fn) const;
+        bool Overlaps(std::uint32_t proxy, const AABBComponent& box) const noexcept;
+        bool OverlapsCircle(std::uint32_t proxy, float x, float y, float radius) const noexcept;
+        bool Cast(std::uint32_t proxy, float x0, float y0, float dx, float dy, RayHit& hit) const noexcept;
+
+        std::vector<AABBComponent> m_bounds;
+        std::vector<std::uint32_t> m_entities;
+        std::vector<std::uint32_t> m_layers;
+        std::size_t                m_boxCount{0};
+        float                      m_cellSize{1.0f};
+
+        // Proxies counting-sorted into hash buckets by min-corner cell, and
+        // the ones too large for a cell.
+        std::vector<std::uint32_t> m_bucketStart;
+        std::vector<std::uint32_t> m_bucketProxies;
+        std::vector<std::uint32_t> m_large;
+        std::uint32_t              m_bucketMask{0};
+    };
+}
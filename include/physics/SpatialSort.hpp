@@ -0,0 +1,54 @@
+/*
+ * Copyright (C) 2025 aeml
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "physics/CollisionSystem.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ecs { class World; }
+
+namespace physics
+{
+    struct SpatialSortStats
+    {
+        std::size_t passes{0};
+        std::size_t bodyCount{0};
+        // Mean distance, in RigidBodyComponent dense slots, between the two
+        // bodies of each contact. A proxy for cache misses in contact gathering
+        // and island solves: smaller means neighbours share cache lines.
+        double contactStrideBefore{0.0};
+        double contactStrideAfter{0.0};
+    };
+
+    // Interleaves the low 16 bits of x and y into a Z-order (Morton) code.
+    std::uint32_t MortonCode(std::uint32_t x, std::uint32_t y) noexcept;
+
+    // Reorders the Transform, RigidBody, AABB and CircleCollider storages by the
+    // Z-order curve of each entity's transform position and trims their excess
+    // capacity. Ties (and entities without a transform) fall back to entity id,
+    // so the resulting layout is fully deterministic. `contacts` is only used to
+    // report the locality improvement.
+    SpatialSortStats SortStoragesByMortonOrder(ecs::World& world,
+                                               const std::vector<CollisionEvent>& contacts);
+
+    double MeanContactStride(const ecs::World& world,
+                             const std::vector<CollisionEvent>& contacts) noexcept;
+}
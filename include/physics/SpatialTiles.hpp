@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2025 aeml
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "physics/Broadphase.hpp"
+#include "physics/CollisionSystem.hpp"
+#include "physics/Components.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace jobs { class JobSystem; }
+
+namespace physics
+{
+    // Spatial domain decomposition of the broadphase proxies, used by the
+    // tiled execution mode of PhysicsSystem (see PhysicsExecution).
+    //
+    // Build lays a fixed grid of tiles over the centres of the moving
+    // proxies (edge tiles reach out to infinity) and gives every tile the
+    // proxies whose bounds overlap it: its own, plus ghosts from its
+    // neighbours along the border. Each dynamic body is owned by the tile
+    // holding its centre.
+    //
+    // Detect runs one sweep-and-prune per tile, tiles in parallel, each
+    // reading only its own proxy list. A pair is reported by its home tile,
+    // the one holding the min corner of the pair's overlap, which both
+    // proxies reach, so every pair is found exactly once. The events are
+    // then handed to their owner in one serial exchange: a pair whose
+    // moving bodies all belong to one tile goes to that tile's list, any
+    // other to the boundary list. Lists are in tile order and then by proxy
+    // index, so they depend on the grid but not on the worker count. Over
+    // all lists the events are those of CollisionSystem::Detect.
+    class TileDecomposition
+    {
+    public:
+        void Build(const std::vector<AABBComponent>& bounds, const std::vector<ProxyMotion>& motion,
+                   int columns, int rows);
+
+        // `bodies` may be empty; otherwise it is parallel to `bounds` and
+        // copied into the events, as in Detect.
+        void Detect(const std::vector<std::uint32_t>& entityIds, const ProxyFilter& filter,
+                    const std::vector<std::uint32_t>& bodies, jobs::JobSystem* jobSystem);
+
+        std::size_t TileCount() const noexcept { return m_tileEvents.size(); }
+        // Proxies in the tile, owned and ghost, by ascending index.
+        std::size_t TileProxyCount(std::size_t tile) const noexcept
+        {
+            return m_tileStart[tile + 1] - m_tileStart[tile];
+        }
+        // The tile owning each proxy's body, or kNoTile for static and
+        // unbodied proxies.
+        static constexpr std::uint32_t kNoTile = 0xFFFFFFFFu;
+        const std::vector<std::uint32_t>& Owners() const noexcept { return m_owner; }
+
+        const std::vector<CollisionEvent>& TileEvents(std::size_t tile) const noexcept { return m_tileEvents[tile]; }
+        const std::vector<CollisionEvent>& BoundaryEvents() const noexcept { return m_boundaryEvents; }
+
+    private:
+        struct TilePair
+        {
+            std::uint32_t a;
+            std::uint32_t b;
+            bool operator<(const TilePair& other) const noexcept
+            {
+                return a != other.a ? a < other.a : b < other.b;
+            }
+        };
+
+        std::uint32_t Column(float x) const noexcept;
+        std::uint32_t Row(float y) const noexcept;
+
+        const std::vector<AABBComponent>* m_bounds{nullptr};
+        std::uint32_t              m_columns{1};
+        std::uint32_t              m_rows{1};
+        float                      m_originX{0.0f};
+        float                      m_originY{0.0f};
+        float                      m_invTileWidth{1.0f};
+        float                      m_invTileHeight{1.0f};
+        std::vector<std::uint32_t> m_owner;
+
+        // Tile t's proxies are m_tileProxies[m_tileStart[t], m_tileStart[t + 1]).
+        std::vector<std::uint32_t> m_tileStart;
+        std::vector<std::uint32_t> m_tileProxies;
+        std::vector<std::uint32_t> m_cursor;
+
+        // Per tile scratch and results, so tiles never share a buffer.
+        std::vector<std::vector<std::uint32_t>> m_sweepOrder;
+        std::vector<std::vector<TilePair>>      m_homePairs;
+        std::vector<std::vector<CollisionEvent>> m_foundEvents;
+        std::vector<std::vector<CollisionEvent>> m_tileEvents;
+        std::vector<CollisionEvent>             m_boundaryEvents;
+    };
+}
@@ -20,14 +20,61 @@
 #include "ecs/World.hpp"
 #include "physics/Components.hpp"
 #include "physics/CollisionSystem.hpp"
+#include "physics/ContinuousCollision.hpp"
+#include "physics/Narrowphase.hpp"
+#include "physics/SpatialQuery.hpp"
+#include "physics/SpatialSort.hpp"
+#include "physics/SpatialTiles.hpp"
 
 #include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
 #include <vector>
 
 namespace jobs { class JobSystem; }
 
 namespace physics
 {
+    // How joint chains are solved. Auto factors every acyclic chain exactly
+    // (see ConstraintResolutionSystem) and falls back to Gauss-Seidel for
+    // chains that contain a loop; Iterative always uses Gauss-Seidel.
+    enum class JointSolver
+    {
+        Auto,
+        Iterative
+    };
+
+    // How contacts are solved. GaussSeidel sweeps each island in order,
+    // applying every correction before the next contact reads the bodies.
+    // Jacobi computes every contact of a pass from the state the pass
+    // started with and gives each body the average of its contacts'
+    // corrections, summed in contact order; it converges more slowly but
+    // runs as flat parallel loops over all contacts and bodies, and its
+    // result does not depend on the number of workers.
+    enum class ContactSolver
+    {
+        GaussSeidel,
+        Jacobi
+    };
+
+    // How PhysicsSystem::Update spreads a substep over the job system.
+    // Staged runs each stage (pair search, contact preparation, each solver
+    // phase) as one parallel pass over the whole world. Tiled cuts the
+    // world into a fixed grid of tiles (see TileDecomposition); each tile
+    // finds, prepares and solves its own contacts as one task, and the
+    // contacts that cross a tile border are solved after the tiles, from
+    // the state they left. The grid comes from the settings, not from the
+    // worker count, so Tiled results do not depend on the number of
+    // workers; they differ from Staged's because contacts are solved in a
+    // different order, and because Tiled always re-measures penetration
+    // (see CollisionResolutionSystem::SolverSettings::measurePenetration).
+    enum class PhysicsExecution
+    {
+        Staged,
+        Tiled
+    };
+
     struct PhysicsSettings
     {
         int   substeps{16};
@@ -37,6 +84,224 @@ namespace physics
         float penetrationSlop{0.01f};
         float correctionPercent{0.2f};
         float maxPositionCorrection{0.2f};
+        // Frames between Morton-order compaction passes over the physics
+        // storages (see SortStoragesByMortonOrder). 0 disables re-sorting.
+        int   spatialSortInterval{0};
+        JointSolver jointSolver{JointSolver::Auto};
+        ContactSolver contactSolver{ContactSolver::GaussSeidel};
+        // Pair search strategy; every choice yields the same contacts.
+        Broadphase  broadphase{Broadphase::Auto};
+        // Residual tolerances for stopping an island's (or joint chain's)
+        // iterations early. 0 stops only once a pass changes nothing, which
+        // gives the same result as running every iteration.
+        float positionTolerance{0.0f};   // remaining penetration beyond slop
+        float velocityTolerance{0.0f};   // largest velocity change in a pass
+        float constraintTolerance{0.0f}; // largest joint length error
+        // Island sleeping: an island whose dynamic bodies have all stayed
+        // below both speed thresholds for sleepTime seconds is parked until
+        // an awake body touches it or a body in it gets velocity or torque.
+        bool  enableSleeping{false};
+        float sleepLinearVelocity{0.05f};
+        float sleepAngularVelocity{0.05f};
+        float sleepTime{0.5f};
+        // Adaptive substepping: each frame picks a count in [minSubsteps,
+        // maxSubsteps] instead of using `substeps`, so that no body travels
+        // more than maxSubstepTravel of its collider half-size per substep
+        // and so that a frame whose deepest penetration exceeded
+        // targetPenetration is followed by proportionally more substeps.
+        // The count rises at once but falls by at most one per frame.
+        bool  adaptiveSubsteps{false};
+        int   minSubsteps{2};
+        int   maxSubsteps{16};
+        float maxSubstepTravel{0.25f};
+        float targetPenetration{0.05f};
+        // Continuous collision: bodies that move more than ccdMotionThreshold
+        // times their collider half-size in one substep are swept against
+        // static boxes (see ClampFastBodiesToStatic).
+        bool  continuousCollision{false};
+        float ccdMotionThreshold{0.5f};
+        PhysicsExecution execution{PhysicsExecution::Staged};
+        int   tileColumns{4}; // Tiled only
+        int   tileRows{4};
+    };
+
+    // Iterations the solvers actually used, per solved group: a contact
+    // island for the position/velocity passes, a joint chain for constraints.
+    struct SolverIterationStats
+    {
+        std::size_t groups{0};
+        std::size_t iterations{0};
+        int         maxIterations{0};
+        // Largest residual seen by a first pass (for contacts: the deepest
+        // penetration beyond slop).
+        float       maxInitialResidual{0.0f};
+
+        void Add(int used, float initialResidual = 0.0f)
+        {
+            ++groups;
+            iterations += static_cast<std::size_t>(used);
+            maxIterations = std::max(maxIterations, used);
+            maxInitialResidual = std::max(maxInitialResidual, initialResidual);
+        }
+
+        void Merge(const SolverIterationStats& other)
+        {
+            groups += other.groups;
+            iterations += other.iterations;
+            maxIterations = std::max(maxIterations, other.maxIterations);
+            maxInitialResidual = std::max(maxInitialResidual, other.maxInitialResidual);
+        }
+
+        double MeanIterations() const noexcept
+        {
+            return groups > 0 ? static_cast<double>(iterations) / static_cast<double>(groups) : 0.0;
+        }
+    };
+
+    // Solver work over all substeps of the last PhysicsSystem::Update.
+    struct PhysicsStepStats
+    {
+        SolverIterationStats position;
+        SolverIterationStats velocity;
+        SolverIterationStats constraint;
+        int         substeps{0};
+        ContinuousCollisionStats continuous;
+        std::size_t sleepingBodies{0}; // asleep at the end of the frame
+        std::size_t bodiesSlept{0};
+        std::size_t bodiesWoken{0};
+    };
+
+    // The contacts of one substep, prepared once (see
+    // CollisionResolutionSystem::PrepareContacts) and shared by the position
+    // and velocity phases.
+    //
+    // Contacts are structure-of-arrays rows over a table of solver bodies.
+    // Every dynamic body has one solver body; a static body gets a separate
+    // solver body for each contact it is in, so islands never share one and
+    // can be solved in parallel without touching the same memory. Contacts
+    // are stored grouped by island (components connected through dynamic
+    // bodies, numbered in order of their first event). Within an island they
+    // are grouped into batches of one kind, each solved by a velocity kernel
+    // compiled for that kind, and keep event order within a batch.
+    struct ContactBuffer
+    {
+        // Contact kinds: what the velocity solve of a row has to do.
+        static constexpr std::uint8_t kFriction = 1; // friction above zero
+        static constexpr std::uint8_t kRotation = 2; // friction can spin a body
+        static constexpr std::uint8_t kStaticA  = 4; // body a does not move
+        static constexpr std::uint8_t kStaticB  = 8;
+        static constexpr std::size_t  kKinds    = 16;
+
+        // Solver bodies. Positions and velocities are copied in at the start
+        // of a phase and written back to the components at its end.
+        std::vector<RigidBodyComponent*> bodyRigid;
+        std::vector<TransformComponent*> bodyTransform;
+        std::vector<float>               bodyInvMass;
+        std::vector<float>               bodyInvInertia;
+        std::vector<float>               bodyX;
+        std::vector<float>               bodyY;
+        std::vector<float>               bodyVx;
+        std::vector<float>               bodyVy;
+        std::vector<float>               bodyAngularVelocity;
+        std::vector<float>               bodyStartX;
+        std::vector<float>               bodyStartY;
+
+        // Contact rows.
+        std::vector<std::uint32_t> a;
+        std::vector<std::uint32_t> b;
+        std::vector<float>         nx;
+        std::vector<float>         ny;
+        std::vector<float>         pen;
+        std::vector<float>         restitution;
+        std::vector<float>         friction;
+        std::vector<float>         invMassSum;
+        std::vector<float>         leverA; // 0 where the body cannot spin
+        std::vector<float>         leverB;
+
+        // Island k owns contact rows [islandStart[k], islandStart[k + 1])
+        // and batches [islandBatch[k], islandBatch[k + 1]). Batch j holds
+        // rows [batchStart[j], batchStart[j + 1]), all of kind batchKind[j];
+        // batches with a static body come first in their island.
+        std::vector<std::uint32_t> islandStart;
+        std::vector<std::uint32_t> islandBatch;
+        std::vector<std::uint32_t> batchStart;
+        std::vector<std::uint8_t>  batchKind;
+
+        // Jacobi solve only (see ContactSolver): solver body i is end s of
+        // the contacts bodyContact[bodyContactStart[i], bodyContactStart[i +
+        // 1]), in contact order, where end 2k is row k's body a and 2k + 1
+        // its body b. Built by the first Jacobi phase after PrepareContacts.
+        std::vector<std::uint32_t> bodyContactStart;
+        std::vector<std::uint32_t> bodyContact;
+
+        std::size_t Size() const noexcept { return a.size(); }
+        std::size_t IslandCount() const noexcept { return islandStart.empty() ? 0 : islandStart.size() - 1; }
+        std::size_t BatchCount() const noexcept { return batchKind.size(); }
+
+        // Scratch reused between substeps.
+        struct BodyRecord
+        {
+            RigidBodyComponent*            rigid;
+            TransformComponent*            transform;
+            const AABBComponent*           aabb;
+            const CircleColliderComponent* circle;
+            std::uint32_t                  material;
+            std::uint32_t                  solverBody;
+            std::uint32_t                  slot; // rigid body slot
+        };
+        struct Candidate
+        {
+            std::uint32_t recordA;
+            std::uint32_t recordB;
+            float         nx;
+            float         ny;
+            float         pen;
+        };
+        std::vector<std::uint32_t> slotRecord;
+        std::vector<BodyRecord>    records;
+        std::vector<Candidate>     candidates;
+        CircleCircleBatch          circlePairs;
+        CircleAabbBatch            circleBoxPairs;
+        ManifoldBatch              manifolds;
+        std::vector<std::uint8_t>  kind;
+        std::vector<std::uint32_t> parent;
+        std::vector<std::uint32_t> islandOf;
+        std::vector<std::uint32_t> bucketStart;
+        std::vector<std::uint32_t> order;
+        std::vector<std::uint32_t> indexScratch;
+        std::vector<float>         floatScratch;
+        std::vector<float>         endDx; // per contact end, Jacobi only
+        std::vector<float>         endDy;
+        std::vector<float>         endDw;
+        std::vector<float>         batchResidual;
+
+        // Material cache: the combined coefficients of every handle pair,
+        // rebuilt when the shared materials change, and each rigid body
+        // slot's handle, rebuilt when the materials or the body slots do.
+        std::vector<PhysicsMaterial> pairTable;
+        std::size_t                  pairTableSize{0}; // handles per row
+        const void*                  pairMaterials{nullptr};
+        std::uint64_t                pairVersion{0};
+        std::vector<std::uint32_t>   bodyMaterial;
+        const void*                  bodyMaterials{nullptr};
+        std::uint64_t                bodyMaterialVersion{0};
+        const void*                  bodyStorage{nullptr};
+        std::uint64_t                bodyStructureVersion{0};
+    };
+
+    // The slots PhysicsSystem's proxy table already holds, so PrepareContacts
+    // can find a body's transform and shapes without storage lookups: per
+    // rigid body slot its proxy, and per proxy its transform slot, AABB slot
+    // (proxies before `boxProxies`) and circle slot. Missing entries are
+    // CollisionEvent::kNoBody. Only valid while no physics storage has
+    // gained, lost or reordered slots since the table was built.
+    struct ContactProxies
+    {
+        const std::vector<std::uint32_t>* bodyProxy{nullptr};
+        const std::vector<std::uint32_t>* transforms{nullptr};
+        const std::vector<std::uint32_t>* shapes{nullptr};
+        const std::vector<std::uint32_t>* circles{nullptr};
+        std::size_t                       boxProxies{0};
     };
 
     // Resolves collisions by applying impulses.
@@ -50,6 +315,16 @@ namespace physics
             float penetrationSlop{0.01f};
             float correctionPercent{0.2f};
             float maxCorrection{0.2f};
+            // With a positive positionTolerance each pass re-measures the
+            // penetration from the displacement since PrepareContacts, so
+            // corrections shrink as an island separates; otherwise every
+            // pass reuses the detected depth.
+            float positionTolerance{0.0f};
+            float velocityTolerance{0.0f};
+            // Re-measure the penetration every pass without stopping early,
+            // as a positive positionTolerance does.
+            bool  measurePenetration{false};
+            ContactSolver solver{ContactSolver::GaussSeidel};
         };
 
         void SetSolverSettings(const SolverSettings& settings) { m_settings = settings; }
@@ -62,23 +337,132 @@ namespace physics
         // Resolve collisions for ECS world
         void Resolve(const std::vector<CollisionEvent>& events, ecs::World& world) const;
 
-        void ResolvePosition(const std::vector<CollisionEvent>& events, ecs::World& world, jobs::JobSystem* jobSystem = nullptr) const;
-        void ResolveVelocity(const std::vector<CollisionEvent>& events, ecs::World& world, jobs::JobSystem* jobSystem = nullptr) const;
+        // Computes the manifolds, combined materials and islands of `events`
+        // once. Bodies are found through the events' bodyA/bodyB slots when
+        // those are current, and their transforms and shapes through
+        // `proxies` when given, so a body costs at most one set of lookups
+        // however many contacts it has. The buffer stays valid until a
+        // component is added to or removed from the world. Island building
+        // runs on the job system when one is given, with the same result.
+        void PrepareContacts(const std::vector<CollisionEvent>& events, ecs::World& world, ContactBuffer& contacts,
+                             jobs::JobSystem* jobSystem = nullptr, const ContactProxies* proxies = nullptr) const;
+
+        // When stats is given, one entry per contact island is added to it
+        // (a single entry for all contacts with the Jacobi solver).
+        void ResolvePosition(ContactBuffer& contacts, jobs::JobSystem* jobSystem = nullptr,
+                             SolverIterationStats* stats = nullptr) const;
+        void ResolveVelocity(ContactBuffer& contacts, jobs::JobSystem* jobSystem = nullptr,
+                             SolverIterationStats* stats = nullptr) const;
+
+        // Prepare-and-solve shorthands for a single phase.
+        void ResolvePosition(const std::vector<CollisionEvent>& events, ecs::World& world, jobs::JobSystem* jobSystem = nullptr,
+                             SolverIterationStats* stats = nullptr) const;
+        void ResolveVelocity(const std::vector<CollisionEvent>& events, ecs::World& world, jobs::JobSystem* jobSystem = nullptr,
+                             SolverIterationStats* stats = nullptr) const;
 
     private:
         SolverSettings m_settings{};
     };
 
     // Resolves constraints (joints).
+    //
+    // Joints are flattened into structure-of-arrays rows that index a dense
+    // body table. The rows survive across substeps and frames and are rebuilt
+    // only when a joint is written or the joint/transform/rigid body storages
+    // change shape. Rows are grouped into chains (components connected through
+    // dynamic bodies); chains share no moving body, so with a JobSystem they
+    // are solved in parallel with results identical to a serial sweep.
+    //
+    // A chain whose body/joint graph is a tree is solved directly: the
+    // linearized KKT system is factored in O(n) by eliminating leaves first
+    // (Baraff, "Linear-Time Dynamics using Lagrange Multipliers", 1996), in
+    // double precision. Rigid joints get a tiny compliance so leaf pivots
+    // stay non-singular.
     class ConstraintResolutionSystem
     {
     public:
-        void Resolve(ecs::World& world, float dt) const;
+        void Resolve(ecs::World& world, float dt, jobs::JobSystem* jobSystem = nullptr);
         void SetIterationCount(int iterations) { m_iterations = std::max(1, iterations); }
         int  IterationCount() const noexcept { return m_iterations; }
+        void SetSolver(JointSolver solver) { m_solver = solver; }
+        JointSolver Solver() const noexcept { return m_solver; }
+        // Chains stop iterating once their largest length error is below this.
+        void SetTolerance(float tolerance) { m_tolerance = std::max(0.0f, tolerance); }
+        float Tolerance() const noexcept { return m_tolerance; }
+        // Iterations per chain used by the last Resolve.
+        const SolverIterationStats& LastIterations() const noexcept { return m_lastIterations; }
+
+        // Number of times the row cache has been rebuilt.
+        std::size_t CacheRebuilds() const noexcept { return m_cacheRebuilds; }
+        std::size_t RowCount() const noexcept { return m_rowA.size(); }
+        std::size_t ChainCount() const noexcept { return m_chainStart.empty() ? 0 : m_chainStart.size() - 1; }
+        // Chains currently eligible for the direct tree solve.
+        std::size_t DirectChainCount() const noexcept;
 
     private:
+        struct TreeNode
+        {
+            std::uint32_t index;   // body index or row index
+            std::uint32_t parent;  // index into m_treeNodes, UINT32_MAX for the root
+            bool          isRow;
+        };
+
+        struct TreeWork
+        {
+            double d[3];  // pivot block: 2x2 symmetric (xx, xy, yy) for bodies, d[0] for rows
+            double j[2];  // elimination factor towards the parent
+            double v[2];  // right-hand side / solution
+        };
+
+        bool CacheIsValid(const ecs::World& world) const;
+        void RebuildCache(ecs::World& world);
+        void BuildTrees();
+        bool GatherBodies();
+        int SolveChain(std::size_t chain, float dt);
+        int SolveChainDirect(std::size_t chain, float dt);
+
         int m_iterations{8};
+        JointSolver m_solver{JointSolver::Auto};
+        float m_tolerance{0.0f};
+        SolverIterationStats m_lastIterations{};
+        std::vector<int> m_chainIterations;
+
+        // Body table: pointers stay valid while the storage layouts are
+        // unchanged (transforms and rigid bodies use stable chunked storage).
+        std::vector<TransformComponent*> m_bodyTransform;
+        std::vector<RigidBodyComponent*> m_bodyRigid;
+        std::vector<std::uint8_t>        m_bodyDynamic;
+        std::vector<float>               m_bodyX;
+        std::vector<float>               m_bodyY;
+        std::vector<float>               m_bodyInvMass;
+
+        // Joint rows (SoA) and chains as ranges into m_chainRows.
+        std::vector<std::uint32_t> m_rowA;
+        std::vector<std::uint32_t> m_rowB;
+        std::vector<float>         m_rowTarget;
+        std::vector<float>         m_rowCompliance;
+        std::vector<std::uint32_t> m_chainRows;
+        std::vector<std::uint32_t> m_chainStart;
+
+        // Acyclic chains as node lists in breadth-first order from a root
+        // body (eliminated in reverse); chains with a loop get an empty range.
+        std::vector<TreeNode>      m_treeNodes;
+        std::vector<std::uint32_t> m_treeStart;
+        std::vector<TreeWork>      m_treeWork;
+        std::vector<double>        m_rowGradX;
+        std::vector<double>        m_rowGradY;
+        std::vector<double>        m_rowLambda;
+
+        const ecs::World*        m_cacheWorld{nullptr};
+        std::uint64_t            m_jointLayout{0};
+        std::uint64_t            m_jointStructure{0};
+        std::uint64_t            m_transformLayout{0};
+        std::uint64_t            m_bodyLayout{0};
+        std::uint64_t            m_transformStructure{0};
+        std::uint64_t            m_bodyStructure{0};
+        std::uint32_t            m_cacheTick{0};
+        bool                     m_cacheIncomplete{false};
+        std::size_t              m_cacheRebuilds{0};
     };
 
     // Integrates rigid bodies into transforms applying gravity / environment forces.
@@ -88,6 +472,11 @@ namespace physics
         void Update(ecs::World& world, float dt) override; // Placeholder for future ECS usage.
         void UpdateVelocities(ecs::World& world, float dt);
 
+        // Advances one body by dt the way Update does (static bodies only get
+        // their derived mass filled in and spin cleared). Returns true if the
+        // body is awake and dynamic and so was moved.
+        bool StepBody(RigidBodyComponent& body, TransformComponent& transform, float dt) const;
+
         void Integrate(std::vector<TransformComponent>& transforms,
                        std::vector<RigidBodyComponent>& bodies,
                        float                            dt) const;
@@ -116,23 +505,79 @@ namespace physics
 
         void SetEnvironment(const EnvironmentForces& env) { m_integration.SetEnvironment(env); }
         void SetJobSystem(jobs::JobSystem* js) { m_jobSystem = js; m_integration.SetJobSystem(js); }
+        // Installs a custom broadphase and records Broadphase::Custom in the
+        // settings; settings naming a built-in strategy replace it again.
+        void SetBroadphase(std::unique_ptr<IBroadphase> broadphase);
 
         const std::vector<CollisionEvent>& GetCollisionEvents() const { return m_events; }
+        const SpatialSortStats& LastSpatialSort() const noexcept { return m_spatialSort; }
+        const ConstraintResolutionSystem& Constraints() const noexcept { return m_constraints; }
+        const CollisionSystem& Collision() const noexcept { return m_collision; }
+        const PhysicsStepStats& StepStats() const noexcept { return m_stepStats; }
+
+        // Spatial queries over the colliders at the last substep's
+        // broadphase (before that substep's solve). The index is rebuilt
+        // by the first call after an Update, so that call must not race
+        // with others; the index can then be shared by any number of
+        // threads until the next Update.
+        const SpatialQueryIndex& Queries() const;
 
     private:
         void ApplySettings();
+        int  ChooseSubsteps(ecs::World& world, float dt);
+        void WakeDisturbedBodies(ecs::World& world);
+        void WakeTouchedBodies(ecs::World& world);
+        void UpdateSleep(ecs::World& world, float dt);
+        ContactProxies Proxies() const;
+        bool ProxyTableIsValid(const ecs::World& world) const;
+        void RebuildProxyTable(ecs::World& world);
+        void UpdateProxies(ecs::World& world, float dt);
+        void DetectTiles(const ecs::World& world);
+        void PrepareTileContacts(ecs::World& world);
+        void ResolveTileContacts(bool velocity);
 
         PhysicsIntegrationSystem  m_integration;
         CollisionSystem           m_collision;
         CollisionResolutionSystem m_resolution;
         ConstraintResolutionSystem m_constraints;
         std::vector<CollisionEvent> m_events;
-        
-        // Broadphase buffers
+        ContactBuffer               m_contacts;
+
+        // Broadphase input, one proxy per AABB and then one per circle
+        // without an AABB. Bounds, motion and layers are rewritten every
+        // substep by UpdateProxies; the rest is the proxy table, which only
+        // changes when a physics storage gains, loses or reorders slots.
         std::vector<AABBComponent> m_broadphaseAABBs;
         std::vector<std::uint32_t> m_broadphaseIds;
+        std::vector<ProxyMotion>   m_broadphaseMotion;
+        std::vector<CollisionFilterComponent> m_broadphaseLayers;
+        std::vector<std::uint32_t> m_broadphaseBodies;
+        std::vector<std::uint32_t> m_proxyTransform; // transform slot
+        std::vector<std::uint32_t> m_proxyShape;     // AABB or circle slot
+        std::vector<std::uint32_t> m_proxyFilter;    // filter slot
+        std::vector<std::uint32_t> m_proxyCircle;    // circle slot, also for AABB proxies
+        std::vector<std::uint32_t> m_bodyProxy;      // proxy by rigid body slot
+        std::size_t                m_aabbProxies{0};
+        // Rigid bodies with a transform but no proxy; integrated only.
+        std::vector<std::uint32_t> m_looseBodies;
+        std::vector<std::uint32_t> m_looseTransforms;
+        const ecs::World*          m_proxyWorld{nullptr};
+        std::uint64_t              m_proxyVersions[5]{};
+        std::vector<std::uint32_t> m_sleepParent;
+
+        // Tiled execution: one contact buffer per tile, then the boundary one.
+        TileDecomposition                 m_tiles;
+        std::vector<ContactBuffer>        m_tileContacts;
+        std::vector<SolverIterationStats> m_tileStats;
 
         jobs::JobSystem*          m_jobSystem{nullptr};
         PhysicsSettings           m_settings{};
+        SpatialSortStats          m_spatialSort{};
+        PhysicsStepStats          m_stepStats{};
+        std::size_t               m_frameCounter{0};
+        int                       m_lastSubsteps{0};
+        float                     m_lastPenetration{0.0f};
+        mutable SpatialQueryIndex m_queries;
+        mutable bool              m_queriesStale{true};
     };
 }
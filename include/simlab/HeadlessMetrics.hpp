@@ -18,6 +18,7 @@
 #pragma once
 
 #include "core/Logger.hpp"
+#include "simlab/WorldHasher.hpp"
 
 #include <atomic>
 #include <cstddef>
@@ -49,6 +50,15 @@ namespace simlab
         double updateWallSeconds{0.0};
         double renderWallSeconds{0.0};
         double frameWallSeconds{0.0};
+        double contactIndexStride{0.0};
+        // Mean solver iterations per contact island / joint chain this frame.
+        double positionIterationsPerIsland{0.0};
+        double velocityIterationsPerIsland{0.0};
+        double constraintIterationsPerChain{0.0};
+        std::size_t sleepingBodyCount{0};
+        std::size_t bodiesSlept{0};
+        std::size_t bodiesWoken{0};
+        int substeps{0};
     };
 
     struct HeadlessRunSummary
@@ -207,6 +217,7 @@ namespace simlab
         int frameCounter{0};
         double simTimeSeconds{0.0};
         std::string currentFailurePhase;
+        WorldHasher hasher; // rehashes only what each frame changed
     };
 
     struct HeadlessRuntimeFrameConfig
@@ -532,6 +543,13 @@ namespace simlab
                                      std::size_t frameIndex,
                                      double simTimeSeconds) noexcept;
 
+    // Same, hashing the world through a hasher kept across frames.
+    FrameMetrics CaptureFrameMetrics(const ecs::World& world,
+                                     const physics::PhysicsSystem& physicsSystem,
+                                     std::size_t frameIndex,
+                                     double simTimeSeconds,
+                                     WorldHasher& hasher) noexcept;
+
     std::string_view ClassifyHeadlessFailurePhase(std::string_view phase, bool startupPhase) noexcept;
 
     std::uint64_t HashHeadlessRunConfig(const std::string& scenarioKey,
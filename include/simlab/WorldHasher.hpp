@@ -35,10 +35,36 @@ namespace simlab
                                  const std::vector<physics::RigidBodyComponent>& bodies) const noexcept;
         std::uint64_t HashAABBs(const std::vector<physics::AABBComponent>& aabbs) const noexcept;
         std::uint64_t HashWorld(const ecs::World& world) const noexcept;
+        // Same value as HashWorld, for a world hashed every frame: keeps one
+        // hash per component and rehashes only the components written since
+        // the previous call on the same world (see World::ChangeTick), or a
+        // whole storage once it gains, loses or reorders slots.
+        std::uint64_t HashWorldChanged(const ecs::World& world) noexcept;
         std::uint64_t Combine(std::uint64_t h1, std::uint64_t h2) const noexcept { return h1 ^ (h2 + 0x9e3779b97f4a7c15ull + (h1<<6) + (h1>>2)); }
     private:
         static constexpr std::uint64_t kOffset = 1469598103934665603ull;
         static constexpr std::uint64_t kPrime  = 1099511628211ull;
         void HashBytes(std::uint64_t& h, const void* data, std::size_t len) const noexcept;
+
+        // HashWorld folds one hash per component, in storage order.
+        std::uint64_t HashComponent(std::uint32_t id, const physics::TransformComponent& t) const noexcept;
+        std::uint64_t HashComponent(std::uint32_t id, const physics::RigidBodyComponent& body) const noexcept;
+        std::uint64_t HashComponent(std::uint32_t id, const physics::AABBComponent& box) const noexcept;
+        std::uint64_t HashComponent(std::uint32_t id, const physics::CircleColliderComponent& circle) const noexcept;
+        std::uint64_t HashComponent(std::uint32_t id, const physics::DistanceJointComponent& joint) const noexcept;
+
+        struct StorageHashes
+        {
+            std::uint64_t              version{0}; // World::StructureVersionOf
+            std::vector<std::uint64_t> components;
+        };
+        template <typename TComponent>
+        void FoldStorage(const ecs::World& world, std::uint64_t& h) const noexcept;
+        template <typename TComponent>
+        void FoldChanged(const ecs::World& world, StorageHashes& cache, bool all, std::uint64_t& h) noexcept;
+
+        StorageHashes     m_cache[5];
+        const ecs::World* m_cacheWorld{nullptr};
+        std::uint32_t     m_cacheSince{0};
     };
 }
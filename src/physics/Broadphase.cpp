@@ -0,0 +1,384 @@
+/*
+ * Copyright (C) 2025 aeml
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "physics/Broadphase.hpp"
+#include "jobs/JobSystem.hpp"
+#include "jobs/Parallel.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+namespace physics {
+
+namespace {
+    inline uint64_t PackKey(int x, int y) {
+        return (static_cast<uint64_t>(x) << 32) | (static_cast<uint32_t>(y));
+    }
+
+    inline int CellIndex(float v, float cellSize) {
+        return static_cast<int>(std::floor(v / cellSize));
+    }
+
+    inline bool Overlaps(const AABBComponent& a, const AABBComponent& b) {
+        return !(a.maxX < b.minX || b.maxX < a.minX || a.maxY < b.minY || b.maxY < a.minY);
+    }
+
+    inline float Extent(const AABBComponent& box) {
+        return std::max(box.maxX - box.minX, box.maxY - box.minY);
+    }
+
+    inline ProxyPair Ordered(uint32_t a, uint32_t b) {
+        return a < b ? ProxyPair{a, b} : ProxyPair{b, a};
+    }
+
+    // Runs query(begin, end, pairs) over `count` work items, in batches on the
+    // job system when there are enough of them. Each batch fills its own
+    // buffer from `batchPairs` (kept by the caller), appended in batch order.
+    template <typename Query>
+    void CollectPairs(std::size_t count, jobs::JobSystem* jobSystem, const Query& query,
+                      std::vector<std::vector<ProxyPair>>& batchPairs, std::vector<ProxyPair>& pairs) {
+        const jobs::BatchPlan plan = jobs::PlanBatches(count, 64, jobSystem);
+        if (plan.batches < 2) {
+            query(0, count, pairs);
+            return;
+        }
+        if (batchPairs.size() < plan.batches) batchPairs.resize(plan.batches);
+        jobs::ForEachBatch(plan, jobSystem, [&](std::size_t batch, std::size_t begin, std::size_t end) {
+            query(begin, end, batchPairs[batch]);
+        });
+        jobs::AppendBatches(batchPairs, plan.batches, jobSystem, pairs);
+    }
+
+    // Cells covered by a box.
+    struct CellSpan {
+        int minX, minY, maxX, maxY;
+        std::size_t Count() const {
+            return static_cast<std::size_t>(maxX - minX + 1) * static_cast<std::size_t>(maxY - minY + 1);
+        }
+    };
+
+    inline CellSpan SpanOf(const AABBComponent& box, float cellSize) {
+        return {CellIndex(box.minX, cellSize), CellIndex(box.minY, cellSize),
+                CellIndex(box.maxX, cellSize), CellIndex(box.maxY, cellSize)};
+    }
+
+    constexpr int kMaxGridLevels = 32;
+    constexpr float kMinGridCell = 1e-3f;
+
+    inline std::size_t HashCell(int level, uint64_t key, std::size_t mask) {
+        const uint64_t h = (key ^ (static_cast<uint64_t>(level) << 56)) * 0x9E3779B97F4A7C15ull;
+        return static_cast<std::size_t>(h >> 32) & mask;
+    }
+}
+
+void BruteForceBroadphase::FindPairs(const std::vector<AABBComponent>& aabbs, const ProxyFilter& filter,
+                                     jobs::JobSystem*, std::vector<ProxyPair>& pairs) {
+    const std::size_t n = aabbs.size();
+    for (std::size_t i = 0; i < n; ++i) {
+        for (std::size_t j = i + 1; j < n; ++j) {
+            if (filter.Rejects(i, j)) continue;
+            if (Overlaps(aabbs[i], aabbs[j])) {
+                pairs.push_back({static_cast<uint32_t>(i), static_cast<uint32_t>(j)});
+            }
+        }
+    }
+}
+
+void UniformGridBroadphase::FindPairs(const std::vector<AABBComponent>& aabbs, const ProxyFilter& filter,
+                                      jobs::JobSystem* jobSystem, std::vector<ProxyPair>& pairs) {
+    const std::size_t n = aabbs.size();
+    const float cellSize = m_cellSize;
+    const jobs::BatchPlan proxies = jobs::PlanBatches(n, 256, jobSystem);
+
+    // 1. Count the (proxy, cell) entries to size the bucket table. Cells are
+    //    hashed into at least as many buckets as there are entries.
+    m_batchCounts.assign(proxies.batches, 0);
+    jobs::ForEachBatch(proxies, jobSystem, [&](std::size_t batch, std::size_t begin, std::size_t end) {
+        std::size_t count = 0;
+        for (std::size_t i = begin; i < end; ++i) count += SpanOf(aabbs[i], cellSize).Count();
+        m_batchCounts[batch] = count;
+    });
+    std::size_t entries = 0;
+    for (const std::size_t count : m_batchCounts) entries += count;
+    std::size_t buckets = 16;
+    while (buckets < entries) buckets *= 2;
+    const std::size_t mask = buckets - 1;
+
+    // 2. Counting sort into buckets: histogram, prefix scan, scatter. The
+    //    scatter order inside a bucket depends on thread timing, so each
+    //    bucket is sorted by (cell, proxy) before use.
+    m_bucketStart.assign(buckets + 1, 0);
+    jobs::ForEachBatch(proxies, jobSystem, [&](std::size_t, std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            const CellSpan span = SpanOf(aabbs[i], cellSize);
+            for (int x = span.minX; x <= span.maxX; ++x) {
+                for (int y = span.minY; y <= span.maxY; ++y) {
+                    std::atomic_ref<uint32_t>(m_bucketStart[HashCell(0, PackKey(x, y), mask)])
+                        .fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+        }
+    });
+    jobs::ExclusiveScan(m_bucketStart, jobSystem, m_scanScratch);
+    m_bucketCursor.assign(m_bucketStart.begin(), m_bucketStart.end() - 1);
+    m_entries.resize(entries);
+    jobs::ForEachBatch(proxies, jobSystem, [&](std::size_t, std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            const CellSpan span = SpanOf(aabbs[i], cellSize);
+            for (int x = span.minX; x <= span.maxX; ++x) {
+                for (int y = span.minY; y <= span.maxY; ++y) {
+                    const uint64_t key = PackKey(x, y);
+                    const uint32_t slot = std::atomic_ref<uint32_t>(m_bucketCursor[HashCell(0, key, mask)])
+                                              .fetch_add(1, std::memory_order_relaxed);
+                    m_entries[slot] = {key, static_cast<uint32_t>(i)};
+                }
+            }
+        }
+    });
+
+    // 3. Check all pairs of each cell. A pair is reported only from the
+    //    cell holding the min corner of its overlap (the primary cell).
+    auto checkBuckets = [&](std::size_t start, std::size_t end, std::vector<ProxyPair>& results) {
+        for (std::size_t bucket = start; bucket < end; ++bucket) {
+            const auto first = m_entries.begin() + m_bucketStart[bucket];
+            const auto last = m_entries.begin() + m_bucketStart[bucket + 1];
+            if (last - first < 2) continue;
+            std::sort(first, last);
+            for (auto run = first; run != last;) {
+                auto runEnd = run + 1;
+                while (runEnd != last && runEnd->key == run->key) ++runEnd;
+                for (auto a = run; a != runEnd; ++a) {
+                    for (auto b = a + 1; b != runEnd; ++b) {
+                        const uint32_t idxA = a->index;
+                        const uint32_t idxB = b->index;
+                        if (filter.Rejects(idxA, idxB)) continue;
+
+                        const auto& boxA = aabbs[idxA];
+                        const auto& boxB = aabbs[idxB];
+                        if (!Overlaps(boxA, boxB)) continue;
+
+                        const float interMinX = std::max(boxA.minX, boxB.minX);
+                        const float interMinY = std::max(boxA.minY, boxB.minY);
+                        if (PackKey(CellIndex(interMinX, cellSize), CellIndex(interMinY, cellSize)) == run->key) {
+                            results.push_back({idxA, idxB});
+                        }
+                    }
+                }
+                run = runEnd;
+            }
+        }
+    };
+
+    CollectPairs(buckets, jobSystem, checkBuckets, m_batchPairs, pairs);
+}
+
+void HierarchicalGridBroadphase::FindPairs(const std::vector<AABBComponent>& aabbs, const ProxyFilter& filter,
+                                           jobs::JobSystem* jobSystem, std::vector<ProxyPair>& pairs) {
+    const std::size_t n = aabbs.size();
+
+    // 1. Level 0 fits the smallest proxy; a proxy goes to the first level
+    //    whose cell is at least its larger extent, keyed by its min corner.
+    float smallest = std::numeric_limits<float>::infinity();
+    for (const auto& box : aabbs) {
+        const float extent = Extent(box);
+        if (extent > 0.0f) smallest = std::min(smallest, extent);
+    }
+    const float baseCell = std::isfinite(smallest) ? std::max(smallest, kMinGridCell) : 1.0f;
+
+    float cellSizes[kMaxGridLevels];
+    cellSizes[0] = baseCell;
+    for (int l = 1; l < kMaxGridLevels; ++l) cellSizes[l] = cellSizes[l - 1] * 2.0f;
+
+    constexpr uint32_t kEnd = std::numeric_limits<uint32_t>::max();
+    std::size_t tableSize = 16;
+    while (tableSize < 2 * n) tableSize *= 2;
+    const std::size_t mask = tableSize - 1;
+    m_table.assign(tableSize, GridCell{0, kEnd, -1});
+    m_next.assign(n, kEnd);
+    m_levelOf.resize(n);
+    auto& table = m_table;
+    auto& next = m_next;
+    auto& levelOf = m_levelOf;
+    bool levelUsed[kMaxGridLevels] = {};
+    int topLevel = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        const auto& box = aabbs[i];
+        const float extent = Extent(box);
+        int level = 0;
+        while (level < kMaxGridLevels - 1 && cellSizes[level] < extent) ++level;
+        levelOf[i] = static_cast<uint8_t>(level);
+        levelUsed[level] = true;
+        topLevel = std::max(topLevel, level);
+
+        const float cell = cellSizes[level];
+        const uint64_t key = PackKey(CellIndex(box.minX, cell), CellIndex(box.minY, cell));
+        std::size_t slot = HashCell(level, key, mask);
+        while (table[slot].level >= 0 && !(table[slot].level == level && table[slot].key == key)) {
+            slot = (slot + 1) & mask;
+        }
+        if (table[slot].level < 0) table[slot] = {key, kEnd, level};
+        next[i] = table[slot].head;
+        table[slot].head = static_cast<uint32_t>(i);
+    }
+    auto findCell = [&](int level, uint64_t key) -> uint32_t {
+        for (std::size_t slot = HashCell(level, key, mask);; slot = (slot + 1) & mask) {
+            const GridCell& cell = table[slot];
+            if (cell.level < 0) return kEnd;
+            if (cell.level == level && cell.key == key) return cell.head;
+        }
+    };
+
+    // 2. Each proxy looks only at its own level and coarser ones. A proxy in
+    //    a cell of size s overlapping box A has its min corner within
+    //    [A.min - s, A.max], which is at most 3x3 cells because A fits in s.
+    //    Pairs inside one level are taken from the lower index only.
+    auto queryRange = [&](std::size_t begin, std::size_t end, std::vector<ProxyPair>& results) {
+        for (std::size_t i = begin; i < end; ++i) {
+            const auto& box = aabbs[i];
+            for (int l = levelOf[i]; l <= topLevel; ++l) {
+                if (!levelUsed[l]) continue;
+                const float cell = cellSizes[l];
+                const int x0 = CellIndex(box.minX, cell) - 1;
+                const int x1 = CellIndex(box.maxX, cell);
+                const int y0 = CellIndex(box.minY, cell) - 1;
+                const int y1 = CellIndex(box.maxY, cell);
+                for (int x = x0; x <= x1; ++x) {
+                    for (int y = y0; y <= y1; ++y) {
+                        for (uint32_t j = findCell(l, PackKey(x, y)); j != kEnd; j = next[j]) {
+                            if (l == levelOf[i] && j <= i) continue;
+                            if (filter.Rejects(i, j)) continue;
+                            if (!Overlaps(box, aabbs[j])) continue;
+                            results.push_back(Ordered(static_cast<uint32_t>(i), j));
+                        }
+                    }
+                }
+            }
+        }
+    };
+
+    CollectPairs(n, jobSystem, queryRange, m_batchPairs, pairs);
+}
+
+void SweepAndPruneBroadphase::FindPairs(const std::vector<AABBComponent>& aabbs, const ProxyFilter& filter,
+                                        jobs::JobSystem* jobSystem, std::vector<ProxyPair>& pairs) {
+    const std::size_t n = aabbs.size();
+
+    // 1. Refresh the kept min-x endpoints and repair their order. Between
+    //    substeps proxies move little, so insertion sort does few moves. A
+    //    new proxy count (spawn, despawn) rebuilds the list, and a repair
+    //    that turns out expensive (e.g. after a storage re-sort) finishes
+    //    with a full sort. Both produce the same (minX, index) order.
+    m_sortMoves = 0;
+    if (m_endpoints.size() != n) {
+        m_endpoints.resize(n);
+        for (std::size_t i = 0; i < n; ++i) m_endpoints[i] = {aabbs[i].minX, static_cast<uint32_t>(i)};
+        std::sort(m_endpoints.begin(), m_endpoints.end());
+        m_sortMoves = n;
+    } else {
+        for (auto& endpoint : m_endpoints) endpoint.minX = aabbs[endpoint.index].minX;
+        const std::size_t budget = 8 * n;
+        for (std::size_t k = 1; k < n && m_sortMoves <= budget; ++k) {
+            const Endpoint moving = m_endpoints[k];
+            std::size_t m = k;
+            while (m > 0 && moving < m_endpoints[m - 1]) {
+                m_endpoints[m] = m_endpoints[m - 1];
+                --m;
+            }
+            m_endpoints[m] = moving;
+            m_sortMoves += k - m;
+        }
+        if (m_sortMoves > budget) std::sort(m_endpoints.begin(), m_endpoints.end());
+    }
+
+    // 2. Sweep: each proxy pairs with the following ones whose min x lies
+    //    inside its x extent, then the y extents decide.
+    const auto& endpoints = m_endpoints;
+    std::atomic<std::size_t> candidates{0};
+    auto sweepRange = [&](std::size_t begin, std::size_t end, std::vector<ProxyPair>& results) {
+        std::size_t tested = 0;
+        for (std::size_t k = begin; k < end; ++k) {
+            const uint32_t i = endpoints[k].index;
+            const auto& box = aabbs[i];
+            for (std::size_t m = k + 1; m < n && endpoints[m].minX <= box.maxX; ++m) {
+                ++tested;
+                const uint32_t j = endpoints[m].index;
+                const auto& other = aabbs[j];
+                if (other.maxY < box.minY || box.maxY < other.minY) continue;
+                if (filter.Rejects(i, j)) continue;
+                results.push_back(Ordered(i, j));
+            }
+        }
+        candidates.fetch_add(tested, std::memory_order_relaxed);
+    };
+
+    CollectPairs(n, jobSystem, sweepRange, m_batchPairs, pairs);
+    m_candidates = candidates.load(std::memory_order_relaxed);
+}
+
+void AutoBroadphase::FindPairs(const std::vector<AABBComponent>& aabbs, const ProxyFilter& filter,
+                               jobs::JobSystem* jobSystem, std::vector<ProxyPair>& pairs) {
+    const std::size_t n = aabbs.size();
+    if (n <= kBruteForceLimit) {
+        m_last = &m_bruteForce;
+        m_last->FindPairs(aabbs, filter, jobSystem, pairs);
+        return;
+    }
+
+    float smallest = std::numeric_limits<float>::infinity();
+    float largest = 0.0f;
+    for (const auto& box : aabbs) {
+        const float extent = Extent(box);
+        largest = std::max(largest, extent);
+        if (extent > 0.0f) smallest = std::min(smallest, extent);
+    }
+    const bool similarSizes = !std::isfinite(smallest) || largest <= kSizeSpreadLimit * smallest;
+    if (similarSizes && n > kParallelGridLimit && jobSystem && jobSystem->WorkerCount() > 1) {
+        m_uniformGrid.SetCellSize(std::max(largest, kMinGridCell));
+        m_last = &m_uniformGrid;
+        m_last->FindPairs(aabbs, filter, jobSystem, pairs);
+        return;
+    }
+
+    if (m_crowded && ++m_callsSinceProbe < kProbeInterval) {
+        m_last = &m_hierarchical;
+        m_last->FindPairs(aabbs, filter, jobSystem, pairs);
+        return;
+    }
+
+    m_last = &m_sweepAndPrune;
+    m_sweepAndPrune.FindPairs(aabbs, filter, jobSystem, pairs);
+    m_crowded = m_sweepAndPrune.LastCandidates() > kCrowdFactor * n;
+    m_callsSinceProbe = 0;
+}
+
+std::unique_ptr<IBroadphase> CreateBroadphase(Broadphase kind) {
+    switch (kind) {
+        case Broadphase::Auto:             return std::make_unique<AutoBroadphase>();
+        case Broadphase::BruteForce:       return std::make_unique<BruteForceBroadphase>();
+        case Broadphase::UniformGrid:      return std::make_unique<UniformGridBroadphase>();
+        case Broadphase::HierarchicalGrid: return std::make_unique<HierarchicalGridBroadphase>();
+        case Broadphase::SweepAndPrune:    return std::make_unique<SweepAndPruneBroadphase>();
+        case Broadphase::Custom:           break;
+    }
+    return nullptr;
+}
+
+} // namespace physics
@@ -16,180 +16,122 @@
  */
 
 #include "physics/CollisionSystem.hpp"
-#include "jobs/JobSystem.hpp"
+#include "jobs/Parallel.hpp"
+
 #include <algorithm>
-#include <mutex>
-#include <cmath>
-#include <unordered_map>
+#include <atomic>
+#include <utility>
 
 namespace physics {
 
-namespace {
-    constexpr float CELL_SIZE = 2.0f;
+bool AabbManifold(const AABBComponent& a, const AABBComponent& b, CollisionEvent& event) noexcept {
+    // Check for overlap
+    if (a.maxX < b.minX || a.minX > b.maxX || a.maxY < b.minY || a.minY > b.maxY)
+        return false;
 
-    inline std::pair<int, int> GetCellCoords(float x, float y) {
-        return { static_cast<int>(std::floor(x / CELL_SIZE)), static_cast<int>(std::floor(y / CELL_SIZE)) };
-    }
+    float x_overlap = std::min(a.maxX, b.maxX) - std::max(a.minX, b.minX);
+    float y_overlap = std::min(a.maxY, b.maxY) - std::max(a.minY, b.minY);
 
-    inline uint64_t PackKey(int x, int y) {
-        return (static_cast<uint64_t>(x) << 32) | (static_cast<uint32_t>(y));
+    if (x_overlap < y_overlap) {
+        // Point from A to B
+        event.normalX = (a.minX + a.maxX) < (b.minX + b.maxX) ? 1.0f : -1.0f;
+        event.normalY = 0.0f;
+        event.penetration = x_overlap;
+    } else {
+        event.normalX = 0.0f;
+        event.normalY = (a.minY + a.maxY) < (b.minY + b.maxY) ? 1.0f : -1.0f;
+        event.penetration = y_overlap;
     }
+    return true;
+}
 
-    struct CellEntry {
-        uint64_t key;
-        uint32_t index;
-        // Sort by key, then index for determinism
-        bool operator<(const CellEntry& rhs) const {
-            if (key != rhs.key) return key < rhs.key;
-            return index < rhs.index;
-        }
-    };
+CollisionSystem::CollisionSystem() : m_broadphase(CreateBroadphase(Broadphase::Auto)) {}
 
-    bool GetManifold(const AABBComponent& a, const AABBComponent& b, CollisionEvent& event) {
-        // Check for overlap
-        if (a.maxX < b.minX || a.minX > b.maxX || a.maxY < b.minY || a.minY > b.maxY)
-            return false;
+void CollisionSystem::SetBroadphase(Broadphase kind) {
+    if (kind == Broadphase::Custom || (kind == m_kind && m_broadphase)) return;
+    m_kind = kind;
+    m_broadphase = CreateBroadphase(kind);
+}
 
-        float x_overlap = std::min(a.maxX, b.maxX) - std::max(a.minX, b.minX);
-        float y_overlap = std::min(a.maxY, b.maxY) - std::max(a.minY, b.minY);
+void CollisionSystem::SetBroadphase(std::unique_ptr<IBroadphase> broadphase) {
+    if (!broadphase) return;
+    m_kind = Broadphase::Custom;
+    m_broadphase = std::move(broadphase);
+}
 
-        if (x_overlap < y_overlap) {
-            // Point from A to B
-            event.normalX = (a.minX + a.maxX) < (b.minX + b.maxX) ? 1.0f : -1.0f;
-            event.normalY = 0.0f;
-            event.penetration = x_overlap;
-        } else {
-            event.normalX = 0.0f;
-            event.normalY = (a.minY + a.maxY) < (b.minY + b.maxY) ? 1.0f : -1.0f;
-            event.penetration = y_overlap;
-        }
-        return true;
+const IBroadphase& CollisionSystem::ActiveBroadphase() const noexcept {
+    if (m_kind == Broadphase::Auto) {
+        if (const auto* chosen = static_cast<const AutoBroadphase&>(*m_broadphase).LastChoice()) return *chosen;
     }
+    return *m_broadphase;
 }
 
 void CollisionSystem::Detect(const std::vector<AABBComponent>& aabbs, 
                              const std::vector<std::uint32_t>& entityIds,
                              std::vector<CollisionEvent>& outEvents, 
-                             jobs::JobSystem* jobSystem) const {
+                             jobs::JobSystem* jobSystem,
+                             const std::vector<ProxyMotion>* motion,
+                             const std::vector<CollisionFilterComponent>* layers,
+                             const std::vector<std::uint32_t>* bodies) {
     outEvents.clear();
     const std::size_t n = aabbs.size();
     if (n < 2 || n != entityIds.size()) return;
-
-    // Use Spatial Hash for large N
-    if (jobSystem && n > 100) {
-        // 1. Build Grid Entries (Deterministic & Contiguous)
-        std::vector<CellEntry> entries;
-        entries.reserve(n * 4); // Heuristic
-
-        for (std::size_t i = 0; i < n; ++i) {
-            const auto& box = aabbs[i];
-            auto [minX, minY] = GetCellCoords(box.minX, box.minY);
-            auto [maxX, maxY] = GetCellCoords(box.maxX, box.maxY);
-
-            for (int x = minX; x <= maxX; ++x) {
-                for (int y = minY; y <= maxY; ++y) {
-                    entries.push_back({PackKey(x, y), static_cast<uint32_t>(i)});
-                }
-            }
+    ProxyFilter filter;
+    if (motion && motion->size() == n) filter.motion = motion;
+    if (layers && layers->size() == n) filter.layers = layers;
+    if (bodies && bodies->size() != n) bodies = nullptr;
+
+    m_pairs.clear();
+    m_broadphase->FindPairs(aabbs, filter, jobSystem, m_pairs);
+
+    // Bucket the pairs by lower index (counting sort: histogram, prefix scan,
+    // scatter), then sort each bucket: the serial all-pairs order,
+    // independent of strategy, batching and thread timing.
+    const jobs::BatchPlan pairPlan = jobs::PlanBatches(m_pairs.size(), 1024, jobSystem);
+    m_bucketStart.assign(n + 1, 0);
+    jobs::ForEachBatch(pairPlan, jobSystem, [&](std::size_t, std::size_t begin, std::size_t end) {
+        for (std::size_t k = begin; k < end; ++k) {
+            std::atomic_ref<uint32_t>(m_bucketStart[m_pairs[k].first]).fetch_add(1, std::memory_order_relaxed);
         }
-
-        // 2. Sort entries (Deterministic)
-        std::sort(entries.begin(), entries.end());
-
-        // 3. Identify Tasks (Cells)
-        struct GridTask {
-            uint64_t key;
-            std::size_t start;
-            std::size_t count;
-        };
-        std::vector<GridTask> tasks;
-        tasks.reserve(entries.size() / 2); // Rough estimate
-
-        if (!entries.empty()) {
-            std::size_t currentStart = 0;
-            uint64_t currentKey = entries[0].key;
-            
-            for (std::size_t i = 1; i < entries.size(); ++i) {
-                if (entries[i].key != currentKey) {
-                    if (i - currentStart > 1) { // Only cells with > 1 entity
-                        tasks.push_back({currentKey, currentStart, i - currentStart});
-                    }
-                    currentKey = entries[i].key;
-                    currentStart = i;
-                }
-            }
-            // Last one
-            if (entries.size() - currentStart > 1) {
-                tasks.push_back({currentKey, currentStart, entries.size() - currentStart});
-            }
+    });
+    jobs::ExclusiveScan(m_bucketStart, jobSystem, m_scanScratch);
+    m_bucketCursor.assign(m_bucketStart.begin(), m_bucketStart.end() - 1);
+    m_partners.resize(m_pairs.size());
+    jobs::ForEachBatch(pairPlan, jobSystem, [&](std::size_t, std::size_t begin, std::size_t end) {
+        for (std::size_t k = begin; k < end; ++k) {
+            const auto& pair = m_pairs[k];
+            const uint32_t slot = std::atomic_ref<uint32_t>(m_bucketCursor[pair.first])
+                                      .fetch_add(1, std::memory_order_relaxed);
+            m_partners[slot] = pair.second;
         }
-
-        if (tasks.empty()) return;
-
-        // 4. Dispatch
-        // Per-task results to avoid mutex and ensure deterministic merge
-        std::vector<std::vector<CollisionEvent>> taskResults(tasks.size());
-        
-        const std::size_t batchSize = std::max(std::size_t(16), tasks.size() / (jobSystem->WorkerCount() * 4));
-
-        auto handles = jobSystem->Dispatch(tasks.size(), batchSize, [&](std::size_t start, std::size_t end) {
-            CollisionEvent event;
-            for (std::size_t t = start; t < end; ++t) {
-                const auto& task = tasks[t];
-                auto& results = taskResults[t];
-                
-                // Check all pairs in this cell
-                // entries[task.start ... task.start + task.count] contains indices
-                for (std::size_t i = 0; i < task.count; ++i) {
-                    for (std::size_t j = i + 1; j < task.count; ++j) {
-                        uint32_t idxA = entries[task.start + i].index;
-                        uint32_t idxB = entries[task.start + j].index;
-                        
-                        const auto& boxA = aabbs[idxA];
-                        const auto& boxB = aabbs[idxB];
-
-                        // Fast overlap check
-                        if (boxA.maxX < boxB.minX || boxA.minX > boxB.maxX || 
-                            boxA.maxY < boxB.minY || boxA.minY > boxB.maxY)
-                            continue;
-
-                        // Primary cell check
-                        float interMinX = std::max(boxA.minX, boxB.minX);
-                        float interMinY = std::max(boxA.minY, boxB.minY);
-                        
-                        auto [cx, cy] = GetCellCoords(interMinX, interMinY);
-                        if (PackKey(cx, cy) == task.key) {
-                            if (GetManifold(boxA, boxB, event)) {
-                                event.entityA = entityIds[idxA];
-                                event.entityB = entityIds[idxB];
-                                results.push_back(event);
-                            }
-                        }
-                    }
-                }
-            }
-        });
-
-        jobSystem->Wait(handles);
-
-        // 5. Merge Results (Deterministic Order)
-        for (const auto& res : taskResults) {
-            outEvents.insert(outEvents.end(), res.begin(), res.end());
-        }
-
-    } else {
-        // Serial O(N^2) execution
+    });
+
+    // Each batch of lower indices fills its own event buffer; the buffers
+    // are appended in batch order.
+    const jobs::BatchPlan proxyPlan = jobs::PlanBatches(n, 256, jobSystem);
+    if (m_batchEvents.size() < proxyPlan.batches) m_batchEvents.resize(proxyPlan.batches);
+    jobs::ForEachBatch(proxyPlan, jobSystem, [&](std::size_t batch, std::size_t first, std::size_t last) {
+        auto& events = m_batchEvents[batch];
         CollisionEvent event;
-        for (std::size_t i = 0; i < n; ++i) {
-            for (std::size_t j = i + 1; j < n; ++j) {
-                if (GetManifold(aabbs[i], aabbs[j], event)) {
-                    event.entityA = entityIds[i];
-                    event.entityB = entityIds[j];
-                    outEvents.push_back(event);
+        for (std::size_t a = first; a < last; ++a) {
+            const auto begin = m_partners.begin() + m_bucketStart[a];
+            const auto end = m_partners.begin() + m_bucketStart[a + 1];
+            std::sort(begin, end);
+            for (auto it = begin; it != end; ++it) {
+                const uint32_t b = *it;
+                if (AabbManifold(aabbs[a], aabbs[b], event)) {
+                    event.entityA = entityIds[a];
+                    event.entityB = entityIds[b];
+                    if (bodies) {
+                        event.bodyA = (*bodies)[a];
+                        event.bodyB = (*bodies)[b];
+                    }
+                    events.push_back(event);
                 }
             }
         }
-    }
+    });
+    jobs::AppendBatches(m_batchEvents, proxyPlan.batches, jobSystem, outEvents);
 }
 
 }
@@ -0,0 +1,263 @@
+/*
+ * Copyright (C) 2025 aeml
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "physics/ContinuousCollision.hpp"
+
+#include "ecs/World.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace physics
+{
+    namespace
+    {
+        constexpr float kSkin = 1e-4f;
+
+        // Slab test of the segment p0 + t * d, t in [0, 1], against a box.
+        bool SegmentBox(float x0, float y0, float dx, float dy,
+                        float minX, float minY, float maxX, float maxY,
+                        SweepHit& hit) noexcept
+        {
+            float tEnter = -std::numeric_limits<float>::infinity();
+            float tExit = std::numeric_limits<float>::infinity();
+            float nx = 0.0f;
+            float ny = 0.0f;
+
+            auto slab = [&](float origin, float delta, float lo, float hi, bool xAxis)
+            {
+                if (std::fabs(delta) < 1e-12f)
+                {
+                    return origin >= lo && origin <= hi;
+                }
+                float t1 = (lo - origin) / delta;
+                float t2 = (hi - origin) / delta;
+                if (t1 > t2) std::swap(t1, t2);
+                if (t1 > tEnter)
+                {
+                    tEnter = t1;
+                    nx = xAxis ? (delta > 0.0f ? -1.0f : 1.0f) : 0.0f;
+                    ny = xAxis ? 0.0f : (delta > 0.0f ? -1.0f : 1.0f);
+                }
+                tExit = std::min(tExit, t2);
+                return true;
+            };
+
+            if (!slab(x0, dx, minX, maxX, true) || !slab(y0, dy, minY, maxY, false))
+            {
+                return false;
+            }
+            if (tEnter > tExit || tEnter < 0.0f || tEnter > 1.0f)
+            {
+                return false;
+            }
+            hit.t = tEnter;
+            hit.normalX = nx;
+            hit.normalY = ny;
+            return true;
+        }
+
+        // Earliest t in [0, 1] at which p0 + t * d is `radius` from (cx, cy).
+        bool SegmentCircle(float x0, float y0, float dx, float dy, float cx, float cy, float radius, SweepHit& hit) noexcept
+        {
+            const float fx = x0 - cx;
+            const float fy = y0 - cy;
+            const float a = dx * dx + dy * dy;
+            const float b = 2.0f * (fx * dx + fy * dy);
+            const float c = fx * fx + fy * fy - radius * radius;
+            const float disc = b * b - 4.0f * a * c;
+            if (a <= 0.0f || disc < 0.0f)
+            {
+                return false;
+            }
+            const float t = (-b - std::sqrt(disc)) / (2.0f * a);
+            if (t < 0.0f || t > 1.0f)
+            {
+                return false;
+            }
+            const float px = x0 + dx * t - cx;
+            const float py = y0 + dy * t - cy;
+            const float len = std::sqrt(px * px + py * py);
+            hit.t = t;
+            hit.normalX = len > 0.0f ? px / len : 0.0f;
+            hit.normalY = len > 0.0f ? py / len : 0.0f;
+            return true;
+        }
+
+        struct StaticBox
+        {
+            AABBComponent   box;
+            PhysicsMaterial material;
+            std::size_t     proxy;
+        };
+    }
+
+    bool SweepCircleAabb(float x0, float y0, float x1, float y1, float radius,
+                         const AABBComponent& box, SweepHit& hit) noexcept
+    {
+        const float dx = x1 - x0;
+        const float dy = y1 - y0;
+        // The swept shape is the box rounded by the radius: test the expanded
+        // box, then the corner circle if the entry point lies in a corner.
+        SweepHit entry;
+        if (!SegmentBox(x0, y0, dx, dy, box.minX - radius, box.minY - radius, box.maxX + radius, box.maxY + radius, entry))
+        {
+            return false;
+        }
+        const float px = x0 + dx * entry.t;
+        const float py = y0 + dy * entry.t;
+        const bool outsideX = px < box.minX || px > box.maxX;
+        const bool outsideY = py < box.minY || py > box.maxY;
+        if (outsideX && outsideY)
+        {
+            const float cx = px < box.minX ? box.minX : box.maxX;
+            const float cy = py < box.minY ? box.minY : box.maxY;
+            return SegmentCircle(x0, y0, dx, dy, cx, cy, radius, hit);
+        }
+        hit = entry;
+        return true;
+    }
+
+    bool SweepAabbAabb(float x0, float y0, float x1, float y1, float halfW, float halfH,
+                       const AABBComponent& box, SweepHit& hit) noexcept
+    {
+        return SegmentBox(x0, y0, x1 - x0, y1 - y0,
+                          box.minX - halfW, box.minY - halfH, box.maxX + halfW, box.maxY + halfH, hit);
+    }
+
+    ContinuousCollisionStats ClampFastBodiesToStatic(ecs::World& world, const SweepProxies& proxies, float dt,
+                                                     float motionThreshold)
+    {
+        ContinuousCollisionStats stats{};
+        auto* rbStorage = world.GetStorage<RigidBodyComponent>();
+        auto* tfStorage = world.GetStorage<TransformComponent>();
+        auto* aabbStorage = world.GetStorage<AABBComponent>();
+        const auto* materials = std::as_const(world).GetSharedStorage<PhysicsMaterial>();
+        if (!rbStorage || !tfStorage || !proxies.bounds || dt <= 0.0f) return stats;
+
+        auto& bounds = *proxies.bounds;
+        const auto& motion = *proxies.motion;
+        const auto& ids = *proxies.ids;
+        const auto& bodySlots = *proxies.bodies;
+        const auto& transformSlots = *proxies.transforms;
+        auto& bodies = rbStorage->GetData();
+        auto& transforms = tfStorage->GetData();
+        auto materialOf = [&](std::size_t k)
+        {
+            return MaterialOf(bodies[bodySlots[k]], materials ? materials->Get(ids[k]) : nullptr);
+        };
+
+        // Layers only: the static targets never pair with each other.
+        ProxyFilter filter;
+        filter.layers = proxies.layers;
+
+        // Static boxes are gathered only once a fast body turns up.
+        std::vector<StaticBox> statics;
+        bool gathered = false;
+
+        for (std::size_t k = 0; k < bounds.size(); ++k)
+        {
+            if (motion[k] != ProxyMotion::Awake) continue;
+            auto& b = bodies[bodySlots[k]];
+            auto& tf = transforms[transformSlots[k]];
+            auto& box = bounds[k];
+            const float halfW = 0.5f * (box.maxX - box.minX);
+            const float halfH = 0.5f * (box.maxY - box.minY);
+            const float halfSize = std::min(halfW, halfH);
+            if (halfSize <= 0.0f) continue;
+
+            const float dx = tf.x - b.lastX;
+            const float dy = tf.y - b.lastY;
+            const float limit = motionThreshold * halfSize;
+            if (dx * dx + dy * dy <= limit * limit) continue;
+
+            if (!gathered)
+            {
+                gathered = true;
+                for (std::size_t s = 0; s < proxies.boxProxies; ++s)
+                {
+                    if (motion[s] == ProxyMotion::Static)
+                    {
+                        statics.push_back({bounds[s], materialOf(s), s});
+                    }
+                }
+            }
+            if (statics.empty()) break;
+
+            ++stats.sweptBodies;
+            // The bounds are centred on the shape, which may be offset from
+            // the transform.
+            const float x1 = 0.5f * (box.minX + box.maxX);
+            const float y1 = 0.5f * (box.minY + box.maxY);
+            const float x0 = x1 - dx;
+            const float y0 = y1 - dy;
+            const bool circle = k >= proxies.boxProxies;
+            SweepHit first;
+            const StaticBox* firstBox = nullptr;
+            for (const auto& s : statics)
+            {
+                // The broadphase never pairs these, so neither does the sweep.
+                if (filter.Rejects(k, s.proxy)) continue;
+                SweepHit hit;
+                const bool touched = circle ? SweepCircleAabb(x0, y0, x1, y1, halfW, s.box, hit)
+                                            : SweepAabbAabb(x0, y0, x1, y1, halfW, halfH, s.box, hit);
+                if (touched && hit.t < first.t)
+                {
+                    first = hit;
+                    firstBox = &s;
+                }
+            }
+            if (!firstBox) continue;
+
+            ++stats.clampedBodies;
+            const float oldX = tf.x;
+            const float oldY = tf.y;
+            tf.x = b.lastX + dx * first.t + first.normalX * kSkin;
+            tf.y = b.lastY + dy * first.t + first.normalY * kSkin;
+            const float vn = b.vx * first.normalX + b.vy * first.normalY;
+            if (vn < 0.0f)
+            {
+                // The same coefficient a discrete contact with the box would get.
+                const float e = CombineMaterials(materialOf(k), firstBox->material).restitution;
+                b.vx -= (1.0f + e) * vn * first.normalX;
+                b.vy -= (1.0f + e) * vn * first.normalY;
+            }
+            // The velocity pass derives velocity from the pose change, so move
+            // the start pose to keep the reflected velocity.
+            b.lastX = tf.x - b.vx * dt;
+            b.lastY = tf.y - b.vy * dt;
+            rbStorage->MarkChanged(bodySlots[k]);
+            tfStorage->MarkChanged(transformSlots[k]);
+
+            const float shiftX = tf.x - oldX;
+            const float shiftY = tf.y - oldY;
+            box = {box.minX + shiftX, box.minY + shiftY, box.maxX + shiftX, box.maxY + shiftY};
+            if (!circle)
+            {
+                // A dynamic box's own AABB follows its transform, as the proxy pass keeps it.
+                const std::uint32_t shape = (*proxies.shapes)[k];
+                aabbStorage->GetData()[shape] = box;
+                aabbStorage->MarkChanged(shape);
+            }
+        }
+        return stats;
+    }
+}
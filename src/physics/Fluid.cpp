@@ -0,0 +1,528 @@
+/*
+ * Copyright (C) 2025 aeml
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "physics/Fluid.hpp"
+
+#include "jobs/Parallel.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <numbers>
+#include <utility>
+
+namespace physics
+{
+    namespace
+    {
+        constexpr std::uint32_t kNone = 0xFFFFFFFFu;
+
+        template <typename TComponent>
+        std::uint32_t SlotIn(const ecs::ComponentStorage<TComponent>* storage, ecs::EntityId id)
+        {
+            const std::size_t slot = storage ? storage->IndexOf(id) : ecs::ComponentStorage<TComponent>::npos;
+            return slot == ecs::ComponentStorage<TComponent>::npos ? kNone : static_cast<std::uint32_t>(slot);
+        }
+
+        int CellOf(float v, float cell) noexcept
+        {
+            return static_cast<int>(std::floor(v / cell));
+        }
+
+        std::uint32_t HashCell(int x, int y, std::uint32_t mask) noexcept
+        {
+            return ((static_cast<std::uint32_t>(x) * 73856093u) ^ (static_cast<std::uint32_t>(y) * 19349663u)) & mask;
+        }
+
+        // 2D SPH kernels over support h: poly6 for density, the spiky
+        // gradient for pressure. Both are zero from h on, so neighbours
+        // that drift apart during the iterations fade out.
+        struct Kernels
+        {
+            float h, h2, poly6, spiky;
+
+            explicit Kernels(float support) noexcept
+                : h(support)
+                , h2(support * support)
+                , poly6(4.0f / (std::numbers::pi_v<float> * std::pow(support, 8.0f)))
+                , spiky(-30.0f / (std::numbers::pi_v<float> * std::pow(support, 5.0f)))
+            {
+            }
+
+            float Density(float r2) const noexcept
+            {
+                const float d = std::max(h2 - r2, 0.0f);
+                return poly6 * d * d * d;
+            }
+
+            // Gradient of the spiky kernel is (dx, dy) times this.
+            float GradientScale(float r2) const noexcept
+            {
+                const float r = std::sqrt(r2);
+                const float d = std::max(h - r, 0.0f);
+                return r > 0.0f ? spiky * d * d / r : 0.0f;
+            }
+        };
+    }
+
+    void FluidSystem::Update(ecs::World& world, float dt)
+    {
+        if (!std::isfinite(dt) || dt <= 0.0f)
+        {
+            return;
+        }
+        auto* fluidStorage = world.GetStorage<FluidParticleComponent>();
+        auto* tfStorage = world.GetStorage<TransformComponent>();
+        if (!fluidStorage || !tfStorage)
+        {
+            return;
+        }
+        Join(world);
+        GatherObstacles(world);
+
+        const Kernels kernels(m_settings.smoothingRadius);
+        const float spacing = m_settings.restSpacing;
+        const int reach = static_cast<int>(std::ceil(kernels.h / spacing));
+        m_restDensity = 0.0f;
+        for (int ix = -reach; ix <= reach; ++ix)
+        {
+            for (int iy = -reach; iy <= reach; ++iy)
+            {
+                const float x = static_cast<float>(ix) * spacing;
+                const float y = static_cast<float>(iy) * spacing;
+                m_restDensity += kernels.Density(x * x + y * y);
+            }
+        }
+
+        const std::size_t count = m_fluidSlot.size();
+        auto& fluidData = fluidStorage->GetData();
+        auto& tfData = tfStorage->GetData();
+        for (auto* v : {&m_x, &m_y, &m_vx, &m_vy, &m_px, &m_py, &m_lambda, &m_dx, &m_dy})
+        {
+            v->resize(count);
+        }
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            const auto& tf = tfData[m_transformSlot[i]];
+            const auto& particle = fluidData[m_fluidSlot[i]];
+            m_x[i] = tf.x;
+            m_y[i] = tf.y;
+            m_vx[i] = particle.vx;
+            m_vy[i] = particle.vy;
+        }
+
+        const int substeps = std::max(1, m_settings.substeps);
+        const float subDt = dt / static_cast<float>(substeps);
+        for (int s = 0; s < substeps && count > 0; ++s)
+        {
+            Step(world, subDt);
+        }
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            auto& tf = tfData[m_transformSlot[i]];
+            auto& particle = fluidData[m_fluidSlot[i]];
+            tf.x = m_x[i];
+            tf.y = m_y[i];
+            particle.vx = m_vx[i];
+            particle.vy = m_vy[i];
+            tfStorage->MarkChanged(m_transformSlot[i]);
+            fluidStorage->MarkChanged(m_fluidSlot[i]);
+        }
+    }
+
+    void FluidSystem::Join(const ecs::World& world)
+    {
+        const std::uint64_t versions[5] = {world.StructureVersionOf<FluidParticleComponent>(),
+                                           world.StructureVersionOf<TransformComponent>(),
+                                           world.StructureVersionOf<RigidBodyComponent>(),
+                                           world.StructureVersionOf<AABBComponent>(),
+                                           world.StructureVersionOf<CircleColliderComponent>()};
+        if (m_joinWorld == &world && std::equal(std::begin(versions), std::end(versions), std::begin(m_joinVersions)))
+        {
+            return;
+        }
+        m_joinWorld = &world;
+        std::copy(std::begin(versions), std::end(versions), std::begin(m_joinVersions));
+
+        const auto* fluidStorage = world.GetStorage<FluidParticleComponent>();
+        const auto* tfStorage = world.GetStorage<TransformComponent>();
+        const auto* rbStorage = world.GetStorage<RigidBodyComponent>();
+        const auto* aabbStorage = world.GetStorage<AABBComponent>();
+        const auto* circleStorage = world.GetStorage<CircleColliderComponent>();
+
+        m_fluidSlot.clear();
+        m_transformSlot.clear();
+        const auto& particles = fluidStorage->GetEntities();
+        for (std::size_t slot = 0; slot < particles.size(); ++slot)
+        {
+            const std::uint32_t tf = SlotIn(tfStorage, particles[slot]);
+            if (tf == kNone) continue;
+            m_fluidSlot.push_back(static_cast<std::uint32_t>(slot));
+            m_transformSlot.push_back(tf);
+        }
+
+        for (auto& slots : m_wallSlots) slots.clear();
+        if (aabbStorage)
+        {
+            const auto& boxes = aabbStorage->GetEntities();
+            for (std::size_t slot = 0; slot < boxes.size(); ++slot)
+            {
+                m_wallSlots[0].push_back(static_cast<std::uint32_t>(slot));
+                m_wallSlots[1].push_back(SlotIn(rbStorage, boxes[slot]));
+            }
+        }
+
+        for (auto& slots : m_circleSlots) slots.clear();
+        if (circleStorage)
+        {
+            const auto& circles = circleStorage->GetEntities();
+            for (std::size_t slot = 0; slot < circles.size(); ++slot)
+            {
+                const std::uint32_t tf = SlotIn(tfStorage, circles[slot]);
+                if (tf == kNone) continue;
+                m_circleSlots[0].push_back(static_cast<std::uint32_t>(slot));
+                m_circleSlots[1].push_back(tf);
+                m_circleSlots[2].push_back(SlotIn(rbStorage, circles[slot]));
+            }
+        }
+    }
+
+    void FluidSystem::GatherObstacles(const ecs::World& world)
+    {
+        const auto* tfStorage = world.GetStorage<TransformComponent>();
+        const auto* rbStorage = world.GetStorage<RigidBodyComponent>();
+        const auto* aabbStorage = world.GetStorage<AABBComponent>();
+        const auto* circleStorage = world.GetStorage<CircleColliderComponent>();
+
+        // Dynamic boxes are left to the rigid body solver.
+        m_walls.clear();
+        for (std::size_t k = 0; k < m_wallSlots[0].size(); ++k)
+        {
+            const std::uint32_t body = m_wallSlots[1][k];
+            if (body != kNone && rbStorage->GetData()[body].invMass > 0.0f) continue;
+            m_walls.push_back(aabbStorage->GetData()[m_wallSlots[0][k]]);
+        }
+
+        m_circles.clear();
+        for (std::size_t k = 0; k < m_circleSlots[0].size(); ++k)
+        {
+            const auto& circle = circleStorage->GetData()[m_circleSlots[0][k]];
+            const auto& tf = tfStorage->GetData()[m_circleSlots[1][k]];
+            const std::uint32_t body = m_circleSlots[2][k];
+            const float invMass = body != kNone ? rbStorage->GetData()[body].invMass : 0.0f;
+            m_circles.push_back({tf.x + circle.offsetX, tf.y + circle.offsetY, std::max(circle.radius, 0.0f),
+                                 invMass, body});
+        }
+    }
+
+    void FluidSystem::Step(ecs::World& world, float dt)
+    {
+        const std::size_t count = m_x.size();
+        const Kernels kernels(m_settings.smoothingRadius);
+        const float invRest = 1.0f / m_restDensity;
+        const float gravity = m_settings.gravityY;
+        const float relaxation = m_settings.relaxation;
+        const float particleRadius = 0.5f * m_settings.restSpacing;
+        const jobs::BatchPlan plan = jobs::PlanBatches(count, 1024, m_jobSystem);
+
+        // 1. Predict positions.
+        jobs::ForEachBatch(plan, m_jobSystem, [&](std::size_t, std::size_t begin, std::size_t end)
+        {
+            for (std::size_t i = begin; i < end; ++i)
+            {
+                m_vy[i] += gravity * dt;
+                m_px[i] = m_x[i] + m_vx[i] * dt;
+                m_py[i] = m_y[i] + m_vy[i] * dt;
+            }
+        });
+
+        // 2. Neighbours of the predicted positions, kept for the substep.
+        BuildNeighbours();
+
+        // 3. Density constraints, one Jacobi step per iteration: every
+        //    particle's multiplier, then every particle's move, then the
+        //    moves are applied and the walls pushed back.
+        auto forNeighbours = [&](std::size_t i, auto&& fn)
+        {
+            const std::uint32_t* list = m_neighbours.data() + i * kMaxNeighbours;
+            for (std::uint32_t k = 0; k < m_neighbourCount[i]; ++k)
+            {
+                const std::uint32_t j = list[k];
+                fn(j, m_px[i] - m_px[j], m_py[i] - m_py[j]);
+            }
+        };
+        for (int iteration = 0; iteration < std::max(1, m_settings.iterations); ++iteration)
+        {
+            jobs::ForEachBatch(plan, m_jobSystem, [&](std::size_t, std::size_t begin, std::size_t end)
+            {
+                for (std::size_t i = begin; i < end; ++i)
+                {
+                    float density = kernels.Density(0.0f);
+                    float gradX = 0.0f;
+                    float gradY = 0.0f;
+                    float gradSq = 0.0f;
+                    forNeighbours(i, [&](std::uint32_t, float dx, float dy)
+                    {
+                        const float r2 = dx * dx + dy * dy;
+                        density += kernels.Density(r2);
+                        const float g = kernels.GradientScale(r2) * invRest;
+                        gradX += g * dx;
+                        gradY += g * dy;
+                        gradSq += g * g * r2;
+                    });
+                    // Only compression is corrected, so particles never
+                    // pull each other into clumps.
+                    const float constraint = std::max(density * invRest - 1.0f, 0.0f);
+                    m_lambda[i] = -constraint / (gradX * gradX + gradY * gradY + gradSq + relaxation);
+                }
+            });
+            jobs::ForEachBatch(plan, m_jobSystem, [&](std::size_t, std::size_t begin, std::size_t end)
+            {
+                for (std::size_t i = begin; i < end; ++i)
+                {
+                    float moveX = 0.0f;
+                    float moveY = 0.0f;
+                    forNeighbours(i, [&](std::uint32_t j, float dx, float dy)
+                    {
+                        const float g = (m_lambda[i] + m_lambda[j]) * kernels.GradientScale(dx * dx + dy * dy);
+                        moveX += g * dx;
+                        moveY += g * dy;
+                    });
+                    m_dx[i] = moveX * invRest;
+                    m_dy[i] = moveY * invRest;
+                }
+            });
+            jobs::ForEachBatch(plan, m_jobSystem, [&](std::size_t, std::size_t begin, std::size_t end)
+            {
+                for (std::size_t i = begin; i < end; ++i)
+                {
+                    float x = m_px[i] + m_dx[i];
+                    float y = m_py[i] + m_dy[i];
+                    // Out of each wall through its nearest face.
+                    for (const auto& wall : m_walls)
+                    {
+                        const float left = x - (wall.minX - particleRadius);
+                        const float right = (wall.maxX + particleRadius) - x;
+                        const float bottom = y - (wall.minY - particleRadius);
+                        const float top = (wall.maxY + particleRadius) - y;
+                        if (left <= 0.0f || right <= 0.0f || bottom <= 0.0f || top <= 0.0f) continue;
+                        const float nearest = std::min({left, right, bottom, top});
+                        if (nearest == left) x -= left;
+                        else if (nearest == right) x += right;
+                        else if (nearest == bottom) y -= bottom;
+                        else y += top;
+                    }
+                    m_px[i] = x;
+                    m_py[i] = y;
+                }
+            });
+        }
+
+        // 4. Rigid circles, serially so their impulses add up in order.
+        PushOutOfCircles(world, dt);
+
+        // 5. Velocities from the moves, XSPH-smoothed towards the
+        //    neighbours' mean; the smoothing reads the unsmoothed values
+        //    kept in m_dx/m_dy.
+        const float invDt = 1.0f / dt;
+        jobs::ForEachBatch(plan, m_jobSystem, [&](std::size_t, std::size_t begin, std::size_t end)
+        {
+            for (std::size_t i = begin; i < end; ++i)
+            {
+                m_dx[i] = (m_px[i] - m_x[i]) * invDt;
+                m_dy[i] = (m_py[i] - m_y[i]) * invDt;
+            }
+        });
+        const float viscosity = m_settings.viscosity * invRest;
+        jobs::ForEachBatch(plan, m_jobSystem, [&](std::size_t, std::size_t begin, std::size_t end)
+        {
+            for (std::size_t i = begin; i < end; ++i)
+            {
+                float smoothX = 0.0f;
+                float smoothY = 0.0f;
+                forNeighbours(i, [&](std::uint32_t j, float dx, float dy)
+                {
+                    const float w = kernels.Density(dx * dx + dy * dy);
+                    smoothX += (m_dx[j] - m_dx[i]) * w;
+                    smoothY += (m_dy[j] - m_dy[i]) * w;
+                });
+                m_vx[i] = m_dx[i] + viscosity * smoothX;
+                m_vy[i] = m_dy[i] + viscosity * smoothY;
+                m_x[i] = m_px[i];
+                m_y[i] = m_py[i];
+            }
+        });
+    }
+
+    void FluidSystem::BuildNeighbours()
+    {
+        const std::size_t count = m_px.size();
+        const float cell = m_settings.smoothingRadius;
+        const float h2 = cell * cell;
+        std::size_t buckets = 16;
+        while (buckets < 2 * count) buckets *= 2;
+        const auto mask = static_cast<std::uint32_t>(buckets - 1);
+        const jobs::BatchPlan plan = jobs::PlanBatches(count, 1024, m_jobSystem);
+
+        // Counting sort by hashed cell: histogram, prefix scan, scatter. The
+        // scatter order inside a bucket depends on thread timing, so each
+        // bucket is then sorted by particle index.
+        m_cellOf.resize(count);
+        m_bucketStart.assign(buckets + 1, 0);
+        jobs::ForEachBatch(plan, m_jobSystem, [&](std::size_t, std::size_t begin, std::size_t end)
+        {
+            for (std::size_t i = begin; i < end; ++i)
+            {
+                m_cellOf[i] = HashCell(CellOf(m_px[i], cell), CellOf(m_py[i], cell), mask);
+                std::atomic_ref<std::uint32_t>(m_bucketStart[m_cellOf[i]]).fetch_add(1, std::memory_order_relaxed);
+            }
+        });
+        jobs::ExclusiveScan(m_bucketStart, m_jobSystem, m_scanScratch);
+        m_bucketCursor.assign(m_bucketStart.begin(), m_bucketStart.end() - 1);
+        m_bucketParticles.resize(count);
+        jobs::ForEachBatch(plan, m_jobSystem, [&](std::size_t, std::size_t begin, std::size_t end)
+        {
+            for (std::size_t i = begin; i < end; ++i)
+            {
+                const std::uint32_t slot = std::atomic_ref<std::uint32_t>(m_bucketCursor[m_cellOf[i]])
+                                               .fetch_add(1, std::memory_order_relaxed);
+                m_bucketParticles[slot] = static_cast<std::uint32_t>(i);
+            }
+        });
+        const jobs::BatchPlan bucketPlan = jobs::PlanBatches(buckets, 4096, m_jobSystem);
+        jobs::ForEachBatch(bucketPlan, m_jobSystem, [&](std::size_t, std::size_t begin, std::size_t end)
+        {
+            for (std::size_t b = begin; b < end; ++b)
+            {
+                std::sort(m_bucketParticles.begin() + m_bucketStart[b], m_bucketParticles.begin() + m_bucketStart[b + 1]);
+            }
+        });
+
+        // Each particle scans the 3x3 cells around it; cells that hash to
+        // a bucket already scanned are skipped.
+        m_neighbourCount.resize(count);
+        m_neighbours.resize(count * kMaxNeighbours);
+        m_batchNeighbours.assign(plan.batches, 0);
+        jobs::ForEachBatch(plan, m_jobSystem, [&](std::size_t batch, std::size_t begin, std::size_t end)
+        {
+            std::uint32_t total = 0;
+            for (std::size_t i = begin; i < end; ++i)
+            {
+                const float x = m_px[i];
+                const float y = m_py[i];
+                const int cx = CellOf(x, cell);
+                const int cy = CellOf(y, cell);
+                std::array<std::uint32_t, 9> seen{};
+                std::size_t seenCount = 0;
+                std::uint32_t* list = m_neighbours.data() + i * kMaxNeighbours;
+                std::uint32_t found = 0;
+                for (int oy = -1; oy <= 1; ++oy)
+                {
+                    for (int ox = -1; ox <= 1; ++ox)
+                    {
+                        const std::uint32_t bucket = HashCell(cx + ox, cy + oy, mask);
+                        if (std::find(seen.begin(), seen.begin() + static_cast<std::ptrdiff_t>(seenCount), bucket)
+                            != seen.begin() + static_cast<std::ptrdiff_t>(seenCount)) continue;
+                        seen[seenCount++] = bucket;
+                        for (std::uint32_t k = m_bucketStart[bucket]; k < m_bucketStart[bucket + 1]; ++k)
+                        {
+                            const std::uint32_t j = m_bucketParticles[k];
+                            const float dx = m_px[j] - x;
+                            const float dy = m_py[j] - y;
+                            if (j == i || dx * dx + dy * dy >= h2 || found == kMaxNeighbours) continue;
+                            list[found++] = j;
+                        }
+                    }
+                }
+                m_neighbourCount[i] = found;
+                total += found;
+            }
+            m_batchNeighbours[batch] = total;
+        });
+        m_neighbourTotal = 0;
+        for (const std::uint32_t n : m_batchNeighbours) m_neighbourTotal += n;
+    }
+
+    void FluidSystem::PushOutOfCircles(ecs::World& world, float dt)
+    {
+        if (m_circles.empty())
+        {
+            return;
+        }
+        auto* rbStorage = world.GetStorage<RigidBodyComponent>();
+        const float cell = m_settings.smoothingRadius;
+        const float particleRadius = 0.5f * m_settings.restSpacing;
+        const auto mask = static_cast<std::uint32_t>(m_bucketStart.size() - 2);
+        std::vector<std::uint32_t> buckets;
+        for (const Circle& circle : m_circles)
+        {
+            // Cells the circle covers, one cell wider for particles that
+            // moved since the grid was built.
+            const float reach = circle.radius + particleRadius;
+            const int minX = CellOf(circle.x - reach, cell) - 1;
+            const int maxX = CellOf(circle.x + reach, cell) + 1;
+            const int minY = CellOf(circle.y - reach, cell) - 1;
+            const int maxY = CellOf(circle.y + reach, cell) + 1;
+            buckets.clear();
+            for (int y = minY; y <= maxY; ++y)
+            {
+                for (int x = minX; x <= maxX; ++x)
+                {
+                    buckets.push_back(HashCell(x, y, mask));
+                }
+            }
+            std::sort(buckets.begin(), buckets.end());
+            buckets.erase(std::unique(buckets.begin(), buckets.end()), buckets.end());
+
+            float pushX = 0.0f;
+            float pushY = 0.0f;
+            for (const std::uint32_t bucket : buckets)
+            {
+                for (std::uint32_t k = m_bucketStart[bucket]; k < m_bucketStart[bucket + 1]; ++k)
+                {
+                    const std::uint32_t i = m_bucketParticles[k];
+                    const float dx = m_px[i] - circle.x;
+                    const float dy = m_py[i] - circle.y;
+                    const float distSq = dx * dx + dy * dy;
+                    if (distSq >= reach * reach) continue;
+                    const float dist = std::sqrt(distSq);
+                    const float nx = dist > 1e-6f ? dx / dist : 0.0f;
+                    const float ny = dist > 1e-6f ? dy / dist : 1.0f;
+                    const float moveX = circle.x + nx * reach - m_px[i];
+                    const float moveY = circle.y + ny * reach - m_py[i];
+                    m_px[i] += moveX;
+                    m_py[i] += moveY;
+                    pushX += moveX;
+                    pushY += moveY;
+                }
+            }
+
+            // The body takes the momentum the particles gained.
+            if (circle.invMass > 0.0f && (pushX != 0.0f || pushY != 0.0f))
+            {
+                auto& body = rbStorage->GetData()[circle.body];
+                const float scale = m_settings.particleMass * circle.invMass / dt;
+                body.vx -= pushX * scale;
+                body.vy -= pushY * scale;
+                WakeBody(body);
+                rbStorage->MarkChanged(circle.body);
+            }
+        }
+    }
+}
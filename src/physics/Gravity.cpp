@@ -0,0 +1,397 @@
+/*
+ * Copyright (C) 2025 aeml
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "physics/Gravity.hpp"
+
+#include "jobs/Parallel.hpp"
+#include "physics/Components.hpp"
+#include "physics/SpatialSort.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+namespace physics
+{
+    namespace
+    {
+        // Morton codes use this many bits per axis, which also bounds the
+        // tree depth.
+        constexpr int kLevels = 16;
+
+        // Quadrant of a key at `level`: bit 0 is x, bit 1 is y.
+        std::uint32_t QuadrantOf(std::uint64_t key, int level) noexcept
+        {
+            return static_cast<std::uint32_t>(key >> (32 + 2 * (kLevels - 1 - level))) & 3u;
+        }
+
+        // Adds the softened pull of mass m at offset (dx, dy); nothing when
+        // the offset and softening are both zero. Written as a select so
+        // the lane loop below has no branches.
+        inline void Accumulate(float dx, float dy, float m, float softeningSq, float& ax, float& ay) noexcept
+        {
+            const float r2 = dx * dx + dy * dy + softeningSq;
+            const float root = std::sqrt(r2);
+            const float scale = r2 > 0.0f ? m / (r2 * root) : 0.0f;
+            ax += dx * scale;
+            ay += dy * scale;
+        }
+
+        // Bodies of one leaf handled together, in local arrays like the
+        // narrowphase lanes.
+        constexpr std::size_t kLanes = 8;
+        using Lanes = std::array<float, kLanes>;
+
+        // Sums the pull of every source on each lane, sources in order. Each
+        // lane has its own sums, so this vectorizes across lanes without
+        // changing any lane's summation order.
+        void AccumulateLanes(const Lanes& px, const Lanes& py, const std::vector<float>& sourceX,
+                             const std::vector<float>& sourceY, const std::vector<float>& sourceMass,
+                             float softeningSq, Lanes& sumX, Lanes& sumY) noexcept
+        {
+            for (std::size_t e = 0; e < sourceMass.size(); ++e)
+            {
+                const float ex = sourceX[e];
+                const float ey = sourceY[e];
+                const float em = sourceMass[e];
+                for (std::size_t k = 0; k < kLanes; ++k)
+                {
+                    Accumulate(ex - px[k], ey - py[k], em, softeningSq, sumX[k], sumY[k]);
+                }
+            }
+        }
+    }
+
+    void GravityBodies::Clear() noexcept
+    {
+        x.clear();
+        y.clear();
+        mass.clear();
+    }
+
+    void GravityBodies::Push(float px, float py, float pmass)
+    {
+        x.push_back(px);
+        y.push_back(py);
+        mass.push_back(pmass);
+    }
+
+    void GravitySolver::Accelerations(const GravityBodies& bodies, const GravitySettings& settings,
+                                      jobs::JobSystem* jobSystem, std::vector<float>& ax, std::vector<float>& ay)
+    {
+        const std::size_t count = bodies.Size();
+        ax.assign(count, 0.0f);
+        ay.assign(count, 0.0f);
+        m_nodes.clear();
+        m_leaves.clear();
+        if (count < 2)
+        {
+            return;
+        }
+        const float g = settings.gravitationalConstant;
+        const float softeningSq = settings.softening * settings.softening;
+        const float* x = bodies.x.data();
+        const float* y = bodies.y.data();
+        const float* mass = bodies.mass.data();
+
+        if (settings.method == GravityMethod::Direct)
+        {
+            const jobs::BatchPlan plan = jobs::PlanBatches(count, 64, jobSystem);
+            jobs::ForEachBatch(plan, jobSystem, [&](std::size_t, std::size_t begin, std::size_t end)
+            {
+                for (std::size_t i = begin; i < end; ++i)
+                {
+                    float sumX = 0.0f;
+                    float sumY = 0.0f;
+                    for (std::size_t j = 0; j < count; ++j)
+                    {
+                        if (j == i || mass[j] == 0.0f) continue;
+                        Accumulate(x[j] - x[i], y[j] - y[i], mass[j], softeningSq, sumX, sumY);
+                    }
+                    ax[i] = g * sumX;
+                    ay[i] = g * sumY;
+                }
+            });
+            return;
+        }
+
+        BuildTree(bodies, std::max<std::size_t>(1, settings.leafSize), jobSystem);
+        const float thetaSq = settings.openingAngle * settings.openingAngle;
+        const Node* nodes = m_nodes.data();
+        const std::uint32_t* order = m_order.data();
+
+        // Each leaf walks the tree once for all of its bodies: a cell is
+        // taken whole only if it passes the opening test from every point of
+        // the leaf's bounding box, which is stricter than testing each body.
+        // The walk lists the sources in tree order and every body of the
+        // leaf sums that same list.
+        const jobs::BatchPlan plan = jobs::PlanBatches(m_leaves.size(), 32, jobSystem);
+        jobs::ForEachBatch(plan, jobSystem, [&](std::size_t, std::size_t begin, std::size_t end)
+        {
+            // Depth-first, at most three siblings wait per level.
+            std::array<std::uint32_t, 4 * (kLevels + 2)> stack;
+            std::vector<float> sourceX, sourceY, sourceMass;
+            for (std::size_t l = begin; l < end; ++l)
+            {
+                const Node& leaf = nodes[m_leaves[l]];
+                float boxMinX = std::numeric_limits<float>::max();
+                float boxMinY = std::numeric_limits<float>::max();
+                float boxMaxX = std::numeric_limits<float>::lowest();
+                float boxMaxY = std::numeric_limits<float>::lowest();
+                for (std::uint32_t s = leaf.begin; s < leaf.end; ++s)
+                {
+                    boxMinX = std::min(boxMinX, x[order[s]]);
+                    boxMinY = std::min(boxMinY, y[order[s]]);
+                    boxMaxX = std::max(boxMaxX, x[order[s]]);
+                    boxMaxY = std::max(boxMaxY, y[order[s]]);
+                }
+
+                sourceX.clear();
+                sourceY.clear();
+                sourceMass.clear();
+                std::size_t top = 0;
+                stack[top++] = 0;
+                while (top > 0)
+                {
+                    const Node& node = nodes[stack[--top]];
+                    if (node.mass == 0.0f) continue;
+                    if (node.children == 0)
+                    {
+                        // Includes the leaf's own bodies; a body's pull on
+                        // itself is zero.
+                        for (std::uint32_t k = node.begin; k < node.end; ++k)
+                        {
+                            const std::uint32_t j = order[k];
+                            sourceX.push_back(x[j]);
+                            sourceY.push_back(y[j]);
+                            sourceMass.push_back(mass[j]);
+                        }
+                        continue;
+                    }
+                    const float dx = std::max({boxMinX - node.comX, 0.0f, node.comX - boxMaxX});
+                    const float dy = std::max({boxMinY - node.comY, 0.0f, node.comY - boxMaxY});
+                    if (node.width * node.width < thetaSq * (dx * dx + dy * dy))
+                    {
+                        sourceX.push_back(node.comX);
+                        sourceY.push_back(node.comY);
+                        sourceMass.push_back(node.mass);
+                        continue;
+                    }
+                    // Pushed last to first so the first child is listed first.
+                    for (std::uint32_t c = node.children; c-- > 0;)
+                    {
+                        stack[top++] = node.firstChild + c;
+                    }
+                }
+
+                // Lanes past the leaf's bodies compute on zeros and are not
+                // stored.
+                for (std::uint32_t base = leaf.begin; base < leaf.end; base += kLanes)
+                {
+                    const std::size_t lanes = std::min<std::size_t>(kLanes, leaf.end - base);
+                    Lanes px{}, py{}, sumX{}, sumY{};
+                    for (std::size_t k = 0; k < lanes; ++k)
+                    {
+                        px[k] = x[order[base + k]];
+                        py[k] = y[order[base + k]];
+                    }
+                    AccumulateLanes(px, py, sourceX, sourceY, sourceMass, softeningSq, sumX, sumY);
+                    for (std::size_t k = 0; k < lanes; ++k)
+                    {
+                        ax[order[base + k]] = g * sumX[k];
+                        ay[order[base + k]] = g * sumY[k];
+                    }
+                }
+            }
+        });
+    }
+
+    void GravitySolver::BuildTree(const GravityBodies& bodies, std::size_t leafSize, jobs::JobSystem* jobSystem)
+    {
+        const std::size_t count = bodies.Size();
+        float minX = std::numeric_limits<float>::max();
+        float minY = std::numeric_limits<float>::max();
+        float maxX = std::numeric_limits<float>::lowest();
+        float maxY = std::numeric_limits<float>::lowest();
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            minX = std::min(minX, bodies.x[i]);
+            minY = std::min(minY, bodies.y[i]);
+            maxX = std::max(maxX, bodies.x[i]);
+            maxY = std::max(maxY, bodies.y[i]);
+        }
+        // The root is a square a little larger than the bodies' bounds, so
+        // the largest coordinate still maps inside the last cell.
+        const float width = std::max({maxX - minX, maxY - minY, 1e-6f}) * 1.0001f;
+        const float cells = static_cast<float>(1u << kLevels);
+        const float scale = cells / width;
+
+        m_keys.resize(count);
+        const jobs::BatchPlan plan = jobs::PlanBatches(count, 4096, jobSystem);
+        jobs::ForEachBatch(plan, jobSystem, [&](std::size_t, std::size_t begin, std::size_t end)
+        {
+            for (std::size_t i = begin; i < end; ++i)
+            {
+                const float fx = std::min((bodies.x[i] - minX) * scale, cells - 1.0f);
+                const float fy = std::min((bodies.y[i] - minY) * scale, cells - 1.0f);
+                const std::uint32_t code = MortonCode(static_cast<std::uint32_t>(fx), static_cast<std::uint32_t>(fy));
+                m_keys[i] = (static_cast<std::uint64_t>(code) << 32) | static_cast<std::uint64_t>(i);
+            }
+        });
+        // Keys are unique, so the order does not depend on the sort.
+        std::sort(m_keys.begin(), m_keys.end());
+        m_order.resize(count);
+        for (std::size_t s = 0; s < count; ++s)
+        {
+            m_order[s] = static_cast<std::uint32_t>(m_keys[s]);
+        }
+
+        Node root{};
+        root.minX = minX;
+        root.minY = minY;
+        root.width = width;
+        root.begin = 0;
+        root.end = static_cast<std::uint32_t>(count);
+        m_nodes.push_back(root);
+        m_leaves.clear();
+        BuildNode(bodies, leafSize, 0, 0);
+    }
+
+    void GravitySolver::BuildNode(const GravityBodies& bodies, std::size_t leafSize, std::uint32_t node, int level)
+    {
+        const std::uint32_t begin = m_nodes[node].begin;
+        const std::uint32_t end = m_nodes[node].end;
+        float mass = 0.0f;
+        float sumX = 0.0f;
+        float sumY = 0.0f;
+
+        if (end - begin <= leafSize || level == kLevels)
+        {
+            m_leaves.push_back(node);
+            for (std::uint32_t s = begin; s < end; ++s)
+            {
+                const std::uint32_t i = m_order[s];
+                mass += bodies.mass[i];
+                sumX += bodies.x[i] * bodies.mass[i];
+                sumY += bodies.y[i] * bodies.mass[i];
+            }
+        }
+        else
+        {
+            // Bodies are sorted by key, so each quadrant is one run.
+            std::array<std::uint32_t, 5> split{};
+            split[0] = begin;
+            for (std::uint32_t q = 0; q < 4; ++q)
+            {
+                std::uint32_t s = split[q];
+                while (s < end && QuadrantOf(m_keys[s], level) == q) ++s;
+                split[q + 1] = s;
+            }
+            const float half = 0.5f * m_nodes[node].width;
+            const auto firstChild = static_cast<std::uint32_t>(m_nodes.size());
+            std::uint32_t children = 0;
+            for (std::uint32_t q = 0; q < 4; ++q)
+            {
+                if (split[q] == split[q + 1]) continue;
+                Node child{};
+                child.minX = m_nodes[node].minX + ((q & 1u) ? half : 0.0f);
+                child.minY = m_nodes[node].minY + ((q & 2u) ? half : 0.0f);
+                child.width = half;
+                child.begin = split[q];
+                child.end = split[q + 1];
+                m_nodes.push_back(child);
+                ++children;
+            }
+            m_nodes[node].firstChild = firstChild;
+            m_nodes[node].children = children;
+            for (std::uint32_t c = 0; c < children; ++c)
+            {
+                BuildNode(bodies, leafSize, firstChild + c, level + 1);
+                const Node& child = m_nodes[firstChild + c];
+                mass += child.mass;
+                sumX += child.comX * child.mass;
+                sumY += child.comY * child.mass;
+            }
+        }
+
+        Node& n = m_nodes[node];
+        n.mass = mass;
+        n.comX = mass > 0.0f ? sumX / mass : n.minX + 0.5f * n.width;
+        n.comY = mass > 0.0f ? sumY / mass : n.minY + 0.5f * n.width;
+    }
+
+    void GravitySystem::Update(ecs::World& world, float dt)
+    {
+        if (!std::isfinite(dt) || dt <= 0.0f)
+        {
+            return;
+        }
+        auto* rbStorage = world.GetStorage<RigidBodyComponent>();
+        const auto* tfStorage = std::as_const(world).GetStorage<TransformComponent>();
+        if (!rbStorage || !tfStorage)
+        {
+            return;
+        }
+
+        // Join rigid bodies to their transforms once per structural change.
+        const std::uint64_t versions[2] = {world.StructureVersionOf<RigidBodyComponent>(),
+                                           world.StructureVersionOf<TransformComponent>()};
+        if (m_joinWorld != &world || versions[0] != m_joinVersions[0] || versions[1] != m_joinVersions[1])
+        {
+            m_bodySlot.clear();
+            m_transformSlot.clear();
+            const auto& entities = rbStorage->GetEntities();
+            for (std::size_t slot = 0; slot < entities.size(); ++slot)
+            {
+                const std::size_t tf = tfStorage->IndexOf(entities[slot]);
+                if (tf == ecs::ComponentStorage<TransformComponent>::npos) continue;
+                m_bodySlot.push_back(static_cast<std::uint32_t>(slot));
+                m_transformSlot.push_back(static_cast<std::uint32_t>(tf));
+            }
+            m_joinWorld = &world;
+            m_joinVersions[0] = versions[0];
+            m_joinVersions[1] = versions[1];
+        }
+
+        auto& rbData = rbStorage->GetData();
+        const auto& tfData = tfStorage->GetData();
+        const std::size_t count = m_bodySlot.size();
+        m_bodies.x.resize(count);
+        m_bodies.y.resize(count);
+        m_bodies.mass.resize(count);
+        for (std::size_t k = 0; k < count; ++k)
+        {
+            const auto& tf = tfData[m_transformSlot[k]];
+            const auto& rb = rbData[m_bodySlot[k]];
+            m_bodies.x[k] = tf.x;
+            m_bodies.y[k] = tf.y;
+            m_bodies.mass[k] = std::max(rb.mass, 0.0f);
+        }
+
+        m_solver.Accelerations(m_bodies, m_settings, m_jobSystem, m_ax, m_ay);
+        for (std::size_t k = 0; k < count; ++k)
+        {
+            auto& rb = rbData[m_bodySlot[k]];
+            if (rb.invMass <= 0.0f || rb.asleep || (m_ax[k] == 0.0f && m_ay[k] == 0.0f)) continue;
+            rb.vx += m_ax[k] * dt;
+            rb.vy += m_ay[k] * dt;
+            rbStorage->MarkChanged(m_bodySlot[k]);
+        }
+    }
+}
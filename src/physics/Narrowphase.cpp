@@ -0,0 +1,237 @@
+/*
+ * Copyright (C) 2025 aeml
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "physics/Narrowphase.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace physics
+{
+    namespace
+    {
+        constexpr float kContactEpsilon = 1e-6f;
+
+        // One lane of each kernel. Every value is computed on both sides of
+        // each test and picked afterwards, so a block of lanes has no
+        // branches; a square root of 1 stands in where the distance is unused.
+
+        inline std::uint32_t CircleCircleLane(float ax, float ay, float radiusA, float bx, float by, float radiusB,
+                                              float& nx, float& ny, float& penetration) noexcept
+        {
+            const float dx = bx - ax;
+            const float dy = by - ay;
+            const float radii = (radiusA > 0.0f ? radiusA : 0.0f) + (radiusB > 0.0f ? radiusB : 0.0f);
+            const float distSq = dx * dx + dy * dy;
+            // Coincident centres get an arbitrary normal.
+            const bool coincident = distSq <= kContactEpsilon;
+            const float dist = std::sqrt(coincident ? 1.0f : distSq);
+            const float ux = dx / dist;
+            const float uy = dy / dist;
+            nx = coincident ? 0.0f : ux;
+            ny = coincident ? 1.0f : uy;
+            penetration = coincident ? radii : radii - dist;
+            return static_cast<std::uint32_t>((radii > 0.0f) & (coincident | (dist < radii)));
+        }
+
+        inline std::uint32_t CircleAabbLane(float cx, float cy, float radius, float minX, float minY, float maxX,
+                                            float maxY, float& nx, float& ny, float& penetration) noexcept
+        {
+            const bool positive = radius > 0.0f;
+            const float closestX = cx < minX ? minX : (maxX < cx ? maxX : cx);
+            const float closestY = cy < minY ? minY : (maxY < cy ? maxY : cy);
+            const float dx = closestX - cx;
+            const float dy = closestY - cy;
+            const float distSq = dx * dx + dy * dy;
+            const bool reaches = distSq <= radius * radius + kContactEpsilon;
+            const bool outside = distSq > kContactEpsilon;
+            const float dist = std::sqrt(outside ? distSq : 1.0f);
+
+            // Centre inside the box: push out through the closest face, in
+            // the order left, right, bottom, top on ties.
+            const float left = cx - minX;
+            const float right = maxX - cx;
+            const float bottom = cy - minY;
+            const float top = maxY - cy;
+            float face = left;
+            float faceX = 1.0f;
+            float faceY = 0.0f;
+            faceX = right < face ? -1.0f : faceX;
+            face = right < face ? right : face;
+            faceY = bottom < face ? 1.0f : faceY;
+            faceX = bottom < face ? 0.0f : faceX;
+            face = bottom < face ? bottom : face;
+            faceY = top < face ? -1.0f : faceY;
+            faceX = top < face ? 0.0f : faceX;
+            face = top < face ? top : face;
+
+            const float ux = dx / dist;
+            const float uy = dy / dist;
+            nx = outside ? ux : faceX;
+            ny = outside ? uy : faceY;
+            penetration = outside ? radius - dist : radius + face;
+            return static_cast<std::uint32_t>(positive & reaches & (!outside | (penetration > 0.0f)));
+        }
+
+        // A block of lanes lives in local arrays, which the compiler knows
+        // alias nothing else.
+        using Lanes = std::array<float, kNarrowphaseLanes>;
+        using Mask = std::array<std::uint32_t, kNarrowphaseLanes>;
+
+        template <typename T>
+        void Load(const std::vector<T>& from, std::size_t base, std::size_t lanes,
+                  std::array<T, kNarrowphaseLanes>& to) noexcept
+        {
+            std::copy(from.begin() + static_cast<std::ptrdiff_t>(base),
+                      from.begin() + static_cast<std::ptrdiff_t>(base + lanes), to.begin());
+        }
+
+        template <typename T, typename U>
+        void Store(const std::array<T, kNarrowphaseLanes>& from, std::size_t base, std::size_t lanes,
+                   std::vector<U>& to) noexcept
+        {
+            for (std::size_t k = 0; k < lanes; ++k)
+            {
+                to[base + k] = static_cast<U>(from[k]);
+            }
+        }
+
+        void Resize(ManifoldBatch& out, std::size_t count)
+        {
+            out.nx.resize(count);
+            out.ny.resize(count);
+            out.penetration.resize(count);
+            out.hit.resize(count);
+        }
+    }
+
+    bool CircleCircleManifold(float ax, float ay, float radiusA, float bx, float by, float radiusB,
+                              float& nx, float& ny, float& penetration) noexcept
+    {
+        return CircleCircleLane(ax, ay, radiusA, bx, by, radiusB, nx, ny, penetration) != 0;
+    }
+
+    bool CircleAabbManifold(float cx, float cy, float radius, const AABBComponent& box,
+                            float& nx, float& ny, float& penetration) noexcept
+    {
+        return CircleAabbLane(cx, cy, radius, box.minX, box.minY, box.maxX, box.maxY, nx, ny, penetration) != 0;
+    }
+
+    void CircleCircleBatch::Clear() noexcept
+    {
+        ax.clear();
+        ay.clear();
+        radiusA.clear();
+        bx.clear();
+        by.clear();
+        radiusB.clear();
+        tag.clear();
+    }
+
+    void CircleCircleBatch::Push(float pax, float pay, float pra, float pbx, float pby, float prb, std::uint32_t ptag)
+    {
+        ax.push_back(pax);
+        ay.push_back(pay);
+        radiusA.push_back(pra);
+        bx.push_back(pbx);
+        by.push_back(pby);
+        radiusB.push_back(prb);
+        tag.push_back(ptag);
+    }
+
+    void CircleAabbBatch::Clear() noexcept
+    {
+        cx.clear();
+        cy.clear();
+        radius.clear();
+        minX.clear();
+        minY.clear();
+        maxX.clear();
+        maxY.clear();
+        tag.clear();
+    }
+
+    void CircleAabbBatch::Push(float pcx, float pcy, float pradius, const AABBComponent& box, std::uint32_t ptag)
+    {
+        cx.push_back(pcx);
+        cy.push_back(pcy);
+        radius.push_back(pradius);
+        minX.push_back(box.minX);
+        minY.push_back(box.minY);
+        maxX.push_back(box.maxX);
+        maxY.push_back(box.maxY);
+        tag.push_back(ptag);
+    }
+
+    void CircleCircleManifolds(const CircleCircleBatch& pairs, ManifoldBatch& out)
+    {
+        const std::size_t count = pairs.Size();
+        Resize(out, count);
+        for (std::size_t base = 0; base < count; base += kNarrowphaseLanes)
+        {
+            // Lanes past the end of the batch compute on zeros and are not
+            // stored.
+            const std::size_t lanes = std::min(kNarrowphaseLanes, count - base);
+            Lanes ax{}, ay{}, ra{}, bx{}, by{}, rb{};
+            Load(pairs.ax, base, lanes, ax);
+            Load(pairs.ay, base, lanes, ay);
+            Load(pairs.radiusA, base, lanes, ra);
+            Load(pairs.bx, base, lanes, bx);
+            Load(pairs.by, base, lanes, by);
+            Load(pairs.radiusB, base, lanes, rb);
+            Lanes nx, ny, pen;
+            Mask hit;
+            for (std::size_t k = 0; k < kNarrowphaseLanes; ++k)
+            {
+                hit[k] = CircleCircleLane(ax[k], ay[k], ra[k], bx[k], by[k], rb[k], nx[k], ny[k], pen[k]);
+            }
+            Store(nx, base, lanes, out.nx);
+            Store(ny, base, lanes, out.ny);
+            Store(pen, base, lanes, out.penetration);
+            Store(hit, base, lanes, out.hit);
+        }
+    }
+
+    void CircleAabbManifolds(const CircleAabbBatch& pairs, ManifoldBatch& out)
+    {
+        const std::size_t count = pairs.Size();
+        Resize(out, count);
+        for (std::size_t base = 0; base < count; base += kNarrowphaseLanes)
+        {
+            const std::size_t lanes = std::min(kNarrowphaseLanes, count - base);
+            Lanes cx{}, cy{}, r{}, minX{}, minY{}, maxX{}, maxY{};
+            Load(pairs.cx, base, lanes, cx);
+            Load(pairs.cy, base, lanes, cy);
+            Load(pairs.radius, base, lanes, r);
+            Load(pairs.minX, base, lanes, minX);
+            Load(pairs.minY, base, lanes, minY);
+            Load(pairs.maxX, base, lanes, maxX);
+            Load(pairs.maxY, base, lanes, maxY);
+            Lanes nx, ny, pen;
+            Mask hit;
+            for (std::size_t k = 0; k < kNarrowphaseLanes; ++k)
+            {
+                hit[k] = CircleAabbLane(cx[k], cy[k], r[k], minX[k], minY[k], maxX[k], maxY[k], nx[k], ny[k], pen[k]);
+            }
+            Store(nx, base, lanes, out.nx);
+            Store(ny, base, lanes, out.ny);
+            Store(pen, base, lanes, out.penetration);
+            Store(hit, base, lanes, out.hit);
+        }
+    }
+}
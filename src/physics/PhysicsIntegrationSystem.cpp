@@ -21,6 +21,7 @@
 
 #include <algorithm>
 #include <cmath>
+#include <utility>
 
 namespace physics
 {
@@ -53,6 +54,61 @@ namespace physics
         }
     }
 
+    bool PhysicsIntegrationSystem::StepBody(RigidBodyComponent& b, TransformComponent& tf, float dt) const
+    {
+        if (b.invMass == 0.0f && b.mass > 0.0f) {
+            EnsureDerivedMass(b);
+        }
+        if (b.invMass == 0.0f) {
+            b.angularVelocity = 0.0f;
+            b.torque = 0.0f;
+            return false;
+        }
+        if (b.asleep) {
+            return false;
+        }
+
+        b.lastX = tf.x;
+        b.lastY = tf.y;
+        b.lastAngle = tf.rotation;
+
+        const float ax = m_env.windX - m_env.drag * b.vx;
+        const float ay = m_env.gravityY + m_env.windY - m_env.drag * b.vy;
+
+        b.vx += ax * dt;
+        b.vy += ay * dt;
+
+        const float maxVel = 50.0f;
+        float vSq = b.vx * b.vx + b.vy * b.vy;
+        if (vSq > maxVel * maxVel) {
+            float v = std::sqrt(vSq);
+            b.vx = (b.vx / v) * maxVel;
+            b.vy = (b.vy / v) * maxVel;
+        }
+
+        tf.x += b.vx * dt;
+        tf.y += b.vy * dt;
+
+        if (b.invInertia == 0.0f && b.inertia > 0.0f)
+        {
+            b.invInertia = 1.0f / b.inertia;
+        }
+        if (b.invInertia > 0.0f)
+        {
+            float angularAccel = b.torque * b.invInertia - b.angularDrag * b.angularVelocity;
+            b.angularVelocity += angularAccel * dt;
+            const float damping = std::max(0.0f, 1.0f - b.angularFriction * dt);
+            b.angularVelocity *= damping;
+            tf.rotation += b.angularVelocity * dt;
+        }
+        else
+        {
+            b.angularVelocity = 0.0f;
+        }
+        b.torque = 0.0f;
+        return true;
+    }
+
     void PhysicsIntegrationSystem::Update(ecs::World& world, float dt)
     {
         auto* rbStorage = world.GetStorage<RigidBodyComponent>();
@@ -60,63 +116,19 @@ namespace physics
         if (!rbStorage || !tfStorage) return;
 
         auto& bodies = rbStorage->GetData();
+        auto& transforms = tfStorage->GetData();
         const auto& entities = rbStorage->GetEntities();
         size_t count = bodies.size();
 
+        // Static bodies are only read here, so only moving slots get a change
+        // stamp and downstream change queries skip the static scenery.
         auto integrateRange = [&](size_t start, size_t end) {
             for (size_t i = start; i < end; ++i) {
                 ecs::EntityId id = entities[i];
-                TransformComponent* tf = tfStorage->Get(id);
-                if (tf) {
-                    auto& b = bodies[i];
-                    if (b.invMass == 0.0f && b.mass > 0.0f) {
-                        EnsureDerivedMass(b);
-                    }
-                    if (b.invMass == 0.0f) {
-                        b.angularVelocity = 0.0f;
-                        b.torque = 0.0f;
-                        continue;
-                    }
-
-                    b.lastX = tf->x;
-                    b.lastY = tf->y;
-                    b.lastAngle = tf->rotation;
-
-                    const float ax = m_env.windX - m_env.drag * b.vx;
-                    const float ay = m_env.gravityY + m_env.windY - m_env.drag * b.vy;
-
-                    b.vx += ax * dt;
-                    b.vy += ay * dt;
-
-                    const float maxVel = 50.0f;
-                    float vSq = b.vx * b.vx + b.vy * b.vy;
-                    if (vSq > maxVel * maxVel) {
-                        float v = std::sqrt(vSq);
-                        b.vx = (b.vx / v) * maxVel;
-                        b.vy = (b.vy / v) * maxVel;
-                    }
-
-                    tf->x += b.vx * dt;
-                    tf->y += b.vy * dt;
-
-                    if (b.invInertia == 0.0f && b.inertia > 0.0f)
-                    {
-                        b.invInertia = 1.0f / b.inertia;
-                    }
-                    if (b.invInertia > 0.0f)
-                    {
-                        float angularAccel = b.torque * b.invInertia - b.angularDrag * b.angularVelocity;
-                        b.angularVelocity += angularAccel * dt;
-                        const float damping = std::max(0.0f, 1.0f - b.angularFriction * dt);
-                        b.angularVelocity *= damping;
-                        tf->rotation += b.angularVelocity * dt;
-                    }
-                    else
-                    {
-                        b.angularVelocity = 0.0f;
-                    }
-                    b.torque = 0.0f;
-
+                const size_t tfSlot = tfStorage->IndexOf(id);
+                if (tfSlot != tfStorage->npos && StepBody(bodies[i], transforms[tfSlot], dt)) {
+                    rbStorage->MarkChanged(i);
+                    tfStorage->MarkChanged(tfSlot);
                 }
             }
         };
@@ -208,12 +220,14 @@ namespace physics
         const auto& entities = rbStorage->GetEntities();
         size_t count = bodies.size();
 
+        const auto& transforms = std::as_const(*tfStorage);
         for (size_t i = 0; i < count; ++i) {
             ecs::EntityId id = entities[i];
-            TransformComponent* tf = tfStorage->Get(id);
+            const TransformComponent* tf = transforms.Get(id);
             if (tf) {
                 auto& b = bodies[i];
-                if (b.invMass == 0.0f) continue;
+                if (b.invMass == 0.0f || b.asleep) continue;
+                rbStorage->MarkChanged(i);
 
                 b.vx = (tf->x - b.lastX) / dt;
                 b.vy = (tf->y - b.lastY) / dt;
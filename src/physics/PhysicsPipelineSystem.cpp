@@ -17,43 +17,53 @@
 
 #include "physics/Systems.hpp"
 
+#include "jobs/Parallel.hpp"
+
 #include <algorithm>
 #include <cmath>
+#include <utility>
 
 namespace physics
 {
     namespace
     {
-        void SyncDynamicAabbsToTransforms(ecs::World& world)
+        constexpr std::uint32_t kNone = CollisionEvent::kNoBody;
+
+        template <typename TComponent>
+        std::uint32_t SlotIn(const ecs::ComponentStorage<TComponent>* storage, ecs::EntityId id)
+        {
+            const std::size_t slot = storage ? storage->IndexOf(id) : ecs::ComponentStorage<TComponent>::npos;
+            return slot == ecs::ComponentStorage<TComponent>::npos ? kNone : static_cast<std::uint32_t>(slot);
+        }
+
+        ProxyMotion MotionOf(const RigidBodyComponent* rb)
         {
-            auto* aabbStorage = world.GetStorage<AABBComponent>();
-            auto* tfStorage = world.GetStorage<TransformComponent>();
-            auto* rbStorage = world.GetStorage<RigidBodyComponent>();
-            if (!aabbStorage || !tfStorage || !rbStorage)
+            if (!rb)
             {
-                return;
+                return ProxyMotion::Unbodied;
             }
-
-            auto& aabbs = aabbStorage->GetData();
-            const auto& entities = aabbStorage->GetEntities();
-            const size_t count = aabbs.size();
-            for (size_t i = 0; i < count; ++i)
+            if (rb->invMass == 0.0f)
             {
-                const ecs::EntityId id = entities[i];
-                auto* rb = rbStorage->Get(id);
-                auto* tf = tfStorage->Get(id);
-                if (!rb || rb->invMass == 0.0f || !tf)
-                {
-                    continue;
-                }
+                return ProxyMotion::Static;
+            }
+            return rb->asleep ? ProxyMotion::Asleep : ProxyMotion::Awake;
+        }
 
-                auto& aabb = aabbs[i];
-                const float halfW = std::max(0.0f, (aabb.maxX - aabb.minX) * 0.5f);
-                const float halfH = std::max(0.0f, (aabb.maxY - aabb.minY) * 0.5f);
-                aabb.minX = tf->x - halfW;
-                aabb.maxX = tf->x + halfW;
-                aabb.minY = tf->y - halfH;
-                aabb.maxY = tf->y + halfH;
+        std::uint32_t SlotOf(const ecs::ComponentStorage<RigidBodyComponent>* rbStorage, ecs::EntityId id)
+        {
+            return SlotIn(rbStorage, id);
+        }
+
+        // Wakes a body mid-step; its last pose becomes the current one so the
+        // velocity update sees only this substep's solver displacement.
+        void Wake(RigidBodyComponent& body, const TransformComponent* tf)
+        {
+            WakeBody(body);
+            if (tf)
+            {
+                body.lastX = tf->x;
+                body.lastY = tf->y;
+                body.lastAngle = tf->rotation;
             }
         }
     }
@@ -70,90 +80,609 @@ namespace physics
             return;
         }
 
-        const int substeps = std::max(1, m_settings.substeps);
+        ++m_frameCounter;
+        if (m_settings.spatialSortInterval > 0
+            && m_frameCounter % static_cast<std::size_t>(m_settings.spatialSortInterval) == 0)
+        {
+            const std::size_t passes = m_spatialSort.passes;
+            m_spatialSort = SortStoragesByMortonOrder(world, m_events);
+            m_spatialSort.passes += passes;
+        }
+
+        m_lastPenetration = m_stepStats.position.maxInitialResidual;
+        m_stepStats = {};
+        const bool sleeping = m_settings.enableSleeping;
+        if (sleeping)
+        {
+            WakeDisturbedBodies(world);
+        }
+
+        const int substeps = m_settings.adaptiveSubsteps ? ChooseSubsteps(world, dt) : std::max(1, m_settings.substeps);
+        m_lastSubsteps = substeps;
+        m_stepStats.substeps = substeps;
         const float subDt = dt / static_cast<float>(substeps);
+        const bool tiled = m_settings.execution == PhysicsExecution::Tiled;
 
         for (int i = 0; i < substeps; ++i)
         {
-            m_integration.Update(world, subDt);
-            SyncDynamicAabbsToTransforms(world);
+            // Integration, the AABB sync and the broadphase input are one
+            // pass over the bodies; CCD then sweeps the fast proxies against
+            // the static ones and moves the bounds of those it stops.
+            if (!ProxyTableIsValid(world))
+            {
+                RebuildProxyTable(world);
+            }
+            UpdateProxies(world, subDt);
+            if (m_settings.continuousCollision)
+            {
+                SweepProxies sweep;
+                sweep.bounds = &m_broadphaseAABBs;
+                sweep.motion = &m_broadphaseMotion;
+                sweep.ids = &m_broadphaseIds;
+                sweep.bodies = &m_broadphaseBodies;
+                sweep.transforms = &m_proxyTransform;
+                sweep.shapes = &m_proxyShape;
+                if (world.GetStorage<CollisionFilterComponent>()) sweep.layers = &m_broadphaseLayers;
+                sweep.boxProxies = m_aabbProxies;
+                const auto ccd = ClampFastBodiesToStatic(world, sweep, subDt, m_settings.ccdMotionThreshold);
+                m_stepStats.continuous.sweptBodies += ccd.sweptBodies;
+                m_stepStats.continuous.clampedBodies += ccd.clampedBodies;
+            }
+            world.AdvanceChangeTick();
 
             m_events.clear();
-            m_broadphaseAABBs.clear();
-            m_broadphaseIds.clear();
+            const auto* filterLookup = std::as_const(world).GetStorage<CollisionFilterComponent>();
+            if (tiled)
+            {
+                DetectTiles(world);
+            }
+            else if (!m_broadphaseAABBs.empty())
+            {
+                // Static/static and sleeping pairs and layer mismatches are
+                // rejected inside the pair search and never become events.
+                m_collision.Detect(m_broadphaseAABBs, m_broadphaseIds, m_events, m_jobSystem, &m_broadphaseMotion,
+                                   filterLookup ? &m_broadphaseLayers : nullptr, &m_broadphaseBodies);
+            }
+            if (sleeping)
+            {
+                WakeTouchedBodies(world);
+            }
+
+            // Contacts are gathered once and shared by both solver phases.
+            if (tiled)
+            {
+                PrepareTileContacts(world);
+                ResolveTileContacts(false);
+            }
+            else
+            {
+                const ContactProxies proxies = Proxies();
+                m_resolution.PrepareContacts(m_events, world, m_contacts, m_jobSystem, &proxies);
+                m_resolution.ResolvePosition(m_contacts, m_jobSystem, &m_stepStats.position);
+            }
+
+            m_constraints.Resolve(world, subDt, m_jobSystem);
+            m_stepStats.constraint.Merge(m_constraints.LastIterations());
+            m_integration.UpdateVelocities(world, subDt);
 
-            auto* aabbStorage = world.GetStorage<AABBComponent>();
-            if (aabbStorage)
+            if (tiled)
+            {
+                ResolveTileContacts(true);
+            }
+            else
             {
-                const auto& aabbs = aabbStorage->GetData();
-                const auto& entities = aabbStorage->GetEntities();
+                m_resolution.ResolveVelocity(m_contacts, m_jobSystem, &m_stepStats.velocity);
+            }
+        }
+
+        if (sleeping)
+        {
+            UpdateSleep(world, dt);
+        }
+        m_queriesStale = true;
+    }
 
-                size_t count = aabbs.size();
-                m_broadphaseAABBs.reserve(count);
-                m_broadphaseIds.reserve(count);
+    void PhysicsSystem::DetectTiles(const ecs::World& world)
+    {
+        // The same pruning as Detect; the tiles' events, then the boundary
+        // ones, make up m_events for waking and sleeping.
+        ProxyFilter filter;
+        filter.motion = &m_broadphaseMotion;
+        if (world.GetStorage<CollisionFilterComponent>()) filter.layers = &m_broadphaseLayers;
+        m_tiles.Build(m_broadphaseAABBs, m_broadphaseMotion, m_settings.tileColumns, m_settings.tileRows);
+        m_tiles.Detect(m_broadphaseIds, filter, m_broadphaseBodies, m_jobSystem);
+        for (std::size_t t = 0; t < m_tiles.TileCount(); ++t)
+        {
+            const auto& events = m_tiles.TileEvents(t);
+            m_events.insert(m_events.end(), events.begin(), events.end());
+        }
+        const auto& boundary = m_tiles.BoundaryEvents();
+        m_events.insert(m_events.end(), boundary.begin(), boundary.end());
+    }
+
+    void PhysicsSystem::PrepareTileContacts(ecs::World& world)
+    {
+        // A tile's events name only the moving bodies it owns, so tiles
+        // share nothing but static bodies, which PrepareContacts only reads.
+        // The boundary buffer shares moving bodies with the tiles and is
+        // prepared after them.
+        const std::size_t tiles = m_tiles.TileCount();
+        m_tileContacts.resize(tiles + 1);
+        const ContactProxies proxies = Proxies();
+        const jobs::BatchPlan plan = jobs::PlanBatches(tiles, 1, m_jobSystem);
+        jobs::ForEachBatch(plan, m_jobSystem, [&](std::size_t, std::size_t begin, std::size_t end)
+        {
+            for (std::size_t t = begin; t < end; ++t)
+            {
+                m_resolution.PrepareContacts(m_tiles.TileEvents(t), world, m_tileContacts[t], nullptr, &proxies);
+            }
+        });
+        m_resolution.PrepareContacts(m_tiles.BoundaryEvents(), world, m_tileContacts[tiles], m_jobSystem, &proxies);
+    }
 
-                m_broadphaseAABBs.insert(m_broadphaseAABBs.end(), aabbs.begin(), aabbs.end());
-                m_broadphaseIds.insert(m_broadphaseIds.end(), entities.begin(), entities.end());
+    void PhysicsSystem::ResolveTileContacts(bool velocity)
+    {
+        const std::size_t tiles = m_tiles.TileCount();
+        auto solve = [&](ContactBuffer& contacts, jobs::JobSystem* jobSystem, SolverIterationStats* stats)
+        {
+            if (velocity)
+            {
+                m_resolution.ResolveVelocity(contacts, jobSystem, stats);
+            }
+            else
+            {
+                m_resolution.ResolvePosition(contacts, jobSystem, stats);
             }
+        };
 
-            auto* circleStorage = world.GetStorage<CircleColliderComponent>();
-            auto* tfStorage = world.GetStorage<TransformComponent>();
-            if (circleStorage && tfStorage)
+        // Each tile is solved whole by one worker.
+        m_tileStats.assign(tiles, SolverIterationStats{});
+        const jobs::BatchPlan plan = jobs::PlanBatches(tiles, 1, m_jobSystem);
+        jobs::ForEachBatch(plan, m_jobSystem, [&](std::size_t, std::size_t begin, std::size_t end)
+        {
+            for (std::size_t t = begin; t < end; ++t)
             {
-                const auto& circles = circleStorage->GetData();
-                const auto& entities = circleStorage->GetEntities();
-                const size_t count = circles.size();
+                solve(m_tileContacts[t], nullptr, &m_tileStats[t]);
+            }
+        });
+        auto& stats = velocity ? m_stepStats.velocity : m_stepStats.position;
+        for (const auto& tileStats : m_tileStats)
+        {
+            stats.Merge(tileStats);
+        }
+
+        // The boundary rule: border contacts go last, reading the bodies as
+        // the tiles left them, whichever worker finished first.
+        solve(m_tileContacts[tiles], m_jobSystem, &stats);
+    }
+
+    const SpatialQueryIndex& PhysicsSystem::Queries() const
+    {
+        if (m_queriesStale)
+        {
+            m_queries.Build(m_broadphaseAABBs, m_broadphaseIds, m_broadphaseLayers, m_aabbProxies);
+            m_queriesStale = false;
+        }
+        return m_queries;
+    }
+
+    ContactProxies PhysicsSystem::Proxies() const
+    {
+        ContactProxies proxies;
+        proxies.bodyProxy = &m_bodyProxy;
+        proxies.transforms = &m_proxyTransform;
+        proxies.shapes = &m_proxyShape;
+        proxies.circles = &m_proxyCircle;
+        proxies.boxProxies = m_aabbProxies;
+        return proxies;
+    }
+
+    bool PhysicsSystem::ProxyTableIsValid(const ecs::World& world) const
+    {
+        return m_proxyWorld == &world
+            && m_proxyVersions[0] == world.StructureVersionOf<AABBComponent>()
+            && m_proxyVersions[1] == world.StructureVersionOf<CircleColliderComponent>()
+            && m_proxyVersions[2] == world.StructureVersionOf<RigidBodyComponent>()
+            && m_proxyVersions[3] == world.StructureVersionOf<TransformComponent>()
+            && m_proxyVersions[4] == world.StructureVersionOf<CollisionFilterComponent>();
+    }
+
+    void PhysicsSystem::RebuildProxyTable(ecs::World& world)
+    {
+        const ecs::World& view = world;
+        const auto* aabbStorage = view.GetStorage<AABBComponent>();
+        const auto* circleStorage = view.GetStorage<CircleColliderComponent>();
+        const auto* rbStorage = view.GetStorage<RigidBodyComponent>();
+        const auto* tfStorage = view.GetStorage<TransformComponent>();
+        const auto* filterStorage = view.GetStorage<CollisionFilterComponent>();
 
-                m_broadphaseAABBs.reserve(m_broadphaseAABBs.size() + count);
-                m_broadphaseIds.reserve(m_broadphaseIds.size() + count);
+        m_broadphaseIds.clear();
+        m_broadphaseBodies.clear();
+        m_proxyTransform.clear();
+        m_proxyShape.clear();
+        m_proxyFilter.clear();
+        m_proxyCircle.clear();
+        m_looseBodies.clear();
+        m_looseTransforms.clear();
+        auto addProxy = [&](ecs::EntityId id, std::uint32_t shape, std::uint32_t tfSlot, std::uint32_t circle)
+        {
+            m_broadphaseIds.push_back(id);
+            m_broadphaseBodies.push_back(SlotIn(rbStorage, id));
+            m_proxyTransform.push_back(tfSlot);
+            m_proxyShape.push_back(shape);
+            m_proxyFilter.push_back(SlotIn(filterStorage, id));
+            m_proxyCircle.push_back(circle);
+        };
 
-                for (size_t j = 0; j < count; ++j)
+        if (aabbStorage)
+        {
+            const auto& entities = aabbStorage->GetEntities();
+            for (std::size_t j = 0; j < entities.size(); ++j)
+            {
+                addProxy(entities[j], static_cast<std::uint32_t>(j), SlotIn(tfStorage, entities[j]),
+                         SlotIn(circleStorage, entities[j]));
+            }
+        }
+        m_aabbProxies = m_broadphaseIds.size();
+        if (circleStorage && tfStorage)
+        {
+            const auto& entities = circleStorage->GetEntities();
+            for (std::size_t j = 0; j < entities.size(); ++j)
+            {
+                const ecs::EntityId id = entities[j];
+                const std::uint32_t tfSlot = SlotIn(tfStorage, id);
+                if ((aabbStorage && aabbStorage->IndexOf(id) != aabbStorage->npos) || tfSlot == kNone)
                 {
-                    const ecs::EntityId id = entities[j];
-                    if (aabbStorage && aabbStorage->Get(id))
+                    continue;
+                }
+                addProxy(id, static_cast<std::uint32_t>(j), tfSlot, static_cast<std::uint32_t>(j));
+            }
+        }
+
+        m_bodyProxy.assign(rbStorage ? rbStorage->Size() : 0, kNone);
+        for (std::size_t p = 0; p < m_broadphaseBodies.size(); ++p)
+        {
+            if (m_broadphaseBodies[p] != kNone) m_bodyProxy[m_broadphaseBodies[p]] = static_cast<std::uint32_t>(p);
+        }
+        if (rbStorage && tfStorage)
+        {
+            for (std::size_t i = 0; i < m_bodyProxy.size(); ++i)
+            {
+                const std::uint32_t tfSlot = SlotIn(tfStorage, rbStorage->GetEntities()[i]);
+                if (m_bodyProxy[i] != kNone || tfSlot == kNone) continue;
+                m_looseBodies.push_back(static_cast<std::uint32_t>(i));
+                m_looseTransforms.push_back(tfSlot);
+            }
+        }
+
+        m_proxyWorld = &world;
+        m_proxyVersions[0] = world.StructureVersionOf<AABBComponent>();
+        m_proxyVersions[1] = world.StructureVersionOf<CircleColliderComponent>();
+        m_proxyVersions[2] = world.StructureVersionOf<RigidBodyComponent>();
+        m_proxyVersions[3] = world.StructureVersionOf<TransformComponent>();
+        m_proxyVersions[4] = world.StructureVersionOf<CollisionFilterComponent>();
+    }
+
+    void PhysicsSystem::UpdateProxies(ecs::World& world, float dt)
+    {
+        auto* aabbStorage = world.GetStorage<AABBComponent>();
+        auto* rbStorage = world.GetStorage<RigidBodyComponent>();
+        auto* tfStorage = world.GetStorage<TransformComponent>();
+        const auto* circleStorage = std::as_const(world).GetStorage<CircleColliderComponent>();
+        const auto* filterStorage = std::as_const(world).GetStorage<CollisionFilterComponent>();
+
+        const std::size_t proxies = m_broadphaseIds.size();
+        m_broadphaseAABBs.resize(proxies);
+        m_broadphaseMotion.resize(proxies);
+        m_broadphaseLayers.resize(filterStorage ? proxies : 0);
+
+        // Proxies first, then the bodies that have none. Each item reads and
+        // writes only its own slots, so batches run in parallel.
+        const std::size_t loose = m_looseBodies.size();
+        const jobs::BatchPlan plan = jobs::PlanBatches(proxies + loose, 256, m_jobSystem);
+        jobs::ForEachBatch(plan, m_jobSystem, [&](std::size_t, std::size_t begin, std::size_t end)
+        {
+            for (std::size_t k = begin; k < end; ++k)
+            {
+                if (k >= proxies)
+                {
+                    const std::uint32_t slot = m_looseBodies[k - proxies];
+                    const std::uint32_t tfSlot = m_looseTransforms[k - proxies];
+                    if (m_integration.StepBody(rbStorage->GetData()[slot], tfStorage->GetData()[tfSlot], dt))
                     {
-                        continue;
+                        rbStorage->MarkChanged(slot);
+                        tfStorage->MarkChanged(tfSlot);
                     }
+                    continue;
+                }
 
-                    auto* tf = tfStorage->Get(id);
-                    if (!tf)
+                const std::uint32_t slot = m_broadphaseBodies[k];
+                const std::uint32_t tfSlot = m_proxyTransform[k];
+                RigidBodyComponent* body = slot != kNone ? &rbStorage->GetData()[slot] : nullptr;
+                TransformComponent* tf = tfSlot != kNone ? &tfStorage->GetData()[tfSlot] : nullptr;
+                bool moving = false;
+                if (body && tf)
+                {
+                    if (m_integration.StepBody(*body, *tf, dt))
                     {
-                        continue;
+                        rbStorage->MarkChanged(slot);
+                        tfStorage->MarkChanged(tfSlot);
                     }
+                    moving = body->invMass != 0.0f && !body->asleep;
+                }
 
-                    const auto& circle = circles[j];
+                const std::uint32_t shape = m_proxyShape[k];
+                if (k < m_aabbProxies)
+                {
+                    // Dynamic boxes follow their transform; others keep theirs.
+                    auto& box = aabbStorage->GetData()[shape];
+                    if (moving)
+                    {
+                        const float halfW = std::max(0.0f, (box.maxX - box.minX) * 0.5f);
+                        const float halfH = std::max(0.0f, (box.maxY - box.minY) * 0.5f);
+                        box.minX = tf->x - halfW;
+                        box.maxX = tf->x + halfW;
+                        box.minY = tf->y - halfH;
+                        box.maxY = tf->y + halfH;
+                        aabbStorage->MarkChanged(shape);
+                    }
+                    m_broadphaseAABBs[k] = box;
+                }
+                else
+                {
+                    const auto& circle = circleStorage->GetData()[shape];
                     const float radius = std::max(0.0f, circle.radius);
                     const float cx = tf->x + circle.offsetX;
                     const float cy = tf->y + circle.offsetY;
-                    m_broadphaseAABBs.push_back({cx - radius, cy - radius, cx + radius, cy + radius});
-                    m_broadphaseIds.push_back(id);
+                    m_broadphaseAABBs[k] = {cx - radius, cy - radius, cx + radius, cy + radius};
+                }
+                m_broadphaseMotion[k] = MotionOf(body);
+                if (filterStorage)
+                {
+                    const std::uint32_t filter = m_proxyFilter[k];
+                    m_broadphaseLayers[k] = filter != kNone ? filterStorage->GetData()[filter] : CollisionFilterComponent{};
                 }
             }
+        });
+    }
+
+    int PhysicsSystem::ChooseSubsteps(ecs::World& world, float dt)
+    {
+        const int lo = std::max(1, m_settings.minSubsteps);
+        const int hi = std::max(lo, m_settings.maxSubsteps);
+        int wanted = lo;
 
-            if (!m_broadphaseAABBs.empty())
+        // Motion: the fastest body relative to its own size, read through
+        // the proxy table's body and shape slots. The bounds from the last
+        // substep would do as well, but not right after a rebuild.
+        if (!ProxyTableIsValid(world))
+        {
+            RebuildProxyTable(world);
+        }
+        const ecs::World& view = world;
+        const auto* rbStorage = view.GetStorage<RigidBodyComponent>();
+        const auto* aabbStorage = view.GetStorage<AABBComponent>();
+        const auto* circleStorage = view.GetStorage<CircleColliderComponent>();
+        const float travelFraction = m_settings.maxSubstepTravel;
+        if (rbStorage && travelFraction > 0.0f)
+        {
+            const auto& bodies = rbStorage->GetData();
+            float worst = 0.0f;
+            for (std::size_t k = 0; k < m_broadphaseIds.size(); ++k)
+            {
+                const std::uint32_t slot = m_broadphaseBodies[k];
+                if (slot == kNone) continue;
+                const auto& b = bodies[slot];
+                if (b.invMass == 0.0f || b.asleep) continue;
+                float halfSize = 0.0f;
+                if (k < m_aabbProxies)
+                {
+                    const auto& box = aabbStorage->GetData()[m_proxyShape[k]];
+                    halfSize = 0.5f * std::min(box.maxX - box.minX, box.maxY - box.minY);
+                }
+                else
+                {
+                    halfSize = circleStorage->GetData()[m_proxyShape[k]].radius;
+                }
+                if (halfSize <= 0.0f) continue;
+                const float travel = std::sqrt(b.vx * b.vx + b.vy * b.vy) * dt;
+                worst = std::max(worst, travel / (travelFraction * halfSize));
+            }
+            if (worst > static_cast<float>(lo))
             {
-                m_collision.Detect(m_broadphaseAABBs, m_broadphaseIds, m_events, m_jobSystem);
+                wanted = static_cast<int>(std::min(std::ceil(worst), static_cast<float>(hi)));
             }
+        }
+
+        // Penetration scales roughly with the step length.
+        if (m_lastSubsteps > 0 && m_settings.targetPenetration > 0.0f && m_lastPenetration > 0.0f)
+        {
+            const float ratio = m_lastPenetration / m_settings.targetPenetration;
+            const float scaled = std::ceil(static_cast<float>(m_lastSubsteps) * ratio);
+            wanted = std::max(wanted, static_cast<int>(std::min(scaled, static_cast<float>(hi))));
+        }
+
+        // Rise at once, settle gradually so one quiet frame does not undo it.
+        if (m_lastSubsteps > 0)
+        {
+            wanted = std::max(wanted, m_lastSubsteps - 1);
+        }
+        return std::clamp(wanted, lo, hi);
+    }
 
-            if (!m_events.empty()) {
-                m_resolution.ResolvePosition(m_events, world, m_jobSystem);
+    void PhysicsSystem::WakeDisturbedBodies(ecs::World& world)
+    {
+        auto* rbStorage = world.GetStorage<RigidBodyComponent>();
+        const auto* tfStorage = std::as_const(world).GetStorage<TransformComponent>();
+        if (!rbStorage || !tfStorage) return;
+
+        const float linear = m_settings.sleepLinearVelocity;
+        const float angular = m_settings.sleepAngularVelocity;
+        auto& bodies = rbStorage->GetData();
+        const auto& entities = rbStorage->GetEntities();
+        for (std::size_t i = 0; i < bodies.size(); ++i)
+        {
+            auto& b = bodies[i];
+            if (!b.asleep) continue;
+            // Sleeping bodies hold zero velocity, so any set from outside
+            // (an impulse) or a pending torque wakes them.
+            if (b.vx * b.vx + b.vy * b.vy > linear * linear
+                || std::fabs(b.angularVelocity) > angular
+                || b.torque != 0.0f
+                || b.invMass == 0.0f)
+            {
+                Wake(b, tfStorage->Get(entities[i]));
+                rbStorage->MarkChanged(i);
+                ++m_stepStats.bodiesWoken;
             }
+        }
+    }
 
-            m_constraints.Resolve(world, subDt);
-            m_integration.UpdateVelocities(world, subDt);
+    void PhysicsSystem::WakeTouchedBodies(ecs::World& world)
+    {
+        auto* rbStorage = world.GetStorage<RigidBodyComponent>();
+        const auto* tfStorage = std::as_const(world).GetStorage<TransformComponent>();
+        if (!rbStorage || !tfStorage) return;
+
+        // Returns true if it woke one side of an awake/asleep pair.
+        auto wakePair = [&](ecs::EntityId idA, ecs::EntityId idB, std::uint32_t a, std::uint32_t b)
+        {
+            if (a == CollisionEvent::kNoBody || b == CollisionEvent::kNoBody) return false;
+            auto& bodies = rbStorage->GetData();
+            auto& bA = bodies[a];
+            auto& bB = bodies[b];
+            const bool awakeA = bA.invMass != 0.0f && !bA.asleep;
+            const bool awakeB = bB.invMass != 0.0f && !bB.asleep;
+            if (awakeA && bB.asleep)
+            {
+                Wake(bB, tfStorage->Get(idB));
+                rbStorage->MarkChanged(b);
+            }
+            else if (awakeB && bA.asleep)
+            {
+                Wake(bA, tfStorage->Get(idA));
+                rbStorage->MarkChanged(a);
+            }
+            else
+            {
+                return false;
+            }
+            ++m_stepStats.bodiesWoken;
+            return true;
+        };
+
+        // Sleeping/sleeping pairs are not detected, so a touched island wakes
+        // one contact layer per substep; joints wake their whole chain at once.
+        for (const auto& event : m_events)
+        {
+            wakePair(event.entityA, event.entityB, event.bodyA, event.bodyB);
+        }
 
-            if (!m_events.empty()) {
-                m_resolution.ResolveVelocity(m_events, world, m_jobSystem);
+        const auto* joints = std::as_const(world).GetStorage<DistanceJointComponent>();
+        if (!joints) return;
+        bool woke = true;
+        while (woke)
+        {
+            woke = false;
+            for (const auto& joint : joints->GetData())
+            {
+                woke |= wakePair(joint.entityA, joint.entityB, SlotOf(rbStorage, joint.entityA),
+                                 SlotOf(rbStorage, joint.entityB));
             }
         }
     }
 
+    void PhysicsSystem::UpdateSleep(ecs::World& world, float dt)
+    {
+        auto* rbStorage = world.GetStorage<RigidBodyComponent>();
+        if (!rbStorage) return;
+
+        auto& bodies = rbStorage->GetData();
+        const std::size_t count = bodies.size();
+        const float linear = m_settings.sleepLinearVelocity;
+        const float angular = m_settings.sleepAngularVelocity;
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            auto& b = bodies[i];
+            if (b.invMass == 0.0f || b.asleep) continue;
+            const bool slow = b.vx * b.vx + b.vy * b.vy <= linear * linear
+                && std::fabs(b.angularVelocity) <= angular;
+            b.sleepTimer = slow ? b.sleepTimer + dt : 0.0f;
+        }
+
+        // Islands: dynamic bodies connected by this frame's contacts or joints.
+        m_sleepParent.resize(count);
+        for (std::uint32_t i = 0; i < count; ++i) m_sleepParent[i] = i;
+        auto find = [&](std::uint32_t x)
+        {
+            while (m_sleepParent[x] != x)
+            {
+                m_sleepParent[x] = m_sleepParent[m_sleepParent[x]];
+                x = m_sleepParent[x];
+            }
+            return x;
+        };
+        auto unite = [&](std::uint32_t a, std::uint32_t b)
+        {
+            if (a == CollisionEvent::kNoBody || b == CollisionEvent::kNoBody) return;
+            if (bodies[a].invMass == 0.0f || bodies[b].invMass == 0.0f) return;
+            const std::uint32_t ra = find(static_cast<std::uint32_t>(a));
+            const std::uint32_t rb = find(static_cast<std::uint32_t>(b));
+            if (ra != rb) m_sleepParent[std::max(ra, rb)] = std::min(ra, rb);
+        };
+        for (const auto& event : m_events)
+        {
+            unite(event.bodyA, event.bodyB);
+        }
+        if (const auto* joints = std::as_const(world).GetStorage<DistanceJointComponent>())
+        {
+            for (const auto& joint : joints->GetData())
+            {
+                unite(SlotOf(rbStorage, joint.entityA), SlotOf(rbStorage, joint.entityB));
+            }
+        }
+
+        // An island may sleep only if every member is asleep or has been slow
+        // for long enough.
+        std::vector<std::uint8_t> restless(count, 0);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            const auto& b = bodies[i];
+            if (b.invMass != 0.0f && !b.asleep && b.sleepTimer < m_settings.sleepTime)
+            {
+                restless[find(static_cast<std::uint32_t>(i))] = 1;
+            }
+        }
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            auto& b = bodies[i];
+            if (b.invMass == 0.0f) continue;
+            if (!b.asleep && !restless[find(static_cast<std::uint32_t>(i))])
+            {
+                b.asleep = true;
+                b.vx = 0.0f;
+                b.vy = 0.0f;
+                b.angularVelocity = 0.0f;
+                rbStorage->MarkChanged(i);
+                ++m_stepStats.bodiesSlept;
+            }
+            if (b.asleep) ++m_stepStats.sleepingBodies;
+        }
+    }
+
     void PhysicsSystem::SetSettings(const PhysicsSettings& settings)
     {
         m_settings = settings;
         ApplySettings();
     }
 
+    void PhysicsSystem::SetBroadphase(std::unique_ptr<IBroadphase> broadphase)
+    {
+        if (!broadphase) return;
+        m_collision.SetBroadphase(std::move(broadphase));
+        m_settings.broadphase = Broadphase::Custom;
+    }
+
     void PhysicsSystem::ApplySettings()
     {
         CollisionResolutionSystem::SolverSettings solver{};
@@ -162,7 +691,17 @@ namespace physics
         solver.penetrationSlop = m_settings.penetrationSlop;
         solver.correctionPercent = m_settings.correctionPercent;
         solver.maxCorrection = m_settings.maxPositionCorrection;
+        solver.positionTolerance = m_settings.positionTolerance;
+        solver.velocityTolerance = m_settings.velocityTolerance;
+        solver.solver = m_settings.contactSolver;
+        // A tiled body's contacts can be split between its tile and the
+        // boundary buffer; re-measuring keeps the second solve from
+        // repeating the correction the first already made.
+        solver.measurePenetration = m_settings.execution == PhysicsExecution::Tiled;
         m_resolution.SetSolverSettings(solver);
         m_constraints.SetIterationCount(m_settings.constraintIterations);
+        m_constraints.SetSolver(m_settings.jointSolver);
+        m_constraints.SetTolerance(m_settings.constraintTolerance);
+        m_collision.SetBroadphase(m_settings.broadphase);
     }
 }
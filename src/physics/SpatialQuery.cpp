@@ -0,0 +1,470 @@
+/*
+ * Copyright (C) 2025 aeml
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "physics/SpatialQuery.hpp"
+
+#include "jobs/Parallel.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+
+namespace physics
+{
+    namespace
+    {
+        // Proxies up to this fraction of a cell go into the grid, leaving
+        // room for rounding in the cell arithmetic.
+        constexpr float kSmallFraction = 0.9f;
+
+        int CellOf(float v, float cell) noexcept
+        {
+            const float c = std::floor(v / cell);
+            return static_cast<int>(std::clamp(c, -1073741824.0f, 1073741824.0f));
+        }
+
+        std::uint32_t HashCell(int x, int y, std::uint32_t mask) noexcept
+        {
+            return ((static_cast<std::uint32_t>(x) * 73856093u) ^ (static_cast<std::uint32_t>(y) * 19349663u)) & mask;
+        }
+
+        bool Finite(const AABBComponent& box) noexcept
+        {
+            return std::isfinite(box.minX) && std::isfinite(box.minY) && std::isfinite(box.maxX)
+                && std::isfinite(box.maxY);
+        }
+
+        bool HitBefore(const RayHit& a, const RayHit& b) noexcept
+        {
+            if (a.fraction != b.fraction) return a.fraction < b.fraction;
+            return a.entity < b.entity;
+        }
+
+        void SortUnique(std::vector<std::uint32_t>& out, std::size_t from)
+        {
+            const auto begin = out.begin() + static_cast<std::ptrdiff_t>(from);
+            std::sort(begin, out.end());
+            out.erase(std::unique(begin, out.end()), out.end());
+        }
+    }
+
+    void SpatialQueryIndex::Build(const std::vector<AABBComponent>& bounds, const std::vector<std::uint32_t>& entities,
+                                  const std::vector<CollisionFilterComponent>& layers, std::size_t boxCount)
+    {
+        const std::size_t count = bounds.size();
+        m_bounds = bounds;
+        m_entities = entities;
+        m_boxCount = std::min(boxCount, count);
+        m_layers.resize(count);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            m_layers[i] = layers.empty() ? CollisionFilterComponent{}.layer : layers[i].layer;
+        }
+
+        // Cells twice the median proxy size hold most proxies in one cell
+        // whatever a few walls measure.
+        std::vector<float> extents;
+        extents.reserve(count);
+        for (const auto& box : bounds)
+        {
+            if (Finite(box)) extents.push_back(std::max(box.maxX - box.minX, box.maxY - box.minY));
+        }
+        m_cellSize = 1.0f;
+        if (!extents.empty())
+        {
+            const auto median = extents.begin() + static_cast<std::ptrdiff_t>(extents.size() / 2);
+            std::nth_element(extents.begin(), median, extents.end());
+            if (*median > 0.0f && std::isfinite(*median)) m_cellSize = 2.0f * *median;
+        }
+
+        // Counting sort of the small proxies by hashed min-corner cell; the
+        // scatter runs in index order, so each bucket is sorted by index.
+        std::size_t buckets = 16;
+        while (buckets < count) buckets *= 2;
+        m_bucketMask = static_cast<std::uint32_t>(buckets - 1);
+        m_bucketStart.assign(buckets + 1, 0);
+        m_large.clear();
+        std::vector<std::uint32_t> bucketOf(count, m_bucketMask + 1);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            const auto& box = bounds[i];
+            if (!Finite(box)) continue;
+            if (std::max(box.maxX - box.minX, box.maxY - box.minY) > kSmallFraction * m_cellSize)
+            {
+                m_large.push_back(static_cast<std::uint32_t>(i));
+                continue;
+            }
+            bucketOf[i] = HashCell(CellOf(box.minX, m_cellSize), CellOf(box.minY, m_cellSize), m_bucketMask);
+            ++m_bucketStart[bucketOf[i]];
+        }
+        std::uint32_t total = 0;
+        for (auto& start : m_bucketStart)
+        {
+            const std::uint32_t n = start;
+            start = total;
+            total += n;
+        }
+        m_bucketProxies.resize(total);
+        std::vector<std::uint32_t> cursor(m_bucketStart.begin(), m_bucketStart.end() - 1);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            if (bucketOf[i] <= m_bucketMask) m_bucketProxies[cursor[bucketOf[i]]++] = static_cast<std::uint32_t>(i);
+        }
+    }
+
+    template <typename Fn>
+    void SpatialQueryIndex::ForEachCandidate(const AABBComponent& box, std::uint32_t mask, const Fn& fn) const
+    {
+        if (!Finite(box) || m_bounds.empty())
+        {
+            return;
+        }
+        for (const std::uint32_t proxy : m_large)
+        {
+            if (m_layers[proxy] & mask) fn(proxy);
+        }
+        // A small proxy reaches at most one cell past its min corner.
+        const int x0 = CellOf(box.minX, m_cellSize) - 1;
+        const int x1 = CellOf(box.maxX, m_cellSize);
+        const int y0 = CellOf(box.minY, m_cellSize) - 1;
+        const int y1 = CellOf(box.maxY, m_cellSize);
+        const double cells = (static_cast<double>(x1) - x0 + 1.0) * (static_cast<double>(y1) - y0 + 1.0);
+        if (cells > static_cast<double>(m_bucketMask) + 1.0)
+        {
+            // Larger than the grid itself: every small proxy is a candidate.
+            for (const std::uint32_t proxy : m_bucketProxies)
+            {
+                if (m_layers[proxy] & mask) fn(proxy);
+            }
+            return;
+        }
+        for (int y = y0; y <= y1; ++y)
+        {
+            for (int x = x0; x <= x1; ++x)
+            {
+                const std::uint32_t bucket = HashCell(x, y, m_bucketMask);
+                for (std::uint32_t k = m_bucketStart[bucket]; k < m_bucketStart[bucket + 1]; ++k)
+                {
+                    const std::uint32_t proxy = m_bucketProxies[k];
+                    if (m_layers[proxy] & mask) fn(proxy);
+                }
+            }
+        }
+    }
+
+    template <typename Fn>
+    void SpatialQueryIndex::WalkSegment(float x0, float y0, float x1, float y1, std::uint32_t mask, const Fn& fn) const
+    {
+        if (m_bounds.empty())
+        {
+            return;
+        }
+        for (const std::uint32_t proxy : m_large)
+        {
+            if ((m_layers[proxy] & mask) && !fn(proxy, 0.0f)) return;
+        }
+
+        const float dx = x1 - x0;
+        const float dy = y1 - y0;
+        const float cell = m_cellSize;
+        const double crossings = (std::fabs(static_cast<double>(dx)) + std::fabs(static_cast<double>(dy))) / cell + 2.0;
+        if (crossings > static_cast<double>(m_bucketMask) + 1.0)
+        {
+            for (const std::uint32_t proxy : m_bucketProxies)
+            {
+                if ((m_layers[proxy] & mask) && !fn(proxy, 0.0f)) return;
+            }
+            return;
+        }
+
+        // Grid walk (Amanatides and Woo) in segment fractions. A proxy in
+        // the visited cell is stored there or one cell below or left of it.
+        constexpr float kNever = std::numeric_limits<float>::infinity();
+        int cx = CellOf(x0, cell);
+        int cy = CellOf(y0, cell);
+        const int endX = CellOf(x1, cell);
+        const int endY = CellOf(y1, cell);
+        const int stepX = dx > 0.0f ? 1 : -1;
+        const int stepY = dy > 0.0f ? 1 : -1;
+        float nextX = dx != 0.0f ? ((static_cast<float>(cx + (dx > 0.0f ? 1 : 0)) * cell) - x0) / dx : kNever;
+        float nextY = dy != 0.0f ? ((static_cast<float>(cy + (dy > 0.0f ? 1 : 0)) * cell) - y0) / dy : kNever;
+        const float deltaX = dx != 0.0f ? cell / std::fabs(dx) : kNever;
+        const float deltaY = dy != 0.0f ? cell / std::fabs(dy) : kNever;
+        float enter = 0.0f;
+        for (;;)
+        {
+            std::array<std::uint32_t, 4> seen{};
+            std::size_t seenCount = 0;
+            for (int oy = -1; oy <= 0; ++oy)
+            {
+                for (int ox = -1; ox <= 0; ++ox)
+                {
+                    const std::uint32_t bucket = HashCell(cx + ox, cy + oy, m_bucketMask);
+                    if (std::find(seen.begin(), seen.begin() + static_cast<std::ptrdiff_t>(seenCount), bucket)
+                        != seen.begin() + static_cast<std::ptrdiff_t>(seenCount)) continue;
+                    seen[seenCount++] = bucket;
+                    for (std::uint32_t k = m_bucketStart[bucket]; k < m_bucketStart[bucket + 1]; ++k)
+                    {
+                        const std::uint32_t proxy = m_bucketProxies[k];
+                        if ((m_layers[proxy] & mask) && !fn(proxy, enter)) return;
+                    }
+                }
+            }
+            if ((cx == endX && cy == endY) || enter > 1.0f)
+            {
+                return;
+            }
+            if (nextX < nextY)
+            {
+                enter = nextX;
+                nextX += deltaX;
+                cx += stepX;
+            }
+            else
+            {
+                enter = nextY;
+                nextY += deltaY;
+                cy += stepY;
+            }
+        }
+    }
+
+    bool SpatialQueryIndex::Overlaps(std::uint32_t proxy, const AABBComponent& box) const noexcept
+    {
+        const auto& b = m_bounds[proxy];
+        if (b.maxX < box.minX || box.maxX < b.minX || b.maxY < box.minY || box.maxY < b.minY)
+        {
+            return false;
+        }
+        if (proxy < m_boxCount)
+        {
+            return true;
+        }
+        const float x = 0.5f * (b.minX + b.maxX);
+        const float y = 0.5f * (b.minY + b.maxY);
+        const float radius = 0.5f * (b.maxX - b.minX);
+        const float dx = std::clamp(x, box.minX, box.maxX) - x;
+        const float dy = std::clamp(y, box.minY, box.maxY) - y;
+        return dx * dx + dy * dy <= radius * radius;
+    }
+
+    bool SpatialQueryIndex::OverlapsCircle(std::uint32_t proxy, float x, float y, float radius) const noexcept
+    {
+        const auto& b = m_bounds[proxy];
+        if (proxy < m_boxCount)
+        {
+            const float dx = std::clamp(x, b.minX, b.maxX) - x;
+            const float dy = std::clamp(y, b.minY, b.maxY) - y;
+            return dx * dx + dy * dy <= radius * radius;
+        }
+        const float dx = 0.5f * (b.minX + b.maxX) - x;
+        const float dy = 0.5f * (b.minY + b.maxY) - y;
+        const float reach = radius + 0.5f * (b.maxX - b.minX);
+        return dx * dx + dy * dy <= reach * reach;
+    }
+
+    bool SpatialQueryIndex::Cast(std::uint32_t proxy, float x0, float y0, float dx, float dy, RayHit& hit) const noexcept
+    {
+        const auto& b = m_bounds[proxy];
+        float enter = 0.0f;
+        float normalX = 0.0f;
+        float normalY = 0.0f;
+        if (proxy < m_boxCount)
+        {
+            // Slabs: the last axis to be entered gives the normal.
+            float leave = 1.0f;
+            const float origin[2] = {x0, y0};
+            const float dir[2] = {dx, dy};
+            const float lo[2] = {b.minX, b.minY};
+            const float hi[2] = {b.maxX, b.maxY};
+            for (int axis = 0; axis < 2; ++axis)
+            {
+                if (dir[axis] == 0.0f)
+                {
+                    if (origin[axis] < lo[axis] || origin[axis] > hi[axis]) return false;
+                    continue;
+                }
+                float near = (lo[axis] - origin[axis]) / dir[axis];
+                float far = (hi[axis] - origin[axis]) / dir[axis];
+                if (near > far) std::swap(near, far);
+                if (near > enter)
+                {
+                    enter = near;
+                    normalX = axis == 0 ? (dir[axis] > 0.0f ? -1.0f : 1.0f) : 0.0f;
+                    normalY = axis == 1 ? (dir[axis] > 0.0f ? -1.0f : 1.0f) : 0.0f;
+                }
+                leave = std::min(leave, far);
+                if (enter > leave) return false;
+            }
+        }
+        else
+        {
+            const float radius = 0.5f * (b.maxX - b.minX);
+            const float cx = 0.5f * (b.minX + b.maxX);
+            const float cy = 0.5f * (b.minY + b.maxY);
+            const float mx = x0 - cx;
+            const float my = y0 - cy;
+            const float c = mx * mx + my * my - radius * radius;
+            if (c > 0.0f)
+            {
+                const float a = dx * dx + dy * dy;
+                const float half = mx * dx + my * dy;
+                const float disc = half * half - a * c;
+                if (a == 0.0f || half >= 0.0f || disc < 0.0f) return false;
+                enter = (-half - std::sqrt(disc)) / a;
+                if (enter > 1.0f) return false;
+                if (radius > 0.0f)
+                {
+                    normalX = (mx + enter * dx) / radius;
+                    normalY = (my + enter * dy) / radius;
+                }
+            }
+        }
+        hit.entity = m_entities[proxy];
+        hit.fraction = enter;
+        hit.x = x0 + enter * dx;
+        hit.y = y0 + enter * dy;
+        hit.normalX = normalX;
+        hit.normalY = normalY;
+        return true;
+    }
+
+    void SpatialQueryIndex::AppendAabb(const AABBComponent& box, std::uint32_t mask, std::vector<std::uint32_t>& out) const
+    {
+        const std::size_t from = out.size();
+        ForEachCandidate(box, mask, [&](std::uint32_t proxy)
+        {
+            if (Overlaps(proxy, box)) out.push_back(m_entities[proxy]);
+        });
+        SortUnique(out, from);
+    }
+
+    void SpatialQueryIndex::QueryAabb(const AABBComponent& box, std::vector<std::uint32_t>& out, std::uint32_t mask) const
+    {
+        out.clear();
+        AppendAabb(box, mask, out);
+    }
+
+    void SpatialQueryIndex::QueryRadius(float x, float y, float radius, std::vector<std::uint32_t>& out,
+                                        std::uint32_t mask) const
+    {
+        out.clear();
+        if (!(radius >= 0.0f))
+        {
+            return;
+        }
+        ForEachCandidate(AABBComponent{x - radius, y - radius, x + radius, y + radius}, mask, [&](std::uint32_t proxy)
+        {
+            if (OverlapsCircle(proxy, x, y, radius)) out.push_back(m_entities[proxy]);
+        });
+        SortUnique(out, 0);
+    }
+
+    void SpatialQueryIndex::CastSegment(float x0, float y0, float x1, float y1, std::vector<RayHit>& out,
+                                        std::uint32_t mask) const
+    {
+        out.clear();
+        if (!std::isfinite(x0) || !std::isfinite(y0) || !std::isfinite(x1) || !std::isfinite(y1))
+        {
+            return;
+        }
+        WalkSegment(x0, y0, x1, y1, mask, [&](std::uint32_t proxy, float)
+        {
+            RayHit hit;
+            if (Cast(proxy, x0, y0, x1 - x0, y1 - y0, hit)) out.push_back(hit);
+            return true;
+        });
+        // A proxy seen from several cells gives the same hit each time.
+        std::sort(out.begin(), out.end(), HitBefore);
+        out.erase(std::unique(out.begin(), out.end(),
+                              [](const RayHit& a, const RayHit& b) { return a.entity == b.entity; }),
+                  out.end());
+    }
+
+    bool SpatialQueryIndex::Raycast(const Ray& ray, RayHit& hit, std::uint32_t mask) const
+    {
+        hit = RayHit{};
+        const float length = std::sqrt(ray.dirX * ray.dirX + ray.dirY * ray.dirY);
+        if (!(length > 0.0f) || !(ray.maxDistance >= 0.0f) || !std::isfinite(ray.x) || !std::isfinite(ray.y)
+            || !std::isfinite(ray.maxDistance))
+        {
+            return false;
+        }
+        const float scale = ray.maxDistance / length;
+        const float dx = ray.dirX * scale;
+        const float dy = ray.dirY * scale;
+        bool found = false;
+        WalkSegment(ray.x, ray.y, ray.x + dx, ray.y + dy, mask, [&](std::uint32_t proxy, float enter)
+        {
+            // Nothing in this cell or later ones can beat a hit before it.
+            if (found && hit.fraction < enter) return false;
+            RayHit candidate;
+            if (Cast(proxy, ray.x, ray.y, dx, dy, candidate) && (!found || HitBefore(candidate, hit)))
+            {
+                hit = candidate;
+                found = true;
+            }
+            return true;
+        });
+        return found;
+    }
+
+    void SpatialQueryIndex::QueryAabbs(const std::vector<AABBComponent>& boxes, std::vector<std::uint32_t>& offsets,
+                                       std::vector<std::uint32_t>& out, jobs::JobSystem* jobSystem,
+                                       std::uint32_t mask) const
+    {
+        // Each batch fills its own list; the lists are joined in batch order.
+        const jobs::BatchPlan plan = jobs::PlanBatches(boxes.size(), 64, jobSystem);
+        std::vector<std::vector<std::uint32_t>> batchOut(plan.batches);
+        offsets.assign(boxes.size() + 1, 0);
+        jobs::ForEachBatch(plan, jobSystem, [&](std::size_t batch, std::size_t begin, std::size_t end)
+        {
+            auto& results = batchOut[batch];
+            for (std::size_t q = begin; q < end; ++q)
+            {
+                const std::size_t before = results.size();
+                AppendAabb(boxes[q], mask, results);
+                offsets[q + 1] = static_cast<std::uint32_t>(results.size() - before);
+            }
+        });
+        for (std::size_t q = 0; q < boxes.size(); ++q)
+        {
+            offsets[q + 1] += offsets[q];
+        }
+        out.clear();
+        out.reserve(offsets.back());
+        for (const auto& results : batchOut)
+        {
+            out.insert(out.end(), results.begin(), results.end());
+        }
+    }
+
+    void SpatialQueryIndex::Raycasts(const std::vector<Ray>& rays, std::vector<RayHit>& hits, jobs::JobSystem* jobSystem,
+                                     std::uint32_t mask) const
+    {
+        hits.resize(rays.size());
+        const jobs::BatchPlan plan = jobs::PlanBatches(rays.size(), 64, jobSystem);
+        jobs::ForEachBatch(plan, jobSystem, [&](std::size_t, std::size_t begin, std::size_t end)
+        {
+            for (std::size_t r = begin; r < end; ++r)
+            {
+                Raycast(rays[r], hits[r], mask);
+            }
+        });
+    }
+}
@@ -0,0 +1,172 @@
+/*
+ * Copyright (C) 2025 aeml
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "physics/SpatialSort.hpp"
+
+#include "ecs/World.hpp"
+#include "physics/Components.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+namespace physics
+{
+    namespace
+    {
+        constexpr std::uint64_t kNoTransformKey = 0xFFFFFFFFull << 32;
+
+        std::uint32_t Part1By1(std::uint32_t v) noexcept
+        {
+            v &= 0x0000FFFFu;
+            v = (v | (v << 8)) & 0x00FF00FFu;
+            v = (v | (v << 4)) & 0x0F0F0F0Fu;
+            v = (v | (v << 2)) & 0x33333333u;
+            v = (v | (v << 1)) & 0x55555555u;
+            return v;
+        }
+
+        template <typename TComponent, typename KeyFn>
+        void SortStorage(ecs::ComponentStorage<TComponent>* storage, KeyFn&& keyOf)
+        {
+            if (!storage)
+            {
+                return;
+            }
+
+            const auto& entities = storage->GetEntities();
+            std::vector<std::pair<std::uint64_t, std::size_t>> keyed(entities.size());
+            for (std::size_t i = 0; i < entities.size(); ++i)
+            {
+                keyed[i] = {keyOf(entities[i]), i};
+            }
+
+            if (!std::is_sorted(keyed.begin(), keyed.end()))
+            {
+                std::sort(keyed.begin(), keyed.end());
+                std::vector<std::size_t> order(keyed.size());
+                for (std::size_t k = 0; k < keyed.size(); ++k)
+                {
+                    order[k] = keyed[k].second;
+                }
+                storage->Reorder(order);
+            }
+            storage->ShrinkToFit();
+        }
+    }
+
+    std::uint32_t MortonCode(std::uint32_t x, std::uint32_t y) noexcept
+    {
+        return Part1By1(x) | (Part1By1(y) << 1);
+    }
+
+    double MeanContactStride(const ecs::World& world, const std::vector<CollisionEvent>& contacts) noexcept
+    {
+        const auto* rbStorage = world.GetStorage<RigidBodyComponent>();
+        if (!rbStorage || contacts.empty())
+        {
+            return 0.0;
+        }
+
+        double total = 0.0;
+        std::size_t counted = 0;
+        for (const auto& event : contacts)
+        {
+            const std::size_t a = rbStorage->IndexOf(event.entityA);
+            const std::size_t b = rbStorage->IndexOf(event.entityB);
+            if (a == rbStorage->npos || b == rbStorage->npos)
+            {
+                continue;
+            }
+            total += static_cast<double>(a > b ? a - b : b - a);
+            ++counted;
+        }
+        return counted > 0 ? total / static_cast<double>(counted) : 0.0;
+    }
+
+    SpatialSortStats SortStoragesByMortonOrder(ecs::World& world, const std::vector<CollisionEvent>& contacts)
+    {
+        SpatialSortStats stats{};
+        auto* tfStorage = world.GetStorage<TransformComponent>();
+        if (!tfStorage || tfStorage->Size() == 0)
+        {
+            return stats;
+        }
+
+        stats.passes = 1;
+        stats.contactStrideBefore = MeanContactStride(world, contacts);
+
+        // Quantize positions over the live bounds so the curve uses all 16 bits
+        // per axis regardless of world scale.
+        const auto& transforms = tfStorage->GetData();
+        float minX = std::numeric_limits<float>::max();
+        float minY = std::numeric_limits<float>::max();
+        float maxX = std::numeric_limits<float>::lowest();
+        float maxY = std::numeric_limits<float>::lowest();
+        for (const auto& tf : transforms)
+        {
+            if (!std::isfinite(tf.x) || !std::isfinite(tf.y))
+            {
+                continue;
+            }
+            minX = std::min(minX, tf.x);
+            minY = std::min(minY, tf.y);
+            maxX = std::max(maxX, tf.x);
+            maxY = std::max(maxY, tf.y);
+        }
+
+        const float extent = std::max(maxX - minX, maxY - minY);
+        const float scale = extent > 0.0f ? 65535.0f / extent : 0.0f;
+        std::vector<std::uint32_t> codes(transforms.size(), 0xFFFFFFFFu);
+        for (std::size_t i = 0; i < transforms.size(); ++i)
+        {
+            const auto& tf = transforms[i];
+            if (!std::isfinite(tf.x) || !std::isfinite(tf.y))
+            {
+                continue;
+            }
+            const float qx = std::clamp((tf.x - minX) * scale, 0.0f, 65535.0f);
+            const float qy = std::clamp((tf.y - minY) * scale, 0.0f, 65535.0f);
+            codes[i] = MortonCode(static_cast<std::uint32_t>(qx), static_cast<std::uint32_t>(qy));
+        }
+
+        auto keyOf = [&](ecs::EntityId id) -> std::uint64_t
+        {
+            const std::size_t slot = tfStorage->IndexOf(id);
+            if (slot == tfStorage->npos)
+            {
+                return kNoTransformKey | id;
+            }
+            return (static_cast<std::uint64_t>(codes[slot]) << 32) | id;
+        };
+
+        // Every storage is sorted by the same key, so the rigid body of the n-th
+        // transform is (usually) the n-th rigid body as well.
+        SortStorage(world.GetStorage<RigidBodyComponent>(), keyOf);
+        SortStorage(world.GetStorage<AABBComponent>(), keyOf);
+        SortStorage(world.GetStorage<CircleColliderComponent>(), keyOf);
+        SortStorage(tfStorage, keyOf);
+
+        if (const auto* rbStorage = world.GetStorage<RigidBodyComponent>())
+        {
+            stats.bodyCount = rbStorage->Size();
+        }
+        stats.contactStrideAfter = MeanContactStride(world, contacts);
+        return stats;
+    }
+}
@@ -0,0 +1,216 @@
+/*
+ * Copyright (C) 2025 aeml
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "physics/SpatialTiles.hpp"
+
+#include "jobs/Parallel.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace physics
+{
+    std::uint32_t TileDecomposition::Column(float x) const noexcept
+    {
+        // Clamped, so edge tiles reach out to infinity; NaN lands in 0.
+        const float f = (x - m_originX) * m_invTileWidth;
+        if (!(f >= 0.0f)) return 0;
+        if (f >= static_cast<float>(m_columns)) return m_columns - 1;
+        return static_cast<std::uint32_t>(f);
+    }
+
+    std::uint32_t TileDecomposition::Row(float y) const noexcept
+    {
+        const float f = (y - m_originY) * m_invTileHeight;
+        if (!(f >= 0.0f)) return 0;
+        if (f >= static_cast<float>(m_rows)) return m_rows - 1;
+        return static_cast<std::uint32_t>(f);
+    }
+
+    void TileDecomposition::Build(const std::vector<AABBComponent>& bounds, const std::vector<ProxyMotion>& motion,
+                                  int columns, int rows)
+    {
+        m_bounds = &bounds;
+        m_columns = static_cast<std::uint32_t>(std::max(1, columns));
+        m_rows = static_cast<std::uint32_t>(std::max(1, rows));
+        const std::size_t tiles = static_cast<std::size_t>(m_columns) * m_rows;
+        const std::size_t n = bounds.size();
+        auto moving = [&](std::size_t k)
+        {
+            if (motion.size() != n) return true;
+            return motion[k] == ProxyMotion::Awake || motion[k] == ProxyMotion::Asleep;
+        };
+
+        // The grid spans the centres of the moving proxies; static ones only
+        // ever appear as ghosts.
+        float minX = INFINITY, minY = INFINITY, maxX = -INFINITY, maxY = -INFINITY;
+        for (std::size_t k = 0; k < n; ++k)
+        {
+            if (!moving(k)) continue;
+            const auto& box = bounds[k];
+            const float cx = 0.5f * (box.minX + box.maxX);
+            const float cy = 0.5f * (box.minY + box.maxY);
+            if (!std::isfinite(cx) || !std::isfinite(cy)) continue;
+            minX = std::min(minX, cx);
+            maxX = std::max(maxX, cx);
+            minY = std::min(minY, cy);
+            maxY = std::max(maxY, cy);
+        }
+        if (minX > maxX)
+        {
+            minX = maxX = minY = maxY = 0.0f;
+        }
+        const float width = (maxX - minX) / static_cast<float>(m_columns);
+        const float height = (maxY - minY) / static_cast<float>(m_rows);
+        m_originX = minX;
+        m_originY = minY;
+        m_invTileWidth = width > 0.0f ? 1.0f / width : 0.0f;
+        m_invTileHeight = height > 0.0f ? 1.0f / height : 0.0f;
+
+        m_owner.resize(n);
+        for (std::size_t k = 0; k < n; ++k)
+        {
+            const auto& box = bounds[k];
+            const float cx = 0.5f * (box.minX + box.maxX);
+            const float cy = 0.5f * (box.minY + box.maxY);
+            m_owner[k] = moving(k) ? Row(cy) * m_columns + Column(cx) : kNoTile;
+        }
+
+        // Counting sort of (tile, proxy) by tile; proxies go in ascending
+        // order, so each tile's list is sorted.
+        m_tileStart.assign(tiles + 1, 0);
+        auto forEachTile = [&](const AABBComponent& box, auto&& fn)
+        {
+            const std::uint32_t c0 = Column(box.minX);
+            const std::uint32_t c1 = std::max(c0, Column(box.maxX));
+            const std::uint32_t r0 = Row(box.minY);
+            const std::uint32_t r1 = std::max(r0, Row(box.maxY));
+            for (std::uint32_t r = r0; r <= r1; ++r)
+            {
+                for (std::uint32_t c = c0; c <= c1; ++c) fn(r * m_columns + c);
+            }
+        };
+        for (std::size_t k = 0; k < n; ++k)
+        {
+            forEachTile(bounds[k], [&](std::uint32_t tile) { ++m_tileStart[tile + 1]; });
+        }
+        for (std::size_t t = 0; t < tiles; ++t) m_tileStart[t + 1] += m_tileStart[t];
+        m_tileProxies.resize(m_tileStart[tiles]);
+        m_cursor.assign(m_tileStart.begin(), m_tileStart.end() - 1);
+        for (std::size_t k = 0; k < n; ++k)
+        {
+            forEachTile(bounds[k], [&](std::uint32_t tile) { m_tileProxies[m_cursor[tile]++] = static_cast<std::uint32_t>(k); });
+        }
+
+        m_sweepOrder.resize(tiles);
+        m_homePairs.resize(tiles);
+        m_foundEvents.resize(tiles);
+        m_tileEvents.resize(tiles);
+    }
+
+    void TileDecomposition::Detect(const std::vector<std::uint32_t>& entityIds, const ProxyFilter& filter,
+                                   const std::vector<std::uint32_t>& bodies, jobs::JobSystem* jobSystem)
+    {
+        const std::size_t tiles = m_tileEvents.size();
+        const auto& bounds = *m_bounds;
+        const bool withBodies = bodies.size() == bounds.size();
+
+        // Every tile is one task and touches only its own lists.
+        const jobs::BatchPlan plan = jobs::PlanBatches(tiles, 1, jobSystem);
+        jobs::ForEachBatch(plan, jobSystem, [&](std::size_t, std::size_t begin, std::size_t end)
+        {
+            for (std::size_t t = begin; t < end; ++t)
+            {
+                auto& order = m_sweepOrder[t];
+                order.assign(m_tileProxies.begin() + m_tileStart[t], m_tileProxies.begin() + m_tileStart[t + 1]);
+                std::sort(order.begin(), order.end(), [&](std::uint32_t a, std::uint32_t b)
+                {
+                    return bounds[a].minX != bounds[b].minX ? bounds[a].minX < bounds[b].minX : a < b;
+                });
+
+                auto& pairs = m_homePairs[t];
+                pairs.clear();
+                for (std::size_t i = 0; i < order.size(); ++i)
+                {
+                    const std::uint32_t a = order[i];
+                    const auto& boxA = bounds[a];
+                    for (std::size_t j = i + 1; j < order.size() && bounds[order[j]].minX <= boxA.maxX; ++j)
+                    {
+                        const std::uint32_t b = order[j];
+                        const auto& boxB = bounds[b];
+                        if (boxA.maxY < boxB.minY || boxA.minY > boxB.maxY) continue;
+                        // Only the tile holding the overlap's min corner
+                        // reports the pair.
+                        const std::uint32_t home = Row(std::max(boxA.minY, boxB.minY)) * m_columns
+                            + Column(std::max(boxA.minX, boxB.minX));
+                        if (home != t) continue;
+                        const std::uint32_t lo = std::min(a, b);
+                        const std::uint32_t hi = std::max(a, b);
+                        if (filter.Rejects(lo, hi)) continue;
+                        pairs.push_back({lo, hi});
+                    }
+                }
+                std::sort(pairs.begin(), pairs.end());
+
+                // Pairs without a manifold are dropped from both lists, which
+                // stay row for row.
+                auto& found = m_foundEvents[t];
+                found.clear();
+                std::size_t kept = 0;
+                CollisionEvent event;
+                for (const auto& pair : pairs)
+                {
+                    if (!AabbManifold(bounds[pair.a], bounds[pair.b], event)) continue;
+                    event.entityA = entityIds[pair.a];
+                    event.entityB = entityIds[pair.b];
+                    if (withBodies)
+                    {
+                        event.bodyA = bodies[pair.a];
+                        event.bodyB = bodies[pair.b];
+                    }
+                    found.push_back(event);
+                    pairs[kept++] = pair;
+                }
+                pairs.resize(kept);
+            }
+        });
+
+        // The exchange: each event goes to the tile owning all of its moving
+        // bodies, or to the boundary list.
+        for (auto& events : m_tileEvents) events.clear();
+        m_boundaryEvents.clear();
+        for (std::size_t t = 0; t < tiles; ++t)
+        {
+            const auto& pairs = m_homePairs[t];
+            const auto& found = m_foundEvents[t];
+            for (std::size_t i = 0; i < found.size(); ++i)
+            {
+                const std::uint32_t ownerA = m_owner[pairs[i].a];
+                const std::uint32_t ownerB = m_owner[pairs[i].b];
+                const std::uint32_t owner = ownerA == kNoTile ? ownerB : ownerA;
+                if (owner != kNoTile && (ownerB == kNoTile || ownerB == owner))
+                {
+                    m_tileEvents[owner].push_back(found[i]);
+                }
+                else
+                {
+                    m_boundaryEvents.push_back(found[i]);
+                }
+            }
+        }
+    }
+}
@@ -17,33 +17,19 @@
 
 #include "physics/Systems.hpp"
 #include "jobs/JobSystem.hpp"
+#include "jobs/Parallel.hpp"
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <cmath>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
 
 namespace physics
 {
     namespace
     {
-        struct Contact
-        {
-            RigidBodyComponent* bA;
-            RigidBodyComponent* bB;
-            TransformComponent* tA;
-            TransformComponent* tB;
-            ecs::EntityId entityA;
-            ecs::EntityId entityB;
-            float leverA{0.0f};
-            float leverB{0.0f};
-            float nx;
-            float ny;
-            float pen;
-            float restitution;
-            float friction;
-            float invMassSum;
-        };
-
-        constexpr float kContactEpsilon = 1e-6f;
-
         float EstimateLever(const CircleColliderComponent* circle, const AABBComponent* aabb)
         {
             if (circle)
@@ -59,310 +45,722 @@ namespace physics
             return 0.0f;
         }
 
-        bool CircleCircleManifold(const TransformComponent& tA,
-                                  const CircleColliderComponent& cA,
-                                  const TransformComponent& tB,
-                                  const CircleColliderComponent& cB,
-                                  float& nx,
-                                  float& ny,
-                                  float& penetration)
-        {
-            const float ax = tA.x + cA.offsetX;
-            const float ay = tA.y + cA.offsetY;
-            const float bx = tB.x + cB.offsetX;
-            const float by = tB.y + cB.offsetY;
-
-            // Vector from A to B (Normal direction for solver)
-            const float dx = bx - ax;
-            const float dy = by - ay;
-            const float radiusA = std::max(cA.radius, 0.0f);
-            const float radiusB = std::max(cB.radius, 0.0f);
-            const float radii = radiusA + radiusB;
-            if (radii <= 0.0f) return false;
-
-            const float distSq = dx * dx + dy * dy;
-            if (distSq <= kContactEpsilon)
-            {
-                penetration = radii;
-                // Arbitrary normal if centers coincide
-                nx = 0.0f;
-                ny = 1.0f;
-                return true;
-            }
-
-            const float dist = std::sqrt(distSq);
-            if (dist >= radii) return false;
-
-            nx = dx / dist;
-            ny = dy / dist;
-            penetration = radii - dist;
-            return penetration > 0.0f;
-        }
-
-        bool CircleAabbManifold(const TransformComponent& tCircle,
-                                const CircleColliderComponent& circle,
-                                const AABBComponent& box,
-                                float& nx,
-                                float& ny,
-                                float& penetration)
-        {
-            const float cx = tCircle.x + circle.offsetX;
-            const float cy = tCircle.y + circle.offsetY;
-            const float radius = std::max(circle.radius, 0.0f);
-            if (radius <= 0.0f) return false;
-
-            const float closestX = std::clamp(cx, box.minX, box.maxX);
-            const float closestY = std::clamp(cy, box.minY, box.maxY);
-            
-            // Vector from Circle to Box (Normal direction for solver)
-            const float dx = closestX - cx;
-            const float dy = closestY - cy;
-            const float distSq = dx * dx + dy * dy;
+        constexpr std::uint32_t kNone = 0xFFFFFFFFu;
 
-            if (distSq > radius * radius + kContactEpsilon)
+        // Reorders values so that slot k holds the value that was at order[k].
+        template <typename T>
+        void ApplyOrder(std::vector<T>& values, const std::vector<std::uint32_t>& order, std::vector<T>& scratch,
+                        jobs::JobSystem* jobSystem)
+        {
+            scratch.resize(values.size());
+            const jobs::BatchPlan plan = jobs::PlanBatches(order.size(), 4096, jobSystem);
+            jobs::ForEachBatch(plan, jobSystem, [&](std::size_t, std::size_t begin, std::size_t end)
             {
-                return false;
-            }
+                for (std::size_t k = begin; k < end; ++k)
+                {
+                    scratch[k] = values[order[k]];
+                }
+            });
+            values.swap(scratch);
+        }
 
-            if (distSq > kContactEpsilon)
+        // Concurrent union-find over `parent`. A root is only ever linked
+        // under a smaller root, by compare-and-swap, so each set's root ends
+        // up its smallest element whatever order the unions ran in.
+        std::uint32_t FindRoot(std::vector<std::uint32_t>& parent, std::uint32_t x) noexcept
+        {
+            for (;;)
             {
-                const float dist = std::sqrt(distSq);
-                nx = dx / dist;
-                ny = dy / dist;
-                penetration = radius - dist;
-                return penetration > 0.0f;
+                const std::uint32_t up = std::atomic_ref<std::uint32_t>(parent[x]).load(std::memory_order_acquire);
+                if (up == x) return x;
+                // Path halving; any ancestor is a valid parent.
+                const std::uint32_t next = std::atomic_ref<std::uint32_t>(parent[up]).load(std::memory_order_acquire);
+                if (next != up) std::atomic_ref<std::uint32_t>(parent[x]).store(next, std::memory_order_release);
+                x = next;
             }
+        }
 
-            // Circle center inside the box. Push out along the closest face.
-            const float left = cx - box.minX;
-            const float right = box.maxX - cx;
-            const float bottom = cy - box.minY;
-            const float top = box.maxY - cy;
-            float minDist = left;
-            
-            // Default to pushing Left (towards minX). Solver applies -Normal to A.
-            // To push Left (-1,0), we need Normal = (1,0).
-            nx = 1.0f;
-            ny = 0.0f;
-
-            if (right < minDist) { minDist = right; nx = -1.0f; ny = 0.0f; }
-            if (bottom < minDist) { minDist = bottom; nx = 0.0f; ny = 1.0f; }
-            if (top < minDist) { minDist = top; nx = 0.0f; ny = -1.0f; }
-
-            // Penetration is radius + distance to edge (to clear the edge)
-            penetration = radius + minDist;
-            return true;
+        void Unite(std::vector<std::uint32_t>& parent, std::uint32_t a, std::uint32_t b) noexcept
+        {
+            for (;;)
+            {
+                a = FindRoot(parent, a);
+                b = FindRoot(parent, b);
+                if (a == b) return;
+                if (a > b) std::swap(a, b);
+                std::uint32_t expected = b;
+                if (std::atomic_ref<std::uint32_t>(parent[b]).compare_exchange_weak(expected, a, std::memory_order_acq_rel))
+                {
+                    return;
+                }
+            }
         }
 
-        std::vector<Contact> GatherContacts(const std::vector<CollisionEvent>& events, ecs::World& world)
+        // Groups the rows of `contacts` into islands and kind batches (see
+        // ContactBuffer). Every pass is a parallel loop and the result does
+        // not depend on the number of workers: set roots are fixed by
+        // Unite, islands are numbered by their first row through a prefix
+        // scan, and rows scattered by atomic cursors are sorted back into
+        // row order within each batch.
+        void BuildIslands(ContactBuffer& contacts, jobs::JobSystem* jobSystem)
         {
-            auto* tfStorage = world.GetStorage<TransformComponent>();
-            auto* rbStorage = world.GetStorage<RigidBodyComponent>();
-            auto* aabbStorage = world.GetStorage<AABBComponent>();
-            auto* circleStorage = world.GetStorage<CircleColliderComponent>();
+            const std::size_t count = contacts.Size();
+            const std::size_t bodies = contacts.bodyRigid.size();
+            const jobs::BatchPlan rowPlan = jobs::PlanBatches(count, 2048, jobSystem);
+            const jobs::BatchPlan bodyPlan = jobs::PlanBatches(bodies, 4096, jobSystem);
+
+            auto& parent = contacts.parent;
+            parent.resize(bodies);
+            jobs::ForEachBatch(bodyPlan, jobSystem, [&](std::size_t, std::size_t begin, std::size_t end)
+            {
+                for (std::size_t i = begin; i < end; ++i) parent[i] = static_cast<std::uint32_t>(i);
+            });
+            jobs::ForEachBatch(rowPlan, jobSystem, [&](std::size_t, std::size_t begin, std::size_t end)
+            {
+                for (std::size_t k = begin; k < end; ++k) Unite(parent, contacts.a[k], contacts.b[k]);
+            });
+            jobs::ForEachBatch(bodyPlan, jobSystem, [&](std::size_t, std::size_t begin, std::size_t end)
+            {
+                for (std::size_t i = begin; i < end; ++i)
+                {
+                    const std::uint32_t root = FindRoot(parent, static_cast<std::uint32_t>(i));
+                    std::atomic_ref<std::uint32_t>(parent[i]).store(root, std::memory_order_relaxed);
+                }
+            });
 
-            std::vector<Contact> contacts;
-            if (!tfStorage || !rbStorage) return contacts;
+            // First row of each set, then a scan over the rows that are first
+            // numbers the islands in order of their first row.
+            auto& firstRow = contacts.islandOf;
+            firstRow.assign(bodies, kNone);
+            jobs::ForEachBatch(rowPlan, jobSystem, [&](std::size_t, std::size_t begin, std::size_t end)
+            {
+                for (std::size_t k = begin; k < end; ++k)
+                {
+                    std::atomic_ref<std::uint32_t> first(firstRow[parent[contacts.a[k]]]);
+                    std::uint32_t seen = first.load(std::memory_order_relaxed);
+                    while (k < seen && !first.compare_exchange_weak(seen, static_cast<std::uint32_t>(k),
+                                                                    std::memory_order_relaxed)) {}
+                }
+            });
+            auto& islandNumber = contacts.indexScratch;
+            islandNumber.resize(count);
+            jobs::ForEachBatch(rowPlan, jobSystem, [&](std::size_t, std::size_t begin, std::size_t end)
+            {
+                for (std::size_t k = begin; k < end; ++k) islandNumber[k] = firstRow[parent[contacts.a[k]]] == k ? 1u : 0u;
+            });
+            auto& bucketStart = contacts.bucketStart;
+            const std::size_t islands = jobs::ExclusiveScan(islandNumber, jobSystem, bucketStart);
+            auto& order = contacts.order;
+            order.resize(count);
+            jobs::ForEachBatch(rowPlan, jobSystem, [&](std::size_t, std::size_t begin, std::size_t end)
+            {
+                for (std::size_t k = begin; k < end; ++k) order[k] = islandNumber[firstRow[parent[contacts.a[k]]]];
+            });
 
-            contacts.reserve(events.size());
+            // Counting sort of the rows by island, then by kind within an
+            // island. Kinds with a static body go first: ground contacts feed
+            // the ones stacked on them.
+            constexpr std::size_t kinds = ContactBuffer::kKinds;
+            auto bucketOf = [&](std::size_t k) { return order[k] * kinds + (kinds - 1 - contacts.kind[k]); };
+            bucketStart.assign(islands * kinds + 1, 0);
+            jobs::ForEachBatch(rowPlan, jobSystem, [&](std::size_t, std::size_t begin, std::size_t end)
+            {
+                for (std::size_t k = begin; k < end; ++k)
+                {
+                    std::atomic_ref<std::uint32_t>(bucketStart[bucketOf(k)]).fetch_add(1, std::memory_order_relaxed);
+                }
+            });
+            auto& cursor = contacts.indexScratch;
+            jobs::ExclusiveScan(bucketStart, jobSystem, cursor);
+            cursor.assign(bucketStart.begin(), bucketStart.end() - 1);
+            auto& rows = contacts.parent; // free again once islands are numbered
+            rows.resize(count);
+            jobs::ForEachBatch(rowPlan, jobSystem, [&](std::size_t, std::size_t begin, std::size_t end)
+            {
+                for (std::size_t k = begin; k < end; ++k)
+                {
+                    const std::uint32_t slot = std::atomic_ref<std::uint32_t>(cursor[bucketOf(k)])
+                                                   .fetch_add(1, std::memory_order_relaxed);
+                    rows[slot] = static_cast<std::uint32_t>(k);
+                }
+            });
+            // A single batch scatters in row order already.
+            if (rowPlan.batches > 1 && jobSystem)
+            {
+                const jobs::BatchPlan islandPlan = jobs::PlanBatches(islands, 64, jobSystem);
+                jobs::ForEachBatch(islandPlan, jobSystem, [&](std::size_t, std::size_t begin, std::size_t end)
+                {
+                    for (std::size_t bucket = begin * kinds; bucket < end * kinds; ++bucket)
+                    {
+                        std::sort(rows.begin() + bucketStart[bucket], rows.begin() + bucketStart[bucket + 1]);
+                    }
+                });
+            }
+            order.swap(rows);
 
-            for (const auto& event : events)
+            // Non-empty buckets are the batches.
+            auto& islandStart = contacts.islandStart;
+            islandStart.resize(islands + 1);
+            for (std::size_t i = 0; i < islands; ++i)
             {
-                ecs::EntityId idA = event.entityA;
-                ecs::EntityId idB = event.entityB;
+                islandStart[i] = bucketStart[i * kinds];
+                contacts.islandBatch.push_back(static_cast<std::uint32_t>(contacts.batchStart.size()));
+                for (std::size_t slot = 0; slot < kinds; ++slot)
+                {
+                    const std::size_t bucket = i * kinds + slot;
+                    if (bucketStart[bucket + 1] == bucketStart[bucket]) continue;
+                    contacts.batchStart.push_back(bucketStart[bucket]);
+                    contacts.batchKind.push_back(static_cast<std::uint8_t>(kinds - 1 - slot));
+                }
+            }
+            islandStart[islands] = static_cast<std::uint32_t>(count);
+            contacts.islandBatch.push_back(static_cast<std::uint32_t>(contacts.batchStart.size()));
+            contacts.batchStart.push_back(static_cast<std::uint32_t>(count));
+
+            auto& floats = contacts.floatScratch;
+            auto& indices = contacts.indexScratch;
+            ApplyOrder(contacts.a, order, indices, jobSystem);
+            ApplyOrder(contacts.b, order, indices, jobSystem);
+            ApplyOrder(contacts.nx, order, floats, jobSystem);
+            ApplyOrder(contacts.ny, order, floats, jobSystem);
+            ApplyOrder(contacts.pen, order, floats, jobSystem);
+            ApplyOrder(contacts.restitution, order, floats, jobSystem);
+            ApplyOrder(contacts.friction, order, floats, jobSystem);
+            ApplyOrder(contacts.invMassSum, order, floats, jobSystem);
+            ApplyOrder(contacts.leverA, order, floats, jobSystem);
+            ApplyOrder(contacts.leverB, order, floats, jobSystem);
+        }
 
-                auto* bA = rbStorage->Get(idA);
-                auto* bB = rbStorage->Get(idB);
-                auto* tA = tfStorage->Get(idA);
-                auto* tB = tfStorage->Get(idB);
-                auto* aabbA = aabbStorage ? aabbStorage->Get(idA) : nullptr;
-                auto* aabbB = aabbStorage ? aabbStorage->Get(idB) : nullptr;
+        template <typename Fn>
+        void ExecuteIslands(std::size_t islands, jobs::JobSystem* jobSystem, Fn&& fn)
+        {
+            if (islands == 0)
+            {
+                return;
+            }
 
-                if (!bA || !bB || !tA || !tB) continue;
+            if (!jobSystem || islands < 2)
+            {
+                for (std::size_t i = 0; i < islands; ++i)
+                {
+                    fn(i);
+                }
+                return;
+            }
 
-                float nx = event.normalX;
-                float ny = event.normalY;
-                float pen = event.penetration;
+            const std::size_t workerCount = std::max<std::size_t>(1, jobSystem->WorkerCount());
+            const std::size_t batch = std::max<std::size_t>(1, islands / (workerCount * 2));
+            auto handles = jobSystem->Dispatch(islands, batch, [&](std::size_t start, std::size_t end)
+            {
+                for (std::size_t i = start; i < end; ++i)
+                {
+                    fn(i);
+                }
+            });
+            jobSystem->Wait(handles);
+        }
 
-                auto* cA = circleStorage ? circleStorage->Get(idA) : nullptr;
-                auto* cB = circleStorage ? circleStorage->Get(idB) : nullptr;
+        void RecordIslandIterations(const std::vector<int>& used, const std::vector<float>& initialResidual,
+                                    SolverIterationStats* stats)
+        {
+            if (!stats) return;
+            for (std::size_t i = 0; i < used.size(); ++i)
+            {
+                stats->Add(used[i], initialResidual[i]);
+            }
+        }
 
-                if (cA && cB)
+        // What a velocity kernel reads and writes.
+        struct VelocityState
+        {
+            const ContactBuffer* contacts;
+            float*               vx;
+            float*               vy;
+            float*               w;
+            const float*         invMass;
+            const float*         invInertia;
+        };
+
+        // One Gauss-Seidel pass over contact rows [begin, end), all of kind
+        // Kind; returns the largest relative velocity change. Whatever the
+        // kind rules out (friction, spin, writes to a static body) is
+        // compiled out rather than tested per contact.
+        template <std::uint8_t Kind>
+        float SolveVelocityBatch(const VelocityState& state, std::uint32_t begin, std::uint32_t end)
+        {
+            constexpr bool friction = (Kind & ContactBuffer::kFriction) != 0;
+            constexpr bool rotation = (Kind & ContactBuffer::kRotation) != 0;
+            constexpr bool moveA = (Kind & ContactBuffer::kStaticA) == 0;
+            constexpr bool moveB = (Kind & ContactBuffer::kStaticB) == 0;
+            const ContactBuffer& c = *state.contacts;
+            float* vx = state.vx;
+            float* vy = state.vy;
+            float* w = state.w;
+            const float* invMass = state.invMass;
+            const float* invInertia = state.invInertia;
+
+            float residual = 0.0f;
+            for (std::uint32_t k = begin; k < end; ++k)
+            {
+                const std::uint32_t a = c.a[k];
+                const std::uint32_t b = c.b[k];
+                const float nx = c.nx[k];
+                const float ny = c.ny[k];
+                const float invMassSum = c.invMassSum[k];
+                float rvx = vx[b] - vx[a];
+                float rvy = vy[b] - vy[a];
+
+                // Only approaching bodies get a normal impulse.
+                const float velAlongNormal = rvx * nx + rvy * ny;
+                const float j = velAlongNormal < 0.0f ? -(1 + c.restitution[k]) * velAlongNormal / invMassSum : 0.0f;
+                const float impulseX = j * nx;
+                const float impulseY = j * ny;
+                if constexpr (moveA)
                 {
-                    if (!CircleCircleManifold(*tA, *cA, *tB, *cB, nx, ny, pen))
-                    {
-                        continue;
-                    }
+                    vx[a] -= impulseX * invMass[a];
+                    vy[a] -= impulseY * invMass[a];
                 }
-                else if (cA && !cB)
+                if constexpr (moveB)
                 {
-                    if (aabbB)
-                    {
-                        if (!CircleAabbManifold(*tA, *cA, *aabbB, nx, ny, pen))
-                        {
-                            continue;
-                        }
-                    }
+                    vx[b] += impulseX * invMass[b];
+                    vy[b] += impulseY * invMass[b];
                 }
-                else if (!cA && cB)
+                residual = std::max(residual, j * invMassSum);
+
+                if constexpr (friction)
                 {
-                    if (aabbA)
+                    rvx = vx[b] - vx[a];
+                    rvy = vy[b] - vy[a];
+                    const float tx = -ny;
+                    const float ty = nx;
+                    float jt = -(rvx * tx + rvy * ty);
+                    jt /= invMassSum;
+                    // Coulomb limit, with a small allowance for resting contacts.
+                    const float maxJt = c.friction[k] * (j > 0.0f ? j : 0.1f);
+                    jt = std::clamp(jt, -maxJt, maxJt);
+
+                    const float frictionImpulseX = jt * tx;
+                    const float frictionImpulseY = jt * ty;
+                    if constexpr (moveA)
                     {
-                        if (!CircleAabbManifold(*tB, *cB, *aabbA, nx, ny, pen))
-                        {
-                            continue;
-                        }
-                        nx = -nx;
-                        ny = -ny;
+                        vx[a] -= frictionImpulseX * invMass[a];
+                        vy[a] -= frictionImpulseY * invMass[a];
+                        if constexpr (rotation) w[a] -= jt * c.leverA[k] * invInertia[a];
+                    }
+                    if constexpr (moveB)
+                    {
+                        vx[b] += frictionImpulseX * invMass[b];
+                        vy[b] += frictionImpulseY * invMass[b];
+                        if constexpr (rotation) w[b] += jt * c.leverB[k] * invInertia[b];
                     }
+                    residual = std::max(residual, std::abs(jt) * invMassSum);
                 }
+            }
+            return residual;
+        }
 
-                if (pen <= 0.0f) continue;
-
-                Contact c;
-                c.bA = bA;
-                c.bB = bB;
-                c.tA = tA;
-                c.tB = tB;
-                c.entityA = idA;
-                c.entityB = idB;
-                c.leverA = EstimateLever(cA, aabbA);
-                c.leverB = EstimateLever(cB, aabbB);
-                c.nx = nx;
-                c.ny = ny;
-                c.pen = pen;
-                c.restitution = std::min(bA->restitution, bB->restitution);
-                c.friction = std::sqrt(bA->friction * bA->friction + bB->friction * bB->friction);
-                c.invMassSum = bA->invMass + bB->invMass;
-                if (c.invMassSum == 0.0f) continue;
+        using VelocityKernel = float (*)(const VelocityState&, std::uint32_t, std::uint32_t);
 
-                contacts.push_back(c);
-            }
-            return contacts;
+        template <std::size_t... Kinds>
+        constexpr std::array<VelocityKernel, sizeof...(Kinds)> MakeVelocityKernels(std::index_sequence<Kinds...>)
+        {
+            return {{&SolveVelocityBatch<static_cast<std::uint8_t>(Kinds)>...}};
         }
 
-        struct IslandBuilder
+        // One kernel per contact kind, indexed by the kind.
+        constexpr auto kVelocityKernels = MakeVelocityKernels(std::make_index_sequence<ContactBuffer::kKinds>{});
+
+        // Lists each solver body's contact ends in contact order (see
+        // ContactBuffer::bodyContact), once per PrepareContacts.
+        void BuildBodyContacts(ContactBuffer& c)
         {
-            int Add(ecs::EntityId id)
+            const std::size_t bodies = c.bodyRigid.size();
+            auto& start = c.bodyContactStart;
+            if (start.size() == bodies + 1)
             {
-                auto it = indices.find(id);
-                if (it != indices.end())
-                {
-                    return it->second;
-                }
-                const int idx = static_cast<int>(parent.size());
-                indices.emplace(id, idx);
-                parent.push_back(idx);
-                rank.push_back(0);
-                return idx;
+                return;
             }
-
-            void Unite(ecs::EntityId a, ecs::EntityId b)
+            const auto rows = static_cast<std::uint32_t>(c.Size());
+            start.assign(bodies + 1, 0);
+            for (std::uint32_t k = 0; k < rows; ++k)
             {
-                const int ia = Add(a);
-                const int ib = Add(b);
-                int ra = Find(ia);
-                int rb = Find(ib);
-                if (ra == rb) return;
-                if (rank[ra] < rank[rb]) std::swap(ra, rb);
-                parent[rb] = ra;
-                if (rank[ra] == rank[rb]) ++rank[ra];
+                ++start[c.a[k] + 1];
+                ++start[c.b[k] + 1];
             }
-
-            int Root(ecs::EntityId id)
+            for (std::size_t i = 0; i < bodies; ++i)
             {
-                auto it = indices.find(id);
-                if (it == indices.end()) return -1;
-                return Find(it->second);
+                start[i + 1] += start[i];
             }
+            auto& next = c.indexScratch;
+            next.assign(start.begin(), start.end() - 1);
+            c.bodyContact.resize(2 * static_cast<std::size_t>(rows));
+            for (std::uint32_t k = 0; k < rows; ++k)
+            {
+                c.bodyContact[next[c.a[k]]++] = 2 * k;
+                c.bodyContact[next[c.b[k]]++] = 2 * k + 1;
+            }
+        }
 
-        private:
-            int Find(int idx)
+        // Jacobi passes until one's residual is within tolerance; returns the
+        // passes run. contact(k) writes the change row k asks of its two
+        // bodies into the contact-end arrays (endDw only when Angular) and
+        // returns its residual; apply(i, dx, dy, dw) then gets the mean over
+        // body i's contact ends. A contact reads only the state the pass
+        // started with and a body sums its ends in contact order, so neither
+        // loop's batching can change a bit of the result.
+        template <bool Angular, typename ContactFn, typename ApplyFn>
+        int SolveJacobi(ContactBuffer& c, int iterations, float tolerance, jobs::JobSystem* jobSystem,
+                        float& initialResidual, const ContactFn& contact, const ApplyFn& apply)
+        {
+            BuildBodyContacts(c);
+            const std::size_t ends = 2 * c.Size();
+            c.endDx.resize(ends);
+            c.endDy.resize(ends);
+            c.endDw.resize(Angular ? ends : 0);
+            const jobs::BatchPlan contactPlan = jobs::PlanBatches(c.Size(), 1024, jobSystem);
+            const jobs::BatchPlan bodyPlan = jobs::PlanBatches(c.bodyRigid.size(), 1024, jobSystem);
+            c.batchResidual.resize(contactPlan.batches);
+
+            for (int i = 0; i < iterations; ++i)
             {
-                if (parent[idx] != idx)
+                jobs::ForEachBatch(contactPlan, jobSystem, [&](std::size_t batch, std::size_t begin, std::size_t end)
+                {
+                    float residual = 0.0f;
+                    for (std::size_t k = begin; k < end; ++k)
+                    {
+                        residual = std::max(residual, contact(static_cast<std::uint32_t>(k)));
+                    }
+                    c.batchResidual[batch] = residual;
+                });
+                jobs::ForEachBatch(bodyPlan, jobSystem, [&](std::size_t, std::size_t begin, std::size_t end)
+                {
+                    for (std::size_t body = begin; body < end; ++body)
+                    {
+                        const std::uint32_t first = c.bodyContactStart[body];
+                        const std::uint32_t last = c.bodyContactStart[body + 1];
+                        if (c.bodyInvMass[body] == 0.0f || first == last) continue;
+                        float dx = 0.0f;
+                        float dy = 0.0f;
+                        float dw = 0.0f;
+                        for (std::uint32_t s = first; s < last; ++s)
+                        {
+                            const std::uint32_t e = c.bodyContact[s];
+                            dx += c.endDx[e];
+                            dy += c.endDy[e];
+                            if constexpr (Angular) dw += c.endDw[e];
+                        }
+                        const float share = 1.0f / static_cast<float>(last - first);
+                        apply(body, dx * share, dy * share, dw * share);
+                    }
+                });
+                // A maximum is exact, so the batch order does not matter.
+                float residual = 0.0f;
+                for (const float r : c.batchResidual)
                 {
-                    parent[idx] = Find(parent[idx]);
+                    residual = std::max(residual, r);
                 }
-                return parent[idx];
+                if (i == 0) initialResidual = residual;
+                if (residual <= tolerance) return i + 1;
             }
+            return iterations;
+        }
+    }
 
-            std::unordered_map<ecs::EntityId, int> indices;
-            std::vector<int> parent;
-            std::vector<int> rank;
-        };
+    void CollisionResolutionSystem::PrepareContacts(const std::vector<CollisionEvent>& events, ecs::World& world,
+                                                    ContactBuffer& contacts, jobs::JobSystem* jobSystem,
+                                                    const ContactProxies* proxies) const
+    {
+        contacts.bodyRigid.clear();
+        contacts.bodyTransform.clear();
+        contacts.bodyInvMass.clear();
+        contacts.bodyInvInertia.clear();
+        contacts.bodyStartX.clear();
+        contacts.bodyStartY.clear();
+        contacts.a.clear();
+        contacts.b.clear();
+        contacts.nx.clear();
+        contacts.ny.clear();
+        contacts.pen.clear();
+        contacts.restitution.clear();
+        contacts.friction.clear();
+        contacts.invMassSum.clear();
+        contacts.leverA.clear();
+        contacts.leverB.clear();
+        contacts.islandStart.clear();
+        contacts.islandBatch.clear();
+        contacts.batchStart.clear();
+        contacts.batchKind.clear();
+        contacts.bodyContactStart.clear();
+        contacts.kind.clear();
+        contacts.records.clear();
 
-        std::vector<std::vector<const Contact*>> BuildIslands(const std::vector<Contact>& contacts)
+        auto* tfStorage = world.GetStorage<TransformComponent>();
+        auto* rbStorage = world.GetStorage<RigidBodyComponent>();
+        // Shapes are only read; fetching them const keeps them out of change queries.
+        const auto* aabbStorage = std::as_const(world).GetStorage<AABBComponent>();
+        const auto* circleStorage = std::as_const(world).GetStorage<CircleColliderComponent>();
+        if (!tfStorage || !rbStorage || events.empty()) return;
+
+        // Combine coefficients once per material pair instead of per
+        // contact, and only again once the shared materials change.
+        using MaterialHandle = ecs::SharedComponentStorage<PhysicsMaterial>::Handle;
+        constexpr MaterialHandle kNoMaterial = ecs::SharedComponentStorage<PhysicsMaterial>::kInvalidHandle;
+        const auto* materials = std::as_const(world).GetSharedStorage<PhysicsMaterial>();
+        if (materials && materials->Size() == 0) materials = nullptr;
+        if (materials && (contacts.pairMaterials != materials || contacts.pairVersion != materials->Version()))
         {
-            std::vector<std::vector<const Contact*>> islands;
-            if (contacts.empty())
+            const std::size_t count = materials->HandleCapacity();
+            contacts.pairTable.assign(count * count, PhysicsMaterial{});
+            for (std::size_t a = 0; a < count; ++a)
             {
-                return islands;
+                for (std::size_t b = 0; b < count; ++b)
+                {
+                    if (materials->ReferenceCount(static_cast<MaterialHandle>(a)) == 0
+                        || materials->ReferenceCount(static_cast<MaterialHandle>(b)) == 0)
+                    {
+                        continue;
+                    }
+                    contacts.pairTable[a * count + b] = CombineMaterials(materials->Value(static_cast<MaterialHandle>(a)),
+                                                                         materials->Value(static_cast<MaterialHandle>(b)));
+                }
             }
-
-            IslandBuilder builder;
-            for (const auto& c : contacts)
+            contacts.pairTableSize = count;
+            contacts.pairMaterials = materials;
+            contacts.pairVersion = materials->Version();
+        }
+        // Each body's handle, by rigid body slot, so a record needs no lookup.
+        if (materials
+            && (contacts.bodyMaterials != materials || contacts.bodyMaterialVersion != materials->Version()
+                || contacts.bodyStorage != rbStorage || contacts.bodyStructureVersion != rbStorage->StructureVersion()))
+        {
+            contacts.bodyMaterial.assign(rbStorage->Size(), kNoMaterial);
+            materials->ForEachSharedGroup([&](MaterialHandle handle, const PhysicsMaterial&,
+                                              const std::vector<ecs::EntityId>& members)
             {
-                builder.Unite(c.entityA, c.entityB);
+                for (const ecs::EntityId id : members)
+                {
+                    const std::size_t slot = rbStorage->IndexOf(id);
+                    if (slot != rbStorage->npos) contacts.bodyMaterial[slot] = handle;
+                }
+            });
+            contacts.bodyMaterials = materials;
+            contacts.bodyMaterialVersion = materials->Version();
+            contacts.bodyStorage = rbStorage;
+            contacts.bodyStructureVersion = rbStorage->StructureVersion();
+        }
+        const std::size_t materialCount = materials ? contacts.pairTableSize : 0;
+        const auto& pairTable = contacts.pairTable;
+
+        // One set of component lookups per body, however many events name it.
+        auto& rbData = rbStorage->GetData();
+        const auto& rbEntities = rbStorage->GetEntities();
+        auto& tfData = tfStorage->GetData();
+        // slotRecord is left all kNone by the previous call (see the end of
+        // the event loop), so only a resize costs a pass over every body.
+        if (contacts.slotRecord.size() != rbData.size()) contacts.slotRecord.assign(rbData.size(), kNone);
+        auto recordOf = [&](ecs::EntityId id, std::uint32_t slot) -> std::uint32_t
+        {
+            if (slot >= rbEntities.size() || rbEntities[slot] != id)
+            {
+                const std::size_t found = rbStorage->IndexOf(id);
+                if (found == rbStorage->npos) return kNone;
+                slot = static_cast<std::uint32_t>(found);
             }
-
-            std::unordered_map<int, std::size_t> rootToIsland;
-            islands.reserve(contacts.size());
-            for (const auto& c : contacts)
+            std::uint32_t& index = contacts.slotRecord[slot];
+            if (index == kNone)
             {
-                const int root = builder.Root(c.entityA);
-                if (root < 0) continue;
-                auto [it, inserted] = rootToIsland.emplace(root, islands.size());
-                std::size_t islandIndex;
-                if (inserted)
+                // The proxy table has the body's slots unless it has no
+                // proxy (or no transform), which needs the lookups.
+                const std::uint32_t proxy = proxies ? (*proxies->bodyProxy)[slot] : kNone;
+                std::size_t tfSlot;
+                const AABBComponent* aabb;
+                const CircleColliderComponent* circle;
+                if (proxy != kNone && (*proxies->transforms)[proxy] != kNone)
                 {
-                    islands.emplace_back();
-                    islandIndex = islands.size() - 1;
+                    tfSlot = (*proxies->transforms)[proxy];
+                    const std::uint32_t circleSlot = (*proxies->circles)[proxy];
+                    aabb = proxy < proxies->boxProxies ? &aabbStorage->GetData()[(*proxies->shapes)[proxy]] : nullptr;
+                    circle = circleSlot != kNone ? &circleStorage->GetData()[circleSlot] : nullptr;
                 }
                 else
                 {
-                    islandIndex = it->second;
+                    tfSlot = tfStorage->IndexOf(id);
+                    if (tfSlot == tfStorage->npos) return kNone;
+                    aabb = aabbStorage ? aabbStorage->Get(id) : nullptr;
+                    circle = circleStorage ? circleStorage->Get(id) : nullptr;
                 }
-                islands[islandIndex].push_back(&c);
+                // Static bodies are never written back, so they are not
+                // stamped; buffers sharing only static bodies can then be
+                // prepared concurrently.
+                if (rbData[slot].invMass != 0.0f)
+                {
+                    rbStorage->MarkChanged(slot);
+                    tfStorage->MarkChanged(tfSlot);
+                }
+                index = static_cast<std::uint32_t>(contacts.records.size());
+                contacts.records.push_back({&rbData[slot], &tfData[tfSlot], aabb, circle,
+                                            materials ? contacts.bodyMaterial[slot] : kNoMaterial, kNone, slot});
+            }
+            return index;
+        };
+        // Dynamic bodies share one solver body; static ones get one per contact.
+        auto solverBodyOf = [&](ContactBuffer::BodyRecord& record) -> std::uint32_t
+        {
+            const bool dynamic = record.rigid->invMass != 0.0f;
+            if (dynamic && record.solverBody != kNone) return record.solverBody;
+            const auto index = static_cast<std::uint32_t>(contacts.bodyRigid.size());
+            contacts.bodyRigid.push_back(record.rigid);
+            contacts.bodyTransform.push_back(record.transform);
+            contacts.bodyInvMass.push_back(record.rigid->invMass);
+            contacts.bodyInvInertia.push_back(record.rigid->invInertia);
+            if (dynamic) record.solverBody = index;
+            return index;
+        };
+
+        // Pairs that need solving, with the broadphase manifold as a start.
+        // Circle pairs are bucketed by shape pair and get their manifold
+        // from the batch kernels; box/box pairs keep the broadphase one.
+        auto& candidates = contacts.candidates;
+        candidates.clear();
+        contacts.circlePairs.Clear();
+        contacts.circleBoxPairs.Clear();
+        for (const auto& event : events)
+        {
+            const std::uint32_t recordA = recordOf(event.entityA, event.bodyA);
+            const std::uint32_t recordB = recordOf(event.entityB, event.bodyB);
+            if (recordA == kNone || recordB == kNone) continue;
+            const auto& rA = contacts.records[recordA];
+            const auto& rB = contacts.records[recordB];
+            const RigidBodyComponent* bA = rA.rigid;
+            const RigidBodyComponent* bB = rB.rigid;
+            // Nothing to solve unless one side is awake and dynamic.
+            if ((bA->invMass == 0.0f || bA->asleep) && (bB->invMass == 0.0f || bB->asleep)) continue;
+            if (bA->invMass + bB->invMass == 0.0f) continue;
+
+            const auto tag = static_cast<std::uint32_t>(candidates.size());
+            candidates.push_back({recordA, recordB, event.normalX, event.normalY, event.penetration});
+            const auto* cA = rA.circle;
+            const auto* cB = rB.circle;
+            if (cA && cB)
+            {
+                contacts.circlePairs.Push(rA.transform->x + cA->offsetX, rA.transform->y + cA->offsetY, cA->radius,
+                                          rB.transform->x + cB->offsetX, rB.transform->y + cB->offsetY, cB->radius,
+                                          tag);
             }
-            return islands;
+            else if (cA && rB.aabb)
+            {
+                contacts.circleBoxPairs.Push(rA.transform->x + cA->offsetX, rA.transform->y + cA->offsetY,
+                                             cA->radius, *rB.aabb, tag);
+            }
+            else if (cB && rA.aabb)
+            {
+                contacts.circleBoxPairs.Push(rB.transform->x + cB->offsetX, rB.transform->y + cB->offsetY,
+                                             cB->radius, *rA.aabb, tag);
+            }
+        }
+        for (const auto& record : contacts.records)
+        {
+            contacts.slotRecord[record.slot] = kNone;
         }
 
-        template <typename Fn>
-        void ExecuteIslands(const std::vector<std::vector<const Contact*>>& islands,
-                            jobs::JobSystem* jobSystem,
-                            Fn&& fn)
+        // A miss leaves no depth, which drops the candidate below. Normals
+        // come back pointing from the circle to the box and are flipped when
+        // the box is the first body.
+        auto& manifolds = contacts.manifolds;
+        CircleCircleManifolds(contacts.circlePairs, manifolds);
+        for (std::size_t i = 0; i < contacts.circlePairs.Size(); ++i)
+        {
+            auto& candidate = candidates[contacts.circlePairs.tag[i]];
+            candidate.nx = manifolds.nx[i];
+            candidate.ny = manifolds.ny[i];
+            candidate.pen = manifolds.hit[i] ? manifolds.penetration[i] : 0.0f;
+        }
+        CircleAabbManifolds(contacts.circleBoxPairs, manifolds);
+        for (std::size_t i = 0; i < contacts.circleBoxPairs.Size(); ++i)
         {
-            if (islands.empty())
+            auto& candidate = candidates[contacts.circleBoxPairs.tag[i]];
+            const float sign = contacts.records[candidate.recordA].circle ? 1.0f : -1.0f;
+            candidate.nx = sign * manifolds.nx[i];
+            candidate.ny = sign * manifolds.ny[i];
+            candidate.pen = manifolds.hit[i] ? manifolds.penetration[i] : 0.0f;
+        }
+
+        for (const auto& candidate : candidates)
+        {
+            const float pen = candidate.pen;
+            if (pen <= 0.0f) continue;
+            const std::uint32_t recordA = candidate.recordA;
+            const std::uint32_t recordB = candidate.recordB;
+            const auto& rA = contacts.records[recordA];
+            const auto& rB = contacts.records[recordB];
+            const RigidBodyComponent* bA = rA.rigid;
+            const RigidBodyComponent* bB = rB.rigid;
+
+            float restitution;
+            float friction;
+            const MaterialHandle mA = rA.material;
+            const MaterialHandle mB = rB.material;
+            if (mA != kNoMaterial && mB != kNoMaterial)
             {
-                return;
+                const auto& pair = pairTable[mA * materialCount + mB];
+                restitution = pair.restitution;
+                friction = pair.friction;
+            }
+            else
+            {
+                const auto pair = CombineMaterials(MaterialOf(*bA, mA != kNoMaterial ? &materials->Value(mA) : nullptr),
+                                                   MaterialOf(*bB, mB != kNoMaterial ? &materials->Value(mB) : nullptr));
+                restitution = pair.restitution;
+                friction = pair.friction;
             }
 
-            if (!jobSystem || islands.size() < 2)
+            const float leverA = bA->invInertia > 0.0f ? EstimateLever(rA.circle, rA.aabb) : 0.0f;
+            const float leverB = bB->invInertia > 0.0f ? EstimateLever(rB.circle, rB.aabb) : 0.0f;
+            std::uint8_t kind = 0;
+            if (friction > 0.0f)
             {
-                for (const auto& island : islands)
-                {
-                    fn(island);
-                }
-                return;
+                kind |= ContactBuffer::kFriction;
+                if (leverA > 0.0f || leverB > 0.0f) kind |= ContactBuffer::kRotation;
             }
+            if (bA->invMass == 0.0f) kind |= ContactBuffer::kStaticA;
+            if (bB->invMass == 0.0f) kind |= ContactBuffer::kStaticB;
+
+            contacts.a.push_back(solverBodyOf(contacts.records[recordA]));
+            contacts.b.push_back(solverBodyOf(contacts.records[recordB]));
+            contacts.nx.push_back(candidate.nx);
+            contacts.ny.push_back(candidate.ny);
+            contacts.pen.push_back(pen);
+            contacts.restitution.push_back(restitution);
+            contacts.friction.push_back(friction);
+            contacts.invMassSum.push_back(bA->invMass + bB->invMass);
+            contacts.leverA.push_back(leverA);
+            contacts.leverB.push_back(leverB);
+            contacts.kind.push_back(kind);
+        }
 
-            const std::size_t workerCount = std::max<std::size_t>(1, jobSystem->WorkerCount());
-            const std::size_t batch = std::max<std::size_t>(1, islands.size() / (workerCount * 2));
-            auto handles = jobSystem->Dispatch(islands.size(), batch, [&](std::size_t start, std::size_t end)
+        const std::size_t count = contacts.Size();
+        if (count == 0) return;
+
+        BuildIslands(contacts, jobSystem);
+
+        // The positions the depths were taken at, for re-measuring.
+        if (m_settings.positionTolerance > 0.0f || m_settings.measurePenetration)
+        {
+            const std::size_t bodies = contacts.bodyTransform.size();
+            contacts.bodyStartX.resize(bodies);
+            contacts.bodyStartY.resize(bodies);
+            for (std::size_t i = 0; i < bodies; ++i)
             {
-                for (std::size_t i = start; i < end; ++i)
-                {
-                    fn(islands[i]);
-                }
-            });
-            jobSystem->Wait(handles);
+                contacts.bodyStartX[i] = contacts.bodyTransform[i]->x;
+                contacts.bodyStartY[i] = contacts.bodyTransform[i]->y;
+            }
         }
     }
 
-    void CollisionResolutionSystem::ResolvePosition(const std::vector<CollisionEvent>& events, ecs::World& world, jobs::JobSystem* jobSystem) const
+    void CollisionResolutionSystem::ResolvePosition(ContactBuffer& contacts, jobs::JobSystem* jobSystem,
+                                                    SolverIterationStats* stats) const
     {
-        auto contacts = GatherContacts(events, world);
-        if (contacts.empty())
+        if (contacts.Size() == 0)
         {
             return;
         }
@@ -371,122 +769,249 @@ namespace physics
         const float percent = m_settings.correctionPercent;
         const float slop = m_settings.penetrationSlop;
         const float maxCorrection = m_settings.maxCorrection;
-        auto islands = BuildIslands(contacts);
+        const float tolerance = std::max(0.0f, m_settings.positionTolerance);
+
+        const std::size_t bodies = contacts.bodyRigid.size();
+        auto& x = contacts.bodyX;
+        auto& y = contacts.bodyY;
+        x.resize(bodies);
+        y.resize(bodies);
+        for (std::size_t i = 0; i < bodies; ++i)
+        {
+            x[i] = contacts.bodyTransform[i]->x;
+            y[i] = contacts.bodyTransform[i]->y;
+        }
+        // Re-measuring penetration needs each body's position at the time
+        // the depths were taken (see PrepareContacts).
+        const bool measure = tolerance > 0.0f || m_settings.measurePenetration;
+        if (measure && contacts.bodyStartX.size() != bodies)
+        {
+            // Prepared under other settings: measure from here instead.
+            contacts.bodyStartX = x;
+            contacts.bodyStartY = y;
+        }
+        const float* startX = contacts.bodyStartX.data();
+        const float* startY = contacts.bodyStartY.data();
+        const float* invMass = contacts.bodyInvMass.data();
 
-        auto solveIsland = [&](const std::vector<const Contact*>& islandContacts)
+        // Correction along row k's normal, from the penetration beyond slop
+        // (also returned through `error`).
+        auto correctionOf = [&](std::uint32_t k, float& error)
         {
-            for (int i = 0; i < positionIterations; ++i)
+            const std::uint32_t a = contacts.a[k];
+            const std::uint32_t b = contacts.b[k];
+            float pen = contacts.pen[k];
+            if (measure)
             {
-                for (const Contact* contactPtr : islandContacts)
-                {
-                    const auto& c = *contactPtr;
-                    float correction = std::max(c.pen - slop, 0.0f) / c.invMassSum * percent;
-                    if (correction > maxCorrection) correction = maxCorrection;
-
-                    float cx = correction * c.nx;
-                    float cy = correction * c.ny;
-
-                    c.tA->x -= cx * c.bA->invMass;
-                    c.tA->y -= cy * c.bA->invMass;
-                    c.tB->x += cx * c.bB->invMass;
-                    c.tB->y += cy * c.bB->invMass;
-                }
+                const float moveX = (x[b] - startX[b]) - (x[a] - startX[a]);
+                const float moveY = (y[b] - startY[b]) - (y[a] - startY[a]);
+                pen -= moveX * contacts.nx[k] + moveY * contacts.ny[k];
             }
+            error = std::max(pen - slop, 0.0f);
+            float correction = error / contacts.invMassSum[k] * percent;
+            if (correction > maxCorrection) correction = maxCorrection;
+            return correction;
         };
 
-        ExecuteIslands(islands, jobSystem, solveIsland);
+        if (m_settings.solver == ContactSolver::Jacobi)
+        {
+            float initial = 0.0f;
+            const int passes = SolveJacobi<false>(contacts, positionIterations, tolerance, jobSystem, initial,
+                [&](std::uint32_t k)
+                {
+                    float error = 0.0f;
+                    const float correction = correctionOf(k, error);
+                    const float cx = correction * contacts.nx[k];
+                    const float cy = correction * contacts.ny[k];
+                    contacts.endDx[2 * k] = -cx * invMass[contacts.a[k]];
+                    contacts.endDy[2 * k] = -cy * invMass[contacts.a[k]];
+                    contacts.endDx[2 * k + 1] = cx * invMass[contacts.b[k]];
+                    contacts.endDy[2 * k + 1] = cy * invMass[contacts.b[k]];
+                    return error;
+                },
+                [&](std::size_t i, float dx, float dy, float)
+                {
+                    x[i] += dx;
+                    y[i] += dy;
+                });
+            if (stats) stats->Add(passes, initial);
+        }
+        else
+        {
+            const std::size_t islands = contacts.IslandCount();
+            std::vector<int> used(islands, 0);
+            std::vector<float> initialResidual(islands, 0.0f);
+            auto solveIsland = [&](std::size_t island)
+            {
+                const std::uint32_t begin = contacts.islandStart[island];
+                const std::uint32_t end = contacts.islandStart[island + 1];
+                for (int i = 0; i < positionIterations; ++i)
+                {
+                    float residual = 0.0f;
+                    for (std::uint32_t k = begin; k < end; ++k)
+                    {
+                        const std::uint32_t a = contacts.a[k];
+                        const std::uint32_t b = contacts.b[k];
+                        float error = 0.0f;
+                        const float correction = correctionOf(k, error);
+                        residual = std::max(residual, error);
+
+                        const float cx = correction * contacts.nx[k];
+                        const float cy = correction * contacts.ny[k];
+
+                        x[a] -= cx * invMass[a];
+                        y[a] -= cy * invMass[a];
+                        x[b] += cx * invMass[b];
+                        y[b] += cy * invMass[b];
+                    }
+                    if (i == 0) initialResidual[island] = residual;
+                    used[island] = i + 1;
+                    if (residual <= tolerance) break;
+                }
+            };
+            ExecuteIslands(islands, jobSystem, solveIsland);
+            RecordIslandIterations(used, initialResidual, stats);
+        }
+
+        for (std::size_t i = 0; i < bodies; ++i)
+        {
+            if (invMass[i] == 0.0f) continue;
+            contacts.bodyTransform[i]->x = x[i];
+            contacts.bodyTransform[i]->y = y[i];
+        }
     }
 
-    void CollisionResolutionSystem::ResolveVelocity(const std::vector<CollisionEvent>& events, ecs::World& world, jobs::JobSystem* jobSystem) const
+    void CollisionResolutionSystem::ResolveVelocity(ContactBuffer& contacts, jobs::JobSystem* jobSystem,
+                                                    SolverIterationStats* stats) const
     {
-        auto contacts = GatherContacts(events, world);
-        if (contacts.empty())
+        if (contacts.Size() == 0)
         {
             return;
         }
 
         const int velocityIterations = std::max(1, m_settings.velocityIterations);
-        auto islands = BuildIslands(contacts);
+        const float tolerance = std::max(0.0f, m_settings.velocityTolerance);
+
+        const std::size_t bodies = contacts.bodyRigid.size();
+        auto& vx = contacts.bodyVx;
+        auto& vy = contacts.bodyVy;
+        auto& w = contacts.bodyAngularVelocity;
+        vx.resize(bodies);
+        vy.resize(bodies);
+        w.resize(bodies);
+        for (std::size_t i = 0; i < bodies; ++i)
+        {
+            const auto* body = contacts.bodyRigid[i];
+            vx[i] = body->vx;
+            vy[i] = body->vy;
+            w[i] = body->angularVelocity;
+        }
+        const float* invMass = contacts.bodyInvMass.data();
+        const float* invInertia = contacts.bodyInvInertia.data();
 
-        auto solveIsland = [&](const std::vector<const Contact*>& islandContacts)
+        if (m_settings.solver == ContactSolver::Jacobi)
         {
-            for (int i = 0; i < velocityIterations; ++i)
+            float initial = 0.0f;
+            const int passes = SolveJacobi<true>(contacts, velocityIterations, tolerance, jobSystem, initial,
+                [&](std::uint32_t k)
+                {
+                    // The same impulses as SolveVelocityBatch, both from the
+                    // pass's starting velocities; the normal impulse leaves
+                    // the tangential velocity unchanged.
+                    const std::uint32_t a = contacts.a[k];
+                    const std::uint32_t b = contacts.b[k];
+                    const float nx = contacts.nx[k];
+                    const float ny = contacts.ny[k];
+                    const float invMassSum = contacts.invMassSum[k];
+                    const float rvx = vx[b] - vx[a];
+                    const float rvy = vy[b] - vy[a];
+                    const float velAlongNormal = rvx * nx + rvy * ny;
+                    const float j = velAlongNormal < 0.0f
+                        ? -(1 + contacts.restitution[k]) * velAlongNormal / invMassSum : 0.0f;
+                    const float tx = -ny;
+                    const float ty = nx;
+                    const float maxJt = contacts.friction[k] * (j > 0.0f ? j : 0.1f);
+                    const float jt = std::clamp(-(rvx * tx + rvy * ty) / invMassSum, -maxJt, maxJt);
+
+                    const float impulseX = j * nx + jt * tx;
+                    const float impulseY = j * ny + jt * ty;
+                    contacts.endDx[2 * k] = -impulseX * invMass[a];
+                    contacts.endDy[2 * k] = -impulseY * invMass[a];
+                    contacts.endDw[2 * k] = -jt * contacts.leverA[k] * invInertia[a];
+                    contacts.endDx[2 * k + 1] = impulseX * invMass[b];
+                    contacts.endDy[2 * k + 1] = impulseY * invMass[b];
+                    contacts.endDw[2 * k + 1] = jt * contacts.leverB[k] * invInertia[b];
+                    return std::max(j, std::abs(jt)) * invMassSum;
+                },
+                [&](std::size_t i, float dx, float dy, float dw)
+                {
+                    vx[i] += dx;
+                    vy[i] += dy;
+                    w[i] += dw;
+                });
+            if (stats) stats->Add(passes, initial);
+        }
+        else
+        {
+            const std::size_t islands = contacts.IslandCount();
+            std::vector<int> used(islands, 0);
+            std::vector<float> initialResidual(islands, 0.0f);
+            const VelocityState state{&contacts, vx.data(), vy.data(), w.data(), invMass, invInertia};
+            auto solveIsland = [&](std::size_t island)
             {
-                for (const Contact* contactPtr : islandContacts)
+                const std::uint32_t firstBatch = contacts.islandBatch[island];
+                const std::uint32_t lastBatch = contacts.islandBatch[island + 1];
+                for (int i = 0; i < velocityIterations; ++i)
                 {
-                    const auto& c = *contactPtr;
-                    float rvx = c.bB->vx - c.bA->vx;
-                    float rvy = c.bB->vy - c.bA->vy;
-
-                    float velAlongNormal = rvx * c.nx + rvy * c.ny;
-
-                    float j = 0.0f;
-                    if (velAlongNormal < 0)
+                    // Largest relative velocity change applied in this pass.
+                    float residual = 0.0f;
+                    for (std::uint32_t batch = firstBatch; batch < lastBatch; ++batch)
                     {
-                        j = -(1 + c.restitution) * velAlongNormal;
-                        j /= c.invMassSum;
-
-                        float impulseX = j * c.nx;
-                        float impulseY = j * c.ny;
-
-                        c.bA->vx -= impulseX * c.bA->invMass;
-                        c.bA->vy -= impulseY * c.bA->invMass;
-                        c.bB->vx += impulseX * c.bB->invMass;
-                        c.bB->vy += impulseY * c.bB->invMass;
+                        const auto kernel = kVelocityKernels[contacts.batchKind[batch]];
+                        residual = std::max(residual,
+                                            kernel(state, contacts.batchStart[batch], contacts.batchStart[batch + 1]));
                     }
+                    if (i == 0) initialResidual[island] = residual;
+                    used[island] = i + 1;
+                    if (residual <= tolerance) break;
+                }
+            };
+            ExecuteIslands(islands, jobSystem, solveIsland);
+            RecordIslandIterations(used, initialResidual, stats);
+        }
 
-                    if (c.pen > -0.05f)
-                    {
-                        rvx = c.bB->vx - c.bA->vx;
-                        rvy = c.bB->vy - c.bA->vy;
-
-                        float tx = -c.ny;
-                        float ty = c.nx;
-                        float velAlongTangent = rvx * tx + rvy * ty;
-
-                        float jt = -velAlongTangent;
-                        jt /= c.invMassSum;
-
-                        float maxJt = 0.0f;
-                        if (j > 0) {
-                            maxJt = c.friction * j;
-                        } else {
-                            maxJt = c.friction * 0.1f;
-                        }
-
-                        if (std::abs(jt) > maxJt)
-                        {
-                            jt = (jt > 0) ? maxJt : -maxJt;
-                        }
-
-                        float frictionImpulseX = jt * tx;
-                        float frictionImpulseY = jt * ty;
-
-                        c.bA->vx -= frictionImpulseX * c.bA->invMass;
-                        c.bA->vy -= frictionImpulseY * c.bA->invMass;
-                        c.bB->vx += frictionImpulseX * c.bB->invMass;
-                        c.bB->vy += frictionImpulseY * c.bB->invMass;
+        for (std::size_t i = 0; i < bodies; ++i)
+        {
+            if (invMass[i] == 0.0f) continue;
+            auto* body = contacts.bodyRigid[i];
+            body->vx = vx[i];
+            body->vy = vy[i];
+            body->angularVelocity = w[i];
+        }
+    }
 
-                        if (c.leverA > 0.0f && c.bA->invInertia > 0.0f)
-                        {
-                            c.bA->angularVelocity -= jt * c.leverA * c.bA->invInertia;
-                        }
-                        if (c.leverB > 0.0f && c.bB->invInertia > 0.0f)
-                        {
-                            c.bB->angularVelocity += jt * c.leverB * c.bB->invInertia;
-                        }
-                    }
-                }
-            }
-        };
+    void CollisionResolutionSystem::ResolvePosition(const std::vector<CollisionEvent>& events, ecs::World& world, jobs::JobSystem* jobSystem,
+                                                    SolverIterationStats* stats) const
+    {
+        ContactBuffer contacts;
+        PrepareContacts(events, world, contacts, jobSystem);
+        ResolvePosition(contacts, jobSystem, stats);
+    }
 
-        ExecuteIslands(islands, jobSystem, solveIsland);
+    void CollisionResolutionSystem::ResolveVelocity(const std::vector<CollisionEvent>& events, ecs::World& world, jobs::JobSystem* jobSystem,
+                                                    SolverIterationStats* stats) const
+    {
+        ContactBuffer contacts;
+        PrepareContacts(events, world, contacts, jobSystem);
+        ResolveVelocity(contacts, jobSystem, stats);
     }
 
     void CollisionResolutionSystem::Resolve(const std::vector<CollisionEvent>& events, ecs::World& world) const
     {
-        ResolvePosition(events, world, nullptr);
-        ResolveVelocity(events, world, nullptr);
+        ContactBuffer contacts;
+        PrepareContacts(events, world, contacts);
+        ResolvePosition(contacts);
+        ResolveVelocity(contacts);
     }
 
     void CollisionResolutionSystem::Resolve(const std::vector<CollisionEvent>& events,
@@ -548,69 +1073,550 @@ namespace physics
         }
     }
 
-    void ConstraintResolutionSystem::Resolve(ecs::World& world, float dt) const
+    bool ConstraintResolutionSystem::CacheIsValid(const ecs::World& world) const
+    {
+        const auto* jointStorage = world.GetStorage<DistanceJointComponent>();
+        const auto* tfStorage = world.GetStorage<TransformComponent>();
+        const auto* rbStorage = world.GetStorage<RigidBodyComponent>();
+        if (m_cacheWorld != &world || !jointStorage || !tfStorage || !rbStorage)
+        {
+            return false;
+        }
+
+        if (jointStorage->LayoutVersion() != m_jointLayout
+            || jointStorage->StructureVersion() != m_jointStructure
+            || tfStorage->LayoutVersion() != m_transformLayout
+            || rbStorage->LayoutVersion() != m_bodyLayout)
+        {
+            return false;
+        }
+
+        // Joints skipped for a missing endpoint may have become solvable.
+        if (m_cacheIncomplete
+            && (tfStorage->StructureVersion() != m_transformStructure
+                || rbStorage->StructureVersion() != m_bodyStructure))
+        {
+            return false;
+        }
+
+        // A joint written since the build may point at different entities now.
+        for (std::size_t i = 0; i < jointStorage->Size(); ++i)
+        {
+            if (jointStorage->ChangedTick(i) >= m_cacheTick)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void ConstraintResolutionSystem::RebuildCache(ecs::World& world)
     {
-        auto* jointStorage = world.GetStorage<DistanceJointComponent>();
+        m_bodyTransform.clear();
+        m_bodyRigid.clear();
+        m_bodyDynamic.clear();
+        m_rowA.clear();
+        m_rowB.clear();
+        m_rowTarget.clear();
+        m_rowCompliance.clear();
+        m_chainRows.clear();
+        m_chainStart.clear();
+        m_treeNodes.clear();
+        m_treeStart.clear();
+        m_cacheWorld = nullptr;
+        m_cacheIncomplete = false;
+
+        const auto* jointStorage = std::as_const(world).GetStorage<DistanceJointComponent>();
         auto* tfStorage = world.GetStorage<TransformComponent>();
         auto* rbStorage = world.GetStorage<RigidBodyComponent>();
-
         if (!jointStorage || !tfStorage || !rbStorage) return;
 
-        const auto& joints = jointStorage->GetData();
-        
-        // Pre-resolve pointers
-        struct Constraint
-        {
-            TransformComponent* tA;
-            TransformComponent* tB;
-            RigidBodyComponent* bA;
-            RigidBodyComponent* bB;
-            float targetDistance;
-            float invMassSum;
-            float compliance;
+        ++m_cacheRebuilds;
+        std::unordered_map<ecs::EntityId, std::uint32_t> bodyIndex;
+        auto bodyFor = [&](ecs::EntityId id) -> std::uint32_t
+        {
+            auto it = bodyIndex.find(id);
+            if (it != bodyIndex.end())
+            {
+                return it->second;
+            }
+            auto* tf = tfStorage->Get(id);
+            auto* rb = rbStorage->Get(id);
+            if (!tf || !rb)
+            {
+                return UINT32_MAX;
+            }
+            const auto index = static_cast<std::uint32_t>(m_bodyTransform.size());
+            m_bodyTransform.push_back(tf);
+            m_bodyRigid.push_back(rb);
+            m_bodyDynamic.push_back(rb->invMass != 0.0f && !rb->asleep ? 1 : 0);
+            bodyIndex.emplace(id, index);
+            return index;
         };
 
-        std::vector<Constraint> constraints;
-        constraints.reserve(joints.size());
+        for (const auto& joint : jointStorage->GetData())
+        {
+            const std::uint32_t a = bodyFor(joint.entityA);
+            const std::uint32_t b = bodyFor(joint.entityB);
+            if (a == UINT32_MAX || b == UINT32_MAX)
+            {
+                m_cacheIncomplete = true;
+                continue;
+            }
+            m_rowA.push_back(a);
+            m_rowB.push_back(b);
+            m_rowTarget.push_back(joint.targetDistance);
+            m_rowCompliance.push_back(joint.compliance);
+        }
+
+        // Chains: union rows over dynamic bodies only. Static bodies are read
+        // but never written, so they may be shared between chains.
+        const std::size_t bodyCount = m_bodyTransform.size();
+        std::vector<std::uint32_t> parent(bodyCount);
+        for (std::uint32_t k = 0; k < bodyCount; ++k) parent[k] = k;
+        auto find = [&](std::uint32_t x)
+        {
+            while (parent[x] != x)
+            {
+                parent[x] = parent[parent[x]];
+                x = parent[x];
+            }
+            return x;
+        };
+        for (std::size_t r = 0; r < m_rowA.size(); ++r)
+        {
+            if (m_bodyDynamic[m_rowA[r]] && m_bodyDynamic[m_rowB[r]])
+            {
+                const std::uint32_t ra = find(m_rowA[r]);
+                const std::uint32_t rb = find(m_rowB[r]);
+                if (ra != rb) parent[std::max(ra, rb)] = std::min(ra, rb);
+            }
+        }
 
-        for (const auto& joint : joints)
+        // Chains are numbered by first row and keep rows in joint order.
+        std::vector<std::uint32_t> chainOfRoot(bodyCount, UINT32_MAX);
+        std::vector<std::uint32_t> rowChain(m_rowA.size());
+        std::vector<std::uint32_t> chainSize;
+        for (std::size_t r = 0; r < m_rowA.size(); ++r)
         {
-            auto* tA = tfStorage->Get(joint.entityA);
-            auto* tB = tfStorage->Get(joint.entityB);
-            auto* bA = rbStorage->Get(joint.entityA);
-            auto* bB = rbStorage->Get(joint.entityB);
+            const std::uint32_t anchor = m_bodyDynamic[m_rowA[r]] ? m_rowA[r] : m_rowB[r];
+            const std::uint32_t root = find(anchor);
+            if (chainOfRoot[root] == UINT32_MAX)
+            {
+                chainOfRoot[root] = static_cast<std::uint32_t>(chainSize.size());
+                chainSize.push_back(0);
+            }
+            rowChain[r] = chainOfRoot[root];
+            ++chainSize[rowChain[r]];
+        }
+        m_chainStart.assign(chainSize.size() + 1, 0);
+        for (std::size_t c = 0; c < chainSize.size(); ++c)
+        {
+            m_chainStart[c + 1] = m_chainStart[c] + chainSize[c];
+        }
+        m_chainRows.resize(m_rowA.size());
+        std::vector<std::uint32_t> cursor(m_chainStart.begin(), m_chainStart.end() - 1);
+        for (std::size_t r = 0; r < m_rowA.size(); ++r)
+        {
+            m_chainRows[cursor[rowChain[r]]++] = static_cast<std::uint32_t>(r);
+        }
 
-            if (!tA || !tB || !bA || !bB) continue;
-            float invMassSum = bA->invMass + bB->invMass;
-            if (invMassSum == 0.0f) continue;
+        m_bodyX.resize(bodyCount);
+        m_bodyY.resize(bodyCount);
+        m_bodyInvMass.resize(bodyCount);
+        BuildTrees();
+
+        m_cacheWorld = &world;
+        m_jointLayout = jointStorage->LayoutVersion();
+        m_jointStructure = jointStorage->StructureVersion();
+        m_transformLayout = tfStorage->LayoutVersion();
+        m_bodyLayout = rbStorage->LayoutVersion();
+        m_transformStructure = tfStorage->StructureVersion();
+        m_bodyStructure = rbStorage->StructureVersion();
+        // Writes stamped with the current tick may land after this build, so
+        // they still count as newer; at worst that costs one extra rebuild.
+        m_cacheTick = world.ChangeTick();
+    }
 
-            constraints.push_back({tA, tB, bA, bB, joint.targetDistance, invMassSum, joint.compliance});
+    void ConstraintResolutionSystem::BuildTrees()
+    {
+        const std::size_t bodyCount = m_bodyTransform.size();
+        const std::size_t rowCount = m_rowA.size();
+
+        // Body -> row adjacency over dynamic endpoints (CSR).
+        std::vector<std::uint32_t> adjStart(bodyCount + 1, 0);
+        for (std::size_t r = 0; r < rowCount; ++r)
+        {
+            if (m_bodyDynamic[m_rowA[r]]) ++adjStart[m_rowA[r] + 1];
+            if (m_bodyDynamic[m_rowB[r]]) ++adjStart[m_rowB[r] + 1];
         }
+        for (std::size_t k = 0; k < bodyCount; ++k) adjStart[k + 1] += adjStart[k];
+        std::vector<std::uint32_t> adjRows(adjStart[bodyCount]);
+        std::vector<std::uint32_t> cursor(adjStart.begin(), adjStart.end() - 1);
+        for (std::size_t r = 0; r < rowCount; ++r)
+        {
+            if (m_bodyDynamic[m_rowA[r]]) adjRows[cursor[m_rowA[r]]++] = static_cast<std::uint32_t>(r);
+            if (m_bodyDynamic[m_rowB[r]]) adjRows[cursor[m_rowB[r]]++] = static_cast<std::uint32_t>(r);
+        }
+
+        std::vector<std::uint8_t> bodySeen(bodyCount, 0);
+        std::vector<std::uint8_t> rowSeen(rowCount, 0);
+        const std::size_t chains = ChainCount();
+        m_treeStart.assign(chains + 1, 0);
+        for (std::size_t c = 0; c < chains; ++c)
+        {
+            const auto chainBegin = static_cast<std::uint32_t>(m_treeNodes.size());
+            m_treeStart[c] = chainBegin;
 
+            const std::uint32_t first = m_chainRows[m_chainStart[c]];
+            const std::uint32_t root = m_bodyDynamic[m_rowA[first]] ? m_rowA[first] : m_rowB[first];
+            if (!m_bodyDynamic[root])
+            {
+                continue; // only static bodies: nothing to solve
+            }
+
+            // Breadth-first walk; a tree has exactly one edge fewer than nodes.
+            std::size_t edges = 0;
+            bodySeen[root] = 1;
+            m_treeNodes.push_back({root, UINT32_MAX, false});
+            for (std::size_t n = chainBegin; n < m_treeNodes.size(); ++n)
+            {
+                const TreeNode node = m_treeNodes[n];
+                const auto self = static_cast<std::uint32_t>(n);
+                if (node.isRow)
+                {
+                    edges += static_cast<std::size_t>(m_bodyDynamic[m_rowA[node.index]])
+                           + static_cast<std::size_t>(m_bodyDynamic[m_rowB[node.index]]);
+                    for (std::uint32_t body : {m_rowA[node.index], m_rowB[node.index]})
+                    {
+                        if (m_bodyDynamic[body] && !bodySeen[body])
+                        {
+                            bodySeen[body] = 1;
+                            m_treeNodes.push_back({body, self, false});
+                        }
+                    }
+                }
+                else
+                {
+                    for (std::uint32_t k = adjStart[node.index]; k < adjStart[node.index + 1]; ++k)
+                    {
+                        const std::uint32_t r = adjRows[k];
+                        if (!rowSeen[r])
+                        {
+                            rowSeen[r] = 1;
+                            m_treeNodes.push_back({r, self, true});
+                        }
+                    }
+                }
+            }
+
+            if (edges + 1 != m_treeNodes.size() - chainBegin)
+            {
+                m_treeNodes.resize(chainBegin); // loop: keep the iterative path
+            }
+        }
+        m_treeStart[chains] = static_cast<std::uint32_t>(m_treeNodes.size());
+        m_treeWork.resize(m_treeNodes.size());
+        m_rowGradX.resize(rowCount);
+        m_rowGradY.resize(rowCount);
+        m_rowLambda.resize(rowCount);
+    }
+
+    std::size_t ConstraintResolutionSystem::DirectChainCount() const noexcept
+    {
+        std::size_t count = 0;
+        for (std::size_t c = 0; c + 1 < m_treeStart.size(); ++c)
+        {
+            if (m_treeStart[c + 1] > m_treeStart[c]) ++count;
+        }
+        return count;
+    }
+
+    bool ConstraintResolutionSystem::GatherBodies()
+    {
+        for (std::size_t k = 0; k < m_bodyTransform.size(); ++k)
+        {
+            // Sleeping bodies are held in place like static ones.
+            const float invMass = m_bodyRigid[k]->asleep ? 0.0f : m_bodyRigid[k]->invMass;
+            if ((invMass != 0.0f) != (m_bodyDynamic[k] != 0))
+            {
+                return false; // a body switched between static and dynamic
+            }
+            m_bodyX[k] = m_bodyTransform[k]->x;
+            m_bodyY[k] = m_bodyTransform[k]->y;
+            m_bodyInvMass[k] = invMass;
+        }
+        return true;
+    }
+
+    int ConstraintResolutionSystem::SolveChain(std::size_t chain, float dt)
+    {
         const int iterations = std::max(1, m_iterations);
         const float dtSafe = std::max(dt, 1e-4f);
+        const std::uint32_t begin = m_chainStart[chain];
+        const std::uint32_t end = m_chainStart[chain + 1];
+
+        float* x = m_bodyX.data();
+        float* y = m_bodyY.data();
+        const float* invMass = m_bodyInvMass.data();
         for (int iter = 0; iter < iterations; ++iter)
         {
-            for (const auto& c : constraints)
+            float residual = 0.0f;
+            for (std::uint32_t k = begin; k < end; ++k)
             {
-                float dx = c.tB->x - c.tA->x;
-                float dy = c.tB->y - c.tA->y;
+                const std::uint32_t r = m_chainRows[k];
+                const std::uint32_t a = m_rowA[r];
+                const std::uint32_t b = m_rowB[r];
+                const float invMassSum = invMass[a] + invMass[b];
+                if (invMassSum == 0.0f) continue;
+
+                float dx = x[b] - x[a];
+                float dy = y[b] - y[a];
                 float dist = std::sqrt(dx*dx + dy*dy);
                 if (dist < 0.0001f) continue;
 
-                float diff = dist - c.targetDistance;
-                float complianceTerm = (c.compliance > 0.0f) ? (c.compliance / (dtSafe * dtSafe)) : 0.0f;
-                float denom = c.invMassSum + complianceTerm;
+                float diff = dist - m_rowTarget[r];
+                residual = std::max(residual, std::fabs(diff));
+                float complianceTerm = (m_rowCompliance[r] > 0.0f) ? (m_rowCompliance[r] / (dtSafe * dtSafe)) : 0.0f;
+                float denom = invMassSum + complianceTerm;
                 if (denom <= 0.0f) continue;
                 float correction = diff / denom;
 
                 float px = (dx / dist) * correction;
                 float py = (dy / dist) * correction;
 
-                c.tA->x += px * c.bA->invMass;
-                c.tA->y += py * c.bA->invMass;
-                c.tB->x -= px * c.bB->invMass;
-                c.tB->y -= py * c.bB->invMass;
+                x[a] += px * invMass[a];
+                y[a] += py * invMass[a];
+                x[b] -= px * invMass[b];
+                y[b] -= py * invMass[b];
+            }
+            if (residual <= m_tolerance)
+            {
+                return iter + 1;
+            }
+        }
+        return iterations;
+    }
+
+    int ConstraintResolutionSystem::SolveChainDirect(std::size_t chain, float dt)
+    {
+        // Newton passes on the linearized system
+        //   [ M   J^T ] [ dx ]   [      0      ]
+        //   [ J  -a~  ] [ mu ] = [ -C - a~ lam ]
+        // with mu = -dlam. Each tree node owns one block; eliminating leaves
+        // into parents costs O(n) and needs no pivoting because the system is
+        // quasi-definite (bodies positive, rows negative).
+        constexpr int kPasses = 2;
+        const double dtSafe = std::max(dt, 1e-4f);
+        const std::uint32_t begin = m_treeStart[chain];
+        const std::uint32_t end = m_treeStart[chain + 1];
+
+        float* x = m_bodyX.data();
+        float* y = m_bodyY.data();
+        const float* invMass = m_bodyInvMass.data();
+        const TreeNode* nodes = m_treeNodes.data();
+        TreeWork* work = m_treeWork.data();
+        for (std::uint32_t k = m_chainStart[chain]; k < m_chainStart[chain + 1]; ++k)
+        {
+            m_rowLambda[m_chainRows[k]] = 0.0;
+        }
+
+        // Gradient of a row with respect to one of its bodies.
+        auto gradient = [&](std::uint32_t row, std::uint32_t body, double& gx, double& gy)
+        {
+            const double sign = body == m_rowA[row] ? -1.0 : 1.0;
+            gx = sign * m_rowGradX[row];
+            gy = sign * m_rowGradY[row];
+        };
+
+        // Each round measures the rows and stops once they are within
+        // tolerance or the passes are used up, so the last pass is checked
+        // too. A chain already within tolerance reports one iteration, as
+        // SolveChain does.
+        for (int pass = 0;; ++pass)
+        {
+            double residual = 0.0;
+            for (std::uint32_t n = begin; n < end; ++n)
+            {
+                TreeWork& w = work[n];
+                const std::uint32_t i = nodes[n].index;
+                if (!nodes[n].isRow)
+                {
+                    const double mass = 1.0 / static_cast<double>(invMass[i]);
+                    w.d[0] = mass; w.d[1] = 0.0; w.d[2] = mass;
+                    w.v[0] = 0.0;  w.v[1] = 0.0;
+                    continue;
+                }
+
+                const std::uint32_t a = m_rowA[i];
+                const std::uint32_t b = m_rowB[i];
+                const double dx = static_cast<double>(x[b]) - x[a];
+                const double dy = static_cast<double>(y[b]) - y[a];
+                const double dist = std::sqrt(dx * dx + dy * dy);
+                if (dist < 0.0001)
+                {
+                    // Direction undefined: decouple the row for this pass.
+                    m_rowGradX[i] = 0.0;
+                    m_rowGradY[i] = 0.0;
+                    w.d[0] = -1.0;
+                    w.v[0] = 0.0;
+                    continue;
+                }
+                double compliance = m_rowCompliance[i] > 0.0f ? m_rowCompliance[i] / (dtSafe * dtSafe) : 0.0;
+                compliance += 1e-9 * (static_cast<double>(invMass[a]) + invMass[b]);
+                m_rowGradX[i] = dx / dist;
+                m_rowGradY[i] = dy / dist;
+                w.d[0] = -compliance;
+                w.v[0] = -(dist - m_rowTarget[i]) - compliance * m_rowLambda[i];
+                residual = std::max(residual, std::fabs(w.v[0]));
+            }
+            if (residual <= m_tolerance)
+            {
+                return std::max(pass, 1);
+            }
+            if (pass == kPasses)
+            {
+                return kPasses;
+            }
+
+            // Eliminate leaves first; afterwards v holds D^-1 * rhs.
+            for (std::uint32_t n = end - 1; n > begin; --n)
+            {
+                TreeWork& w = work[n];
+                TreeWork& p = work[nodes[n].parent];
+                double gx, gy;
+                if (nodes[n].isRow)
+                {
+                    gradient(nodes[n].index, nodes[nodes[n].parent].index, gx, gy);
+                    const double inv = 1.0 / w.d[0];
+                    w.j[0] = gx * inv;
+                    w.j[1] = gy * inv;
+                    w.v[0] *= inv;
+                    p.d[0] -= gx * w.j[0];
+                    p.d[1] -= gx * w.j[1];
+                    p.d[2] -= gy * w.j[1];
+                    p.v[0] -= gx * w.v[0];
+                    p.v[1] -= gy * w.v[0];
+                }
+                else
+                {
+                    gradient(nodes[nodes[n].parent].index, nodes[n].index, gx, gy);
+                    const double invDet = 1.0 / (w.d[0] * w.d[2] - w.d[1] * w.d[1]);
+                    const double i00 = w.d[2] * invDet;
+                    const double i01 = -w.d[1] * invDet;
+                    const double i11 = w.d[0] * invDet;
+                    w.j[0] = i00 * gx + i01 * gy;
+                    w.j[1] = i01 * gx + i11 * gy;
+                    const double vx = i00 * w.v[0] + i01 * w.v[1];
+                    const double vy = i01 * w.v[0] + i11 * w.v[1];
+                    w.v[0] = vx;
+                    w.v[1] = vy;
+                    p.d[0] -= gx * w.j[0] + gy * w.j[1];
+                    p.v[0] -= gx * vx + gy * vy;
+                }
+            }
+
+            // The root is always a body.
+            {
+                TreeWork& w = work[begin];
+                const double invDet = 1.0 / (w.d[0] * w.d[2] - w.d[1] * w.d[1]);
+                const double vx = (w.d[2] * w.v[0] - w.d[1] * w.v[1]) * invDet;
+                const double vy = (w.d[0] * w.v[1] - w.d[1] * w.v[0]) * invDet;
+                w.v[0] = vx;
+                w.v[1] = vy;
+            }
+
+            // Back-substitute from the root and apply the step.
+            for (std::uint32_t n = begin; n < end; ++n)
+            {
+                TreeWork& w = work[n];
+                if (n > begin)
+                {
+                    const TreeWork& p = work[nodes[n].parent];
+                    if (nodes[n].isRow)
+                    {
+                        w.v[0] -= w.j[0] * p.v[0] + w.j[1] * p.v[1];
+                    }
+                    else
+                    {
+                        w.v[0] -= w.j[0] * p.v[0];
+                        w.v[1] -= w.j[1] * p.v[0];
+                    }
+                }
+
+                const std::uint32_t i = nodes[n].index;
+                if (nodes[n].isRow)
+                {
+                    m_rowLambda[i] -= w.v[0];
+                }
+                else
+                {
+                    x[i] = static_cast<float>(x[i] + w.v[0]);
+                    y[i] = static_cast<float>(y[i] + w.v[1]);
+                }
+            }
+        }
+    }
+
+    void ConstraintResolutionSystem::Resolve(ecs::World& world, float dt, jobs::JobSystem* jobSystem)
+    {
+        m_lastIterations = {};
+        if (!CacheIsValid(world))
+        {
+            RebuildCache(world);
+        }
+        if (m_rowA.empty()) return;
+        if (!GatherBodies())
+        {
+            RebuildCache(world);
+            GatherBodies();
+        }
+
+        const std::size_t chains = ChainCount();
+        m_chainIterations.assign(chains, 0);
+        const bool direct = m_solver == JointSolver::Auto;
+        auto solve = [&](std::size_t c)
+        {
+            if (direct && m_treeStart[c + 1] > m_treeStart[c])
+            {
+                m_chainIterations[c] = SolveChainDirect(c, dt);
+            }
+            else
+            {
+                m_chainIterations[c] = SolveChain(c, dt);
+            }
+        };
+
+        if (jobSystem && chains > 1 && m_rowA.size() >= 64)
+        {
+            auto handles = jobSystem->Dispatch(chains, 1, [&](std::size_t start, std::size_t end) {
+                for (std::size_t c = start; c < end; ++c)
+                {
+                    solve(c);
+                }
+            });
+            jobSystem->Wait(handles);
+        }
+        else
+        {
+            for (std::size_t c = 0; c < chains; ++c)
+            {
+                solve(c);
+            }
+        }
+        for (int used : m_chainIterations)
+        {
+            m_lastIterations.Add(used);
+        }
+
+        // Scatter moved bodies back. Integration already stamped them this
+        // substep, so the writes need no change marking.
+        for (std::size_t k = 0; k < m_bodyTransform.size(); ++k)
+        {
+            if (m_bodyDynamic[k])
+            {
+                m_bodyTransform[k]->x = m_bodyX[k];
+                m_bodyTransform[k]->y = m_bodyY[k];
             }
         }
     }
@@ -19,7 +19,8 @@
 //
 // Systems / features shown:
 //   ECS        — CreateEntity, AddComponent, GetComponent, GetStorage,
-//                ForEach<T>, View<T1,T2> (multi-component intersection)
+//                ForEach<T>, View<T1,T2> (multi-component intersection),
+//                AddSharedComponent (flyweight PhysicsMaterial)
 //   Physics    — EnvironmentForces (gravity + drag), PhysicsSettings
 //                (substeps, constraintIterations), ConfigureCircleInertia,
 //                ConfigureBoxInertia, restitution, friction, angularDrag
@@ -120,8 +121,11 @@ namespace simlab
             auto phys = std::make_unique<physics::PhysicsSystem>();
             physics::PhysicsSettings cfg;
             cfg.substeps             = 16;  // high stability
-            cfg.constraintIterations = 16;  // stable rigid chain
+            cfg.constraintIterations = 4;   // chain is a tree: solved directly
             cfg.positionIterations   = 20;
+            cfg.spatialSortInterval  = 30;  // keep colliding parts close in memory
+            cfg.positionTolerance    = 0.002f; // settled islands stop early
+            cfg.velocityTolerance    = 0.01f;
             phys->SetSettings(cfg);
             phys->SetEnvironment(env);
             phys->SetJobSystem(&m_jobs);    // pass owned JobSystem
@@ -213,9 +217,8 @@ namespace simlab
                     auto& bb = world.AddComponent<physics::RigidBodyComponent>(box);
                     bb.mass        = 1.5f;
                     bb.invMass     = 1.0f / 1.5f;
-                    bb.friction    = 0.7f;
-                    bb.restitution = 0.1f;
                     bb.angularDrag = 0.15f;
+                    world.AddSharedComponent(box, kBoxMaterial);
                     world.AddComponent<physics::AABBComponent>(
                         box,
                         bx - kBoxSize * 0.5f, by - kBoxSize * 0.5f,
@@ -243,8 +246,7 @@ namespace simlab
                 auto& pb = world.AddComponent<physics::RigidBodyComponent>(p);
                 pb.mass        = 0.12f;
                 pb.invMass     = 1.0f / 0.12f;
-                pb.restitution = 0.80f;
-                pb.friction    = 0.05f;
+                world.AddSharedComponent(p, kParticleMaterial);
                 pb.vx          = rndVx(rng);
                 pb.vy          = rndVy(rng);
                 world.AddComponent<physics::CircleColliderComponent>(p, 0.30f);
@@ -274,6 +276,7 @@ namespace simlab
         void Render(ecs::World& world, std::ostream& out) override
         {
             m_renderer->Clear();
+            const ecs::World& scene = world;
 
             // ---- Arena border: DrawRect (White '+') -------------------------
             //  Maps inner bounds [kLeftX..kRightX] × [kFloorY..kArenaTop]
@@ -292,12 +295,12 @@ namespace simlab
             //  Uses multi-component View to select only entities that have
             //  both a transform and an AABB.  Static bodies (invMass==0) are
             //  skipped so only the dynamic tower blocks are drawn.
-            world.View<physics::TransformComponent, physics::AABBComponent>(
+            scene.View<physics::TransformComponent, physics::AABBComponent>(
                 [&](ecs::EntityId id,
-                    physics::TransformComponent& t,
-                    physics::AABBComponent& /*aabb*/)
+                    const physics::TransformComponent& t,
+                    const physics::AABBComponent& /*aabb*/)
                 {
-                    auto* rb = world.GetComponent<physics::RigidBodyComponent>(id);
+                    const auto* rb = scene.GetComponent<physics::RigidBodyComponent>(id);
                     if (!rb || rb->invMass == 0.0f) return;
                     const int sx = toSX(t.x), sy = toSY(t.y);
                     if (inBounds(sx, sy))
@@ -307,7 +310,7 @@ namespace simlab
             // ---- Particles: iterate tracked IDs (Green '.') ----------------
             for (ecs::EntityId pid : m_partIds)
             {
-                if (auto* t = world.GetComponent<physics::TransformComponent>(pid))
+                if (const auto* t = scene.GetComponent<physics::TransformComponent>(pid))
                 {
                     const int sx = toSX(t->x), sy = toSY(t->y);
                     if (inBounds(sx, sy))
@@ -322,7 +325,7 @@ namespace simlab
                 int px = toSX(kAnchorX), py = toSY(kAnchorY);
                 for (ecs::EntityId cid : m_chainIds)
                 {
-                    if (auto* t = world.GetComponent<physics::TransformComponent>(cid))
+                    if (const auto* t = scene.GetComponent<physics::TransformComponent>(cid))
                     {
                         const int nx = toSX(t->x), ny = toSY(t->y);
                         m_renderer->DrawLine(px, py, nx, ny, '-', ascii::Color::Yellow);
@@ -334,7 +337,7 @@ namespace simlab
             // ---- Wrecking ball: DrawEllipse outer ring + FillEllipse body --
             //  DrawEllipse (Red ':') draws the impact halo one cell larger than
             //  the filled body, giving the ball a distinct outline.
-            if (auto* bt = world.GetComponent<physics::TransformComponent>(m_ballId))
+            if (const auto* bt = scene.GetComponent<physics::TransformComponent>(m_ballId))
             {
                 const int bsx = toSX(bt->x), bsy = toSY(bt->y);
                 const int rx  = static_cast<int>(kBallR * kSX);  // = 3
@@ -400,6 +403,10 @@ namespace simlab
         static constexpr int   kTowerCols   =  4;
         static constexpr int   kTowerRows   =  3;
 
+        // ---- Shared contact materials (one instance per group) --------------
+        static constexpr physics::PhysicsMaterial kBoxMaterial     {0.10f, 0.70f};
+        static constexpr physics::PhysicsMaterial kParticleMaterial{0.80f, 0.05f};
+
         // ---- Particles ------------------------------------------------------
         static constexpr int   kParticles  = 30;
 
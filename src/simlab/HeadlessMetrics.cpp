@@ -448,7 +448,8 @@ namespace simlab
             auto metrics = CaptureFrameMetrics(world,
                                                *physicsSystem,
                                                static_cast<std::size_t>(state.frameCounter),
-                                               state.simTimeSeconds);
+                                               state.simTimeSeconds,
+                                               state.hasher);
             metrics.updateWallSeconds = std::chrono::duration<double>(updateEnd - updateStart).count();
             metrics.renderWallSeconds = std::chrono::duration<double>(renderEnd - renderStart).count();
             metrics.frameWallSeconds = std::chrono::duration<double>(renderEnd - frameStart).count();
@@ -1096,14 +1097,32 @@ namespace simlab
                                      const physics::PhysicsSystem& physicsSystem,
                                      std::size_t frameIndex,
                                      double simTimeSeconds) noexcept
+    {
+        WorldHasher hasher;
+        return CaptureFrameMetrics(world, physicsSystem, frameIndex, simTimeSeconds, hasher);
+    }
+
+    FrameMetrics CaptureFrameMetrics(const ecs::World& world,
+                                     const physics::PhysicsSystem& physicsSystem,
+                                     std::size_t frameIndex,
+                                     double simTimeSeconds,
+                                     WorldHasher& hasher) noexcept
     {
         FrameMetrics metrics{};
         metrics.frameIndex = frameIndex;
         metrics.simTimeSeconds = simTimeSeconds;
 
-        WorldHasher hasher;
-        metrics.worldHash = hasher.HashWorld(world);
+        metrics.worldHash = hasher.HashWorldChanged(world);
         metrics.collisionCount = physicsSystem.GetCollisionEvents().size();
+        metrics.contactIndexStride = physics::MeanContactStride(world, physicsSystem.GetCollisionEvents());
+        const auto& stepStats = physicsSystem.StepStats();
+        metrics.positionIterationsPerIsland = stepStats.position.MeanIterations();
+        metrics.velocityIterationsPerIsland = stepStats.velocity.MeanIterations();
+        metrics.constraintIterationsPerChain = stepStats.constraint.MeanIterations();
+        metrics.sleepingBodyCount = stepStats.sleepingBodies;
+        metrics.bodiesSlept = stepStats.bodiesSlept;
+        metrics.bodiesWoken = stepStats.bodiesWoken;
+        metrics.substeps = stepStats.substeps;
 
         if (const auto* rigidBodies = world.GetStorage<physics::RigidBodyComponent>())
         {
@@ -1166,7 +1185,7 @@ namespace simlab
 
     void WriteFrameMetricsCsvHeader(std::ostream& out)
     {
-        out << "frame,sim_time_seconds,world_hash,collision_count,rigid_body_count,dynamic_body_count,transform_count,update_wall_seconds,render_wall_seconds,frame_wall_seconds\n";
+        out << "frame,sim_time_seconds,world_hash,collision_count,rigid_body_count,dynamic_body_count,transform_count,update_wall_seconds,render_wall_seconds,frame_wall_seconds,contact_index_stride,position_iterations_per_island,velocity_iterations_per_island,constraint_iterations_per_chain,sleeping_bodies,bodies_slept,bodies_woken,substeps\n";
     }
 
     void WriteFrameMetricsCsvRow(std::ostream& out, const FrameMetrics& metrics)
@@ -1183,7 +1202,15 @@ namespace simlab
             << metrics.transformCount << ','
             << metrics.updateWallSeconds << ','
             << metrics.renderWallSeconds << ','
-            << metrics.frameWallSeconds << '\n';
+            << metrics.frameWallSeconds << ','
+            << metrics.contactIndexStride << ','
+            << metrics.positionIterationsPerIsland << ','
+            << metrics.velocityIterationsPerIsland << ','
+            << metrics.constraintIterationsPerChain << ','
+            << metrics.sleepingBodyCount << ','
+            << metrics.bodiesSlept << ','
+            << metrics.bodiesWoken << ','
+            << metrics.substeps << '\n';
 
         out.flags(previousFlags);
         out.precision(previousPrecision);
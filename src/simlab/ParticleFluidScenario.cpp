@@ -18,6 +18,7 @@
 #include "simlab/Scenario.hpp"
 #include "ecs/World.hpp"
 #include "physics/Components.hpp"
+#include "physics/Fluid.hpp"
 #include "physics/Systems.hpp"
 #include "jobs/JobSystem.hpp"
 #include "ascii/TextRenderer.hpp"
@@ -37,39 +38,68 @@ namespace simlab
             physics::EnvironmentForces env;
             env.gravityY = -9.81f;
             
+            // Rigid balls; the fluid is not part of the rigid body step.
             auto physicsSystem = std::make_unique<physics::PhysicsSystem>();
             physics::PhysicsSettings settings;
-            settings.substeps = 8; // Increased substeps for stability
+            settings.substeps = 8;
+            settings.spatialSortInterval = 30; // Re-sort bodies into Z-order every half second
+            settings.positionTolerance = 0.002f; // settled islands stop iterating early
+            settings.velocityTolerance = 0.01f;
+            settings.enableSleeping = true; // resting balls sleep until the fluid wakes them
+            settings.adaptiveSubsteps = true; // up to 8 substeps on violent frames
+            settings.minSubsteps = 2;
+            settings.maxSubsteps = 8;
+            settings.continuousCollision = true; // fast balls cannot skip through the walls at 2 substeps
             physicsSystem->SetSettings(settings);
             physicsSystem->SetEnvironment(env);
             physicsSystem->SetJobSystem(&m_jobSystem);
             world.AddSystem(std::move(physicsSystem));
 
+            // Position-based fluid, run after the rigid step so it sees this
+            // frame's ball positions.
+            auto fluidSystem = std::make_unique<physics::FluidSystem>();
+            physics::FluidSettings fluid;
+            fluid.gravityY = env.gravityY;
+            fluidSystem->SetSettings(fluid);
+            fluidSystem->SetJobSystem(&m_jobSystem);
+            world.AddSystem(std::move(fluidSystem));
+
             // Container (Closed box)
             // Visible range: X[-20, 20], Y[-15, 25]
-            // Walls made very thick (100.0f) to prevent tunneling
             // Inner faces at: Left -18.5, Right 18.5, Bottom -13.5, Top 23.5
             CreateWall(world, -68.5f, 5.0f, 100.0f, 40.0f); // Left
             CreateWall(world, 68.5f, 5.0f, 100.0f, 40.0f);  // Right
             CreateWall(world, 0.0f, -63.5f, 40.0f, 100.0f); // Bottom
             CreateWall(world, 0.0f, 73.5f, 40.0f, 100.0f);  // Top
 
-            // Particles
-            std::mt19937 rng(123);
-            std::uniform_real_distribution<float> distX(-15.0f, 15.0f);
-            std::uniform_real_distribution<float> distY(-5.0f, 15.0f);
+            // Dam break: a column of water against the left wall.
+            const float spacing = fluid.restSpacing;
+            for (float y = -13.5f + 0.5f * spacing; y < 8.0f; y += spacing)
+            {
+                for (float x = -18.5f + 0.5f * spacing; x < -8.0f; x += spacing)
+                {
+                    auto p = world.CreateEntity();
+                    world.AddComponent<physics::TransformComponent>(p, x, y, 0.0f);
+                    world.AddComponent<physics::FluidParticleComponent>(p);
+                }
+            }
 
-            for (int i = 0; i < 100; ++i)
+            // Floating balls dropped into the empty side.
+            std::mt19937 rng(123);
+            std::uniform_real_distribution<float> distX(0.0f, 15.0f);
+            std::uniform_real_distribution<float> distY(0.0f, 15.0f);
+            for (int i = 0; i < 5; ++i)
             {
                 float x = distX(rng);
                 float y = distY(rng);
-                auto p = world.CreateEntity();
-                world.AddComponent<physics::TransformComponent>(p, x, y, 0.0f);
-                auto& b = world.AddComponent<physics::RigidBodyComponent>(p);
-                b.mass = 0.1f; b.invMass = 10.0f; b.restitution = 0.9f; b.friction = 0.0f; // High restitution for bouncing
+                auto ball = world.CreateEntity();
+                world.AddComponent<physics::TransformComponent>(ball, x, y, 0.0f);
+                auto& b = world.AddComponent<physics::RigidBodyComponent>(ball);
+                b.mass = 1.0f; b.invMass = 1.0f;
+                world.AddSharedComponent(ball, physics::PhysicsMaterial{0.3f, 0.2f});
                 b.lastX = x;
                 b.lastY = y;
-                world.AddComponent<physics::CircleColliderComponent>(p, 0.3f);
+                world.AddComponent<physics::CircleColliderComponent>(ball, 1.0f);
             }
         }
 
@@ -93,7 +123,8 @@ namespace simlab
         {
             m_renderer->Clear();
             
-            world.ForEach<physics::TransformComponent>([&](ecs::EntityId id, physics::TransformComponent& t) {
+            const ecs::World& scene = world;
+            scene.ForEach<physics::TransformComponent>([&](ecs::EntityId id, const physics::TransformComponent& t) {
                 // Map -20..20 to 0..80
                 int sx = static_cast<int>((t.x + 20.0f) * 2.0f);
                 int sy = static_cast<int>(40.0f - (t.y + 15.0f));
@@ -101,7 +132,9 @@ namespace simlab
                 if (sx >= 0 && sx < 80 && sy >= 0 && sy < 40)
                 {
                     char c = '.';
-                    if (world.GetComponent<physics::AABBComponent>(id)) c = '#';
+                    if (scene.GetComponent<physics::AABBComponent>(id)) c = '#';
+                    else if (scene.GetComponent<physics::CircleColliderComponent>(id)) c = 'O';
+                    else if (scene.GetComponent<physics::FluidParticleComponent>(id)) c = '~';
                     m_renderer->Put(sx, sy, c);
                 }
             });
@@ -18,6 +18,7 @@
 #include "simlab/Scenario.hpp"
 #include "ecs/World.hpp"
 #include "physics/Components.hpp"
+#include "physics/Gravity.hpp"
 #include "physics/Systems.hpp"
 #include "jobs/JobSystem.hpp"
 #include "ascii/TextRenderer.hpp"
@@ -29,46 +30,6 @@
 
 namespace simlab
 {
-    namespace
-    {
-        // Custom system for N-body gravity
-        class PlanetaryGravitySystem : public ecs::ISystem
-        {
-        public:
-            void Update(ecs::World& world, float dt) override
-            {
-                // Simple approach: Apply force towards center (0,0) for all dynamic bodies
-                // Or true N-body if we want to be fancy, but O(N^2) is slow for many bodies without optimization.
-                // Let's do a massive central attractor at (0,0).
-                
-                const float G = 100.0f;
-                const float centerMass = 1000.0f;
-
-                world.ForEach<physics::TransformComponent>([&](ecs::EntityId id, physics::TransformComponent& t) {
-                    auto* body = world.GetComponent<physics::RigidBodyComponent>(id);
-                    if (body && body->invMass > 0.0f)
-                    {
-                        float dx = 0.0f - t.x;
-                        float dy = 0.0f - t.y;
-                        float distSq = dx*dx + dy*dy;
-                        float dist = std::sqrt(distSq);
-                        
-                        if (dist > 0.1f)
-                        {
-                            float force = (G * centerMass * body->mass) / distSq;
-                            float fx = (dx / dist) * force;
-                            float fy = (dy / dist) * force;
-
-                            // Apply force (modify velocity directly for this simple integrator)
-                            body->vx += (fx * body->invMass) * dt;
-                            body->vy += (fy * body->invMass) * dt;
-                        }
-                    }
-                });
-            }
-        };
-    }
-
     class PlanetaryGravityScenario : public IScenario
     {
     public:
@@ -89,16 +50,25 @@ namespace simlab
             physicsSystem->SetJobSystem(&m_jobSystem);
             world.AddSystem(std::move(physicsSystem));
 
-            // Add custom gravity system
-            world.AddSystem(std::make_unique<PlanetaryGravitySystem>());
-
-            // Central Star (Static)
-            auto star = world.CreateEntity();
-            world.AddComponent<physics::TransformComponent>(star, 0.0f, 0.0f, 0.0f);
-            auto& starBody = world.AddComponent<physics::RigidBodyComponent>(star);
-            starBody.mass = 0.0f; // Static
-            starBody.invMass = 0.0f;
-            world.AddComponent<physics::CircleColliderComponent>(star, 2.0f);
+            // Mutual gravity between the star and every planet
+            physics::GravitySettings gravity;
+            gravity.gravitationalConstant = kG;
+            gravity.softening = 0.5f;
+            auto gravitySystem = std::make_unique<physics::GravitySystem>();
+            gravitySystem->SetSettings(gravity);
+            gravitySystem->SetJobSystem(&m_jobSystem);
+            world.AddSystem(std::move(gravitySystem));
+
+            // Central Star: heavy but free, so it recoils from the planets
+            m_star = world.CreateEntity();
+            world.AddComponent<physics::TransformComponent>(m_star, 0.0f, 0.0f, 0.0f);
+            auto& starBody = world.AddComponent<physics::RigidBodyComponent>(m_star);
+            starBody.mass = kStarMass;
+            starBody.invMass = 1.0f / kStarMass;
+            world.AddComponent<physics::CircleColliderComponent>(m_star, 2.0f);
+            physics::ConfigureCircleInertia(starBody, 2.0f);
+            float momentumX = 0.0f;
+            float momentumY = 0.0f;
 
             // Planets
             std::mt19937 rng(42);
@@ -117,7 +87,7 @@ namespace simlab
 
                 // Orbital velocity: v = sqrt(GM/r)
                 // Perpendicular to radius
-                float v = std::sqrt(100.0f * 1000.0f / r);
+                float v = std::sqrt(kG * kStarMass / r);
                 float vx = -std::sin(angle) * v;
                 float vy = std::cos(angle) * v;
 
@@ -132,7 +102,15 @@ namespace simlab
                 
                 world.AddComponent<physics::CircleColliderComponent>(p, 0.5f);
                 physics::ConfigureCircleInertia(body, 0.5f);
+                momentumX += mass * vx;
+                momentumY += mass * vy;
             }
+
+            // Start at rest in the centre of mass frame, so the system does
+            // not drift off screen.
+            auto* star = world.GetComponent<physics::RigidBodyComponent>(m_star);
+            star->vx = -momentumX / kStarMass;
+            star->vy = -momentumY / kStarMass;
         }
 
         void Update(ecs::World& world, float dt) override
@@ -145,11 +123,16 @@ namespace simlab
         {
             m_renderer->Clear();
             
+            const ecs::World& scene = world;
+
             // Draw Star
-            m_renderer->DrawCircle(40, 20, 4, '@');
+            if (const auto* star = scene.GetComponent<physics::TransformComponent>(m_star))
+            {
+                m_renderer->DrawCircle(static_cast<int>(star->x + 40.0f), static_cast<int>(20.0f - star->y * 0.5f), 4, '@');
+            }
 
             // Draw Planets
-            world.ForEach<physics::TransformComponent>([&](ecs::EntityId, physics::TransformComponent& t) {
+            scene.ForEach<physics::TransformComponent>([&](ecs::EntityId, const physics::TransformComponent& t) {
                 // Map -40..40 to 0..80
                 int sx = static_cast<int>(t.x + 40.0f);
                 int sy = static_cast<int>(20.0f - t.y * 0.5f); // Aspect ratio correction roughly
@@ -165,8 +148,12 @@ namespace simlab
         }
 
     private:
+        static constexpr float kG = 100.0f;
+        static constexpr float kStarMass = 1000.0f;
+
         std::unique_ptr<ascii::TextRenderer> m_renderer;
         jobs::JobSystem m_jobSystem;
+        ecs::EntityId m_star{};
     };
 
     std::unique_ptr<IScenario> CreatePlanetaryGravityScenario()
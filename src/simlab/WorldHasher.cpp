@@ -73,90 +73,147 @@ namespace simlab
         return h;
     }
 
-    std::uint64_t WorldHasher::HashWorld(const ecs::World& world) const noexcept
+    std::uint64_t WorldHasher::HashComponent(std::uint32_t id, const physics::TransformComponent& t) const noexcept
+    {
+        std::uint64_t h = kOffset;
+        HashBytes(h, &id, sizeof(id));
+        HashBytes(h, &t.x, sizeof(t.x));
+        HashBytes(h, &t.y, sizeof(t.y));
+        HashBytes(h, &t.rotation, sizeof(t.rotation));
+        return h;
+    }
+
+    std::uint64_t WorldHasher::HashComponent(std::uint32_t id, const physics::RigidBodyComponent& body) const noexcept
     {
         std::uint64_t h = kOffset;
+        HashBytes(h, &id, sizeof(id));
+        HashBytes(h, &body.vx, sizeof(body.vx));
+        HashBytes(h, &body.vy, sizeof(body.vy));
+        HashBytes(h, &body.lastX, sizeof(body.lastX));
+        HashBytes(h, &body.lastY, sizeof(body.lastY));
+        HashBytes(h, &body.lastAngle, sizeof(body.lastAngle));
+        HashBytes(h, &body.mass, sizeof(body.mass));
+        HashBytes(h, &body.invMass, sizeof(body.invMass));
+        HashBytes(h, &body.inertia, sizeof(body.inertia));
+        HashBytes(h, &body.invInertia, sizeof(body.invInertia));
+        HashBytes(h, &body.restitution, sizeof(body.restitution));
+        HashBytes(h, &body.friction, sizeof(body.friction));
+        HashBytes(h, &body.angularVelocity, sizeof(body.angularVelocity));
+        HashBytes(h, &body.torque, sizeof(body.torque));
+        HashBytes(h, &body.angularFriction, sizeof(body.angularFriction));
+        HashBytes(h, &body.angularDrag, sizeof(body.angularDrag));
+        HashBytes(h, &body.sleepTimer, sizeof(body.sleepTimer));
+        HashBytes(h, &body.asleep, sizeof(body.asleep));
+        return h;
+    }
+
+    std::uint64_t WorldHasher::HashComponent(std::uint32_t id, const physics::AABBComponent& box) const noexcept
+    {
+        std::uint64_t h = kOffset;
+        HashBytes(h, &id, sizeof(id));
+        HashBytes(h, &box.minX, sizeof(box.minX));
+        HashBytes(h, &box.minY, sizeof(box.minY));
+        HashBytes(h, &box.maxX, sizeof(box.maxX));
+        HashBytes(h, &box.maxY, sizeof(box.maxY));
+        return h;
+    }
+
+    std::uint64_t WorldHasher::HashComponent(std::uint32_t id, const physics::CircleColliderComponent& circle) const noexcept
+    {
+        std::uint64_t h = kOffset;
+        HashBytes(h, &id, sizeof(id));
+        HashBytes(h, &circle.radius, sizeof(circle.radius));
+        HashBytes(h, &circle.offsetX, sizeof(circle.offsetX));
+        HashBytes(h, &circle.offsetY, sizeof(circle.offsetY));
+        return h;
+    }
+
+    std::uint64_t WorldHasher::HashComponent(std::uint32_t id, const physics::DistanceJointComponent& joint) const noexcept
+    {
+        std::uint64_t h = kOffset;
+        HashBytes(h, &id, sizeof(id));
+        HashBytes(h, &joint.entityA, sizeof(joint.entityA));
+        HashBytes(h, &joint.entityB, sizeof(joint.entityB));
+        HashBytes(h, &joint.targetDistance, sizeof(joint.targetDistance));
+        HashBytes(h, &joint.compliance, sizeof(joint.compliance));
+        return h;
+    }
 
-        if (const auto* transforms = world.GetStorage<physics::TransformComponent>())
+    template <typename TComponent>
+    void WorldHasher::FoldStorage(const ecs::World& world, std::uint64_t& h) const noexcept
+    {
+        if (const auto* storage = world.GetStorage<TComponent>())
         {
-            const auto& entities = transforms->GetEntities();
-            const auto& data = transforms->GetData();
+            const auto& entities = storage->GetEntities();
+            const auto& data = storage->GetData();
             for (std::size_t i = 0; i < data.size(); ++i)
             {
-                HashBytes(h, &entities[i], sizeof(entities[i]));
-                HashBytes(h, &data[i].x, sizeof(data[i].x));
-                HashBytes(h, &data[i].y, sizeof(data[i].y));
-                HashBytes(h, &data[i].rotation, sizeof(data[i].rotation));
+                const std::uint64_t component = HashComponent(entities[i], data[i]);
+                HashBytes(h, &component, sizeof(component));
             }
         }
+    }
 
-        if (const auto* bodies = world.GetStorage<physics::RigidBodyComponent>())
+    template <typename TComponent>
+    void WorldHasher::FoldChanged(const ecs::World& world, StorageHashes& cache, bool all, std::uint64_t& h) noexcept
+    {
+        const auto* storage = world.GetStorage<TComponent>();
+        const std::uint64_t version = world.StructureVersionOf<TComponent>();
+        if (!storage)
         {
-            const auto& entities = bodies->GetEntities();
-            const auto& data = bodies->GetData();
-            for (std::size_t i = 0; i < data.size(); ++i)
-            {
-                const auto& body = data[i];
-                HashBytes(h, &entities[i], sizeof(entities[i]));
-                HashBytes(h, &body.vx, sizeof(body.vx));
-                HashBytes(h, &body.vy, sizeof(body.vy));
-                HashBytes(h, &body.lastX, sizeof(body.lastX));
-                HashBytes(h, &body.lastY, sizeof(body.lastY));
-                HashBytes(h, &body.lastAngle, sizeof(body.lastAngle));
-                HashBytes(h, &body.mass, sizeof(body.mass));
-                HashBytes(h, &body.invMass, sizeof(body.invMass));
-                HashBytes(h, &body.inertia, sizeof(body.inertia));
-                HashBytes(h, &body.invInertia, sizeof(body.invInertia));
-                HashBytes(h, &body.restitution, sizeof(body.restitution));
-                HashBytes(h, &body.friction, sizeof(body.friction));
-                HashBytes(h, &body.angularVelocity, sizeof(body.angularVelocity));
-                HashBytes(h, &body.torque, sizeof(body.torque));
-                HashBytes(h, &body.angularFriction, sizeof(body.angularFriction));
-                HashBytes(h, &body.angularDrag, sizeof(body.angularDrag));
-            }
+            cache.version = version;
+            cache.components.clear();
+            return;
         }
 
-        if (const auto* aabbs = world.GetStorage<physics::AABBComponent>())
+        if (all || cache.version != version)
         {
-            const auto& entities = aabbs->GetEntities();
-            const auto& data = aabbs->GetData();
+            const auto& entities = storage->GetEntities();
+            const auto& data = storage->GetData();
+            cache.version = version;
+            cache.components.resize(data.size());
             for (std::size_t i = 0; i < data.size(); ++i)
             {
-                HashBytes(h, &entities[i], sizeof(entities[i]));
-                HashBytes(h, &data[i].minX, sizeof(data[i].minX));
-                HashBytes(h, &data[i].minY, sizeof(data[i].minY));
-                HashBytes(h, &data[i].maxX, sizeof(data[i].maxX));
-                HashBytes(h, &data[i].maxY, sizeof(data[i].maxY));
+                cache.components[i] = HashComponent(entities[i], data[i]);
             }
         }
-
-        if (const auto* circles = world.GetStorage<physics::CircleColliderComponent>())
+        else
         {
-            const auto& entities = circles->GetEntities();
-            const auto& data = circles->GetData();
-            for (std::size_t i = 0; i < data.size(); ++i)
+            world.ForEachChanged<TComponent>(m_cacheSince, [&](ecs::EntityId id, const TComponent& component)
             {
-                HashBytes(h, &entities[i], sizeof(entities[i]));
-                HashBytes(h, &data[i].radius, sizeof(data[i].radius));
-                HashBytes(h, &data[i].offsetX, sizeof(data[i].offsetX));
-                HashBytes(h, &data[i].offsetY, sizeof(data[i].offsetY));
-            }
+                cache.components[storage->IndexOf(id)] = HashComponent(id, component);
+            });
         }
-
-        if (const auto* joints = world.GetStorage<physics::DistanceJointComponent>())
+        for (const std::uint64_t component : cache.components)
         {
-            const auto& entities = joints->GetEntities();
-            const auto& data = joints->GetData();
-            for (std::size_t i = 0; i < data.size(); ++i)
-            {
-                HashBytes(h, &entities[i], sizeof(entities[i]));
-                HashBytes(h, &data[i].entityA, sizeof(data[i].entityA));
-                HashBytes(h, &data[i].entityB, sizeof(data[i].entityB));
-                HashBytes(h, &data[i].targetDistance, sizeof(data[i].targetDistance));
-                HashBytes(h, &data[i].compliance, sizeof(data[i].compliance));
-            }
+            HashBytes(h, &component, sizeof(component));
         }
+    }
 
+    std::uint64_t WorldHasher::HashWorld(const ecs::World& world) const noexcept
+    {
+        std::uint64_t h = kOffset;
+        FoldStorage<physics::TransformComponent>(world, h);
+        FoldStorage<physics::RigidBodyComponent>(world, h);
+        FoldStorage<physics::AABBComponent>(world, h);
+        FoldStorage<physics::CircleColliderComponent>(world, h);
+        FoldStorage<physics::DistanceJointComponent>(world, h);
+        return h;
+    }
+
+    std::uint64_t WorldHasher::HashWorldChanged(const ecs::World& world) noexcept
+    {
+        const bool all = m_cacheWorld != &world;
+        std::uint64_t h = kOffset;
+        FoldChanged<physics::TransformComponent>(world, m_cache[0], all, h);
+        FoldChanged<physics::RigidBodyComponent>(world, m_cache[1], all, h);
+        FoldChanged<physics::AABBComponent>(world, m_cache[2], all, h);
+        FoldChanged<physics::CircleColliderComponent>(world, m_cache[3], all, h);
+        FoldChanged<physics::DistanceJointComponent>(world, m_cache[4], all, h);
+        // Writes later in the current tick carry its stamp, so the next call
+        // looks at that tick again.
+        m_cacheWorld = &world;
+        m_cacheSince = world.ChangeTick() - 1;
         return h;
     }
 }
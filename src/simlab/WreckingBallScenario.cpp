@@ -41,7 +41,8 @@ namespace simlab
             auto physicsSystem = std::make_unique<physics::PhysicsSystem>();
             physics::PhysicsSettings settings;
             settings.substeps = 16;
-            settings.constraintIterations = 16; // High for stable chains
+            settings.constraintIterations = 4; // chains are trees: solved directly
+            settings.enableSleeping = true; // settled tower boxes stop costing anything
             physicsSystem->SetSettings(settings);
             physicsSystem->SetEnvironment(env);
             physicsSystem->SetJobSystem(&m_jobSystem);
@@ -125,7 +126,8 @@ namespace simlab
             for(int x=0; x<80; ++x) m_renderer->Put(x, 29, '#');
 
             // Draw Entities
-            world.ForEach<physics::TransformComponent>([&](ecs::EntityId id, physics::TransformComponent& t) {
+            const ecs::World& scene = world;
+            scene.ForEach<physics::TransformComponent>([&](ecs::EntityId id, const physics::TransformComponent& t) {
                 // Map -20..20 to 0..80
                 int sx = static_cast<int>((t.x + 20.0f) * 2.0f);
                 int sy = static_cast<int>(30.0f - (t.y + 10.0f));
@@ -133,9 +135,9 @@ namespace simlab
                 if (sx >= 0 && sx < 80 && sy >= 0 && sy < 30)
                 {
                     char c = '*';
-                    if (world.GetComponent<physics::AABBComponent>(id)) c = '#'; // Box
-                    if (world.GetComponent<physics::DistanceJointComponent>(id)) c = '.'; // Chain
-                    if (auto* rb = world.GetComponent<physics::RigidBodyComponent>(id)) {
+                    if (scene.GetComponent<physics::AABBComponent>(id)) c = '#'; // Box
+                    if (scene.GetComponent<physics::DistanceJointComponent>(id)) c = '.'; // Chain
+                    if (const auto* rb = scene.GetComponent<physics::RigidBodyComponent>(id)) {
                         if (rb->mass > 10.0f) c = 'O'; // Wrecking ball
                     }
                     m_renderer->Put(sx, sy, c);
@@ -0,0 +1,72 @@
+/*
+ * Copyright (C) 2025 aeml
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "ecs/World.hpp"
+#include "jobs/JobSystem.hpp"
+#include "physics/Components.hpp"
+#include "physics/Systems.hpp"
+
+#include <memory>
+#include <utility>
+
+// Scene building shared by the physics tests.
+namespace physics_test
+{
+    constexpr float kDt = 1.0f / 60.0f;
+
+    inline physics::PhysicsSystem* AddPhysics(ecs::World& world, const physics::PhysicsSettings& settings = {},
+                                              jobs::JobSystem* jobSystem = nullptr)
+    {
+        auto system = std::make_unique<physics::PhysicsSystem>();
+        system->SetSettings(settings);
+        system->SetJobSystem(jobSystem);
+        auto* ptr = system.get();
+        world.AddSystem(std::move(system));
+        return ptr;
+    }
+
+    // A body at rest at (x, y) that does not bounce; invMass 0 makes it static.
+    inline physics::RigidBodyComponent& AddBody(ecs::World& world, ecs::EntityId e, float x, float y, float invMass)
+    {
+        world.AddComponent<physics::TransformComponent>(e, x, y, 0.0f);
+        auto& rb = world.AddComponent<physics::RigidBodyComponent>(e);
+        rb.invMass = invMass;
+        rb.mass = invMass > 0.0f ? 1.0f / invMass : 0.0f;
+        rb.restitution = 0.0f;
+        rb.lastX = x;
+        rb.lastY = y;
+        return rb;
+    }
+
+    inline ecs::EntityId AddBox(ecs::World& world, float x, float y, float halfW, float halfH, float invMass)
+    {
+        auto e = world.CreateEntity();
+        AddBody(world, e, x, y, invMass);
+        world.AddComponent<physics::AABBComponent>(e, x - halfW, y - halfH, x + halfW, y + halfH);
+        return e;
+    }
+
+    inline ecs::EntityId AddBall(ecs::World& world, float x, float y, float radius, float invMass = 1.0f)
+    {
+        auto e = world.CreateEntity();
+        AddBody(world, e, x, y, invMass);
+        world.AddComponent<physics::CircleColliderComponent>(e, radius);
+        return e;
+    }
+}
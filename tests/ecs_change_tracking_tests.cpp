@@ -0,0 +1,170 @@
+/*
+ * Copyright (C) 2025 aeml
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "ecs/World.hpp"
+#include "physics/Components.hpp"
+#include "physics/Systems.hpp"
+
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    std::vector<ecs::EntityId> ChangedTransforms(const ecs::World& world, std::uint32_t since)
+    {
+        std::vector<ecs::EntityId> ids;
+        world.ForEachChanged<physics::TransformComponent>(since, [&](ecs::EntityId id, const physics::TransformComponent&) {
+            ids.push_back(id);
+        });
+        return ids;
+    }
+
+    void VerifyMutableAccessStampsSlots()
+    {
+        ecs::World world;
+        auto a = world.CreateEntity();
+        auto b = world.CreateEntity();
+        world.AddComponent<physics::TransformComponent>(a, 1.0f, 0.0f, 0.0f);
+        world.AddComponent<physics::TransformComponent>(b, 2.0f, 0.0f, 0.0f);
+
+        // Freshly added components count as changed for a consumer starting at 0.
+        assert(ChangedTransforms(world, 0).size() == 2);
+
+        const std::uint32_t since = world.AdvanceChangeTick();
+        assert(ChangedTransforms(world, since).empty());
+
+        // Const reads leave the stamps alone.
+        const ecs::World& readOnly = world;
+        assert(readOnly.GetComponent<physics::TransformComponent>(a)->x == 1.0f);
+        assert(ChangedTransforms(world, since).empty());
+        world.AddComponent<physics::RigidBodyComponent>(a);
+        std::size_t viewed = 0;
+        readOnly.View<physics::TransformComponent, physics::RigidBodyComponent>(
+            [&](ecs::EntityId id, const physics::TransformComponent&, const physics::RigidBodyComponent&) {
+                assert(id == a);
+                ++viewed;
+            });
+        assert(viewed == 1);
+        assert(ChangedTransforms(world, since).empty());
+
+        world.GetComponent<physics::TransformComponent>(b)->x = 5.0f;
+        const auto changed = ChangedTransforms(world, since);
+        assert(changed.size() == 1 && changed[0] == b);
+
+        // Raw writes are invisible until marked.
+        const std::uint32_t since2 = world.AdvanceChangeTick();
+        auto* storage = world.GetStorage<physics::TransformComponent>();
+        storage->GetData()[storage->IndexOf(a)].y = 3.0f;
+        assert(ChangedTransforms(world, since2).empty());
+        storage->MarkChanged(storage->IndexOf(a));
+        assert(ChangedTransforms(world, since2).size() == 1);
+    }
+
+    void VerifyViewChangedAndStructureVersion()
+    {
+        ecs::World world;
+        auto a = world.CreateEntity();
+        auto b = world.CreateEntity();
+        auto c = world.CreateEntity();
+        for (auto id : {a, b, c})
+        {
+            world.AddComponent<physics::TransformComponent>(id);
+        }
+        world.AddComponent<physics::RigidBodyComponent>(a);
+        world.AddComponent<physics::RigidBodyComponent>(b);
+
+        auto* storage = world.GetStorage<physics::TransformComponent>();
+        const auto version = storage->StructureVersion();
+        const std::uint32_t since = world.AdvanceChangeTick();
+
+        // Only the rigid body of b changes; the view still reports b.
+        world.GetComponent<physics::RigidBodyComponent>(b)->vx = 1.0f;
+        std::vector<ecs::EntityId> seen;
+        world.ViewChanged<physics::TransformComponent, physics::RigidBodyComponent>(since,
+            [&](ecs::EntityId id, const physics::TransformComponent&, const physics::RigidBodyComponent& rb) {
+                assert(rb.vx == 1.0f);
+                seen.push_back(id);
+            });
+        assert(seen.size() == 1 && seen[0] == b);
+
+        // Swap-and-pop carries the moved slot's stamp with it.
+        world.GetComponent<physics::TransformComponent>(c)->x = 4.0f;
+        world.DestroyEntity(a);
+        assert(storage->StructureVersion() > version);
+        const auto changed = ChangedTransforms(world, since);
+        assert(changed.size() == 1 && changed[0] == c);
+    }
+
+    void VerifyStandaloneStorageUsesLocalTick()
+    {
+        ecs::ComponentStorage<physics::TransformComponent> storage;
+        storage.Add(7, physics::TransformComponent{});
+        const std::uint32_t since = storage.CurrentTick();
+        storage.AdvanceLocalTick();
+        assert(!storage.ChangedSince(7, since));
+        storage.Get(7)->x = 1.0f;
+        assert(storage.ChangedSince(7, since));
+    }
+
+    void VerifyPhysicsOnlyStampsMovingBodies()
+    {
+        ecs::World world;
+        auto physicsSystem = std::make_unique<physics::PhysicsSystem>();
+        world.AddSystem(std::move(physicsSystem));
+
+        auto ground = world.CreateEntity();
+        world.AddComponent<physics::TransformComponent>(ground, 0.0f, -5.0f, 0.0f);
+        auto& groundBody = world.AddComponent<physics::RigidBodyComponent>(ground);
+        groundBody.mass = 0.0f;
+        groundBody.invMass = 0.0f;
+        world.AddComponent<physics::AABBComponent>(ground, -10.0f, -5.5f, 10.0f, -4.5f);
+
+        auto box = world.CreateEntity();
+        world.AddComponent<physics::TransformComponent>(box, 0.0f, 2.0f, 0.0f);
+        world.AddComponent<physics::RigidBodyComponent>(box);
+        world.AddComponent<physics::AABBComponent>(box, -0.5f, 1.5f, 0.5f, 2.5f);
+
+        world.Update(1.0f / 60.0f);
+        const std::uint32_t since = world.AdvanceChangeTick();
+        world.Update(1.0f / 60.0f);
+
+        const auto changed = ChangedTransforms(world, since);
+        assert(changed.size() == 1 && changed[0] == box);
+
+        // The dynamic AABB followed its transform; the static one is untouched.
+        const auto* tf = std::as_const(world).GetComponent<physics::TransformComponent>(box);
+        const auto* aabb = std::as_const(world).GetComponent<physics::AABBComponent>(box);
+        assert(std::fabs((aabb->minY + aabb->maxY) * 0.5f - tf->y) < 1e-5f);
+        const auto* groundAabb = std::as_const(world).GetComponent<physics::AABBComponent>(ground);
+        assert(groundAabb->minY == -5.5f && groundAabb->maxY == -4.5f);
+        (void)tf; (void)aabb; (void)groundAabb;
+    }
+}
+
+int main()
+{
+    VerifyMutableAccessStampsSlots();
+    VerifyViewChangedAndStructureVersion();
+    VerifyStandaloneStorageUsesLocalTick();
+    VerifyPhysicsOnlyStampsMovingBodies();
+    std::cout << "ECS change tracking tests passed\n";
+    return 0;
+}
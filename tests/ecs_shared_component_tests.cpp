@@ -0,0 +1,141 @@
+/*
+ * Copyright (C) 2025 aeml
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "ecs/World.hpp"
+#include "physics/Components.hpp"
+#include "physics/Systems.hpp"
+
+#include <cassert>
+#include <iostream>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    void VerifyInterningAndCopyOnWrite()
+    {
+        ecs::World world;
+        const physics::PhysicsMaterial rubber{0.9f, 0.8f};
+        std::vector<ecs::EntityId> ids;
+        for (int i = 0; i < 5; ++i)
+        {
+            ids.push_back(world.CreateEntity());
+            world.AddSharedComponent(ids.back(), rubber);
+        }
+
+        auto* storage = world.GetSharedStorage<physics::PhysicsMaterial>();
+        assert(storage && storage->Size() == 5);
+        assert(storage->DistinctCount() == 1);
+        const auto handle = storage->HandleOf(ids[0]);
+        assert(storage->ReferenceCount(handle) == 5);
+        assert(world.GetSharedComponent<physics::PhysicsMaterial>(ids[0])
+               == world.GetSharedComponent<physics::PhysicsMaterial>(ids[4]));
+
+        // One entity diverges; the others keep the original value.
+        storage->Modify(ids[2], [](physics::PhysicsMaterial& m) { m.restitution = 0.1f; });
+        assert(storage->DistinctCount() == 2);
+        assert(storage->ReferenceCount(handle) == 4);
+        assert(world.GetSharedComponent<physics::PhysicsMaterial>(ids[2])->restitution == 0.1f);
+        assert(world.GetSharedComponent<physics::PhysicsMaterial>(ids[3])->restitution == 0.9f);
+
+        // Converging again merges back into the existing instance.
+        storage->Modify(ids[2], [](physics::PhysicsMaterial& m) { m.restitution = 0.9f; });
+        assert(storage->DistinctCount() == 1);
+        assert(storage->HandleOf(ids[2]) == handle);
+
+        world.DestroyEntity(ids[0]);
+        assert(storage->Size() == 4);
+        assert(storage->ReferenceCount(handle) == 4);
+        (void)handle;
+    }
+
+    void VerifyGroupsAreDeterministic()
+    {
+        ecs::World world;
+        const physics::PhysicsMaterial a{0.1f, 0.1f};
+        const physics::PhysicsMaterial b{0.2f, 0.2f};
+        std::vector<ecs::EntityId> ids;
+        for (int i = 0; i < 6; ++i)
+        {
+            ids.push_back(world.CreateEntity());
+            world.AddSharedComponent(ids.back(), i % 2 == 0 ? a : b);
+        }
+
+        std::vector<std::pair<float, std::vector<ecs::EntityId>>> groups;
+        world.ForEachSharedGroup<physics::PhysicsMaterial>(
+            [&](auto, const physics::PhysicsMaterial& value, const std::vector<ecs::EntityId>& members) {
+                groups.emplace_back(value.restitution, members);
+            });
+        assert(groups.size() == 2);
+        assert(groups[0].first == 0.1f);
+        assert((groups[0].second == std::vector<ecs::EntityId>{ids[0], ids[2], ids[4]}));
+        assert((groups[1].second == std::vector<ecs::EntityId>{ids[1], ids[3], ids[5]}));
+    }
+
+    // Drops a ball on a static floor and returns its velocity after the bounce.
+    float BounceVelocity(bool sharedMaterial)
+    {
+        ecs::World world;
+        auto physicsSystem = std::make_unique<physics::PhysicsSystem>();
+        world.AddSystem(std::move(physicsSystem));
+
+        auto floor = world.CreateEntity();
+        world.AddComponent<physics::TransformComponent>(floor, 0.0f, -1.0f, 0.0f);
+        auto& floorBody = world.AddComponent<physics::RigidBodyComponent>(floor);
+        floorBody.mass = 0.0f;
+        floorBody.invMass = 0.0f;
+        world.AddComponent<physics::AABBComponent>(floor, -10.0f, -1.5f, 10.0f, -0.5f);
+
+        auto ball = world.CreateEntity();
+        world.AddComponent<physics::TransformComponent>(ball, 0.0f, 1.0f, 0.0f);
+        auto& ballBody = world.AddComponent<physics::RigidBodyComponent>(ball);
+        ballBody.vy = -5.0f;
+        world.AddComponent<physics::CircleColliderComponent>(ball, 0.5f);
+
+        const physics::PhysicsMaterial bouncy{0.8f, 0.1f};
+        if (sharedMaterial)
+        {
+            world.AddSharedComponent(floor, bouncy);
+            world.AddSharedComponent(ball, bouncy);
+        }
+        else
+        {
+            for (auto id : {floor, ball})
+            {
+                auto* rb = world.GetComponent<physics::RigidBodyComponent>(id);
+                rb->restitution = bouncy.restitution;
+                rb->friction = bouncy.friction;
+            }
+        }
+
+        for (int i = 0; i < 30; ++i)
+        {
+            world.Update(1.0f / 60.0f);
+        }
+        return std::as_const(world).GetComponent<physics::RigidBodyComponent>(ball)->vy;
+    }
+}
+
+int main()
+{
+    VerifyInterningAndCopyOnWrite();
+    VerifyGroupsAreDeterministic();
+    assert(BounceVelocity(true) == BounceVelocity(false));
+    std::cout << "ECS shared component tests passed\n";
+    return 0;
+}
@@ -0,0 +1,160 @@
+/*
+ * Copyright (C) 2025 aeml
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "ecs/ChunkedArray.hpp"
+#include "ecs/World.hpp"
+#include "physics/Components.hpp"
+#include "physics/Systems.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    void VerifyChunkedArrayBasics()
+    {
+        ecs::ChunkedArray<int, 64> values; // 16 ints per chunk
+        static_assert(ecs::ChunkedArray<int, 64>::kChunkSize == 16);
+
+        values.push_back(0);
+        int* first = &values[0];
+        for (int i = 1; i < 100; ++i)
+        {
+            values.push_back(i);
+        }
+        assert(first == &values[0]);
+        assert(values.size() == 100);
+        assert(values.back() == 99);
+        assert(std::accumulate(values.begin(), values.end(), 0) == 4950);
+        assert(values.end() - values.begin() == 100);
+
+        std::vector<int> copy(values.begin(), values.end());
+        assert(copy.size() == 100 && copy[42] == 42);
+
+        for (int i = 0; i < 60; ++i)
+        {
+            values.pop_back();
+        }
+        values.shrink_to_fit();
+        assert(values.size() == 40);
+        assert(values.capacity() == 48);
+        assert(first == &values[0]);
+    }
+
+    void VerifyLayoutVersions()
+    {
+        static_assert(ecs::ComponentStorage<physics::TransformComponent>::kStableAddresses);
+        static_assert(ecs::ComponentStorage<physics::RigidBodyComponent>::kStableAddresses);
+        static_assert(!ecs::ComponentStorage<physics::AABBComponent>::kStableAddresses);
+
+        ecs::ComponentStorage<physics::TransformComponent> transforms;
+        ecs::ComponentStorage<physics::AABBComponent> aabbs;
+        transforms.Add(1, physics::TransformComponent{});
+        aabbs.Add(1, physics::AABBComponent{});
+        const auto* pinned = transforms.Get(1);
+        const auto transformLayout = transforms.LayoutVersion();
+        const auto aabbLayout = aabbs.LayoutVersion();
+
+        for (ecs::EntityId id = 2; id < 5000; ++id)
+        {
+            transforms.Add(id, physics::TransformComponent{});
+            aabbs.Add(id, physics::AABBComponent{});
+        }
+        // Chunked storage never moved entity 1; the vector had to reallocate.
+        assert(transforms.LayoutVersion() == transformLayout);
+        assert(transforms.Get(1) == pinned);
+        assert(aabbs.LayoutVersion() > aabbLayout);
+
+        transforms.Remove(1);
+        assert(transforms.LayoutVersion() != transformLayout);
+        (void)pinned;
+    }
+
+    ecs::EntityId AddBall(ecs::World& world, float x, float y, float mass)
+    {
+        auto e = world.CreateEntity();
+        world.AddComponent<physics::TransformComponent>(e, x, y, 0.0f);
+        auto& rb = world.AddComponent<physics::RigidBodyComponent>(e);
+        rb.mass = mass;
+        rb.invMass = mass > 0.0f ? 1.0f / mass : 0.0f;
+        return e;
+    }
+
+    void VerifyJointCacheSurvivesFrames()
+    {
+        ecs::World world;
+        auto physicsSystem = std::make_unique<physics::PhysicsSystem>();
+        auto* physicsPtr = physicsSystem.get();
+        physics::PhysicsSettings settings;
+        settings.substeps = 4;
+        physicsSystem->SetSettings(settings);
+        world.AddSystem(std::move(physicsSystem));
+
+        auto anchor = AddBall(world, 0.0f, 0.0f, 0.0f);
+        auto prev = anchor;
+        std::vector<ecs::EntityId> links;
+        for (int i = 1; i <= 6; ++i)
+        {
+            auto link = AddBall(world, static_cast<float>(i), 0.0f, 1.0f);
+            world.AddComponent<physics::DistanceJointComponent>(link, physics::DistanceJointComponent{prev, link, 1.0f});
+            links.push_back(link);
+            prev = link;
+        }
+
+        for (int frame = 0; frame < 30; ++frame)
+        {
+            world.Update(1.0f / 60.0f);
+        }
+        // The initial build plus at most one re-check after the joints' own
+        // creation tick; no per-substep re-resolution.
+        const std::size_t rebuilds = physicsPtr->Constraints().CacheRebuilds();
+        assert(rebuilds <= 2);
+
+        // Spawning unrelated bodies does not move chunked transforms.
+        for (int i = 0; i < 200; ++i)
+        {
+            AddBall(world, 100.0f + static_cast<float>(i), 50.0f, 1.0f);
+        }
+        world.Update(1.0f / 60.0f);
+        assert(physicsPtr->Constraints().CacheRebuilds() == rebuilds);
+
+        // Destroying a link changes the layout and forces a rebuild.
+        world.DestroyEntity(links.back());
+        world.Update(1.0f / 60.0f);
+        assert(physicsPtr->Constraints().CacheRebuilds() > rebuilds);
+
+        const auto* first = std::as_const(world).GetComponent<physics::TransformComponent>(links.front());
+        const float dist = std::sqrt(first->x * first->x + first->y * first->y);
+        assert(std::fabs(dist - 1.0f) < 0.1f);
+        (void)first; (void)dist;
+    }
+}
+
+int main()
+{
+    VerifyChunkedArrayBasics();
+    VerifyLayoutVersions();
+    VerifyJointCacheSurvivesFrames();
+    std::cout << "ECS stable storage tests passed\n";
+    return 0;
+}
@@ -305,7 +305,7 @@ namespace
 
         const auto lines = ReadLines(metricsPath);
         assert(lines.size() == 4);
-        assert(lines[0] == "frame,sim_time_seconds,world_hash,collision_count,rigid_body_count,dynamic_body_count,transform_count,update_wall_seconds,render_wall_seconds,frame_wall_seconds");
+        assert(lines[0] == "frame,sim_time_seconds,world_hash,collision_count,rigid_body_count,dynamic_body_count,transform_count,update_wall_seconds,render_wall_seconds,frame_wall_seconds,contact_index_stride,position_iterations_per_island,velocity_iterations_per_island,constraint_iterations_per_chain,sleeping_bodies,bodies_slept,bodies_woken,substeps");
         assert(lines[1].rfind("1,0.016667,", 0) == 0);
         assert(lines[2].rfind("2,0.033333,", 0) == 0);
         assert(lines[3].rfind("3,0.050000,", 0) == 0);
@@ -313,7 +313,7 @@ namespace
         for (std::size_t i = 1; i < lines.size(); ++i)
         {
             const auto columns = SplitCsvRow(lines[i]);
-            assert(columns.size() == 10u);
+            assert(columns.size() == 18u);
 
             const double updateWallSeconds = ParseDouble(columns[7]);
             const double renderWallSeconds = ParseDouble(columns[8]);
@@ -107,14 +107,22 @@ namespace
         metrics.updateWallSeconds = 0.001234;
         metrics.renderWallSeconds = 0.000321;
         metrics.frameWallSeconds = 0.001555;
+        metrics.contactIndexStride = 2.5;
+        metrics.positionIterationsPerIsland = 4.5;
+        metrics.velocityIterationsPerIsland = 3.0;
+        metrics.constraintIterationsPerChain = 2.0;
+        metrics.sleepingBodyCount = 9;
+        metrics.bodiesSlept = 2;
+        metrics.bodiesWoken = 1;
+        metrics.substeps = 6;
 
         std::ostringstream out;
         simlab::WriteFrameMetricsCsvHeader(out);
         simlab::WriteFrameMetricsCsvRow(out, metrics);
 
         const std::string csv = out.str();
-        assert(csv.find("frame,sim_time_seconds,world_hash,collision_count,rigid_body_count,dynamic_body_count,transform_count,update_wall_seconds,render_wall_seconds,frame_wall_seconds\n") == 0);
-        assert(csv.find("7,0.125000,42,3,5,4,6,0.001234,0.000321,0.001555\n") != std::string::npos);
+        assert(csv.find("frame,sim_time_seconds,world_hash,collision_count,rigid_body_count,dynamic_body_count,transform_count,update_wall_seconds,render_wall_seconds,frame_wall_seconds,contact_index_stride,position_iterations_per_island,velocity_iterations_per_island,constraint_iterations_per_chain,sleeping_bodies,bodies_slept,bodies_woken,substeps\n") == 0);
+        assert(csv.find("7,0.125000,42,3,5,4,6,0.001234,0.000321,0.001555,2.500000,4.500000,3.000000,2.000000,9,2,1,6\n") != std::string::npos);
     }
 
     void VerifySummaryAccumulatorTracksFinalHashAndAggregates()
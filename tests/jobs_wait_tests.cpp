@@ -16,10 +16,12 @@
  */
 
 #include "jobs/JobSystem.hpp"
+#include "jobs/Parallel.hpp"
 
 #include <atomic>
 #include <cassert>
 #include <chrono>
+#include <cstdint>
 #include <stdexcept>
 #include <thread>
 #include <vector>
@@ -98,5 +100,35 @@ int main()
     js.Wait(hOkB);
     assert(successCounter.load() == 2);
 
+    // Test 6: Batched scan and append give the serial results.
+    std::vector<std::uint32_t> counts(49000);
+    for (std::size_t i = 0; i < counts.size(); ++i)
+    {
+        counts[i] = static_cast<std::uint32_t>(i % 7);
+    }
+    std::vector<std::uint32_t> serialScan = counts;
+    std::vector<std::uint32_t> parallelScan = counts;
+    std::vector<std::uint32_t> scratch;
+    const auto serialTotal = jobs::ExclusiveScan(serialScan, nullptr, scratch);
+    const auto parallelTotal = jobs::ExclusiveScan(parallelScan, &js, scratch);
+    assert(serialTotal == parallelTotal);
+    assert(serialScan == parallelScan);
+    assert(serialScan[0] == 0 && serialScan[8] == 0 + 1 + 2 + 3 + 4 + 5 + 6 + 0);
+
+    const jobs::BatchPlan plan = jobs::PlanBatches(counts.size(), 256, &js);
+    std::vector<std::vector<std::uint32_t>> parts(plan.batches);
+    jobs::ForEachBatch(plan, &js, [&](std::size_t batch, std::size_t begin, std::size_t end)
+    {
+        for (std::size_t i = begin; i < end; ++i)
+        {
+            if (counts[i] == 3) parts[batch].push_back(static_cast<std::uint32_t>(i));
+        }
+    });
+    std::vector<std::uint32_t> appended = {7u};
+    jobs::AppendBatches(parts, plan.batches, &js, appended);
+    assert(appended.size() == 1 + counts.size() / 7);
+    assert(appended[0] == 7u && appended[1] == 3u && appended.back() > appended[appended.size() - 2]);
+    assert(parts[0].empty());
+
     return 0;
 }
@@ -0,0 +1,275 @@
+/*
+ * Copyright (C) 2025 aeml
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "physics/CollisionSystem.hpp"
+#include "jobs/JobSystem.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    // Chain links, crates, wrecking balls and one long floor.
+    std::vector<physics::AABBComponent> MixedScene(std::size_t count, unsigned seed)
+    {
+        std::mt19937 rng(seed);
+        std::uniform_real_distribution<float> pos(-40.0f, 40.0f);
+        const float sizes[] = {0.44f, 1.0f, 1.0f, 4.0f};
+        std::vector<physics::AABBComponent> boxes;
+        boxes.reserve(count + 1);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            const float size = sizes[i % 4];
+            const float x = pos(rng);
+            const float y = pos(rng);
+            boxes.push_back({x, y, x + size, y + size});
+        }
+        boxes.push_back({-100.0f, -41.0f, 100.0f, -39.0f});
+        return boxes;
+    }
+
+    std::vector<std::uint32_t> Ids(std::size_t count)
+    {
+        std::vector<std::uint32_t> ids(count);
+        for (std::size_t i = 0; i < count; ++i) ids[i] = static_cast<std::uint32_t>(i + 1);
+        return ids;
+    }
+
+    bool SameEvents(const std::vector<physics::CollisionEvent>& a, const std::vector<physics::CollisionEvent>& b)
+    {
+        if (a.size() != b.size()) return false;
+        for (std::size_t i = 0; i < a.size(); ++i)
+        {
+            if (a[i].entityA != b[i].entityA || a[i].entityB != b[i].entityB
+                || a[i].normalX != b[i].normalX || a[i].normalY != b[i].normalY
+                || a[i].penetration != b[i].penetration)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void VerifyStrategiesMatchAllPairs(jobs::JobSystem& jobSystem)
+    {
+        const auto boxes = MixedScene(1500, 7u);
+        const auto ids = Ids(boxes.size());
+
+        physics::CollisionSystem reference;
+        reference.SetBroadphase(physics::Broadphase::BruteForce);
+        std::vector<physics::CollisionEvent> expected;
+        reference.Detect(boxes, ids, expected);
+        assert(expected.size() > 100);
+
+        // Every strategy, serial or parallel, gives the all-pairs events.
+        const physics::Broadphase kinds[] = {
+            physics::Broadphase::UniformGrid, physics::Broadphase::HierarchicalGrid,
+            physics::Broadphase::SweepAndPrune, physics::Broadphase::Auto};
+        for (const auto kind : kinds)
+        {
+            physics::CollisionSystem system;
+            system.SetBroadphase(kind);
+            assert(system.GetBroadphase() == kind);
+            std::vector<physics::CollisionEvent> serial;
+            std::vector<physics::CollisionEvent> parallel;
+            system.Detect(boxes, ids, serial);
+            system.Detect(boxes, ids, parallel, &jobSystem);
+            assert(SameEvents(serial, expected));
+            assert(SameEvents(parallel, expected));
+        }
+    }
+
+    void VerifyAutoSelection(jobs::JobSystem& jobSystem)
+    {
+        physics::CollisionSystem system;
+        assert(system.GetBroadphase() == physics::Broadphase::Auto);
+        std::vector<physics::CollisionEvent> events;
+
+        auto small = MixedScene(12, 1u);
+        small.pop_back(); // drop the floor
+        system.Detect(small, Ids(small.size()), events);
+        assert(std::string(system.ActiveBroadphase().Name()) == "brute force");
+
+        const auto mixed = MixedScene(500, 2u);
+        system.Detect(mixed, Ids(mixed.size()), events, &jobSystem);
+        assert(std::string(system.ActiveBroadphase().Name()) == "sweep and prune");
+
+        // A tall stack shares one x range: the sweep tests every box against
+        // every other, so the next calls use the hierarchical grid.
+        std::vector<physics::AABBComponent> tower;
+        for (int i = 0; i < 400; ++i)
+        {
+            const float y = static_cast<float>(i);
+            tower.push_back({0.0f, y, 1.0f, y + 1.0f});
+        }
+        const auto towerIds = Ids(tower.size());
+        system.Detect(tower, towerIds, events);
+        assert(std::string(system.ActiveBroadphase().Name()) == "sweep and prune");
+        assert(events.size() == tower.size() - 1);
+        system.Detect(tower, towerIds, events);
+        assert(std::string(system.ActiveBroadphase().Name()) == "hierarchical grid");
+        assert(events.size() == tower.size() - 1);
+
+        // Same-size proxies: sweep and prune unless there are many proxies
+        // and several workers.
+        std::vector<physics::AABBComponent> uniform;
+        for (int i = 0; i < 3000; ++i)
+        {
+            const float x = static_cast<float>(i % 60);
+            const float y = static_cast<float>(i / 60);
+            uniform.push_back({x, y, x + 0.9f, y + 0.9f});
+        }
+        physics::CollisionSystem fresh;
+        fresh.Detect(uniform, Ids(uniform.size()), events);
+        assert(std::string(fresh.ActiveBroadphase().Name()) == "sweep and prune");
+        fresh.Detect(uniform, Ids(uniform.size()), events, &jobSystem);
+        const std::string parallelChoice = fresh.ActiveBroadphase().Name();
+        assert(parallelChoice == (jobSystem.WorkerCount() > 1 ? "uniform grid" : "sweep and prune"));
+    }
+
+    void VerifySweepAndPruneKeepsOrderAcrossCalls(jobs::JobSystem& jobSystem)
+    {
+        auto boxes = MixedScene(1500, 11u);
+        const auto ids = Ids(boxes.size());
+        physics::CollisionSystem reference;
+        reference.SetBroadphase(physics::Broadphase::BruteForce);
+        physics::CollisionSystem sap;
+        auto strategy = std::make_unique<physics::SweepAndPruneBroadphase>();
+        const auto* endpoints = strategy.get();
+        sap.SetBroadphase(std::move(strategy));
+        assert(sap.GetBroadphase() == physics::Broadphase::Custom);
+
+        std::vector<physics::CollisionEvent> expected;
+        std::vector<physics::CollisionEvent> events;
+        reference.Detect(boxes, ids, expected);
+        sap.Detect(boxes, ids, events);
+        assert(SameEvents(events, expected));
+        assert(endpoints->LastSortMoves() == boxes.size()); // first call builds the list
+
+        // Small drifts (a settling pile) need only a few insertion moves.
+        std::mt19937 rng(3u);
+        std::uniform_real_distribution<float> drift(-0.02f, 0.02f);
+        for (int step = 0; step < 5; ++step)
+        {
+            for (auto& box : boxes)
+            {
+                const float dx = drift(rng);
+                const float dy = drift(rng);
+                box = {box.minX + dx, box.minY + dy, box.maxX + dx, box.maxY + dy};
+            }
+            reference.Detect(boxes, ids, expected);
+            sap.Detect(boxes, ids, events, step % 2 ? &jobSystem : nullptr);
+            assert(SameEvents(events, expected));
+            assert(endpoints->LastSortMoves() < boxes.size());
+        }
+
+        // Shuffled proxies (e.g. after a storage re-sort) still come out right.
+        std::reverse(boxes.begin(), boxes.end());
+        reference.Detect(boxes, ids, expected);
+        sap.Detect(boxes, ids, events);
+        assert(SameEvents(events, expected));
+
+        // A different proxy count rebuilds the list.
+        boxes.resize(700);
+        const auto fewerIds = Ids(boxes.size());
+        reference.Detect(boxes, fewerIds, expected);
+        sap.Detect(boxes, fewerIds, events);
+        assert(SameEvents(events, expected));
+    }
+
+    void VerifyGridReusesBuffersAcrossScenes(jobs::JobSystem& jobSystem)
+    {
+        physics::CollisionSystem reference;
+        reference.SetBroadphase(physics::Broadphase::BruteForce);
+        // Small cells make most proxies span several, and the floor hundreds.
+        physics::CollisionSystem grid;
+        grid.SetBroadphase(std::make_unique<physics::UniformGridBroadphase>(0.5f));
+
+        std::vector<physics::CollisionEvent> expected;
+        std::vector<physics::CollisionEvent> events;
+        for (const std::size_t count : {2000u, 300u, 4000u, 2000u})
+        {
+            const auto boxes = MixedScene(count, static_cast<unsigned>(count));
+            const auto ids = Ids(boxes.size());
+            reference.Detect(boxes, ids, expected);
+            grid.Detect(boxes, ids, events, &jobSystem);
+            assert(SameEvents(events, expected));
+            grid.Detect(boxes, ids, events);
+            assert(SameEvents(events, expected));
+        }
+    }
+
+    void VerifySleepingPairsSkipped()
+    {
+        std::vector<physics::AABBComponent> boxes = {
+            {0.0f, 0.0f, 1.0f, 1.0f},
+            {0.5f, 0.5f, 1.5f, 1.5f},
+            {0.8f, 0.8f, 5.0f, 5.0f},
+        };
+        const auto ids = Ids(boxes.size());
+        const std::vector<physics::ProxyMotion> motion = {
+            physics::ProxyMotion::Asleep, physics::ProxyMotion::Static, physics::ProxyMotion::Awake};
+
+        for (const auto broadphase : {physics::Broadphase::BruteForce, physics::Broadphase::UniformGrid,
+                                      physics::Broadphase::HierarchicalGrid, physics::Broadphase::SweepAndPrune})
+        {
+            physics::CollisionSystem system;
+            system.SetBroadphase(broadphase);
+            std::vector<physics::CollisionEvent> events;
+            system.Detect(boxes, ids, events, nullptr, &motion);
+            assert(events.size() == 2);
+            assert(events[0].entityA == 1 && events[0].entityB == 3);
+            assert(events[1].entityA == 2 && events[1].entityB == 3);
+        }
+    }
+
+    void VerifyDegenerateProxies()
+    {
+        // Zero-size proxies stacked on one point still pair up.
+        std::vector<physics::AABBComponent> boxes(20, physics::AABBComponent{2.0f, 2.0f, 2.0f, 2.0f});
+        const auto ids = Ids(boxes.size());
+        for (const auto broadphase : {physics::Broadphase::BruteForce, physics::Broadphase::UniformGrid,
+                                      physics::Broadphase::HierarchicalGrid, physics::Broadphase::SweepAndPrune})
+        {
+            physics::CollisionSystem system;
+            system.SetBroadphase(broadphase);
+            std::vector<physics::CollisionEvent> events;
+            system.Detect(boxes, ids, events);
+            assert(events.size() == 20u * 19u / 2u);
+        }
+    }
+}
+
+int main()
+{
+    jobs::JobSystem jobSystem;
+    VerifyStrategiesMatchAllPairs(jobSystem);
+    VerifyAutoSelection(jobSystem);
+    VerifySweepAndPruneKeepsOrderAcrossCalls(jobSystem);
+    VerifyGridReusesBuffersAcrossScenes(jobSystem);
+    VerifySleepingPairsSkipped();
+    VerifyDegenerateProxies();
+    std::cout << "Physics broadphase tests passed\n";
+    return 0;
+}
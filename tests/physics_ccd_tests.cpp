@@ -0,0 +1,152 @@
+/*
+ * Copyright (C) 2025 aeml
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+
+#include "PhysicsTestHelpers.hpp"
+#include "physics/ContinuousCollision.hpp"
+
+#include <cassert>
+#include <cmath>
+#include <iostream>
+
+namespace
+{
+    using physics_test::AddBall;
+    using physics_test::AddBox;
+    using physics_test::AddPhysics;
+    using physics_test::kDt;
+
+    bool Near(float a, float b, float eps = 1e-4f)
+    {
+        return std::fabs(a - b) <= eps;
+    }
+
+    void VerifySweepTimeOfImpact()
+    {
+        const physics::AABBComponent box{1.0f, -1.0f, 2.0f, 1.0f};
+        physics::SweepHit hit;
+
+        // Face hit: circle of radius 0.5 touches x = 1 when its centre is at 0.5.
+        assert(physics::SweepCircleAabb(0.0f, 0.0f, 4.0f, 0.0f, 0.5f, box, hit));
+        assert(Near(hit.t, 0.125f));
+        assert(Near(hit.normalX, -1.0f) && Near(hit.normalY, 0.0f));
+
+        // Corner: the entry point lies past the corner, so the rounded corner decides.
+        assert(physics::SweepCircleAabb(0.0f, 1.4f, 4.0f, 1.4f, 0.5f, box, hit));
+        assert(hit.normalX < 0.0f && hit.normalY > 0.0f);
+        assert(!physics::SweepCircleAabb(0.0f, 1.49f, 0.9f, 1.49f, 0.5f, box, hit));
+        assert(!physics::SweepCircleAabb(0.0f, 1.6f, 4.0f, 1.6f, 0.5f, box, hit));
+
+        // Moving away, or starting inside, is not an impact.
+        assert(!physics::SweepCircleAabb(0.0f, 0.0f, -4.0f, 0.0f, 0.5f, box, hit));
+        assert(!physics::SweepCircleAabb(1.5f, 0.0f, 4.0f, 0.0f, 0.5f, box, hit));
+
+        assert(physics::SweepAabbAabb(1.5f, 3.0f, 1.5f, -3.0f, 0.25f, 0.25f, box, hit));
+        assert(Near(hit.t, (3.0f - 1.25f) / 6.0f));
+        assert(Near(hit.normalY, 1.0f));
+    }
+
+    float RunBallAtThinWall(bool continuous)
+    {
+        ecs::World world;
+        physics::PhysicsSettings settings;
+        settings.substeps = 1;
+        settings.continuousCollision = continuous;
+        auto* physicsPtr = AddPhysics(world, settings);
+
+        AddBox(world, 5.05f, 0.0f, 0.05f, 10.0f, 0.0f);
+        auto ball = AddBall(world, 0.0f, 0.0f, 0.1f);
+        world.GetComponent<physics::RigidBodyComponent>(ball)->vx = 45.0f;
+        world.AddComponent<physics::AABBComponent>(ball, -0.1f, -0.1f, 0.1f, 0.1f);
+
+        std::size_t clamped = 0;
+        for (int frame = 0; frame < 30; ++frame)
+        {
+            world.Update(kDt);
+            clamped += physicsPtr->StepStats().continuous.clampedBodies;
+        }
+        assert(continuous ? clamped >= 1 : clamped == 0);
+
+        const ecs::World& view = world;
+        return view.GetComponent<physics::TransformComponent>(ball)->x;
+    }
+
+    void VerifyFastBallStaysBehindThinWall()
+    {
+        // 0.75 units per step against a 0.1 wall and a 0.1 radius ball.
+        assert(RunBallAtThinWall(false) > 5.1f);
+        assert(RunBallAtThinWall(true) < 5.0f);
+    }
+
+    void VerifyMaskedOutWallIsNotSwept()
+    {
+        // The ball only collides with layer 2 and the wall sits on layer 1, so
+        // the broadphase never pairs them and the sweep must not stop the ball.
+        ecs::World world;
+        physics::PhysicsSettings settings;
+        settings.substeps = 1;
+        settings.continuousCollision = true;
+        auto* physicsPtr = AddPhysics(world, settings);
+        physicsPtr->SetEnvironment(physics::EnvironmentForces{0.0f});
+
+        AddBox(world, 5.05f, 0.0f, 0.05f, 10.0f, 0.0f);
+        auto ball = AddBall(world, 4.5f, 0.0f, 0.1f);
+        world.GetComponent<physics::RigidBodyComponent>(ball)->vx = 45.0f;
+        world.AddComponent<physics::CollisionFilterComponent>(ball, physics::CollisionFilterComponent{2u, 2u});
+
+        world.Update(kDt);
+        assert(physicsPtr->StepStats().continuous.clampedBodies == 0);
+        const ecs::World& view = world;
+        assert(Near(view.GetComponent<physics::TransformComponent>(ball)->x, 5.25f, 1e-3f));
+        assert(Near(view.GetComponent<physics::RigidBodyComponent>(ball)->vx, 45.0f, 1e-2f));
+    }
+
+    void VerifyImpactUsesSharedMaterials()
+    {
+        // The bodies' own coefficients say "no bounce"; their shared
+        // materials, which discrete contacts use, say "full bounce".
+        ecs::World world;
+        physics::PhysicsSettings settings;
+        settings.substeps = 1;
+        settings.continuousCollision = true;
+        auto* physicsPtr = AddPhysics(world, settings);
+        physicsPtr->SetEnvironment(physics::EnvironmentForces{0.0f});
+
+        auto wall = AddBox(world, 5.05f, 0.0f, 0.05f, 10.0f, 0.0f);
+        world.AddSharedComponent(wall, physics::PhysicsMaterial{1.0f, 0.0f});
+        auto ball = AddBall(world, 4.5f, 0.0f, 0.1f);
+        world.GetComponent<physics::RigidBodyComponent>(ball)->vx = 45.0f;
+        world.AddSharedComponent(ball, physics::PhysicsMaterial{1.0f, 0.0f});
+
+        world.Update(kDt);
+        assert(physicsPtr->StepStats().continuous.clampedBodies == 1);
+        const ecs::World& view = world;
+        assert(Near(view.GetComponent<physics::TransformComponent>(ball)->x, 4.9f, 1e-3f));
+        assert(Near(view.GetComponent<physics::RigidBodyComponent>(ball)->vx, -45.0f, 1e-2f));
+    }
+}
+
+int main()
+{
+    VerifySweepTimeOfImpact();
+    VerifyFastBallStaysBehindThinWall();
+    VerifyImpactUsesSharedMaterials();
+    VerifyMaskedOutWallIsNotSwept();
+    std::cout << "Physics CCD tests passed\n";
+    return 0;
+}
@@ -0,0 +1,115 @@
+/*
+ * Copyright (C) 2025 aeml
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "PhysicsTestHelpers.hpp"
+#include "physics/CollisionSystem.hpp"
+
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+    using physics_test::AddBox;
+    using physics_test::AddPhysics;
+    using physics_test::kDt;
+
+    void VerifyLayerMasksPrunePairs()
+    {
+        // Four overlapping boxes: 0 and 1 share layer 2, which excludes itself;
+        // 3 only wants layer 4, which nobody is on.
+        const std::vector<physics::AABBComponent> boxes(4, physics::AABBComponent{0.0f, 0.0f, 1.0f, 1.0f});
+        const std::vector<std::uint32_t> ids = {1, 2, 3, 4};
+        const std::vector<physics::CollisionFilterComponent> layers = {
+            {2u, ~2u}, {2u, ~2u}, {1u, ~0u}, {1u, 4u}};
+
+        for (const auto broadphase : {physics::Broadphase::BruteForce, physics::Broadphase::UniformGrid,
+                                      physics::Broadphase::HierarchicalGrid, physics::Broadphase::SweepAndPrune})
+        {
+            physics::CollisionSystem system;
+            system.SetBroadphase(broadphase);
+            std::vector<physics::CollisionEvent> events;
+            system.Detect(boxes, ids, events, nullptr, nullptr, &layers);
+            assert(events.size() == 2);
+            assert(events[0].entityA == 1 && events[0].entityB == 3);
+            assert(events[1].entityA == 2 && events[1].entityB == 3);
+
+            // Without layers every pair is reported.
+            system.Detect(boxes, ids, events);
+            assert(events.size() == 6);
+        }
+    }
+
+    void VerifyStaticPairsNeverReported()
+    {
+        ecs::World world;
+        auto* physicsPtr = AddPhysics(world);
+
+        // Overlapping scenery, plus two body-less boxes that still report.
+        AddBox(world, 0.0f, 0.0f, 1.0f, 1.0f, 0.0f);
+        AddBox(world, 0.5f, 0.0f, 1.0f, 1.0f, 0.0f);
+        for (int i = 0; i < 2; ++i)
+        {
+            auto e = world.CreateEntity();
+            world.AddComponent<physics::TransformComponent>(e, 10.0f, 0.0f, 0.0f);
+            world.AddComponent<physics::AABBComponent>(e, 9.5f, -0.5f, 10.5f, 0.5f);
+        }
+
+        world.Update(kDt);
+        const auto& events = physicsPtr->GetCollisionEvents();
+        assert(events.size() == 1);
+        assert(events[0].entityA == 3 && events[0].entityB == 4);
+    }
+
+    void VerifySelfExcludingLayerPassesThrough()
+    {
+        ecs::World world;
+        AddPhysics(world);
+
+        AddBox(world, 0.0f, -1.0f, 1.0f, 1.0f, 0.0f);
+        const auto lower = AddBox(world, 0.0f, 0.5f, 0.5f, 0.5f, 1.0f);
+        const auto upper = AddBox(world, 0.0f, 2.0f, 0.5f, 0.5f, 1.0f);
+        for (const auto e : {lower, upper})
+        {
+            world.AddComponent<physics::CollisionFilterComponent>(e, 2u, ~2u);
+        }
+
+        for (int frame = 0; frame < 180; ++frame)
+        {
+            world.Update(kDt);
+        }
+
+        // Both rest on the floor side by side in the same spot.
+        const ecs::World& view = world;
+        const float lowerY = view.GetComponent<physics::TransformComponent>(lower)->y;
+        const float upperY = view.GetComponent<physics::TransformComponent>(upper)->y;
+        assert(std::fabs(lowerY - 0.5f) < 0.05f);
+        assert(std::fabs(upperY - 0.5f) < 0.05f);
+    }
+}
+
+int main()
+{
+    VerifyLayerMasksPrunePairs();
+    VerifyStaticPairsNeverReported();
+    VerifySelfExcludingLayerPassesThrough();
+    std::cout << "Physics collision filter tests passed\n";
+    return 0;
+}
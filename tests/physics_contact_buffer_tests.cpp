@@ -0,0 +1,390 @@
+/*
+ * Copyright (C) 2025 aeml
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "PhysicsTestHelpers.hpp"
+#include "physics/CollisionSystem.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace
+{
+    using physics_test::AddPhysics;
+    using physics_test::kDt;
+
+    // Dynamic boxes start falling at 1 m/s onto whatever is below them.
+    ecs::EntityId AddFallingBox(ecs::World& world, float x, float y, float halfSize, float invMass)
+    {
+        const auto e = physics_test::AddBox(world, x, y, halfSize, halfSize, invMass);
+        world.GetComponent<physics::RigidBodyComponent>(e)->vy = invMass > 0.0f ? -1.0f : 0.0f;
+        return e;
+    }
+
+    physics::CollisionEvent Event(ecs::EntityId a, ecs::EntityId b, float penetration)
+    {
+        physics::CollisionEvent event{};
+        event.entityA = a;
+        event.entityB = b;
+        event.normalX = 0.0f;
+        event.normalY = 1.0f;
+        event.penetration = penetration;
+        return event;
+    }
+
+    void VerifyDetectCarriesBodySlots()
+    {
+        const std::vector<physics::AABBComponent> boxes(3, physics::AABBComponent{0.0f, 0.0f, 1.0f, 1.0f});
+        const std::vector<std::uint32_t> ids = {10, 11, 12};
+        const std::vector<std::uint32_t> bodies = {2, physics::CollisionEvent::kNoBody, 0};
+
+        physics::CollisionSystem system;
+        std::vector<physics::CollisionEvent> events;
+        system.Detect(boxes, ids, events, nullptr, nullptr, nullptr, &bodies);
+        assert(events.size() == 3);
+        assert(events[0].bodyA == 2 && events[0].bodyB == physics::CollisionEvent::kNoBody);
+        assert(events[1].bodyA == 2 && events[1].bodyB == 0);
+
+        system.Detect(boxes, ids, events);
+        assert(events[1].bodyA == physics::CollisionEvent::kNoBody);
+    }
+
+    void VerifyStaticBodiesSplitIslands()
+    {
+        // Two stacks of two on one floor: the floor links nothing, so the
+        // buffer holds two islands, each with its contacts in event order.
+        ecs::World world;
+        const auto floor = AddFallingBox(world, 0.0f, -10.0f, 10.0f, 0.0f);
+        const auto left0 = AddFallingBox(world, -5.0f, 0.4f, 0.5f, 1.0f);
+        const auto right0 = AddFallingBox(world, 5.0f, 0.4f, 0.5f, 1.0f);
+        const auto left1 = AddFallingBox(world, -5.0f, 1.3f, 0.5f, 1.0f);
+        const auto right1 = AddFallingBox(world, 5.0f, 1.3f, 0.5f, 1.0f);
+
+        const std::vector<physics::CollisionEvent> events = {
+            Event(floor, left0, 0.1f), Event(floor, right0, 0.1f), Event(left0, left1, 0.1f),
+            Event(right0, right1, 0.1f)};
+
+        physics::CollisionResolutionSystem resolution;
+        physics::ContactBuffer contacts;
+        resolution.PrepareContacts(events, world, contacts);
+        assert(contacts.Size() == 4);
+        assert(contacts.IslandCount() == 2);
+        assert(contacts.islandStart[1] == 2);
+        // Four dynamic bodies plus one copy of the floor per floor contact.
+        assert(contacts.bodyRigid.size() == 6);
+        assert(contacts.a[0] != contacts.a[2]);
+        assert(contacts.b[0] == contacts.a[1]);
+        assert(contacts.b[2] == contacts.a[3]);
+
+        // Re-preparing reuses the buffer and gives the same result.
+        resolution.PrepareContacts(events, world, contacts);
+        assert(contacts.Size() == 4 && contacts.IslandCount() == 2);
+
+        resolution.PrepareContacts({}, world, contacts);
+        assert(contacts.Size() == 0 && contacts.IslandCount() == 0);
+    }
+
+    float SolveWithSlots(bool staleSlots)
+    {
+        ecs::World world;
+        const auto floor = AddFallingBox(world, 0.0f, -10.0f, 10.0f, 0.0f);
+        const auto box = AddFallingBox(world, 0.0f, 0.4f, 0.5f, 1.0f);
+
+        auto event = Event(floor, box, 0.1f);
+        if (staleSlots)
+        {
+            // Slots of the other entity, as left behind by a storage re-sort.
+            event.bodyA = 1;
+            event.bodyB = 0;
+        }
+        physics::CollisionResolutionSystem resolution;
+        physics::ContactBuffer contacts;
+        resolution.PrepareContacts({event}, world, contacts);
+        resolution.ResolvePosition(contacts);
+        resolution.ResolveVelocity(contacts);
+
+        const ecs::World& view = world;
+        assert(view.GetComponent<physics::TransformComponent>(floor)->y == -10.0f);
+        assert(view.GetComponent<physics::RigidBodyComponent>(box)->vy >= 0.0f);
+        return view.GetComponent<physics::TransformComponent>(box)->y;
+    }
+
+    void VerifyStaleSlotsFallBackToLookups()
+    {
+        const float fresh = SolveWithSlots(false);
+        assert(fresh > 0.4f);
+        assert(SolveWithSlots(true) == fresh);
+    }
+
+    void VerifyProxySlotsAndMaterialCache()
+    {
+        ecs::World world;
+        const auto floor = AddFallingBox(world, 0.0f, -10.0f, 10.0f, 0.0f);
+        const auto box = AddFallingBox(world, 0.0f, 0.4f, 0.5f, 1.0f);
+        world.AddSharedComponent(floor, physics::PhysicsMaterial{0.8f, 0.0f});
+        world.AddSharedComponent(box, physics::PhysicsMaterial{0.6f, 0.0f});
+        const std::vector<physics::CollisionEvent> events = {Event(floor, box, 0.1f)};
+
+        // A proxy table as PhysicsSystem builds it: one AABB proxy per body.
+        const std::uint32_t none = physics::CollisionEvent::kNoBody;
+        const std::vector<std::uint32_t> bodyProxy = {0, 1};
+        const std::vector<std::uint32_t> slots = {0, 1};
+        const std::vector<std::uint32_t> circles = {none, none};
+        physics::ContactProxies proxies;
+        proxies.bodyProxy = &bodyProxy;
+        proxies.transforms = &slots;
+        proxies.shapes = &slots;
+        proxies.circles = &circles;
+        proxies.boxProxies = 2;
+
+        physics::CollisionResolutionSystem resolution;
+        physics::ContactBuffer looked;
+        physics::ContactBuffer proxied;
+        resolution.PrepareContacts(events, world, looked);
+        resolution.PrepareContacts(events, world, proxied, nullptr, &proxies);
+        assert(proxied.Size() == 1 && looked.Size() == 1);
+        assert(proxied.pen[0] == looked.pen[0] && proxied.restitution[0] == looked.restitution[0]);
+        assert(proxied.restitution[0] == 0.6f);
+
+        // The cached pair table follows material edits.
+        world.GetSharedStorage<physics::PhysicsMaterial>()->Modify(box, [](physics::PhysicsMaterial& m) {
+            m.restitution = 0.2f;
+        });
+        resolution.PrepareContacts(events, world, proxied, nullptr, &proxies);
+        assert(proxied.restitution[0] == 0.2f);
+    }
+
+    void VerifyRowsAreBatchedByKind()
+    {
+        // One island mixing a floor contact, box/box contacts with and
+        // without friction, and a pair of bodies that cannot spin.
+        ecs::World world;
+        const auto floor = AddFallingBox(world, 0.0f, -10.0f, 10.0f, 0.0f);
+        const auto low = AddFallingBox(world, 0.0f, 0.4f, 0.5f, 1.0f);
+        const auto mid = AddFallingBox(world, 0.0f, 1.3f, 0.5f, 1.0f);
+        const auto top = AddFallingBox(world, 0.0f, 2.2f, 0.5f, 1.0f);
+        world.GetComponent<physics::RigidBodyComponent>(mid)->invInertia = 0.0f;
+        world.GetComponent<physics::RigidBodyComponent>(top)->invInertia = 0.0f;
+        auto* slippery = world.GetComponent<physics::RigidBodyComponent>(low);
+
+        const std::vector<physics::CollisionEvent> events = {
+            Event(mid, top, 0.1f), Event(low, mid, 0.1f), Event(floor, low, 0.1f)};
+
+        physics::CollisionResolutionSystem resolution;
+        physics::ContactBuffer contacts;
+        resolution.PrepareContacts(events, world, contacts);
+        using CB = physics::ContactBuffer;
+        assert(contacts.IslandCount() == 1 && contacts.Size() == 3);
+        // The floor contact comes first; mid/top cannot spin either body.
+        assert(contacts.BatchCount() == 3);
+        assert(contacts.batchKind[0] == (CB::kFriction | CB::kRotation | CB::kStaticA));
+        assert(contacts.batchKind[1] == (CB::kFriction | CB::kRotation));
+        assert(contacts.batchKind[2] == CB::kFriction);
+        assert(contacts.leverA[2] == 0.0f && contacts.leverB[2] == 0.0f);
+        assert(contacts.islandBatch[0] == 0 && contacts.islandBatch[1] == 3);
+        for (std::size_t j = 0; j < 3; ++j) assert(contacts.batchStart[j] == j);
+
+        // Without friction the low/mid contact loses both friction and spin,
+        // and the floor contact keeps only its static side.
+        slippery->friction = 0.0f;
+        world.GetComponent<physics::RigidBodyComponent>(floor)->friction = 0.0f;
+        world.GetComponent<physics::RigidBodyComponent>(mid)->friction = 0.0f;
+        resolution.PrepareContacts(events, world, contacts);
+        assert(contacts.BatchCount() == 3);
+        assert(contacts.batchKind[0] == CB::kStaticA);
+        assert(contacts.batchKind[1] == CB::kFriction);
+        assert(contacts.batchKind[2] == 0);
+    }
+
+    void VerifyKernelsMatchBranchingSolve()
+    {
+        // A single-kind island is solved in event order, so the kernels must
+        // reproduce the per-contact branching solve exactly.
+        ecs::World world;
+        std::vector<ecs::EntityId> boxes;
+        for (int i = 0; i < 6; ++i)
+        {
+            boxes.push_back(AddFallingBox(world, 0.9f * static_cast<float>(i), 0.0f, 0.5f, 1.0f));
+            auto* rb = world.GetComponent<physics::RigidBodyComponent>(boxes.back());
+            rb->vx = i % 2 == 0 ? 1.0f : -1.5f;
+            rb->vy = 0.3f * static_cast<float>(i);
+        }
+        std::vector<physics::CollisionEvent> events;
+        for (int i = 0; i + 1 < 6; ++i)
+        {
+            auto event = Event(boxes[i], boxes[i + 1], 0.1f);
+            event.normalX = 1.0f;
+            event.normalY = 0.0f;
+            events.push_back(event);
+        }
+
+        physics::CollisionResolutionSystem resolution;
+        physics::ContactBuffer contacts;
+        resolution.PrepareContacts(events, world, contacts);
+        assert(contacts.BatchCount() == 1);
+
+        const std::size_t bodies = contacts.bodyRigid.size();
+        std::vector<float> vx(bodies), vy(bodies), w(bodies);
+        for (std::size_t i = 0; i < bodies; ++i)
+        {
+            vx[i] = contacts.bodyRigid[i]->vx;
+            vy[i] = contacts.bodyRigid[i]->vy;
+            w[i] = contacts.bodyRigid[i]->angularVelocity;
+        }
+        const auto& inv = contacts.bodyInvMass;
+        const auto& invI = contacts.bodyInvInertia;
+        for (int pass = 0; pass < physics::CollisionResolutionSystem::SolverSettings{}.velocityIterations; ++pass)
+        {
+            for (std::size_t k = 0; k < contacts.Size(); ++k)
+            {
+                const auto a = contacts.a[k];
+                const auto b = contacts.b[k];
+                const float nx = contacts.nx[k];
+                const float ny = contacts.ny[k];
+                float j = 0.0f;
+                const float vn = (vx[b] - vx[a]) * nx + (vy[b] - vy[a]) * ny;
+                if (vn < 0.0f)
+                {
+                    j = -(1 + contacts.restitution[k]) * vn;
+                    j /= contacts.invMassSum[k];
+                    vx[a] -= j * nx * inv[a];
+                    vy[a] -= j * ny * inv[a];
+                    vx[b] += j * nx * inv[b];
+                    vy[b] += j * ny * inv[b];
+                }
+                float jt = -((vx[b] - vx[a]) * -ny + (vy[b] - vy[a]) * nx);
+                jt /= contacts.invMassSum[k];
+                const float maxJt = j > 0.0f ? contacts.friction[k] * j : contacts.friction[k] * 0.1f;
+                if (std::fabs(jt) > maxJt) jt = jt > 0.0f ? maxJt : -maxJt;
+                vx[a] -= jt * -ny * inv[a];
+                vy[a] -= jt * nx * inv[a];
+                vx[b] += jt * -ny * inv[b];
+                vy[b] += jt * nx * inv[b];
+                if (contacts.leverA[k] > 0.0f && invI[a] > 0.0f) w[a] -= jt * contacts.leverA[k] * invI[a];
+                if (contacts.leverB[k] > 0.0f && invI[b] > 0.0f) w[b] += jt * contacts.leverB[k] * invI[b];
+            }
+        }
+
+        resolution.ResolveVelocity(contacts);
+        for (std::size_t i = 0; i < bodies; ++i)
+        {
+            assert(contacts.bodyRigid[i]->vx == vx[i]);
+            assert(contacts.bodyRigid[i]->vy == vy[i]);
+            assert(contacts.bodyRigid[i]->angularVelocity == w[i]);
+        }
+    }
+
+    void VerifyPileSettlesWithSharedContacts()
+    {
+        ecs::World world;
+        AddPhysics(world);
+
+        AddFallingBox(world, 0.0f, -10.0f, 10.0f, 0.0f);
+        std::vector<ecs::EntityId> boxes;
+        for (int i = 0; i < 5; ++i)
+        {
+            boxes.push_back(AddFallingBox(world, 0.0f, 0.5f + 1.05f * static_cast<float>(i), 0.5f, 1.0f));
+        }
+        for (int frame = 0; frame < 240; ++frame)
+        {
+            world.Update(kDt);
+        }
+
+        const ecs::World& view = world;
+        for (std::size_t i = 0; i < boxes.size(); ++i)
+        {
+            const float y = view.GetComponent<physics::TransformComponent>(boxes[i])->y;
+            assert(std::fabs(y - (0.5f + static_cast<float>(i))) < 0.1f);
+        }
+    }
+    void VerifyParallelIslandsMatchSerial()
+    {
+        // A grid of boxes with a random subset of neighbour contacts, so
+        // there are islands of every size, and a static tile every so often
+        // that separates them.
+        ecs::World world;
+        constexpr int kSide = 70;
+        std::vector<ecs::EntityId> boxes;
+        for (int row = 0; row < kSide; ++row)
+        {
+            for (int col = 0; col < kSide; ++col)
+            {
+                const bool fixed = (row * kSide + col) % 23 == 0;
+                boxes.push_back(AddFallingBox(world, static_cast<float>(col), static_cast<float>(row), 0.55f,
+                                       fixed ? 0.0f : 1.0f));
+            }
+        }
+        std::mt19937 rng(17u);
+        std::vector<physics::CollisionEvent> events;
+        for (int row = 0; row < kSide; ++row)
+        {
+            for (int col = 0; col < kSide; ++col)
+            {
+                const auto at = [&](int r, int c) { return boxes[static_cast<std::size_t>(r * kSide + c)]; };
+                if (col + 1 < kSide && rng() % 3 != 0) events.push_back(Event(at(row, col), at(row, col + 1), 0.1f));
+                if (row + 1 < kSide && rng() % 3 == 0) events.push_back(Event(at(row, col), at(row + 1, col), 0.1f));
+            }
+        }
+        std::shuffle(events.begin(), events.end(), rng);
+
+        physics::CollisionResolutionSystem resolution;
+        physics::ContactBuffer serial;
+        resolution.PrepareContacts(events, world, serial);
+        jobs::JobSystem jobSystem;
+        physics::ContactBuffer parallel;
+        resolution.PrepareContacts(events, world, parallel, &jobSystem);
+
+        assert(serial.Size() == events.size());
+        assert(serial.IslandCount() > 100);
+        assert(parallel.a == serial.a && parallel.b == serial.b);
+        assert(parallel.nx == serial.nx && parallel.ny == serial.ny && parallel.pen == serial.pen);
+        assert(parallel.islandStart == serial.islandStart && parallel.islandBatch == serial.islandBatch);
+        assert(parallel.batchStart == serial.batchStart && parallel.batchKind == serial.batchKind);
+
+        // No dynamic solver body is in two islands.
+        std::vector<std::size_t> islandOfBody(serial.bodyRigid.size(), serial.IslandCount());
+        for (std::size_t island = 0; island < serial.IslandCount(); ++island)
+        {
+            for (std::uint32_t k = serial.islandStart[island]; k < serial.islandStart[island + 1]; ++k)
+            {
+                for (const std::uint32_t body : {serial.a[k], serial.b[k]})
+                {
+                    assert(islandOfBody[body] == serial.IslandCount() || islandOfBody[body] == island);
+                    islandOfBody[body] = island;
+                }
+            }
+        }
+    }
+}
+
+int main()
+{
+    VerifyDetectCarriesBodySlots();
+    VerifyStaticBodiesSplitIslands();
+    VerifyStaleSlotsFallBackToLookups();
+    VerifyProxySlotsAndMaterialCache();
+    VerifyRowsAreBatchedByKind();
+    VerifyKernelsMatchBranchingSolve();
+    VerifyPileSettlesWithSharedContacts();
+    VerifyParallelIslandsMatchSerial();
+    std::cout << "Physics contact buffer tests passed\n";
+    return 0;
+}
@@ -0,0 +1,167 @@
+/*
+ * Copyright (C) 2025 aeml
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "PhysicsTestHelpers.hpp"
+
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+    using physics_test::AddBall;
+    using physics_test::kDt;
+
+    float Gap(const ecs::World& world, ecs::EntityId a, ecs::EntityId b)
+    {
+        const auto* tA = world.GetComponent<physics::TransformComponent>(a);
+        const auto* tB = world.GetComponent<physics::TransformComponent>(b);
+        return std::hypot(tB->x - tA->x, tB->y - tA->y);
+    }
+
+    void VerifyPositionPassStopsOnceSeparated()
+    {
+        ecs::World world;
+        auto a = AddBall(world, 0.0f, 0.0f, 0.5f, 1.0f);
+        auto b = AddBall(world, 0.9f, 0.0f, 0.5f, 1.0f);
+        const std::vector<physics::CollisionEvent> events{{a, b, 1.0f, 0.0f, 0.1f}};
+
+        physics::CollisionResolutionSystem resolver;
+        physics::CollisionResolutionSystem::SolverSettings settings{};
+        settings.positionIterations = 40;
+        settings.correctionPercent = 0.5f;
+        settings.maxCorrection = 1.0f;
+        settings.positionTolerance = 1e-3f;
+        resolver.SetSolverSettings(settings);
+
+        physics::SolverIterationStats stats;
+        resolver.ResolvePosition(events, world, nullptr, &stats);
+        assert(stats.groups == 1);
+        assert(stats.maxIterations > 1);
+        assert(stats.maxIterations < settings.positionIterations);
+        // Penetration is reduced to within slop plus tolerance, without overshoot.
+        const float remaining = 1.0f - Gap(world, a, b);
+        assert(remaining <= settings.penetrationSlop + settings.positionTolerance + 1e-5f);
+        assert(remaining >= 0.0f);
+    }
+
+    void VerifyVelocityPassStopsWhenNothingChanges()
+    {
+        ecs::World world;
+        auto a = AddBall(world, 0.0f, 0.0f, 0.5f, 1.0f);
+        auto b = AddBall(world, 0.9f, 0.0f, 0.5f, 1.0f);
+        auto* bodyA = world.GetComponent<physics::RigidBodyComponent>(a);
+        auto* bodyB = world.GetComponent<physics::RigidBodyComponent>(b);
+        bodyA->vx = 1.0f;
+        bodyB->vx = -1.0f;
+        bodyA->restitution = bodyB->restitution = 0.5f;
+        const std::vector<physics::CollisionEvent> events{{a, b, 1.0f, 0.0f, 0.1f}};
+
+        physics::CollisionResolutionSystem resolver;
+        physics::CollisionResolutionSystem::SolverSettings settings{};
+        settings.velocityIterations = 12;
+        resolver.SetSolverSettings(settings);
+
+        // The first pass bounces the pair apart; the second changes nothing,
+        // so even a zero tolerance stops there.
+        physics::SolverIterationStats stats;
+        resolver.ResolveVelocity(events, world, nullptr, &stats);
+        assert(stats.groups == 1);
+        assert(stats.maxIterations == 2);
+        assert(world.GetComponent<physics::RigidBodyComponent>(a)->vx < 0.0f);
+        assert(world.GetComponent<physics::RigidBodyComponent>(b)->vx > 0.0f);
+    }
+
+    void BuildChain(ecs::World& world, int links)
+    {
+        auto prev = world.CreateEntity();
+        world.AddComponent<physics::TransformComponent>(prev, 0.0f, 0.0f, 0.0f);
+        world.AddComponent<physics::RigidBodyComponent>(prev).invMass = 0.0f;
+        for (int l = 1; l <= links; ++l)
+        {
+            auto link = world.CreateEntity();
+            world.AddComponent<physics::TransformComponent>(link, static_cast<float>(l) * 1.05f, 0.0f, 0.0f);
+            auto& rb = world.AddComponent<physics::RigidBodyComponent>(link);
+            rb.mass = 1.0f;
+            rb.invMass = 1.0f;
+            world.AddComponent<physics::DistanceJointComponent>(link, physics::DistanceJointComponent{prev, link, 1.0f, 0.0f});
+            prev = link;
+        }
+    }
+
+    void VerifyConstraintIterationsStopAtTolerance()
+    {
+        ecs::World strict;
+        ecs::World loose;
+        BuildChain(strict, 4);
+        BuildChain(loose, 4);
+
+        physics::ConstraintResolutionSystem full;
+        full.SetSolver(physics::JointSolver::Iterative);
+        full.SetIterationCount(200);
+        full.Resolve(strict, kDt);
+
+        physics::ConstraintResolutionSystem early;
+        early.SetSolver(physics::JointSolver::Iterative);
+        early.SetIterationCount(200);
+        early.SetTolerance(1e-3f);
+        early.Resolve(loose, kDt);
+
+        assert(early.LastIterations().groups == 1);
+        assert(early.LastIterations().maxIterations < full.LastIterations().maxIterations);
+
+        // The direct path reports its Newton passes.
+        physics::ConstraintResolutionSystem direct;
+        direct.Resolve(loose, kDt);
+        assert(direct.LastIterations().maxIterations <= 2);
+    }
+
+    void VerifyStepStatsCoverSubsteps()
+    {
+        ecs::World world;
+        physics::PhysicsSettings settings;
+        settings.substeps = 4;
+        settings.positionTolerance = 1e-3f;
+        settings.velocityTolerance = 1e-3f;
+        auto* physicsPtr = physics_test::AddPhysics(world, settings);
+        physics::EnvironmentForces env;
+        env.gravityY = 0.0f;
+        physicsPtr->SetEnvironment(env);
+
+        AddBall(world, 0.0f, 0.0f, 0.5f, 1.0f);
+        AddBall(world, 0.95f, 0.0f, 0.5f, 1.0f);
+        world.Update(kDt);
+
+        const auto& stats = physicsPtr->StepStats();
+        assert(stats.position.groups >= 1);
+        assert(stats.position.groups <= static_cast<std::size_t>(settings.substeps));
+        assert(stats.position.MeanIterations() <= settings.positionIterations);
+        assert(stats.constraint.groups == 0);
+    }
+}
+
+int main()
+{
+    VerifyPositionPassStopsOnceSeparated();
+    VerifyVelocityPassStopsWhenNothingChanges();
+    VerifyConstraintIterationsStopAtTolerance();
+    VerifyStepStatsCoverSubsteps();
+    std::cout << "Physics convergence tests passed\n";
+    return 0;
+}
@@ -0,0 +1,170 @@
+/*
+ * Copyright (C) 2025 aeml
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "ecs/World.hpp"
+#include "jobs/JobSystem.hpp"
+#include "physics/Components.hpp"
+#include "physics/Fluid.hpp"
+
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+namespace
+{
+    void AddWall(ecs::World& world, float minX, float minY, float maxX, float maxY)
+    {
+        auto wall = world.CreateEntity();
+        world.AddComponent<physics::TransformComponent>(wall, 0.5f * (minX + maxX), 0.5f * (minY + maxY), 0.0f);
+        world.AddComponent<physics::AABBComponent>(wall, minX, minY, maxX, maxY);
+    }
+
+    // An open box with inner faces at x = 0, x = width and y = 0, holding
+    // a block of particles at rest spacing against its left wall.
+    std::vector<ecs::EntityId> DamBreak(ecs::World& world, float width, int columns, int rows, float spacing)
+    {
+        AddWall(world, -5.0f, -5.0f, 0.0f, 50.0f);
+        AddWall(world, width, -5.0f, width + 5.0f, 50.0f);
+        AddWall(world, -5.0f, -5.0f, width + 5.0f, 0.0f);
+        std::vector<ecs::EntityId> particles;
+        for (int row = 0; row < rows; ++row)
+        {
+            for (int col = 0; col < columns; ++col)
+            {
+                auto p = world.CreateEntity();
+                world.AddComponent<physics::TransformComponent>(p, (static_cast<float>(col) + 0.5f) * spacing,
+                                                                (static_cast<float>(row) + 0.5f) * spacing, 0.0f);
+                world.AddComponent<physics::FluidParticleComponent>(p);
+                particles.push_back(p);
+            }
+        }
+        return particles;
+    }
+
+    std::vector<float> Positions(ecs::World& world, const std::vector<ecs::EntityId>& particles)
+    {
+        std::vector<float> out;
+        for (const auto id : particles)
+        {
+            const auto* tf = world.GetComponent<physics::TransformComponent>(id);
+            out.push_back(tf->x);
+            out.push_back(tf->y);
+        }
+        return out;
+    }
+
+    void VerifyResultIsIndependentOfWorkers()
+    {
+        jobs::JobSystem jobSystem;
+        std::vector<float> results[2];
+        for (int run = 0; run < 2; ++run)
+        {
+            ecs::World world;
+            const auto particles = DamBreak(world, 20.0f, 30, 40, 0.5f);
+            auto system = std::make_unique<physics::FluidSystem>();
+            system->SetJobSystem(run == 0 ? nullptr : &jobSystem);
+            world.AddSystem(std::move(system));
+            for (int frame = 0; frame < 20; ++frame)
+            {
+                world.Update(1.0f / 60.0f);
+            }
+            results[run] = Positions(world, particles);
+        }
+        assert(results[0] == results[1]);
+    }
+
+    void VerifyDamBreakStaysInBoxAndSettles()
+    {
+        ecs::World world;
+        const float width = 10.0f;
+        const auto particles = DamBreak(world, width, 10, 20, 0.5f);
+        auto owned = std::make_unique<physics::FluidSystem>();
+        auto* system = owned.get();
+        world.AddSystem(std::move(owned));
+        for (int frame = 0; frame < 900; ++frame)
+        {
+            world.Update(1.0f / 60.0f);
+        }
+        assert(system->ParticleCount() == particles.size());
+        assert(system->RestDensity() > 0.0f);
+
+        // The column has spread over the floor and come to rest: every
+        // particle inside the walls, slow, and the pool about as deep as
+        // the same particles at rest spacing would be.
+        const float radius = 0.25f;
+        float top = 0.0f;
+        float maxSpeed = 0.0f;
+        float minX = width;
+        float maxX = 0.0f;
+        for (const auto id : particles)
+        {
+            const auto* tf = world.GetComponent<physics::TransformComponent>(id);
+            const auto* particle = world.GetComponent<physics::FluidParticleComponent>(id);
+            assert(std::isfinite(tf->x) && std::isfinite(tf->y));
+            assert(tf->x >= radius - 1e-3f && tf->x <= width - radius + 1e-3f);
+            assert(tf->y >= radius - 1e-3f);
+            top = std::max(top, tf->y);
+            minX = std::min(minX, tf->x);
+            maxX = std::max(maxX, tf->x);
+            maxSpeed = std::max(maxSpeed, std::hypot(particle->vx, particle->vy));
+        }
+        const float restDepth = static_cast<float>(particles.size()) * 0.25f / width;
+        assert(minX < 1.0f && maxX > width - 1.0f);
+        assert(top > 0.8f * restDepth && top < 1.3f * restDepth);
+        assert(maxSpeed < 0.5f);
+        assert(system->NeighbourCount() > particles.size() * 4);
+    }
+
+    void VerifyFluidPushesRigidCircles()
+    {
+        // A ball resting in the fluid is pushed up and out of it; a fixed
+        // ball (no rigid body) is only an obstacle.
+        ecs::World world;
+        const auto particles = DamBreak(world, 10.0f, 20, 8, 0.5f);
+        auto ball = world.CreateEntity();
+        world.AddComponent<physics::TransformComponent>(ball, 5.0f, 1.0f, 0.0f);
+        auto& body = world.AddComponent<physics::RigidBodyComponent>(ball);
+        body.vx = 0.0f;
+        world.AddComponent<physics::CircleColliderComponent>(ball, 0.75f);
+        auto post = world.CreateEntity();
+        world.AddComponent<physics::TransformComponent>(post, 2.0f, 2.0f, 0.0f);
+        world.AddComponent<physics::CircleColliderComponent>(post, 0.5f);
+
+        world.AddSystem(std::make_unique<physics::FluidSystem>());
+        world.Update(1.0f / 60.0f);
+
+        const auto* rb = world.GetComponent<physics::RigidBodyComponent>(ball);
+        assert(rb->vy > 0.0f);
+        for (const auto id : particles)
+        {
+            const auto* tf = world.GetComponent<physics::TransformComponent>(id);
+            assert(std::hypot(tf->x - 5.0f, tf->y - 1.0f) >= 0.75f + 0.25f - 1e-3f);
+            assert(std::hypot(tf->x - 2.0f, tf->y - 2.0f) >= 0.5f + 0.25f - 1e-3f);
+        }
+    }
+}
+
+int main()
+{
+    VerifyResultIsIndependentOfWorkers();
+    VerifyDamBreakStaysInBoxAndSettles();
+    VerifyFluidPushesRigidCircles();
+    std::cout << "Physics fluid tests passed\n";
+    return 0;
+}
@@ -0,0 +1,167 @@
+/*
+ * Copyright (C) 2025 aeml
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "ecs/World.hpp"
+#include "jobs/JobSystem.hpp"
+#include "physics/Components.hpp"
+#include "physics/Gravity.hpp"
+
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace
+{
+    // A disc of bodies with a dense core, plus a few coincident pairs.
+    physics::GravityBodies Cloud(std::size_t count, unsigned seed)
+    {
+        std::mt19937 rng(seed);
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+        physics::GravityBodies bodies;
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            if (i % 97 == 1)
+            {
+                bodies.Push(bodies.x[i - 1], bodies.y[i - 1], 1.0f);
+                continue;
+            }
+            const float r = 50.0f * unit(rng) * unit(rng);
+            const float angle = 6.2831853f * unit(rng);
+            bodies.Push(r * std::cos(angle), r * std::sin(angle), 0.5f + unit(rng));
+        }
+        return bodies;
+    }
+
+    // Root mean square of |a - reference| over root mean square of |reference|.
+    float RelativeError(const std::vector<float>& ax, const std::vector<float>& ay,
+                        const std::vector<float>& rx, const std::vector<float>& ry)
+    {
+        double error = 0.0;
+        double norm = 0.0;
+        for (std::size_t i = 0; i < ax.size(); ++i)
+        {
+            error += (ax[i] - rx[i]) * (ax[i] - rx[i]) + (ay[i] - ry[i]) * (ay[i] - ry[i]);
+            norm += rx[i] * rx[i] + ry[i] * ry[i];
+        }
+        return static_cast<float>(std::sqrt(error / norm));
+    }
+
+    void VerifyBarnesHutMatchesDirectSum()
+    {
+        const auto bodies = Cloud(3000, 5u);
+        physics::GravitySolver solver;
+        physics::GravitySettings settings;
+        settings.softening = 0.1f;
+        settings.method = physics::GravityMethod::Direct;
+        std::vector<float> directX, directY;
+        solver.Accelerations(bodies, settings, nullptr, directX, directY);
+        assert(solver.NodeCount() == 0);
+
+        settings.method = physics::GravityMethod::BarnesHut;
+        std::vector<float> ax, ay;
+        // Opening every cell leaves only rounding from the summation order.
+        settings.openingAngle = 0.0f;
+        solver.Accelerations(bodies, settings, nullptr, ax, ay);
+        assert(RelativeError(ax, ay, directX, directY) < 1e-5f);
+
+        float previous = 0.0f;
+        for (const float angle : {0.3f, 0.5f, 0.8f})
+        {
+            settings.openingAngle = angle;
+            solver.Accelerations(bodies, settings, nullptr, ax, ay);
+            const float error = RelativeError(ax, ay, directX, directY);
+            assert(error >= previous && error < 0.02f);
+            previous = error;
+        }
+        assert(solver.NodeCount() > 3000 / settings.leafSize);
+    }
+
+    void VerifyResultDoesNotDependOnWorkers()
+    {
+        const auto bodies = Cloud(5000, 9u);
+        jobs::JobSystem jobSystem;
+        physics::GravitySolver solver;
+        for (const auto method : {physics::GravityMethod::BarnesHut, physics::GravityMethod::Direct})
+        {
+            physics::GravitySettings settings;
+            settings.method = method;
+            std::vector<float> serialX, serialY, parallelX, parallelY;
+            solver.Accelerations(bodies, settings, nullptr, serialX, serialY);
+            solver.Accelerations(bodies, settings, &jobSystem, parallelX, parallelY);
+            assert(serialX == parallelX && serialY == parallelY);
+        }
+    }
+
+    ecs::EntityId AddBody(ecs::World& world, float x, float y, float mass)
+    {
+        auto e = world.CreateEntity();
+        world.AddComponent<physics::TransformComponent>(e, x, y, 0.0f);
+        auto& rb = world.AddComponent<physics::RigidBodyComponent>(e);
+        rb.mass = mass;
+        rb.invMass = mass > 0.0f ? 1.0f / mass : 0.0f;
+        return e;
+    }
+
+    void VerifySystemAcceleratesBodies()
+    {
+        ecs::World world;
+        auto gravity = std::make_unique<physics::GravitySystem>();
+        auto* system = gravity.get();
+        physics::GravitySettings settings;
+        settings.gravitationalConstant = 2.0f;
+        settings.softening = 0.0f;
+        system->SetSettings(settings);
+        world.AddSystem(std::move(gravity));
+
+        const auto light = AddBody(world, -1.0f, 0.0f, 1.0f);
+        const auto heavy = AddBody(world, 1.0f, 0.0f, 3.0f);
+        const auto wall = AddBody(world, 0.0f, 5.0f, 0.0f);
+        // A rigid body without a transform is left alone.
+        auto loose = world.CreateEntity();
+        world.AddComponent<physics::RigidBodyComponent>(loose).vx = 4.0f;
+
+        world.Update(0.5f);
+        assert(system->BodyCount() == 3);
+        const auto* a = world.GetComponent<physics::RigidBodyComponent>(light);
+        const auto* b = world.GetComponent<physics::RigidBodyComponent>(heavy);
+        // G m / r^2 = 2 * 3 / 4 on the light body, 2 * 1 / 4 on the heavy one.
+        assert(std::fabs(a->vx - 1.5f * 0.5f) < 1e-6f && a->vy == 0.0f);
+        assert(std::fabs(b->vx + 0.5f * 0.5f) < 1e-6f && b->vy == 0.0f);
+        assert(std::fabs(a->vx * 1.0f + b->vx * 3.0f) < 1e-6f);
+        const auto* w = world.GetComponent<physics::RigidBodyComponent>(wall);
+        assert(w->vx == 0.0f && w->vy == 0.0f);
+        assert(world.GetComponent<physics::RigidBodyComponent>(loose)->vx == 4.0f);
+
+        // A new body joins on the next update.
+        const auto third = AddBody(world, -1.0f, 2.0f, 1.0f);
+        world.Update(0.5f);
+        assert(system->BodyCount() == 4);
+        assert(world.GetComponent<physics::RigidBodyComponent>(third)->vy < 0.0f);
+    }
+}
+
+int main()
+{
+    VerifyBarnesHutMatchesDirectSum();
+    VerifyResultDoesNotDependOnWorkers();
+    VerifySystemAcceleratesBodies();
+    std::cout << "Physics gravity tests passed\n";
+    return 0;
+}
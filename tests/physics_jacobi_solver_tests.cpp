@@ -0,0 +1,204 @@
+/*
+ * Copyright (C) 2025 aeml
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "PhysicsTestHelpers.hpp"
+#include "physics/CollisionSystem.hpp"
+
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+    physics::CollisionResolutionSystem JacobiResolution()
+    {
+        physics::CollisionResolutionSystem resolution;
+        physics::CollisionResolutionSystem::SolverSettings settings;
+        settings.solver = physics::ContactSolver::Jacobi;
+        resolution.SetSolverSettings(settings);
+        return resolution;
+    }
+
+    // A `side` x `side` block of overlapping, sliding balls on a static
+    // floor, with one event per touching neighbour and per bottom ball.
+    std::vector<ecs::EntityId> BallBlock(ecs::World& world, int side, std::vector<physics::CollisionEvent>& events)
+    {
+        auto floor = world.CreateEntity();
+        world.AddComponent<physics::TransformComponent>(floor, 0.0f, -1.0f, 0.0f);
+        auto& floorBody = world.AddComponent<physics::RigidBodyComponent>(floor);
+        floorBody.mass = 0.0f;
+        floorBody.invMass = 0.0f;
+        world.AddComponent<physics::AABBComponent>(floor, -1.0f, -1.0f, 0.95f * static_cast<float>(side), -0.45f);
+
+        std::vector<ecs::EntityId> balls;
+        for (int row = 0; row < side; ++row)
+        {
+            for (int col = 0; col < side; ++col)
+            {
+                auto e = world.CreateEntity();
+                world.AddComponent<physics::TransformComponent>(e, 0.95f * static_cast<float>(col),
+                                                                0.95f * static_cast<float>(row), 0.0f);
+                auto& rb = world.AddComponent<physics::RigidBodyComponent>(e);
+                rb.vy = -2.0f;
+                rb.vx = col % 2 == 0 ? 0.5f : -0.5f;
+                rb.friction = 0.4f;
+                world.AddComponent<physics::CircleColliderComponent>(e, 0.5f);
+                balls.push_back(e);
+            }
+        }
+        auto add = [&](ecs::EntityId a, ecs::EntityId b)
+        {
+            physics::CollisionEvent event{};
+            event.entityA = a;
+            event.entityB = b;
+            events.push_back(event);
+        };
+        for (int row = 0; row < side; ++row)
+        {
+            for (int col = 0; col < side; ++col)
+            {
+                const auto e = balls[static_cast<std::size_t>(row * side + col)];
+                if (row == 0) add(floor, e);
+                if (col + 1 < side) add(e, balls[static_cast<std::size_t>(row * side + col + 1)]);
+                if (row + 1 < side) add(e, balls[static_cast<std::size_t>((row + 1) * side + col)]);
+            }
+        }
+        return balls;
+    }
+
+    void VerifyResultDoesNotDependOnBatching()
+    {
+        // Thousands of contacts in one island: the job system cuts the
+        // contact and body loops into several batches, the serial run into
+        // one, and the results must agree to the bit.
+        jobs::JobSystem jobSystem;
+        const auto resolution = JacobiResolution();
+        auto run = [&](jobs::JobSystem* js, ecs::World& world)
+        {
+            std::vector<physics::CollisionEvent> events;
+            auto balls = BallBlock(world, 40, events);
+            physics::ContactBuffer contacts;
+            resolution.PrepareContacts(events, world, contacts);
+            assert(contacts.Size() > 3000);
+            assert(contacts.IslandCount() == 1);
+            physics::SolverIterationStats position;
+            physics::SolverIterationStats velocity;
+            resolution.ResolvePosition(contacts, js, &position);
+            resolution.ResolveVelocity(contacts, js, &velocity);
+            // One group for all contacts.
+            assert(position.groups == 1 && velocity.groups == 1);
+            return balls;
+        };
+        ecs::World serialWorld;
+        ecs::World parallelWorld;
+        const auto serialBalls = run(nullptr, serialWorld);
+        const auto parallelBalls = run(&jobSystem, parallelWorld);
+        bool moved = false;
+        for (std::size_t i = 0; i < serialBalls.size(); ++i)
+        {
+            const auto* ts = serialWorld.GetComponent<physics::TransformComponent>(serialBalls[i]);
+            const auto* tp = parallelWorld.GetComponent<physics::TransformComponent>(parallelBalls[i]);
+            const auto* rs = serialWorld.GetComponent<physics::RigidBodyComponent>(serialBalls[i]);
+            const auto* rp = parallelWorld.GetComponent<physics::RigidBodyComponent>(parallelBalls[i]);
+            assert(ts->x == tp->x && ts->y == tp->y);
+            assert(rs->vx == rp->vx && rs->vy == rp->vy && rs->angularVelocity == rp->angularVelocity);
+            moved = moved || rs->vy != -2.0f || ts->y != 0.95f * static_cast<float>(i / 40);
+        }
+        assert(moved);
+    }
+
+    void VerifySingleContactsMatchGaussSeidel()
+    {
+        // With one contact per body there is nothing to average, so a pass
+        // of either solver applies the same impulse.
+        auto solve = [](physics::ContactSolver solver, float& vy, float& y)
+        {
+            ecs::World world;
+            auto floor = world.CreateEntity();
+            world.AddComponent<physics::TransformComponent>(floor, 0.0f, -0.5f, 0.0f);
+            auto& floorBody = world.AddComponent<physics::RigidBodyComponent>(floor);
+            floorBody.mass = 0.0f;
+            floorBody.invMass = 0.0f;
+            world.AddComponent<physics::AABBComponent>(floor, -5.0f, -1.0f, 5.0f, 0.0f);
+            auto ball = world.CreateEntity();
+            world.AddComponent<physics::TransformComponent>(ball, 0.0f, 0.4f, 0.0f);
+            auto& rb = world.AddComponent<physics::RigidBodyComponent>(ball);
+            rb.vy = -3.0f;
+            rb.restitution = 0.5f;
+            world.AddComponent<physics::CircleColliderComponent>(ball, 0.5f);
+
+            physics::CollisionEvent event{};
+            event.entityA = floor;
+            event.entityB = ball;
+            physics::CollisionResolutionSystem resolution;
+            physics::CollisionResolutionSystem::SolverSettings settings;
+            settings.solver = solver;
+            settings.positionIterations = 1;
+            settings.velocityIterations = 1;
+            resolution.SetSolverSettings(settings);
+            resolution.Resolve({event}, world);
+            vy = world.GetComponent<physics::RigidBodyComponent>(ball)->vy;
+            y = world.GetComponent<physics::TransformComponent>(ball)->y;
+        };
+        float vyGs = 0.0f, yGs = 0.0f, vyJ = 0.0f, yJ = 0.0f;
+        solve(physics::ContactSolver::GaussSeidel, vyGs, yGs);
+        solve(physics::ContactSolver::Jacobi, vyJ, yJ);
+        assert(vyGs == vyJ && yGs == yJ);
+        assert(vyJ > 0.0f);
+        assert(yJ > 0.4f);
+    }
+
+    void VerifyPileSettles()
+    {
+        // A column of balls dropped on a floor comes to rest on it, stacked,
+        // through PhysicsSystem with the Jacobi solver.
+        ecs::World world;
+        jobs::JobSystem jobSystem;
+        physics::PhysicsSettings settings;
+        settings.contactSolver = physics::ContactSolver::Jacobi;
+        physics_test::AddPhysics(world, settings, &jobSystem);
+
+        physics_test::AddBox(world, 0.0f, -0.5f, 10.0f, 0.5f, 0.0f);
+        std::vector<ecs::EntityId> balls;
+        for (int i = 0; i < 5; ++i)
+        {
+            balls.push_back(physics_test::AddBall(world, 0.0f, 0.6f + 1.1f * static_cast<float>(i), 0.5f));
+        }
+        for (int frame = 0; frame < 240; ++frame)
+        {
+            world.Update(physics_test::kDt);
+        }
+        for (std::size_t i = 0; i < balls.size(); ++i)
+        {
+            const auto* t = world.GetComponent<physics::TransformComponent>(balls[i]);
+            const auto* rb = world.GetComponent<physics::RigidBodyComponent>(balls[i]);
+            assert(std::fabs(t->x) < 1e-3f);
+            assert(std::fabs(t->y - (0.5f + static_cast<float>(i))) < 0.1f);
+            assert(std::fabs(rb->vy) < 0.1f);
+        }
+    }
+}
+
+int main()
+{
+    VerifyResultDoesNotDependOnBatching();
+    VerifySingleContactsMatchGaussSeidel();
+    VerifyPileSettles();
+    std::cout << "Physics Jacobi solver tests passed\n";
+    return 0;
+}
@@ -0,0 +1,263 @@
+/*
+ * Copyright (C) 2025 aeml
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "ecs/World.hpp"
+#include "jobs/JobSystem.hpp"
+#include "physics/Components.hpp"
+#include "physics/Systems.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    constexpr int kChains = 12;
+    constexpr int kLinks = 8;
+
+    // Hangs kChains horizontal chains from static anchors, stretched so every
+    // joint starts violated.
+    void BuildChains(ecs::World& world)
+    {
+        for (int c = 0; c < kChains; ++c)
+        {
+            const float y = static_cast<float>(c) * 3.0f;
+            auto prev = world.CreateEntity();
+            world.AddComponent<physics::TransformComponent>(prev, 0.0f, y, 0.0f);
+            auto& anchor = world.AddComponent<physics::RigidBodyComponent>(prev);
+            anchor.mass = 0.0f;
+            anchor.invMass = 0.0f;
+
+            for (int l = 1; l <= kLinks; ++l)
+            {
+                auto link = world.CreateEntity();
+                world.AddComponent<physics::TransformComponent>(link, static_cast<float>(l) * 1.3f, y - 0.1f * l, 0.0f);
+                auto& rb = world.AddComponent<physics::RigidBodyComponent>(link);
+                rb.mass = 1.0f + 0.1f * l;
+                rb.invMass = 1.0f / rb.mass;
+                world.AddComponent<physics::DistanceJointComponent>(link, physics::DistanceJointComponent{prev, link, 1.0f, l % 3 == 0 ? 1e-4f : 0.0f});
+                prev = link;
+            }
+        }
+    }
+
+    // The straightforward per-joint Gauss-Seidel sweep the row solver replaces.
+    void ReferenceResolve(ecs::World& world, float dt, int iterations)
+    {
+        const auto& joints = std::as_const(world).GetStorage<physics::DistanceJointComponent>()->GetData();
+        const float dtSafe = std::max(dt, 1e-4f);
+        for (int iter = 0; iter < iterations; ++iter)
+        {
+            for (const auto& joint : joints)
+            {
+                auto* tA = world.GetComponent<physics::TransformComponent>(joint.entityA);
+                auto* tB = world.GetComponent<physics::TransformComponent>(joint.entityB);
+                const auto* bA = world.GetComponent<physics::RigidBodyComponent>(joint.entityA);
+                const auto* bB = world.GetComponent<physics::RigidBodyComponent>(joint.entityB);
+                const float invMassSum = bA->invMass + bB->invMass;
+                if (invMassSum == 0.0f) continue;
+
+                float dx = tB->x - tA->x;
+                float dy = tB->y - tA->y;
+                float dist = std::sqrt(dx*dx + dy*dy);
+                if (dist < 0.0001f) continue;
+
+                float diff = dist - joint.targetDistance;
+                float complianceTerm = (joint.compliance > 0.0f) ? (joint.compliance / (dtSafe * dtSafe)) : 0.0f;
+                float denom = invMassSum + complianceTerm;
+                if (denom <= 0.0f) continue;
+                float correction = diff / denom;
+
+                float px = (dx / dist) * correction;
+                float py = (dy / dist) * correction;
+
+                tA->x += px * bA->invMass;
+                tA->y += py * bA->invMass;
+                tB->x -= px * bB->invMass;
+                tB->y -= py * bB->invMass;
+            }
+        }
+    }
+
+    std::vector<float> Positions(const ecs::World& world)
+    {
+        std::vector<float> out;
+        world.ForEach<physics::TransformComponent>([&](ecs::EntityId, const physics::TransformComponent& t) {
+            out.push_back(t.x);
+            out.push_back(t.y);
+        });
+        return out;
+    }
+
+    void VerifyMatchesReferenceSweep(jobs::JobSystem* jobSystem)
+    {
+        constexpr float kDt = 1.0f / 240.0f;
+        ecs::World rows;
+        ecs::World reference;
+        BuildChains(rows);
+        BuildChains(reference);
+
+        physics::ConstraintResolutionSystem solver;
+        solver.SetSolver(physics::JointSolver::Iterative);
+        solver.SetIterationCount(6);
+        for (int step = 0; step < 5; ++step)
+        {
+            solver.Resolve(rows, kDt, jobSystem);
+            ReferenceResolve(reference, kDt, 6);
+            rows.AdvanceChangeTick(); // PhysicsSystem does this once per substep
+
+        }
+
+        assert(Positions(rows) == Positions(reference));
+        assert(solver.RowCount() == static_cast<std::size_t>(kChains * kLinks));
+        assert(solver.ChainCount() == static_cast<std::size_t>(kChains));
+        assert(solver.CacheRebuilds() <= 2);
+    }
+
+    void VerifyRebuildOnJointEdit()
+    {
+        ecs::World world;
+        BuildChains(world);
+        physics::ConstraintResolutionSystem solver;
+        solver.Resolve(world, 1.0f / 60.0f);
+        world.AdvanceChangeTick();
+        solver.Resolve(world, 1.0f / 60.0f);
+        const std::size_t rebuilds = solver.CacheRebuilds();
+
+        // Re-targeting a joint is seen through its change stamp.
+        auto* joints = world.GetStorage<physics::DistanceJointComponent>();
+        world.AdvanceChangeTick();
+        joints->Get(joints->GetEntities()[0])->targetDistance = 2.0f;
+        solver.Resolve(world, 1.0f / 60.0f);
+        assert(solver.CacheRebuilds() == rebuilds + 1);
+
+        // Pinning a link splits its chain in two.
+        auto* body = world.GetComponent<physics::RigidBodyComponent>(joints->GetEntities()[3]);
+        body->invMass = 0.0f;
+        solver.Resolve(world, 1.0f / 60.0f);
+        assert(solver.ChainCount() == static_cast<std::size_t>(kChains + 1));
+        (void)rebuilds;
+    }
+
+    // Largest length error over the rigid joints.
+    float MaxStretch(const ecs::World& world)
+    {
+        float worst = 0.0f;
+        world.ForEach<physics::DistanceJointComponent>([&](ecs::EntityId, const physics::DistanceJointComponent& joint) {
+            if (joint.compliance > 0.0f) return;
+            const auto* tA = world.GetComponent<physics::TransformComponent>(joint.entityA);
+            const auto* tB = world.GetComponent<physics::TransformComponent>(joint.entityB);
+            const float dist = std::hypot(tB->x - tA->x, tB->y - tA->y);
+            worst = std::max(worst, std::fabs(dist - joint.targetDistance));
+        });
+        return worst;
+    }
+
+    void VerifyDirectSolveClosesChains()
+    {
+        constexpr float kDt = 1.0f / 240.0f;
+        ecs::World direct;
+        ecs::World iterative;
+        BuildChains(direct);
+        BuildChains(iterative);
+
+        physics::ConstraintResolutionSystem directSolver;
+        physics::ConstraintResolutionSystem iterativeSolver;
+        iterativeSolver.SetSolver(physics::JointSolver::Iterative);
+        directSolver.Resolve(direct, kDt);
+        iterativeSolver.Resolve(iterative, kDt);
+
+        assert(directSolver.DirectChainCount() == static_cast<std::size_t>(kChains));
+        // Rigid rows close in one call; Gauss-Seidel leaves them stretched.
+        assert(MaxStretch(direct) < 1e-4f);
+        assert(MaxStretch(direct) < MaxStretch(iterative));
+
+        // Parallel chain dispatch gives the same answer as the serial loop.
+        ecs::World parallel;
+        BuildChains(parallel);
+        jobs::JobSystem jobSystem;
+        physics::ConstraintResolutionSystem parallelSolver;
+        parallelSolver.Resolve(parallel, kDt, &jobSystem);
+        assert(Positions(parallel) == Positions(direct));
+    }
+
+    void VerifyDirectSolveStopsWithinTolerance()
+    {
+        constexpr float kDt = 1.0f / 240.0f;
+        ecs::World world;
+        BuildChains(world);
+        // Rigid rows only: a soft row stays stretched by design.
+        for (auto& joint : world.GetStorage<physics::DistanceJointComponent>()->GetData())
+        {
+            joint.compliance = 0.0f;
+        }
+        physics::ConstraintResolutionSystem solver;
+        solver.SetTolerance(1e-3f);
+
+        solver.Resolve(world, kDt);
+        const auto& first = solver.LastIterations();
+        assert(first.groups == static_cast<std::size_t>(kChains));
+        assert(first.maxIterations >= 1 && first.maxIterations <= 2);
+        assert(MaxStretch(world) <= 1e-3f);
+
+        // The chains are closed now: one measuring pass each, no Newton step.
+        const auto before = Positions(world);
+        solver.Resolve(world, kDt);
+        const auto& again = solver.LastIterations();
+        assert(again.maxIterations == 1);
+        assert(again.iterations == static_cast<std::size_t>(kChains));
+        assert(Positions(world) == before);
+    }
+
+    void VerifyLoopFallsBackToIterative()
+    {
+        ecs::World world;
+        BuildChains(world);
+        // Closing the first chain into a loop makes it unsuitable for the
+        // tree factorization; the other chains stay direct.
+        const auto& entities = std::as_const(world).GetStorage<physics::DistanceJointComponent>()->GetEntities();
+        const ecs::EntityId first = entities[0];
+        const ecs::EntityId third = entities[2];
+        auto closer = world.CreateEntity();
+        world.AddComponent<physics::DistanceJointComponent>(closer, physics::DistanceJointComponent{first, third, 2.0f, 0.0f});
+
+        physics::ConstraintResolutionSystem solver;
+        solver.Resolve(world, 1.0f / 240.0f);
+        assert(solver.ChainCount() == static_cast<std::size_t>(kChains));
+        assert(solver.DirectChainCount() == static_cast<std::size_t>(kChains - 1));
+        for (float v : Positions(world))
+        {
+            assert(std::isfinite(v));
+        }
+    }
+}
+
+int main()
+{
+    VerifyMatchesReferenceSweep(nullptr);
+    jobs::JobSystem jobSystem;
+    VerifyMatchesReferenceSweep(&jobSystem);
+    VerifyRebuildOnJointEdit();
+    VerifyDirectSolveClosesChains();
+    VerifyDirectSolveStopsWithinTolerance();
+    VerifyLoopFallsBackToIterative();
+    std::cout << "Physics joint row tests passed\n";
+    return 0;
+}
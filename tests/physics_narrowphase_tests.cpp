@@ -0,0 +1,217 @@
+/*
+ * Copyright (C) 2025 aeml
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "ecs/World.hpp"
+#include "physics/Components.hpp"
+#include "physics/Narrowphase.hpp"
+#include "physics/Systems.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace
+{
+    // The branching per-pair code the kernels replaced.
+    bool ReferenceCircleCircle(float ax, float ay, float ra, float bx, float by, float rb,
+                               float& nx, float& ny, float& pen)
+    {
+        const float dx = bx - ax;
+        const float dy = by - ay;
+        const float radii = std::max(ra, 0.0f) + std::max(rb, 0.0f);
+        if (radii <= 0.0f) return false;
+        const float distSq = dx * dx + dy * dy;
+        if (distSq <= 1e-6f)
+        {
+            pen = radii;
+            nx = 0.0f;
+            ny = 1.0f;
+            return true;
+        }
+        const float dist = std::sqrt(distSq);
+        if (dist >= radii) return false;
+        nx = dx / dist;
+        ny = dy / dist;
+        pen = radii - dist;
+        return pen > 0.0f;
+    }
+
+    bool ReferenceCircleAabb(float cx, float cy, float r, const physics::AABBComponent& box,
+                             float& nx, float& ny, float& pen)
+    {
+        const float radius = std::max(r, 0.0f);
+        if (radius <= 0.0f) return false;
+        const float dx = std::clamp(cx, box.minX, box.maxX) - cx;
+        const float dy = std::clamp(cy, box.minY, box.maxY) - cy;
+        const float distSq = dx * dx + dy * dy;
+        if (distSq > radius * radius + 1e-6f) return false;
+        if (distSq > 1e-6f)
+        {
+            const float dist = std::sqrt(distSq);
+            nx = dx / dist;
+            ny = dy / dist;
+            pen = radius - dist;
+            return pen > 0.0f;
+        }
+        float minDist = cx - box.minX;
+        nx = 1.0f;
+        ny = 0.0f;
+        if (box.maxX - cx < minDist) { minDist = box.maxX - cx; nx = -1.0f; ny = 0.0f; }
+        if (cy - box.minY < minDist) { minDist = cy - box.minY; nx = 0.0f; ny = 1.0f; }
+        if (box.maxY - cy < minDist) { minDist = box.maxY - cy; nx = 0.0f; ny = -1.0f; }
+        pen = radius + minDist;
+        return true;
+    }
+
+    void VerifyCircleCircleKernelMatchesReference()
+    {
+        std::mt19937 rng(7u);
+        std::uniform_real_distribution<float> pos(-2.0f, 2.0f);
+        std::uniform_real_distribution<float> rad(-0.2f, 1.2f);
+        // Sizes around the lane width exercise the partial last block.
+        for (const std::size_t count : {std::size_t{1}, std::size_t{7}, std::size_t{8}, std::size_t{9}, std::size_t{1000}})
+        {
+            physics::CircleCircleBatch pairs;
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                const float ax = pos(rng);
+                const float ay = pos(rng);
+                // Every fifth pair has coincident centres.
+                const bool same = i % 5 == 0;
+                pairs.Push(ax, ay, rad(rng), same ? ax : pos(rng), same ? ay : pos(rng), rad(rng),
+                           static_cast<std::uint32_t>(i));
+            }
+            physics::ManifoldBatch out;
+            physics::CircleCircleManifolds(pairs, out);
+            assert(out.hit.size() == count);
+            std::size_t hits = 0;
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                float nx = 0.0f, ny = 0.0f, pen = 0.0f;
+                const bool hit = ReferenceCircleCircle(pairs.ax[i], pairs.ay[i], pairs.radiusA[i], pairs.bx[i],
+                                                       pairs.by[i], pairs.radiusB[i], nx, ny, pen);
+                assert((out.hit[i] != 0) == hit);
+                if (hit)
+                {
+                    assert(out.nx[i] == nx && out.ny[i] == ny && out.penetration[i] == pen);
+                    ++hits;
+                }
+            }
+            assert(count < 100 || hits > count / 4);
+        }
+    }
+
+    void VerifyCircleAabbKernelMatchesReference()
+    {
+        std::mt19937 rng(11u);
+        std::uniform_real_distribution<float> pos(-3.0f, 3.0f);
+        std::uniform_real_distribution<float> rad(-0.2f, 1.0f);
+        const physics::AABBComponent box{-1.0f, -0.5f, 1.0f, 0.5f};
+        for (const std::size_t count : {std::size_t{3}, std::size_t{8}, std::size_t{13}, std::size_t{2000}})
+        {
+            physics::CircleAabbBatch pairs;
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                // Some centres on the box faces and corners, to hit the ties.
+                const float x = i % 7 == 0 ? box.maxX : pos(rng);
+                const float y = i % 11 == 0 ? box.minY : pos(rng);
+                pairs.Push(x, y, rad(rng), box, static_cast<std::uint32_t>(i));
+            }
+            physics::ManifoldBatch out;
+            physics::CircleAabbManifolds(pairs, out);
+            std::size_t inside = 0;
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                float nx = 0.0f, ny = 0.0f, pen = 0.0f;
+                const bool hit = ReferenceCircleAabb(pairs.cx[i], pairs.cy[i], pairs.radius[i], box, nx, ny, pen);
+                assert((out.hit[i] != 0) == hit);
+                if (hit)
+                {
+                    assert(out.nx[i] == nx && out.ny[i] == ny && out.penetration[i] == pen);
+                    inside += pen > pairs.radius[i] ? 1 : 0;
+                }
+            }
+            assert(count < 100 || inside > 0);
+        }
+    }
+
+    void VerifyPreparedContactsUseKernelManifolds()
+    {
+        // Events carry placeholder manifolds; circle pairs get theirs from
+        // the kernels, a box/box pair keeps the event's, and a circle pair
+        // that only touches in the broadphase is dropped.
+        ecs::World world;
+        auto addBody = [&](float x, float y, float invMass)
+        {
+            auto e = world.CreateEntity();
+            world.AddComponent<physics::TransformComponent>(e, x, y, 0.0f);
+            auto& rb = world.AddComponent<physics::RigidBodyComponent>(e);
+            rb.invMass = invMass;
+            return e;
+        };
+        const auto floor = addBody(0.0f, 0.0f, 0.0f);
+        world.AddComponent<physics::AABBComponent>(floor, -5.0f, -1.0f, 5.0f, 0.0f);
+        const auto ball = addBody(0.0f, 0.3f, 1.0f);
+        world.AddComponent<physics::CircleColliderComponent>(ball, 0.5f);
+        const auto other = addBody(0.8f, 0.3f, 1.0f);
+        world.AddComponent<physics::CircleColliderComponent>(other, 0.5f);
+        const auto far = addBody(0.0f, 1.3f, 1.0f);
+        world.AddComponent<physics::CircleColliderComponent>(far, 0.3f);
+        const auto crate = addBody(3.0f, 0.4f, 1.0f);
+        world.AddComponent<physics::AABBComponent>(crate, 2.5f, -0.1f, 3.5f, 0.9f);
+
+        auto event = [](ecs::EntityId a, ecs::EntityId b)
+        {
+            physics::CollisionEvent e{};
+            e.entityA = a;
+            e.entityB = b;
+            e.normalX = 0.0f;
+            e.normalY = 1.0f;
+            e.penetration = 0.1f;
+            return e;
+        };
+        const std::vector<physics::CollisionEvent> events = {
+            event(floor, ball), event(ball, other), event(ball, far), event(floor, crate)};
+
+        physics::CollisionResolutionSystem resolution;
+        physics::ContactBuffer contacts;
+        resolution.PrepareContacts(events, world, contacts);
+        assert(contacts.Size() == 3);
+        assert(contacts.IslandCount() == 2);
+        // Island 0: floor/ball, with the normal flipped to point from the
+        // floor (the first body) to the ball, then ball/other.
+        assert(contacts.nx[0] == 0.0f && contacts.ny[0] == 1.0f);
+        assert(std::fabs(contacts.pen[0] - 0.2f) < 1e-6f);
+        assert(contacts.nx[1] == 1.0f && contacts.ny[1] == 0.0f);
+        assert(std::fabs(contacts.pen[1] - 0.2f) < 1e-6f);
+        // Island 1: the crate keeps the event manifold.
+        assert(contacts.pen[2] == 0.1f);
+    }
+}
+
+int main()
+{
+    VerifyCircleCircleKernelMatchesReference();
+    VerifyCircleAabbKernelMatchesReference();
+    VerifyPreparedContactsUseKernelManifolds();
+    std::cout << "Physics narrowphase tests passed\n";
+    return 0;
+}
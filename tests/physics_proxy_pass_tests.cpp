@@ -0,0 +1,151 @@
+/*
+ * Copyright (C) 2025 aeml
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "PhysicsTestHelpers.hpp"
+
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+    using physics_test::AddBall;
+    using physics_test::AddBox;
+    using physics_test::kDt;
+
+    physics::PhysicsSystem* AddPhysics(ecs::World& world, jobs::JobSystem* jobSystem = nullptr)
+    {
+        // One substep, so the reported events are the ones of the whole frame.
+        physics::PhysicsSettings settings;
+        settings.substeps = 1;
+        return physics_test::AddPhysics(world, settings, jobSystem);
+    }
+
+    void VerifyBodiesWithAndWithoutProxiesIntegrate()
+    {
+        ecs::World world;
+        AddPhysics(world);
+        const auto box = AddBox(world, 0.0f, 10.0f, 0.5f, 0.25f, 1.0f);
+        const auto ball = AddBall(world, 5.0f, 10.0f, 0.5f);
+        auto loose = world.CreateEntity();
+        world.AddComponent<physics::TransformComponent>(loose, -5.0f, 10.0f, 0.0f);
+        world.AddComponent<physics::RigidBodyComponent>(loose);
+
+        for (int frame = 0; frame < 10; ++frame)
+        {
+            world.Update(kDt);
+        }
+
+        const ecs::World& view = world;
+        const auto* boxTf = view.GetComponent<physics::TransformComponent>(box);
+        const auto* aabb = view.GetComponent<physics::AABBComponent>(box);
+        assert(boxTf->y < 10.0f);
+        assert(std::fabs((aabb->minY + aabb->maxY) * 0.5f - boxTf->y) < 1e-5f);
+        assert(std::fabs((aabb->maxY - aabb->minY) - 0.5f) < 1e-5f);
+        // All three fall the same way: nothing touches anything.
+        const float ballY = view.GetComponent<physics::TransformComponent>(ball)->y;
+        const float looseY = view.GetComponent<physics::TransformComponent>(loose)->y;
+        assert(ballY == boxTf->y);
+        assert(looseY == boxTf->y);
+    }
+
+    void VerifyTableFollowsStructureChanges()
+    {
+        ecs::World world;
+        auto* physicsPtr = AddPhysics(world);
+        AddBox(world, 0.0f, -10.0f, 10.0f, 10.0f, 0.0f);
+        world.Update(kDt);
+        assert(physicsPtr->GetCollisionEvents().empty());
+
+        // A body added later is picked up on the next step...
+        const auto ball = AddBall(world, 0.0f, 0.48f, 0.5f);
+        world.Update(kDt);
+        assert(physicsPtr->GetCollisionEvents().size() == 1);
+
+        // ...and a destroyed one leaves no stale proxy behind.
+        world.DestroyEntity(ball);
+        world.Update(kDt);
+        assert(physicsPtr->GetCollisionEvents().empty());
+    }
+
+    void VerifyValueChangesSeenWithoutRebuild()
+    {
+        ecs::World world;
+        auto* physicsPtr = AddPhysics(world);
+        const auto wall = AddBox(world, 100.0f, 0.0f, 1.0f, 1.0f, 0.0f);
+        const auto ball = AddBall(world, 0.0f, 0.0f, 0.5f);
+        world.AddComponent<physics::CollisionFilterComponent>(ball, 2u, ~0u);
+        world.Update(kDt);
+        assert(physicsPtr->GetCollisionEvents().empty());
+
+        // Scenery moved by hand is seen at its new place.
+        auto* box = world.GetComponent<physics::AABBComponent>(wall);
+        const float y = world.GetComponent<physics::TransformComponent>(ball)->y;
+        *box = {-1.0f, y - 2.48f, 1.0f, y - 0.48f};
+        world.Update(kDt);
+        assert(physicsPtr->GetCollisionEvents().size() == 1);
+
+        // So is a layer change.
+        world.GetComponent<physics::CollisionFilterComponent>(ball)->mask = ~1u;
+        world.Update(kDt);
+        assert(physicsPtr->GetCollisionEvents().empty());
+    }
+
+    std::vector<float> RunPile(jobs::JobSystem* jobSystem)
+    {
+        ecs::World world;
+        AddPhysics(world, jobSystem);
+        AddBox(world, 0.0f, -10.0f, 40.0f, 10.0f, 0.0f);
+        std::vector<ecs::EntityId> balls;
+        for (int i = 0; i < 600; ++i)
+        {
+            const float x = -20.0f + static_cast<float>(i % 40);
+            const float y = 1.0f + 1.1f * static_cast<float>(i / 40);
+            balls.push_back(AddBall(world, x + 0.05f * static_cast<float>(i % 3), y, 0.5f));
+        }
+        for (int frame = 0; frame < 30; ++frame)
+        {
+            world.Update(kDt);
+        }
+        std::vector<float> state;
+        const ecs::World& view = world;
+        for (const auto e : balls)
+        {
+            const auto* tf = view.GetComponent<physics::TransformComponent>(e);
+            state.push_back(tf->x);
+            state.push_back(tf->y);
+        }
+        return state;
+    }
+
+    void VerifyParallelPassMatchesSerial()
+    {
+        jobs::JobSystem jobSystem;
+        assert(RunPile(nullptr) == RunPile(&jobSystem));
+    }
+}
+
+int main()
+{
+    VerifyBodiesWithAndWithoutProxiesIntegrate();
+    VerifyTableFollowsStructureChanges();
+    VerifyValueChangesSeenWithoutRebuild();
+    VerifyParallelPassMatchesSerial();
+    std::cout << "Physics proxy pass tests passed\n";
+    return 0;
+}
@@ -0,0 +1,149 @@
+/*
+ * Copyright (C) 2025 aeml
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "PhysicsTestHelpers.hpp"
+
+#include <cassert>
+#include <iostream>
+
+namespace
+{
+    using physics_test::AddBox;
+    using physics_test::kDt;
+
+    physics::PhysicsSystem* AddPhysics(ecs::World& world)
+    {
+        physics::PhysicsSettings settings;
+        settings.substeps = 8;
+        settings.enableSleeping = true;
+        settings.sleepTime = 0.25f;
+        return physics_test::AddPhysics(world, settings);
+    }
+
+    bool Asleep(const ecs::World& world, ecs::EntityId e)
+    {
+        return world.GetComponent<physics::RigidBodyComponent>(e)->asleep;
+    }
+
+    void VerifyRestingBoxSleepsAndIsSkipped()
+    {
+        ecs::World world;
+        auto* physicsPtr = AddPhysics(world);
+        AddBox(world, 0.0f, -1.0f, 1.0f, 1.0f, 0.0f); // floor, top at y = 0
+        auto box = AddBox(world, 0.0f, 0.5f, 0.5f, 0.5f, 1.0f);
+
+        std::size_t slept = 0;
+        for (int frame = 0; frame < 240 && !Asleep(world, box); ++frame)
+        {
+            world.Update(kDt);
+            slept += physicsPtr->StepStats().bodiesSlept;
+        }
+        assert(Asleep(world, box));
+        assert(slept == 1);
+        assert(physicsPtr->StepStats().sleepingBodies == 1);
+
+        // Asleep, the box is neither moved nor stamped as changed.
+        const ecs::World& view = world;
+        const auto before = *view.GetComponent<physics::TransformComponent>(box);
+        const std::uint32_t since = world.ChangeTick();
+        world.Update(kDt);
+        const auto* after = view.GetComponent<physics::TransformComponent>(box);
+        assert(after->x == before.x && after->y == before.y);
+        std::size_t moved = 0;
+        view.ForEachChanged<physics::TransformComponent>(since, [&](ecs::EntityId, const physics::TransformComponent&) { ++moved; });
+        assert(moved == 0);
+        assert(physicsPtr->GetCollisionEvents().empty());
+
+        // An impulse wakes it.
+        world.GetComponent<physics::RigidBodyComponent>(box)->vx = 2.0f;
+        world.Update(kDt);
+        assert(!Asleep(world, box));
+        assert(physicsPtr->StepStats().bodiesWoken == 1);
+    }
+
+    void VerifyContactWakesSleepingStack()
+    {
+        ecs::World world;
+        auto* physicsPtr = AddPhysics(world);
+        AddBox(world, 0.0f, -1.0f, 1.0f, 1.0f, 0.0f);
+        auto lower = AddBox(world, 0.0f, 0.5f, 0.5f, 0.5f, 1.0f);
+        auto upper = AddBox(world, 0.0f, 1.5f, 0.5f, 0.5f, 1.0f);
+        for (int frame = 0; frame < 240 && !(Asleep(world, lower) && Asleep(world, upper)); ++frame)
+        {
+            world.Update(kDt);
+        }
+        assert(Asleep(world, lower) && Asleep(world, upper));
+
+        // Drop a box onto the stack; the contact wakes it layer by layer.
+        auto dropped = AddBox(world, 0.0f, 3.0f, 0.5f, 0.5f, 1.0f);
+        world.GetComponent<physics::RigidBodyComponent>(dropped)->vy = -5.0f;
+        std::size_t woken = 0;
+        for (int frame = 0; frame < 30; ++frame)
+        {
+            world.Update(kDt);
+            woken += physicsPtr->StepStats().bodiesWoken;
+            if (woken >= 2) break;
+        }
+        assert(woken >= 2);
+        assert(!Asleep(world, upper));
+        assert(!Asleep(world, lower));
+    }
+
+    void VerifyJointedIslandWakesTogether()
+    {
+        ecs::World world;
+        AddPhysics(world);
+        auto anchor = world.CreateEntity();
+        world.AddComponent<physics::TransformComponent>(anchor, 0.0f, 0.0f, 0.0f);
+        world.AddComponent<physics::RigidBodyComponent>(anchor).invMass = 0.0f;
+        world.GetComponent<physics::RigidBodyComponent>(anchor)->mass = 0.0f;
+        ecs::EntityId prev = anchor;
+        ecs::EntityId links[3]{};
+        for (int i = 0; i < 3; ++i)
+        {
+            auto link = world.CreateEntity();
+            const float y = -1.0f * static_cast<float>(i + 1);
+            world.AddComponent<physics::TransformComponent>(link, 0.0f, y, 0.0f);
+            auto& rb = world.AddComponent<physics::RigidBodyComponent>(link);
+            rb.lastY = y;
+            world.AddComponent<physics::DistanceJointComponent>(link, physics::DistanceJointComponent{prev, link, 1.0f, 0.0f});
+            links[i] = link;
+            prev = link;
+        }
+
+        for (int frame = 0; frame < 240 && !Asleep(world, links[2]); ++frame)
+        {
+            world.Update(kDt);
+        }
+        assert(Asleep(world, links[0]) && Asleep(world, links[1]) && Asleep(world, links[2]));
+
+        // Pushing the bottom link wakes the whole chain through its joints.
+        world.GetComponent<physics::RigidBodyComponent>(links[2])->vx = 3.0f;
+        world.Update(kDt);
+        assert(!Asleep(world, links[0]) && !Asleep(world, links[1]) && !Asleep(world, links[2]));
+    }
+}
+
+int main()
+{
+    VerifyRestingBoxSleepsAndIsSkipped();
+    VerifyContactWakesSleepingStack();
+    VerifyJointedIslandWakesTogether();
+    std::cout << "Physics sleep tests passed\n";
+    return 0;
+}
@@ -0,0 +1,282 @@
+/*
+ * Copyright (C) 2025 aeml
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "PhysicsTestHelpers.hpp"
+#include "physics/SpatialQuery.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace
+{
+    // Boxes then circles (as bounds), of mixed sizes, with three wide walls
+    // that go to the index's large list, and entity ids that are not the
+    // proxy indices.
+    struct Scene
+    {
+        std::vector<physics::AABBComponent>            bounds;
+        std::vector<std::uint32_t>                     entities;
+        std::vector<physics::CollisionFilterComponent> layers;
+        std::size_t                                    boxes{0};
+    };
+
+    Scene RandomScene(std::size_t count, unsigned seed)
+    {
+        std::mt19937 rng(seed);
+        std::uniform_real_distribution<float> pos(-50.0f, 50.0f);
+        std::uniform_real_distribution<float> size(0.1f, 2.0f);
+        Scene scene;
+        auto add = [&](const physics::AABBComponent& box)
+        {
+            scene.bounds.push_back(box);
+            scene.entities.push_back(static_cast<std::uint32_t>(1000 + 7 * scene.entities.size()));
+            physics::CollisionFilterComponent filter;
+            filter.layer = scene.entities.size() % 3 == 0 ? 2u : 1u;
+            scene.layers.push_back(filter);
+        };
+        add({-60.0f, -61.0f, 60.0f, -60.0f});
+        add({-61.0f, -60.0f, -60.0f, 60.0f});
+        add({-5.0f, -40.0f, 5.0f, 40.0f});
+        for (std::size_t i = 3; i < count / 2; ++i)
+        {
+            const float x = pos(rng);
+            const float y = pos(rng);
+            add({x, y, x + size(rng), y + size(rng)});
+        }
+        scene.boxes = scene.bounds.size();
+        for (std::size_t i = count / 2; i < count; ++i)
+        {
+            const float x = pos(rng);
+            const float y = pos(rng);
+            const float r = 0.5f * size(rng);
+            add({x - r, y - r, x + r, y + r});
+        }
+        return scene;
+    }
+
+    // The exact tests again, written out plainly, for a full scan.
+    struct Reference
+    {
+        const Scene& scene;
+
+        bool IsBox(std::size_t i) const { return i < scene.boxes; }
+
+        bool Overlaps(std::size_t i, const physics::AABBComponent& q) const
+        {
+            const auto& b = scene.bounds[i];
+            if (b.maxX < q.minX || q.maxX < b.minX || b.maxY < q.minY || q.maxY < b.minY) return false;
+            if (IsBox(i)) return true;
+            const float x = 0.5f * (b.minX + b.maxX);
+            const float y = 0.5f * (b.minY + b.maxY);
+            const float r = 0.5f * (b.maxX - b.minX);
+            const float dx = std::clamp(x, q.minX, q.maxX) - x;
+            const float dy = std::clamp(y, q.minY, q.maxY) - y;
+            return dx * dx + dy * dy <= r * r;
+        }
+
+        bool Near(std::size_t i, float x, float y, float radius) const
+        {
+            const auto& b = scene.bounds[i];
+            if (IsBox(i))
+            {
+                const float dx = std::clamp(x, b.minX, b.maxX) - x;
+                const float dy = std::clamp(y, b.minY, b.maxY) - y;
+                return dx * dx + dy * dy <= radius * radius;
+            }
+            const float dx = 0.5f * (b.minX + b.maxX) - x;
+            const float dy = 0.5f * (b.minY + b.maxY) - y;
+            const float reach = radius + 0.5f * (b.maxX - b.minX);
+            return dx * dx + dy * dy <= reach * reach;
+        }
+
+        template <typename Test>
+        std::vector<std::uint32_t> Scan(std::uint32_t mask, Test&& test) const
+        {
+            std::vector<std::uint32_t> out;
+            for (std::size_t i = 0; i < scene.bounds.size(); ++i)
+            {
+                if ((scene.layers[i].layer & mask) && test(i)) out.push_back(scene.entities[i]);
+            }
+            std::sort(out.begin(), out.end());
+            return out;
+        }
+    };
+
+    void VerifyQueriesMatchFullScan()
+    {
+        const Scene scene = RandomScene(4000, 3u);
+        physics::SpatialQueryIndex index;
+        index.Build(scene.bounds, scene.entities, scene.layers, scene.boxes);
+        assert(index.Size() == scene.bounds.size());
+        const Reference reference{scene};
+
+        std::mt19937 rng(9u);
+        std::uniform_real_distribution<float> pos(-65.0f, 65.0f);
+        std::uniform_real_distribution<float> extent(0.0f, 8.0f);
+        std::vector<std::uint32_t> found;
+        std::vector<physics::RayHit> hits;
+        std::size_t total = 0;
+        for (int q = 0; q < 500; ++q)
+        {
+            const std::uint32_t mask = q % 4 == 0 ? 2u : 0xFFFFFFFFu;
+            const float x = pos(rng);
+            const float y = pos(rng);
+            const physics::AABBComponent box{x, y, x + extent(rng), y + extent(rng)};
+            index.QueryAabb(box, found, mask);
+            assert(found == reference.Scan(mask, [&](std::size_t i) { return reference.Overlaps(i, box); }));
+            total += found.size();
+
+            const float radius = extent(rng);
+            index.QueryRadius(x, y, radius, found, mask);
+            assert(found == reference.Scan(mask, [&](std::size_t i) { return reference.Near(i, x, y, radius); }));
+            total += found.size();
+
+            // Every crossed collider, and the first one, along a segment of
+            // any length (the longest fall back to a scan).
+            const float x1 = q % 50 == 0 ? x + 5000.0f : pos(rng);
+            const float y1 = pos(rng);
+            index.CastSegment(x, y, x1, y1, hits, mask);
+            std::vector<std::uint32_t> crossed;
+            for (const auto& hit : hits)
+            {
+                assert(hit.fraction >= 0.0f && hit.fraction <= 1.0f);
+                crossed.push_back(hit.entity);
+            }
+            assert(std::is_sorted(hits.begin(), hits.end(), [](const auto& a, const auto& b)
+                                  { return a.fraction < b.fraction; }));
+            // A segment crosses every collider whose shape overlaps many
+            // points of it; checked here through the collider's bounds.
+            const auto expected = reference.Scan(mask, [&](std::size_t i)
+            {
+                for (int s = 0; s <= 200; ++s)
+                {
+                    const float t = static_cast<float>(s) / 200.0f;
+                    const float px = x + t * (x1 - x);
+                    const float py = y + t * (y1 - y);
+                    if (reference.Near(i, px, py, 0.0f)) return true;
+                }
+                return false;
+            });
+            std::sort(crossed.begin(), crossed.end());
+            assert(std::includes(crossed.begin(), crossed.end(), expected.begin(), expected.end()));
+            total += crossed.size();
+
+            physics::Ray ray{x, y, x1 - x, y1 - y, std::hypot(x1 - x, y1 - y)};
+            physics::RayHit first;
+            const bool any = index.Raycast(ray, first, mask);
+            assert(any == !hits.empty());
+            if (any)
+            {
+                assert(first.entity == hits.front().entity && std::fabs(first.fraction - hits.front().fraction) < 1e-5f);
+            }
+        }
+        assert(total > 1000);
+    }
+
+    void VerifyBatchedQueriesMatchSingleOnes()
+    {
+        const Scene scene = RandomScene(2000, 4u);
+        physics::SpatialQueryIndex index;
+        index.Build(scene.bounds, scene.entities, {}, scene.boxes);
+
+        std::mt19937 rng(5u);
+        std::uniform_real_distribution<float> pos(-55.0f, 55.0f);
+        std::vector<physics::AABBComponent> boxes;
+        std::vector<physics::Ray> rays;
+        for (int q = 0; q < 300; ++q)
+        {
+            const float x = pos(rng);
+            const float y = pos(rng);
+            boxes.push_back({x, y, x + 3.0f, y + 3.0f});
+            rays.push_back({x, y, pos(rng), pos(rng), 20.0f});
+        }
+        jobs::JobSystem jobSystem;
+        for (jobs::JobSystem* js : {static_cast<jobs::JobSystem*>(nullptr), &jobSystem})
+        {
+            std::vector<std::uint32_t> offsets, out, single;
+            index.QueryAabbs(boxes, offsets, out, js);
+            assert(offsets.size() == boxes.size() + 1 && offsets.back() == out.size());
+            std::vector<physics::RayHit> hits;
+            index.Raycasts(rays, hits, js);
+            for (std::size_t q = 0; q < boxes.size(); ++q)
+            {
+                index.QueryAabb(boxes[q], single);
+                assert(std::equal(single.begin(), single.end(), out.begin() + offsets[q], out.begin() + offsets[q + 1])
+                       && single.size() == offsets[q + 1] - offsets[q]);
+                physics::RayHit hit;
+                if (index.Raycast(rays[q], hit))
+                {
+                    assert(hits[q].entity == hit.entity && hits[q].fraction == hit.fraction);
+                }
+                else
+                {
+                    assert(hits[q].entity == 0xFFFFFFFFu);
+                }
+            }
+        }
+    }
+
+    void VerifyPhysicsSystemAnswersQueries()
+    {
+        // A floor, a resting ball and a ball on layer 2, queried through
+        // PhysicsSystem after a step.
+        ecs::World world;
+        auto floor = physics_test::AddBox(world, 0.0f, -0.5f, 10.0f, 0.5f, 0.0f);
+        auto ball = physics_test::AddBall(world, 0.0f, 0.5f, 0.5f);
+        auto ghost = physics_test::AddBall(world, 4.0f, 0.5f, 0.5f);
+        world.AddComponent<physics::CollisionFilterComponent>(ghost, physics::CollisionFilterComponent{2u, 2u});
+
+        auto* physicsSystem = physics_test::AddPhysics(world);
+        assert(physicsSystem->Queries().Size() == 0);
+        world.Update(physics_test::kDt);
+
+        const auto& queries = physicsSystem->Queries();
+        assert(queries.Size() == 3);
+        std::vector<std::uint32_t> found;
+        queries.QueryRadius(0.0f, 2.0f, 1.2f, found);
+        assert(found.size() == 1 && found[0] == ball);
+        queries.QueryAabb({-20.0f, -20.0f, 20.0f, 20.0f}, found);
+        assert(found.size() == 3);
+        queries.QueryAabb({-20.0f, -20.0f, 20.0f, 20.0f}, found, 2u);
+        assert(found.size() == 1 && found[0] == ghost);
+
+        // Straight down onto the ball's top, then past it onto the floor.
+        physics::RayHit hit;
+        assert(queries.Raycast({0.0f, 5.0f, 0.0f, -1.0f, 10.0f}, hit));
+        assert(hit.entity == ball && std::fabs(hit.y - 1.0f) < 0.05f && hit.normalY > 0.99f);
+        assert(queries.Raycast({2.0f, 5.0f, 0.0f, -1.0f, 10.0f}, hit, 1u));
+        assert(hit.entity == floor && hit.y == 0.0f && hit.normalY == 1.0f);
+        assert(!queries.Raycast({2.0f, 5.0f, 0.0f, -1.0f, 4.0f}, hit));
+        std::vector<physics::RayHit> hits;
+        queries.CastSegment(-8.0f, 0.5f, 8.0f, 0.5f, hits);
+        assert(hits.size() == 2 && hits[0].entity == ball && hits[1].entity == ghost);
+    }
+}
+
+int main()
+{
+    VerifyQueriesMatchFullScan();
+    VerifyBatchedQueriesMatchSingleOnes();
+    VerifyPhysicsSystemAnswersQueries();
+    std::cout << "Physics spatial query tests passed\n";
+    return 0;
+}
@@ -0,0 +1,162 @@
+/*
+ * Copyright (C) 2025 aeml
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "PhysicsTestHelpers.hpp"
+#include "physics/SpatialSort.hpp"
+#include "simlab/WorldHasher.hpp"
+
+#include <cassert>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+    void VerifyReorderKeepsEntityMapping()
+    {
+        ecs::ComponentStorage<physics::TransformComponent> storage;
+        for (ecs::EntityId id = 1; id <= 4; ++id)
+        {
+            storage.Add(id, physics::TransformComponent{static_cast<float>(id), 0.0f, 0.0f});
+        }
+
+        storage.Reorder({3, 1, 0, 2});
+        assert(storage.GetEntities()[0] == 4);
+        assert(storage.GetEntities()[3] == 3);
+        assert(storage.IndexOf(4) == 0);
+        assert(storage.IndexOf(1) == 2);
+        for (ecs::EntityId id = 1; id <= 4; ++id)
+        {
+            assert(storage.Get(id)->x == static_cast<float>(id));
+        }
+        assert(storage.IndexOf(99) == storage.npos);
+
+        ecs::ComponentStorage<physics::CircleColliderComponent> circles;
+        for (ecs::EntityId id = 1; id <= 4; ++id)
+        {
+            circles.Add(id, physics::CircleColliderComponent{});
+        }
+        circles.Remove(2);
+        circles.ShrinkToFit();
+        assert(circles.GetData().capacity() == circles.Size());
+    }
+
+    void VerifyMortonCodeInterleavesAxes()
+    {
+        assert(physics::MortonCode(0, 0) == 0u);
+        assert(physics::MortonCode(1, 0) == 1u);
+        assert(physics::MortonCode(0, 1) == 2u);
+        assert(physics::MortonCode(3, 3) == 15u);
+        assert(physics::MortonCode(0xFFFF, 0xFFFF) == 0xFFFFFFFFu);
+    }
+
+    // Spawns particles on a grid in a scrambled creation order so that spatial
+    // neighbours are far apart in the dense arrays.
+    void SeedScrambledGrid(ecs::World& world, std::vector<physics::CollisionEvent>& neighbours)
+    {
+        constexpr int kSide = 16;
+        std::vector<ecs::EntityId> ids(kSide * kSide);
+        std::uint32_t seed = 7;
+        std::vector<int> cells(kSide * kSide);
+        for (int i = 0; i < kSide * kSide; ++i) cells[i] = i;
+        for (int i = kSide * kSide - 1; i > 0; --i)
+        {
+            seed = seed * 1664525u + 1013904223u;
+            std::swap(cells[i], cells[seed % static_cast<std::uint32_t>(i + 1)]);
+        }
+
+        for (int cell : cells)
+        {
+            const float x = static_cast<float>(cell % kSide);
+            const float y = static_cast<float>(cell / kSide);
+            auto e = world.CreateEntity();
+            ids[cell] = e;
+            world.AddComponent<physics::TransformComponent>(e, x, y, 0.0f);
+            world.AddComponent<physics::RigidBodyComponent>(e);
+            world.AddComponent<physics::CircleColliderComponent>(e, 0.5f);
+        }
+
+        for (int y = 0; y < kSide; ++y)
+        {
+            for (int x = 0; x + 1 < kSide; ++x)
+            {
+                neighbours.push_back({ids[y * kSide + x], ids[y * kSide + x + 1]});
+            }
+        }
+    }
+
+    void VerifySortImprovesContactLocality()
+    {
+        ecs::World world;
+        std::vector<physics::CollisionEvent> neighbours;
+        SeedScrambledGrid(world, neighbours);
+
+        const auto stats = physics::SortStoragesByMortonOrder(world, neighbours);
+        assert(stats.passes == 1);
+        assert(stats.bodyCount == 256);
+        assert(stats.contactStrideAfter < stats.contactStrideBefore * 0.25);
+        assert(stats.contactStrideAfter == physics::MeanContactStride(world, neighbours));
+
+        // All physics storages share one order after the pass.
+        const auto& tfEntities = world.GetStorage<physics::TransformComponent>()->GetEntities();
+        const auto& rbEntities = world.GetStorage<physics::RigidBodyComponent>()->GetEntities();
+        const auto& circleEntities = world.GetStorage<physics::CircleColliderComponent>()->GetEntities();
+        assert(tfEntities == rbEntities);
+        assert(tfEntities == circleEntities);
+
+        // A second pass over an already sorted world is a no-op.
+        simlab::WorldHasher hasher;
+        const auto before = hasher.HashWorld(world);
+        physics::SortStoragesByMortonOrder(world, neighbours);
+        assert(hasher.HashWorld(world) == before);
+    }
+
+    std::uint64_t RunSortedSimulation()
+    {
+        ecs::World world;
+        physics::PhysicsSettings settings;
+        settings.substeps = 2;
+        settings.spatialSortInterval = 3;
+        auto* physicsPtr = physics_test::AddPhysics(world, settings);
+
+        std::vector<physics::CollisionEvent> unused;
+        SeedScrambledGrid(world, unused);
+        world.ForEach<physics::RigidBodyComponent>([](ecs::EntityId, physics::RigidBodyComponent& rb) {
+            rb.restitution = 0.2f;
+        });
+
+        for (int i = 0; i < 9; ++i)
+        {
+            world.Update(physics_test::kDt);
+        }
+        assert(physicsPtr->LastSpatialSort().passes == 3);
+        (void)physicsPtr;
+
+        simlab::WorldHasher hasher;
+        return hasher.HashWorld(world);
+    }
+}
+
+int main()
+{
+    VerifyReorderKeepsEntityMapping();
+    VerifyMortonCodeInterleavesAxes();
+    VerifySortImprovesContactLocality();
+    assert(RunSortedSimulation() == RunSortedSimulation());
+    std::cout << "Physics spatial sort tests passed\n";
+    return 0;
+}
@@ -0,0 +1,267 @@
+/*
+ * Copyright (C) 2025 aeml
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "PhysicsTestHelpers.hpp"
+#include "physics/CollisionSystem.hpp"
+#include "physics/SpatialTiles.hpp"
+#include "simlab/WorldHasher.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    using physics_test::AddBall;
+    using physics_test::AddBox;
+    using physics_test::kDt;
+
+    bool SameEvent(const physics::CollisionEvent& a, const physics::CollisionEvent& b)
+    {
+        return a.entityA == b.entityA && a.entityB == b.entityB && a.normalX == b.normalX
+            && a.normalY == b.normalY && a.penetration == b.penetration && a.bodyA == b.bodyA && a.bodyB == b.bodyB;
+    }
+
+    void VerifyTilesFindTheDetectPairs()
+    {
+        // Random boxes of mixed sizes and motions, a wide static floor, and
+        // a lone box off to the side stretching the grid.
+        std::mt19937 rng(5u);
+        std::uniform_real_distribution<float> pos(-20.0f, 20.0f);
+        std::uniform_real_distribution<float> size(0.1f, 2.5f);
+        std::uniform_int_distribution<int> kind(0, 3);
+        std::vector<physics::AABBComponent> bounds;
+        std::vector<physics::ProxyMotion> motion;
+        std::vector<std::uint32_t> ids;
+        std::vector<std::uint32_t> bodies;
+        for (std::uint32_t i = 0; i < 1500; ++i)
+        {
+            const float x = pos(rng);
+            const float y = pos(rng);
+            const float h = size(rng);
+            bounds.push_back({x - h, y - h, x + h, y + h});
+            const int k = kind(rng);
+            motion.push_back(k == 0 ? physics::ProxyMotion::Static
+                             : k == 1 ? physics::ProxyMotion::Asleep : physics::ProxyMotion::Awake);
+            ids.push_back(1000 + i);
+            bodies.push_back(i);
+        }
+        bounds.push_back({-30.0f, -25.0f, 30.0f, -19.0f});
+        motion.push_back(physics::ProxyMotion::Static);
+        ids.push_back(9000);
+        bodies.push_back(1500);
+        bounds.push_back({40.0f, 40.0f, 41.0f, 41.0f});
+        motion.push_back(physics::ProxyMotion::Awake);
+        ids.push_back(9001);
+        bodies.push_back(1501);
+
+        physics::CollisionSystem collision;
+        std::vector<physics::CollisionEvent> expected;
+        collision.Detect(bounds, ids, expected, nullptr, &motion, nullptr, &bodies);
+        assert(expected.size() > 500);
+
+        physics::ProxyFilter filter;
+        filter.motion = &motion;
+        jobs::JobSystem jobSystem;
+        for (const auto& grid : {std::pair{1, 1}, std::pair{3, 2}, std::pair{8, 8}, std::pair{16, 1}})
+        {
+            for (jobs::JobSystem* js : {static_cast<jobs::JobSystem*>(nullptr), &jobSystem})
+            {
+                physics::TileDecomposition tiles;
+                tiles.Build(bounds, motion, grid.first, grid.second);
+                tiles.Detect(ids, filter, bodies, js);
+                assert(tiles.TileCount() == static_cast<std::size_t>(grid.first * grid.second));
+
+                // Each pair exactly once, internal events only naming the
+                // tile's own moving bodies.
+                std::vector<physics::CollisionEvent> found;
+                const auto& owners = tiles.Owners();
+                for (std::size_t t = 0; t < tiles.TileCount(); ++t)
+                {
+                    for (const auto& e : tiles.TileEvents(t))
+                    {
+                        const std::uint32_t oa = owners[e.bodyA];
+                        const std::uint32_t ob = owners[e.bodyB];
+                        assert(oa == t || (oa == physics::TileDecomposition::kNoTile && ob == t));
+                        assert(ob == t || ob == physics::TileDecomposition::kNoTile);
+                        found.push_back(e);
+                    }
+                }
+                for (const auto& e : tiles.BoundaryEvents())
+                {
+                    assert(owners[e.bodyA] != owners[e.bodyB]);
+                    found.push_back(e);
+                }
+                assert(grid.first * grid.second == 1 ? tiles.BoundaryEvents().empty() : !tiles.BoundaryEvents().empty());
+
+                auto byPair = [](const physics::CollisionEvent& a, const physics::CollisionEvent& b)
+                {
+                    return std::tie(a.bodyA, a.bodyB) < std::tie(b.bodyA, b.bodyB);
+                };
+                std::sort(found.begin(), found.end(), byPair);
+                assert(found.size() == expected.size());
+                for (std::size_t i = 0; i < found.size(); ++i)
+                {
+                    assert(SameEvent(found[i], expected[i]));
+                }
+            }
+        }
+    }
+
+    // A wall of crates and balls, staggered row by row, resting on a floor.
+    std::vector<ecs::EntityId> BuildWall(ecs::World& world, physics::PhysicsExecution execution,
+                                         jobs::JobSystem* jobSystem, float positionTolerance = 0.0f)
+    {
+        physics::PhysicsSettings settings;
+        settings.substeps = 8;
+        settings.execution = execution;
+        settings.tileColumns = 3;
+        settings.tileRows = 3;
+        settings.positionTolerance = positionTolerance;
+        physics_test::AddPhysics(world, settings, jobSystem);
+        AddBox(world, 0.0f, -1.0f, 40.0f, 1.0f, 0.0f);
+
+        std::vector<ecs::EntityId> bodies;
+        for (int row = 0; row < 8; ++row)
+        {
+            for (int col = 0; col < 16; ++col)
+            {
+                const float x = -8.0f + static_cast<float>(col) + (row % 2 == 0 ? 0.0f : 0.5f);
+                const float y = 0.5f + static_cast<float>(row);
+                const auto e = (row + col) % 2 == 0 ? AddBox(world, x, y, 0.5f, 0.5f, 1.0f) : AddBall(world, x, y, 0.5f);
+                auto& rb = *world.GetComponent<physics::RigidBodyComponent>(e);
+                rb.friction = 0.6f;
+                physics::ConfigureBoxInertia(rb, 1.0f, 1.0f);
+                bodies.push_back(e);
+            }
+        }
+        return bodies;
+    }
+
+    void VerifyTiledStepIsIndependentOfWorkers()
+    {
+        jobs::JobSystem jobSystem;
+        ecs::World serial;
+        ecs::World parallel;
+        const auto a = BuildWall(serial, physics::PhysicsExecution::Tiled, nullptr);
+        const auto b = BuildWall(parallel, physics::PhysicsExecution::Tiled, &jobSystem);
+        for (int frame = 0; frame < 60; ++frame)
+        {
+            serial.Update(kDt);
+            parallel.Update(kDt);
+        }
+        const ecs::World& viewA = serial;
+        const ecs::World& viewB = parallel;
+        for (std::size_t i = 0; i < a.size(); ++i)
+        {
+            const auto* ta = viewA.GetComponent<physics::TransformComponent>(a[i]);
+            const auto* tb = viewB.GetComponent<physics::TransformComponent>(b[i]);
+            assert(std::memcmp(&ta->x, &tb->x, sizeof(float)) == 0);
+            assert(std::memcmp(&ta->y, &tb->y, sizeof(float)) == 0);
+        }
+    }
+
+    void VerifyTiledWallRestsLikeStaged()
+    {
+        // Staged re-measures penetration here too, as Tiled always does.
+        jobs::JobSystem jobSystem;
+        ecs::World staged;
+        ecs::World tiled;
+        const auto a = BuildWall(staged, physics::PhysicsExecution::Staged, &jobSystem, 1e-6f);
+        const auto b = BuildWall(tiled, physics::PhysicsExecution::Tiled, &jobSystem);
+        for (int frame = 0; frame < 240; ++frame)
+        {
+            staged.Update(kDt);
+            tiled.Update(kDt);
+        }
+
+        // Every body at rest on the floor or on the row below, across the
+        // tile borders as well as inside the tiles.
+        auto rest = [](const ecs::World& world, const std::vector<ecs::EntityId>& bodies)
+        {
+            float meanY = 0.0f;
+            for (const auto e : bodies)
+            {
+                const auto* tf = world.GetComponent<physics::TransformComponent>(e);
+                const auto* rb = world.GetComponent<physics::RigidBodyComponent>(e);
+                assert(std::sqrt(rb->vx * rb->vx + rb->vy * rb->vy) < 0.05f);
+                assert(tf->y > 0.45f);
+                meanY += tf->y / static_cast<float>(bodies.size());
+            }
+            return meanY;
+        };
+        const float stagedY = rest(staged, a);
+        const float tiledY = rest(tiled, b);
+        assert(std::fabs(stagedY - tiledY) < 0.02f);
+    }
+
+    void VerifyStaticBodiesStayUnstamped()
+    {
+        // PrepareContacts stamps only the bodies it writes back. The floor
+        // keeps its creation stamp through the step, and the one consumer of
+        // body stamps, the incremental world hash, still matches a full hash.
+        jobs::JobSystem jobSystem;
+        for (const auto execution : {physics::PhysicsExecution::Staged, physics::PhysicsExecution::Tiled})
+        {
+            ecs::World world;
+            BuildWall(world, execution, &jobSystem);
+            const auto* rbStorage = std::as_const(world).GetStorage<physics::RigidBodyComponent>();
+            const auto* tfStorage = std::as_const(world).GetStorage<physics::TransformComponent>();
+            std::vector<std::pair<std::size_t, std::uint32_t>> statics;
+            for (std::size_t i = 0; i < rbStorage->Size(); ++i)
+            {
+                if (rbStorage->GetData()[i].invMass == 0.0f)
+                {
+                    statics.emplace_back(i, rbStorage->ChangedTick(i));
+                    assert(tfStorage->ChangedTick(i) == rbStorage->ChangedTick(i));
+                }
+            }
+            assert(statics.size() == 1);
+
+            simlab::WorldHasher hasher;
+            simlab::WorldHasher incremental;
+            const std::uint32_t start = world.ChangeTick();
+            for (int frame = 0; frame < 30; ++frame)
+            {
+                world.Update(kDt);
+                assert(incremental.HashWorldChanged(world) == hasher.HashWorld(world));
+            }
+            for (const auto& [slot, stamp] : statics)
+            {
+                assert(rbStorage->ChangedTick(slot) == stamp);
+                assert(tfStorage->ChangedTick(slot) == stamp);
+            }
+            assert(rbStorage->ChangedTick(statics.front().first + 1) >= start);
+        }
+    }
+}
+
+int main()
+{
+    VerifyTilesFindTheDetectPairs();
+    VerifyTiledStepIsIndependentOfWorkers();
+    VerifyTiledWallRestsLikeStaged();
+    VerifyStaticBodiesStayUnstamped();
+    std::cout << "Physics tiled step tests passed\n";
+    return 0;
+}
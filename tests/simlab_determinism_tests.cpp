@@ -38,6 +38,7 @@ namespace
         scenario->Setup(world);
 
         simlab::WorldHasher hasher;
+        simlab::WorldHasher incremental;
         std::vector<std::uint64_t> hashes;
         hashes.reserve(static_cast<std::size_t>(steps));
 
@@ -46,6 +47,9 @@ namespace
             scenario->Update(world, dt);
             world.Update(dt);
             hashes.push_back(hasher.HashWorld(world));
+            // Every write a system makes must be stamped for the frame metrics
+            // hash to see it.
+            assert(incremental.HashWorldChanged(world) == hashes.back());
         }
 
         return hashes;